@@ -23,6 +23,7 @@
 #include "mpi_tags.h"
 
 #include <RayPlatform/cryptography/crypto.h>
+#include <RayPlatform/core/OperatingSystem.h>
 
 #include <iostream>
 #include <iomanip>
@@ -35,17 +36,17 @@ using namespace std;
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #define NO_VALUE -1
 #define ACTOR_MODEL_NOBODY NO_VALUE
 #define ROUTING_NO_VALUE NO_VALUE
 
 /**
- * We always pad the buffer with actor source and actor destination.
- * If routing is enabled, we also pad with the route source and the route destination.
+ * The buffer is padded with a compact header that ends with a flags byte.
+ * Actors are only written when they can not be deduced from the ranks,
+ * routing fields when routing is enabled, and mini-ranks when mini-ranks are enabled.
  * Finally, the buffer may be padded with a checksum too !
- *
-
  */
 
 Message::Message() {
@@ -68,6 +69,10 @@ void Message::initialize() {
 
 	m_miniRankSource = NO_VALUE;
 	m_miniRankDestination = NO_VALUE;
+
+	m_sequence = MESSAGE_NO_SEQUENCE;
+
+	m_committed = false;
 }
 
 Message::~Message() {
@@ -147,6 +152,7 @@ void Message::print(){
 	cout << " DestinationActor: " << m_destinationActor;
 	cout << " RoutingSource: " << m_routingSource;
 	cout << " RoutingDestination: " << m_routingDestination;
+	cout << " Sequence: " << m_sequence;
 	cout << " MiniRankSource: " << m_miniRankSource;
 	cout << " MiniRankDestination: " << m_miniRankDestination;
 
@@ -181,8 +187,10 @@ void Message::printBuffer(const char * buffer, int bytes) const {
 	cout << endl;
 }
 
+// another buffer may not have room for the header
 void Message::setBuffer(void *buffer){
 	m_buffer = buffer;
+	m_committed = false;
 }
 
 void Message::setTag(MessageTag tag){
@@ -235,63 +243,19 @@ void Message::setDestinationActor(int destinationActor) {
 	m_destinationActor = destinationActor;
 }
 
-void Message::saveActorMetaData() {
-
-	// actor model metadata is the first to be saved.
-	// So we don't have anything to remove from offset.
-
-	// write rank numbers for these.
-	// MPI ranks actually have actor names too !
-	if(m_sourceActor < 0 && m_destinationActor < 0) {
-		m_sourceActor = m_source;
-		m_destinationActor = m_destination;
-	}
+void Message::saveActorMetaData(char*memory) {
 
 #ifdef CONFIG_ASSERT
-	int bytes = getNumberOfBytes();
-	uint32_t checksumBefore = computeCyclicRedundancyCode32((uint8_t*)getBuffer(), bytes);
-
 	if(m_sourceActor < 0) {
 		cout << "Error m_sourceActor " << m_sourceActor;
 		printActorMetaData();
 	}
 	assert(m_sourceActor >= 0 || m_sourceActor == ACTOR_MODEL_NOBODY);
 	assert(m_destinationActor >= 0 || m_destinationActor == ACTOR_MODEL_NOBODY);
-
-	// check that the overwrite worked.
-	/*
-	assert(m_sourceActor != ACTOR_MODEL_NOBODY);
-	assert(m_destinationActor != ACTOR_MODEL_NOBODY);
-	*/
 #endif
 
-	//cout << "DEBUG saveActorMetaData tag " << getTag() << endl;
-
-	int offset = getNumberOfBytes();
-
-	// actor metadata must be the first to be saved.
-	offset -= 0;
-
-	char * memory = (char*) getBuffer();
-
-	memcpy(memory + offset + MESSAGE_META_DATA_ACTOR_SOURCE, &m_sourceActor, sizeof(int));
-	memcpy(memory + offset + MESSAGE_META_DATA_ACTOR_DESTINATION, &m_destinationActor, sizeof(int));
-	//printActorMetaData();
-
-	//setCount(m_count + 1);
-	//m_count += 1; // add 1 uint64_t
-
-	/*
-	cout << "DEBUG after saveActorMetaData ";
-	printActorMetaData();
-	cout << endl;
-	*/
-
-#ifdef CONFIG_ASSERT
-	uint32_t checksumAfter = computeCyclicRedundancyCode32((uint8_t*)getBuffer(), bytes);
-
-	assert(checksumBefore == checksumAfter);
-#endif
+	memcpy(memory, &m_sourceActor, sizeof(int));
+	memcpy(memory + sizeof(int), &m_destinationActor, sizeof(int));
 }
 
 void Message::printActorMetaData() {
@@ -302,37 +266,10 @@ void Message::printActorMetaData() {
 
 }
 
-void Message::loadActorMetaData() {
-/*
-	cout << "DEBUG before loadActorMetaData -> ";
-	printActorMetaData();
-	cout << endl;
-*/
-	// the buffer contains the actor metadata. and routing metadata.
-	int offset = getNumberOfBytes();
-	//offset -= 2 * sizeof(int);
-	//offset -= 2 * sizeof(int);
-
-	char * memory = (char*) getBuffer();
-
-	memcpy(&m_sourceActor, memory + offset + MESSAGE_META_DATA_ACTOR_SOURCE, sizeof(int));
-	memcpy(&m_destinationActor, memory + offset + MESSAGE_META_DATA_ACTOR_DESTINATION, sizeof(int));
+void Message::loadActorMetaData(const char*memory) {
 
-
-	/*
-	cout << "DEBUG loadActorMetaData m_sourceActor= " << m_sourceActor;
-	cout << " m_destinationActor= " << m_destinationActor << endl;
-*/
-	// remove 1 uint64_t
-
-	//setNumberOfBytes(getNumberOfBytes() - 2 * sizeof(int));
-	//setCount(m_count - 1);
-	//m_count -= 1;
-/*
-	cout << "DEBUG after loadActorMetaData -> ";
-	printActorMetaData();
-	cout << endl;
-	*/
+	memcpy(&m_sourceActor, memory, sizeof(int));
+	memcpy(&m_destinationActor, memory + sizeof(int), sizeof(int));
 
 #ifdef CONFIG_ASSERT
 	if(!(m_sourceActor >= 0 || m_sourceActor == ACTOR_MODEL_NOBODY)) {
@@ -346,8 +283,56 @@ void Message::loadActorMetaData() {
 
 }
 
+/**
+ * The actors of a message that is not routed are the source and the
+ * destination of the transport operation, so they are implicit.
+ */
+uint8_t Message::getHeaderFlags() const {
+
+	int sourceActor = m_sourceActor;
+	int destinationActor = m_destinationActor;
+
+	// saveMetaData gives rank names to anonymous actors
+	if(sourceActor < 0 && destinationActor < 0) {
+		sourceActor = m_source;
+		destinationActor = m_destination;
+	}
+
+	uint8_t flags = MESSAGE_WIRE_FORMAT_VERSION << MESSAGE_HEADER_VERSION_SHIFT;
+
+	if(m_miniRankSource != NO_VALUE || m_miniRankDestination != NO_VALUE)
+		flags |= MESSAGE_HEADER_MINI_RANKS;
+
+	if(m_routingSource != ROUTING_NO_VALUE || m_routingDestination != ROUTING_NO_VALUE)
+		flags |= MESSAGE_HEADER_ROUTING;
+
+	if((flags & MESSAGE_HEADER_ROUTING) || sourceActor != m_source
+			|| destinationActor != m_destination)
+		flags |= MESSAGE_HEADER_ACTORS;
+
+	if(m_sequence != MESSAGE_NO_SEQUENCE)
+		flags |= MESSAGE_HEADER_SEQUENCE;
+
+	return flags;
+}
+
+int Message::getHeaderSize(uint8_t flags) {
+
+	int bytes = sizeof(uint8_t);
+
+	for(int bit = 0 ; bit < 3 ; ++bit) {
+		if(flags & (1 << bit))
+			bytes += MESSAGE_HEADER_PAIR_SIZE;
+	}
+
+	if(flags & MESSAGE_HEADER_SEQUENCE)
+		bytes += MESSAGE_HEADER_SEQUENCE_SIZE;
+
+	return bytes;
+}
+
 int Message::getMetaDataSize() const {
-	return 4 * sizeof(int);
+	return getHeaderSize(getHeaderFlags());
 }
 
 void Message::setRoutingSource(int source) {
@@ -360,40 +345,15 @@ void Message::setRoutingDestination(int destination) {
 	m_routingDestination = destination;
 }
 
-void Message::saveRoutingMetaData() {
+void Message::saveRoutingMetaData(char*memory) {
 
 #ifdef CONFIG_ASSERT
 	assert(m_routingSource >= 0 || m_routingSource == ROUTING_NO_VALUE);
 	assert(m_routingDestination >= 0 || m_routingDestination == ROUTING_NO_VALUE);
 #endif
 
-	/*
-	cout << "DEBUG saveRoutingMetaData m_routingSource " << m_routingSource;
-	cout << " m_routingDestination " << m_routingDestination << endl;
-*/
-	int offset = getNumberOfBytes();
-	char * memory = (char*) getBuffer();
-
-	// the count already includes the actor addresses
-	// this is stupid, but hey, nobody aside me is touching this code
-	// with a ten-foot stick
-	// 2013-11-18: this was fixed by grouping the  changes to count in saveMetaData().
-	//offset -= 2 * sizeof(int);
-
-	memcpy(memory + offset + MESSAGE_META_DATA_ROUTE_SOURCE, &m_routingSource, sizeof(int));
-	memcpy(memory + offset + MESSAGE_META_DATA_ROUTE_DESTINATION, &m_routingDestination, sizeof(int));
-	//printActorMetaData();
-
-	//setNumberOfBytes(getNumberOfBytes() + 2 * sizeof(int));
-	//m_count += 1; // add 1 uint64_t
-
-	//cout << "DEBUG saved routing metadata at offset " << offset << " new count " << m_count << endl;
-	//displayMetaData();
-
-#ifdef CONFIG_ASSERT
-	//assert(getNumberOfBytes() <= (int)(MAXIMUM_MESSAGE_SIZE_IN_BYTES + 4 * sizeof(int)));
-#endif
-
+	memcpy(memory, &m_routingSource, sizeof(int));
+	memcpy(memory + sizeof(int), &m_routingDestination, sizeof(int));
 }
 
 
@@ -407,45 +367,10 @@ int Message::getRoutingDestination() const {
 	return m_routingDestination;
 }
 
-void Message::loadRoutingMetaData() {
-	//cout << "DEBUG loadRoutingMetaData count " << getNumberOfBytes() << endl;
-
-	int offset = getNumberOfBytes();
-
-	// m_count contains actor metadata *AND* routing metadata (if necessary)
-	/*
-	offset -= 2 * sizeof(int);
-	offset -= 2 * sizeof(int);
-	*/
-
-	//cout << "Bytes before: " << m_bytes << endl;
-
-	char * memory = (char*) getBuffer();
-
-#ifdef CONFIG_ASSERT
-	assert(memory != NULL);
-#endif
+void Message::loadRoutingMetaData(const char*memory) {
 
-	//cout << "DEBUG memory " << (void*)memory << " offset " << offset;
-	//cout << " MESSAGE_META_DATA_ROUTE_SOURCE " << MESSAGE_META_DATA_ROUTE_SOURCE << endl;
-
-	memcpy(&m_routingSource, memory + offset + MESSAGE_META_DATA_ROUTE_SOURCE, sizeof(int));
-	memcpy(&m_routingDestination, memory + offset + MESSAGE_META_DATA_ROUTE_DESTINATION, sizeof(int));
-
-	//setNumberOfBytes(getNumberOfBytes() - 2 * sizeof(int));
-	//m_count -= 1;
-
-#if 0
-	cout << "DEBUG loadRoutingMetaData ";
-	cout << "loaded m_routingSource ";
-	cout << m_routingSource;
-	cout << " m_routingDestination " << m_routingDestination;
-	cout << " offset " << offset ;
-	printActorMetaData();
-	cout << endl;
-#endif
-
-	//displayMetaData();
+	memcpy(&m_routingSource, memory, sizeof(int));
+	memcpy(&m_routingDestination, memory + sizeof(int), sizeof(int));
 
 	// these can not be negative, otherwise
 	// this method would not have been called now.
@@ -464,17 +389,39 @@ void Message::loadRoutingMetaData() {
 #endif
 }
 
+void Message::setSequence(int sequence) {
+
+	m_sequence = sequence;
+}
+
+int Message::getSequence() const {
+
+	return m_sequence;
+}
+
+void Message::setCommitted(bool committed) {
+
+	m_committed = committed;
+}
+
+bool Message::isCommitted() const {
+
+	return m_committed;
+}
+
 void Message::displayMetaData() {
 	Message * aMessage = this;
 
 	cout << " DEBUG displayMetaData count " << aMessage->getNumberOfBytes();
 	cout << " tag " << getTag() << endl;
 
-	int offset = getNumberOfBytes() - 2 * 2 * sizeof(int);
+	uint8_t flags = getHeaderFlags();
 
-	for(int i = 0 ; i < 4 ; ++i) {
-		cout << " [" << i << " -> " << ((int*)aMessage->getBuffer())[offset + i] << "]";
-	}
+	cout << " [flags -> " << (int) flags << "]";
+	cout << " [header -> " << getHeaderSize(flags) << " bytes]";
+	cout << " [actors -> " << m_sourceActor << " " << m_destinationActor << "]";
+	cout << " [routing -> " << m_routingSource << " " << m_routingDestination << "]";
+	cout << " [sequence -> " << m_sequence << "]";
 	cout << endl;
 
 }
@@ -568,34 +515,79 @@ void Message::saveMetaData() {
 #ifdef CONFIG_ASSERT
 
 	int bytes = getNumberOfBytes();
-	uint32_t checksumBefore = computeCyclicRedundancyCode32((uint8_t*)getBuffer(), bytes);
+	uint32_t checksumBefore = computeCastagnoliCode32((uint8_t*)getBuffer(), bytes);
 #endif
 
-	this->saveMiniRankMetaData();
-	this->saveActorMetaData();
-	this->saveRoutingMetaData();
+	// write rank numbers for these.
+	// MPI ranks actually have actor names too !
+	if(m_sourceActor < 0 && m_destinationActor < 0) {
+		m_sourceActor = m_source;
+		m_destinationActor = m_destination;
+	}
+
+	uint8_t flags = getHeaderFlags();
+
+	char * memory = getBufferBytes() + getNumberOfBytes();
+
+	if(flags & MESSAGE_HEADER_MINI_RANKS) {
+		this->saveMiniRankMetaData(memory);
+		memory += MESSAGE_HEADER_PAIR_SIZE;
+	}
+
+	if(flags & MESSAGE_HEADER_ACTORS) {
+		this->saveActorMetaData(memory);
+		memory += MESSAGE_HEADER_PAIR_SIZE;
+	}
+
+	if(flags & MESSAGE_HEADER_ROUTING) {
+		this->saveRoutingMetaData(memory);
+		memory += MESSAGE_HEADER_PAIR_SIZE;
+	}
+
+	if(flags & MESSAGE_HEADER_SEQUENCE) {
+		memcpy(memory, &m_sequence, sizeof(int));
+		memory += MESSAGE_HEADER_SEQUENCE_SIZE;
+	}
+
+	memcpy(memory, &flags, sizeof(flags));
 
 #ifdef CONFIG_ASSERT
 	assert(getNumberOfBytes() >= 0);
 	assert(getNumberOfBytes() <= MAXIMUM_MESSAGE_SIZE_IN_BYTES);
 
-	uint32_t checksumAfter = computeCyclicRedundancyCode32((uint8_t*)getBuffer(), bytes);
+	uint32_t checksumAfter = computeCastagnoliCode32((uint8_t*)getBuffer(), bytes);
 
 	assert(checksumBefore == checksumAfter);
 #endif
 
 	// we need this for the transfer.
-	setNumberOfBytes(getNumberOfBytes() + MESSAGE_META_DATA_SIZE);
+	setNumberOfBytes(getNumberOfBytes() + getHeaderSize(flags));
 }
 
 void Message::loadMetaData() {
 
-	// we just needed this for the transfer.
-	setNumberOfBytes(getNumberOfBytes() - MESSAGE_META_DATA_SIZE);
+#ifdef CONFIG_ASSERT
+	assert(getNumberOfBytes() >= (int) sizeof(uint8_t));
+#endif
 
-	//cout << "loadMetaData MESSAGE_META_DATA_SIZE " << MESSAGE_META_DATA_SIZE << endl;
+	// the flags byte is the last one
+	uint8_t flags = 0;
+	memcpy(&flags, getBufferBytes() + getNumberOfBytes() - sizeof(flags), sizeof(flags));
 
-	//cout << "loadMetaData bytes: " << getNumberOfBytes() << endl;
+	// decoding another layout would hand garbage to the handlers
+	if((flags >> MESSAGE_HEADER_VERSION_SHIFT) != MESSAGE_WIRE_FORMAT_VERSION) {
+		cout << "Error: wire-format version is " << (flags >> MESSAGE_HEADER_VERSION_SHIFT);
+		cout << ", expected " << MESSAGE_WIRE_FORMAT_VERSION << endl;
+		print();
+		exit(EXIT_WIRE_FORMAT_MISMATCH);
+	}
+
+#ifdef CONFIG_ASSERT
+	assert((flags & ~(MESSAGE_HEADER_FIELDS | (0x07 << MESSAGE_HEADER_VERSION_SHIFT))) == 0);
+#endif
+
+	// we just needed this for the transfer.
+	setNumberOfBytes(getNumberOfBytes() - getHeaderSize(flags));
 
 #ifdef CONFIG_ASSERT
 	assert(getNumberOfBytes() >= 0);
@@ -605,38 +597,55 @@ void Message::loadMetaData() {
 	assert(getNumberOfBytes() <= MAXIMUM_MESSAGE_SIZE_IN_BYTES);
 #endif
 
-	this->loadRoutingMetaData();
-	this->loadActorMetaData();
-	this->loadMiniRankMetaData();
+	const char * memory = getBufferBytes() + getNumberOfBytes();
+
+	setMiniRanks(NO_VALUE, NO_VALUE);
+
+	if(flags & MESSAGE_HEADER_MINI_RANKS) {
+		this->loadMiniRankMetaData(memory);
+		memory += MESSAGE_HEADER_PAIR_SIZE;
+	}
+
+	if(flags & MESSAGE_HEADER_ACTORS) {
+		this->loadActorMetaData(memory);
+		memory += MESSAGE_HEADER_PAIR_SIZE;
+	} else {
+		m_sourceActor = m_source;
+		m_destinationActor = m_destination;
+	}
+
+	m_routingSource = ROUTING_NO_VALUE;
+	m_routingDestination = ROUTING_NO_VALUE;
+
+	if(flags & MESSAGE_HEADER_ROUTING) {
+		this->loadRoutingMetaData(memory);
+		memory += MESSAGE_HEADER_PAIR_SIZE;
+	}
 
+	m_sequence = MESSAGE_NO_SEQUENCE;
+
+	if(flags & MESSAGE_HEADER_SEQUENCE) {
+		memcpy(&m_sequence, memory, sizeof(int));
+		memory += MESSAGE_HEADER_SEQUENCE_SIZE;
+	}
 }
 
-void Message::saveMiniRankMetaData() {
+void Message::saveMiniRankMetaData(char*memory) {
 
 	int sourceMiniRank = getSourceMiniRank();
 	int destinationMiniRank = getDestinationMiniRank();
 
-	memcpy(getBufferBytes() + getNumberOfBytes() + MESSAGE_META_DATA_MINIRANK_SOURCE,
-			&sourceMiniRank, sizeof(sourceMiniRank));
-
-	memcpy(getBufferBytes() + getNumberOfBytes() + MESSAGE_META_DATA_MINIRANK_DESTINATION,
-			&destinationMiniRank, sizeof(destinationMiniRank));
+	memcpy(memory, &sourceMiniRank, sizeof(sourceMiniRank));
+	memcpy(memory + sizeof(int), &destinationMiniRank, sizeof(destinationMiniRank));
 }
 
-void Message::loadMiniRankMetaData() {
+void Message::loadMiniRankMetaData(const char*memory) {
 
 	int sourceMiniRank = -1;
 	int destinationMiniRank = -1;
 
-	memcpy(
-			&sourceMiniRank,
-			getBufferBytes() + getNumberOfBytes() + MESSAGE_META_DATA_MINIRANK_SOURCE,
-			sizeof(sourceMiniRank));
-
-	memcpy(
-			&destinationMiniRank,
-			getBufferBytes() + getNumberOfBytes() + MESSAGE_META_DATA_MINIRANK_DESTINATION,
-			sizeof(destinationMiniRank));
+	memcpy(&sourceMiniRank, memory, sizeof(sourceMiniRank));
+	memcpy(&destinationMiniRank, memory + sizeof(int), sizeof(destinationMiniRank));
 
 	setMiniRanks(sourceMiniRank, destinationMiniRank);
 }
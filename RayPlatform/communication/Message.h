@@ -22,16 +22,33 @@ see <http://www.gnu.org/licenses/>
 #ifndef _Message_H
 #define _Message_H
 
-#define MESSAGE_META_DATA_ACTOR_SOURCE		0
-#define MESSAGE_META_DATA_ACTOR_DESTINATION	( MESSAGE_META_DATA_ACTOR_SOURCE + sizeof(int) )
-#define MESSAGE_META_DATA_ROUTE_SOURCE	 	( MESSAGE_META_DATA_ACTOR_DESTINATION + sizeof(int) )
-#define MESSAGE_META_DATA_ROUTE_DESTINATION	( MESSAGE_META_DATA_ROUTE_SOURCE + sizeof(int))
-#define MESSAGE_META_DATA_MINIRANK_SOURCE       ( MESSAGE_META_DATA_ROUTE_DESTINATION + sizeof(int) )
-#define MESSAGE_META_DATA_MINIRANK_DESTINATION  ( MESSAGE_META_DATA_MINIRANK_SOURCE + sizeof(int) )
-#define MESSAGE_META_DATA_CHECKSUM	 	( MESSAGE_META_DATA_MINIRANK_DESTINATION + sizeof(int))
-#define MESSAGE_META_DATA_SIZE                  ( MESSAGE_META_DATA_CHECKSUM + sizeof(uint32_t) )
+/*
+ * The header is written after the payload and ends with a flags byte.
+ * The flags tell which pairs of fields are present, so that a message
+ * only carries the metadata that is in use.
+ */
+#define MESSAGE_HEADER_ACTORS			0x01
+#define MESSAGE_HEADER_ROUTING			0x02
+#define MESSAGE_HEADER_MINI_RANKS		0x04
+#define MESSAGE_HEADER_SEQUENCE			0x08
+#define MESSAGE_HEADER_FIELDS			0x0f
+
+/* the wire-format version is stored in the 3 high bits of the flags byte */
+#define MESSAGE_WIRE_FORMAT_VERSION		2
+#define MESSAGE_HEADER_VERSION_SHIFT		5
+
+#define MESSAGE_HEADER_PAIR_SIZE		( 2 * sizeof(int) )
+#define MESSAGE_HEADER_SEQUENCE_SIZE		( sizeof(int) )
+#define MESSAGE_HEADER_MAXIMUM_SIZE		( 3 * MESSAGE_HEADER_PAIR_SIZE + MESSAGE_HEADER_SEQUENCE_SIZE + sizeof(uint8_t) )
 
+/* a message that is not a query or a reply of the VirtualCommunicator */
+#define MESSAGE_NO_SEQUENCE			-1
 
+/* the old fixed-size trailer, used to report the bytes saved */
+#define MESSAGE_LEGACY_META_DATA_SIZE		( 7 * sizeof(int) )
+
+/* room to reserve after the payload: the largest header and a checksum */
+#define MESSAGE_META_DATA_SIZE                  ( MESSAGE_HEADER_MAXIMUM_SIZE + sizeof(uint32_t) )
 
 #include <RayPlatform/core/types.h>
 
@@ -47,46 +64,30 @@ see <http://www.gnu.org/licenses/>
 *
 * in the buffer:
 *
-*  Application payload (works)
-*  int source actor (works)
-*  int destination actor (works)
-*  int routing source (works)
-*  int routing destination (works)
-*  int checksum (probably broken)
+*  Application payload
+*  int source mini-rank, int destination mini-rank (if MESSAGE_HEADER_MINI_RANKS)
+*  int source actor, int destination actor (if MESSAGE_HEADER_ACTORS)
+*  int routing source, int routing destination (if MESSAGE_HEADER_ROUTING)
+*  int sequence (if MESSAGE_HEADER_SEQUENCE)
+*  uint8_t flags (field bits and wire-format version)
+*  uint32_t checksum (only if checksums are enabled)
 *
- * The offset (see Message.cpp) are relative to the number of bytes *BEFORE*
- * adding this metadata.
- * Note that the m_count is the number of MessageUnit for the message
- * and may include metadata if saveActorMetaData or saveRoutingMetaData
- * was called.
- *
- * Obviously, this is the correct order for calling this methods:
- *
- * setSourceActor
- * setDestinationActor
- * saveActorMetaData  (increases m_count by 1 MessageUnit)
- * setRoutingSource
- * setRoutingDestination
- * saveRoutingMetaData (increases m_count by 1 MessageUnit)
- *
- * then, the message can be sent.
+ * saveMetaData appends the header and increases the number of bytes.
+ * loadMetaData reads the flags byte at the end of the message, decodes
+ * the fields and removes the header.
  *
- * On the receiving side:
- *
- * loadActorMetaData
- * getSourceActor
- * getDestinationActor (decreases m_count by 1 MessageUnit)
- * loadRoutingMetaData
- * getRoutingSource
- * getRoutingDestination (decreases m_count by 1 MessageUnit)
+ * Actors are omitted when they are the source and destination ranks of
+ * a message that is not routed: the receiver knows these already.
+ * Routing fields are only sent when routing is enabled and mini-rank
+ * fields only when mini-ranks are enabled.
+ * The sequence is only sent with the queries of the VirtualCommunicator
+ * and with their replies.
  *
  * All this crap is necessary because messages exposed to actors or to MPI ranks
  * do not contain these metadata.
  *
  * The platform allows MAXIMUM_MESSAGE_SIZE_IN_BYTES for buffers of application messages.
- * To this, we add 2 * MessageUnit (1 MessageUnit for actors, 1 MessageUnit for routing).
- *
- * TODO: the checksum code is probably broken by now. check that out.
+ * To this, we add MESSAGE_META_DATA_SIZE bytes for the header and the checksum.
  *
  * \author Sébastien Boisvert
  */
@@ -126,14 +127,23 @@ private:
 	int m_routingSource;
 	int m_routingDestination;
 
+	/** identifies a query and its reply, MESSAGE_NO_SEQUENCE otherwise */
+	int m_sequence;
+
+	/** true when m_buffer is an outbox buffer with room for the header,
+	 * set by ComputeCore::commitMessage, this is not sent */
+	bool m_committed;
+
 	void initialize();
 
-	void loadActorMetaData();
-	void saveActorMetaData();
-	void loadMiniRankMetaData();
-	void saveMiniRankMetaData();
-	void loadRoutingMetaData();
-	void saveRoutingMetaData();
+	void loadActorMetaData(const char*memory);
+	void saveActorMetaData(char*memory);
+	void loadMiniRankMetaData(const char*memory);
+	void saveMiniRankMetaData(char*memory);
+	void loadRoutingMetaData(const char*memory);
+	void saveRoutingMetaData(char*memory);
+
+	uint8_t getHeaderFlags() const;
 
 public:
 	Message();
@@ -187,7 +197,9 @@ public:
 	void setSourceActor(int sourceActor);
 	void setDestinationActor(int destinationActor);
 
+/** the number of bytes that saveMetaData will append */
 	int getMetaDataSize() const;
+	static int getHeaderSize(uint8_t flags);
 	void printActorMetaData();
 
 	void setRoutingSource(int source);
@@ -195,6 +207,13 @@ public:
 
 	int getRoutingSource() const;
 	int getRoutingDestination() const;
+
+	void setSequence(int sequence);
+	int getSequence() const;
+
+	void setCommitted(bool committed);
+	bool isCommitted() const;
+
 	void displayMetaData();
 
 	void runAssertions(int size, bool routing, bool miniRanks);
@@ -0,0 +1,314 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+#include "MessageAggregator.h"
+
+#include <RayPlatform/core/ComputeCore.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#include <iostream>
+using namespace std;
+
+#ifdef CONFIG_ASSERT
+#include <assert.h>
+#endif
+
+void MessageAggregator::constructor(Rank rank,int size,ComputeCore*core){
+	m_rank=rank;
+	m_size=size;
+	m_core=core;
+
+	m_openTable.constructor(64);
+	m_firstClosedBuffer=0;
+
+	m_maximumBuffers=128;
+
+	m_flushBytes=MAXIMUM_MESSAGE_SIZE_IN_BYTES;
+	m_flushDelay=1000;
+
+	m_appendedRecords=0;
+	m_rejectedRecords=0;
+	m_sentMessages=0;
+	m_sentRecords=0;
+	m_sentBytes=0;
+
+	for(int i=0;i<AGGREGATOR_FLUSH_REASONS;i++)
+		m_flushes[i]=0;
+}
+
+/*
+ * The buffers belong to the outbox ring of the ComputeCore.
+ */
+void MessageAggregator::destructor(){
+	m_buffers.clear();
+	m_freeBuffers.clear();
+}
+
+void MessageAggregator::setThresholds(int bytes,int microseconds){
+
+	if(bytes<(int)sizeof(MessageUnit))
+		bytes=sizeof(MessageUnit);
+
+	if(bytes>MAXIMUM_MESSAGE_SIZE_IN_BYTES)
+		bytes=MAXIMUM_MESSAGE_SIZE_IN_BYTES;
+
+	if(microseconds<0)
+		microseconds=0;
+
+	m_flushBytes=bytes;
+	m_flushDelay=microseconds;
+}
+
+void MessageAggregator::setMaximumNumberOfBuffers(int buffers){
+	if(buffers<1)
+		buffers=1;
+
+	m_maximumBuffers=buffers;
+}
+
+int MessageAggregator::getMaximumNumberOfBuffers(){
+	return m_maximumBuffers;
+}
+
+uint64_t MessageAggregator::getKey(Rank destination,MessageTag tag){
+	return ((uint64_t)tag)*m_size+destination;
+}
+
+int MessageAggregator::getFreeBuffer(){
+
+	if(!m_freeBuffers.empty()){
+		int buffer=m_freeBuffers.back();
+		m_freeBuffers.pop_back();
+		m_buffers[buffer]=m_core->holdMessage();
+		return buffer;
+	}
+
+	if((int)m_buffers.size()>=m_maximumBuffers)
+		return -1;
+
+	int buffer=m_buffers.size();
+
+	m_buffers.push_back(m_core->holdMessage());
+	m_bytes.push_back(0);
+	m_records.push_back(0);
+	m_destinations.push_back(0);
+	m_tags.push_back(0);
+	m_firstRecordTimes.push_back(0);
+	m_openPositions.push_back(-1);
+	m_reasons.push_back(AGGREGATOR_FLUSH_SIZE);
+
+	return buffer;
+}
+
+bool MessageAggregator::appendBytes(Rank destination,MessageTag tag,const void*record,int bytes){
+
+	int recordBytes=AGGREGATOR_RECORD_SIZE(bytes);
+
+	#ifdef CONFIG_ASSERT
+	assert(destination>=0 && destination<m_size);
+	assert(bytes>0);
+	assert(recordBytes<=MAXIMUM_MESSAGE_SIZE_IN_BYTES);
+	#endif
+
+	uint64_t key=getKey(destination,tag);
+	int buffer=m_openTable.find(key);
+
+	// the record does not fit, the buffer is sent as it is
+	if(buffer>=0 && m_bytes[buffer]+recordBytes>MAXIMUM_MESSAGE_SIZE_IN_BYTES){
+		closeBuffer(buffer,AGGREGATOR_FLUSH_SIZE);
+		buffer=-1;
+	}
+
+	if(buffer<0){
+		buffer=getFreeBuffer();
+
+		if(buffer<0){
+			m_rejectedRecords++;
+			return false;
+		}
+
+		m_bytes[buffer]=0;
+		m_records[buffer]=0;
+		m_destinations[buffer]=destination;
+		m_tags[buffer]=tag;
+		m_firstRecordTimes[buffer]=getMicroseconds();
+
+		m_openTable.insert(key,buffer);
+		m_openPositions[buffer]=m_openBuffers.size();
+		m_openBuffers.push_back(buffer);
+	}
+
+	char*position=(char*)m_buffers[buffer]+m_bytes[buffer];
+
+	memcpy(position,record,bytes);
+
+	if(recordBytes>bytes)
+		memset(position+bytes,0,recordBytes-bytes);
+
+	m_bytes[buffer]+=recordBytes;
+	m_records[buffer]++;
+	m_appendedRecords++;
+
+	if(m_bytes[buffer]>=m_flushBytes)
+		closeBuffer(buffer,AGGREGATOR_FLUSH_SIZE);
+
+	return true;
+}
+
+/*
+ * A closed buffer does not accept records anymore and waits in
+ * m_closedBuffers for a flush.
+ */
+void MessageAggregator::closeBuffer(int buffer,int reason){
+
+	#ifdef CONFIG_ASSERT
+	assert(m_openPositions[buffer]>=0);
+	#endif
+
+	m_openTable.erase(getKey(m_destinations[buffer],m_tags[buffer]));
+
+	int position=m_openPositions[buffer];
+	int last=m_openBuffers.back();
+
+	m_openBuffers[position]=last;
+	m_openPositions[last]=position;
+	m_openBuffers.pop_back();
+	m_openPositions[buffer]=-1;
+
+	m_reasons[buffer]=reason;
+	m_closedBuffers.push_back(buffer);
+}
+
+void MessageAggregator::sendBuffer(int buffer){
+
+	#ifdef CONFIG_ASSERT
+	assert(m_bytes[buffer]>0);
+	assert(m_bytes[buffer]%sizeof(MessageUnit)==0);
+	#endif
+
+	// the records are already in the outbox buffer
+	m_core->commitMessage(m_buffers[buffer],m_bytes[buffer]/sizeof(MessageUnit),
+		m_destinations[buffer],m_tags[buffer]);
+
+	m_sentMessages++;
+	m_sentRecords+=m_records[buffer];
+	m_sentBytes+=m_bytes[buffer];
+	m_flushes[m_reasons[buffer]]++;
+
+	m_bytes[buffer]=0;
+	m_records[buffer]=0;
+	m_buffers[buffer]=NULL;
+
+	m_freeBuffers.push_back(buffer);
+}
+
+void MessageAggregator::flushAll(){
+	while(!m_openBuffers.empty())
+		closeBuffer(m_openBuffers.back(),AGGREGATOR_FLUSH_FORCED);
+}
+
+void MessageAggregator::flush(int maximumMessages){
+
+	if(!hasBufferedRecords())
+		return;
+
+	// the closed buffers first, in the order they were closed
+	int sent=0;
+
+	while(sent<maximumMessages && m_firstClosedBuffer<(int)m_closedBuffers.size()){
+		sendBuffer(m_closedBuffers[m_firstClosedBuffer++]);
+		sent++;
+	}
+
+	if(m_firstClosedBuffer==(int)m_closedBuffers.size()){
+		m_closedBuffers.clear();
+		m_firstClosedBuffer=0;
+	}
+
+	if(m_openBuffers.empty() || sent==maximumMessages)
+		return;
+
+	// then the open buffers that are old enough
+	uint64_t now=getMicroseconds();
+
+	int position=0;
+
+	while(position<(int)m_openBuffers.size() && sent<maximumMessages){
+		int buffer=m_openBuffers[position];
+
+		if(now-m_firstRecordTimes[buffer]<(uint64_t)m_flushDelay){
+			position++;
+			continue;
+		}
+
+		// the last open buffer takes this position
+		closeBuffer(buffer,AGGREGATOR_FLUSH_AGE);
+		m_closedBuffers.pop_back();
+
+		sendBuffer(buffer);
+		sent++;
+	}
+}
+
+bool MessageAggregator::hasBufferedRecords(){
+	return !m_openBuffers.empty() || m_firstClosedBuffer<(int)m_closedBuffers.size();
+}
+
+uint64_t MessageAggregator::getNumberOfSentMessages(){
+	return m_sentMessages;
+}
+
+uint64_t MessageAggregator::getNumberOfSentRecords(){
+	return m_sentRecords;
+}
+
+uint64_t MessageAggregator::getNumberOfFlushes(int reason){
+	return m_flushes[reason];
+}
+
+double MessageAggregator::getFillRatio(){
+	if(m_sentMessages==0)
+		return 0;
+
+	return (0.0+m_sentBytes)/m_sentMessages/MAXIMUM_MESSAGE_SIZE_IN_BYTES;
+}
+
+void MessageAggregator::printStatus(){
+
+	if(m_appendedRecords==0)
+		return;
+
+	double recordsPerMessage=0;
+
+	if(m_sentMessages>0)
+		recordsPerMessage=(0.0+m_sentRecords)/m_sentMessages;
+
+	cout<<"[MessageAggregator] Rank "<<m_rank<<" sent "<<m_sentRecords<<" records in ";
+	cout<<m_sentMessages<<" messages ("<<recordsPerMessage<<" records per message, ";
+	cout<<(int)(100*getFillRatio())<<"% full), flushes: "<<m_flushes[AGGREGATOR_FLUSH_SIZE]<<" size ";
+	cout<<m_flushes[AGGREGATOR_FLUSH_AGE]<<" age "<<m_flushes[AGGREGATOR_FLUSH_FORCED]<<" forced";
+
+	if(m_rejectedRecords>0)
+		cout<<", "<<m_rejectedRecords<<" records rejected because all buffers were in use";
+
+	cout<<endl;
+}
@@ -0,0 +1,188 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+#ifndef _MessageAggregator_h
+#define _MessageAggregator_h
+
+#include "Message.h"
+
+#include <RayPlatform/core/types.h>
+#include <RayPlatform/structures/StaticVector.h>
+#include <RayPlatform/structures/HandleTable.h>
+
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+using namespace std;
+
+class ComputeCore;
+
+/*
+ * Why a buffer was sent.
+ */
+#define AGGREGATOR_FLUSH_SIZE 0
+#define AGGREGATOR_FLUSH_AGE 1
+#define AGGREGATOR_FLUSH_FORCED 2
+#define AGGREGATOR_FLUSH_REASONS 3
+
+/* records are padded to a number of message units */
+#define AGGREGATOR_RECORD_SIZE(bytes) ( ((bytes)+sizeof(MessageUnit)-1)/sizeof(MessageUnit)*sizeof(MessageUnit) )
+
+/**
+ * Aggregation of small records sent to other ranks.
+ *
+ * A plugin appends records for a destination and a message tag, and
+ * the records with the same destination and the same tag are sent
+ * together in one message. A buffer is sent when it holds enough bytes
+ * (the size threshold) or when its first record is old enough (the
+ * age threshold). The ComputeCore sends the buffers that are due
+ * before it sends its outbox, so a plugin does not flush anything
+ * itself.
+ *
+ * The records are written directly in outbox buffers that the
+ * ComputeCore holds for the aggregator, and a buffer is committed
+ * in place when it is sent, so a record is copied only once.
+ *
+ * The receiver gets a normal message with the tag. It reads the
+ * records with getNumberOfRecords() and getRecord().
+ *
+ * \author RayPlatform contributors
+ */
+class MessageAggregator{
+
+	Rank m_rank;
+	int m_size;
+	ComputeCore*m_core;
+
+/** the outbox buffers, NULL when a buffer is not in use */
+	vector<MessageUnit*> m_buffers;
+
+/** state of each buffer */
+	vector<int> m_bytes;
+	vector<int> m_records;
+	vector<Rank> m_destinations;
+	vector<MessageTag> m_tags;
+	vector<uint64_t> m_firstRecordTimes;
+	vector<int> m_reasons;
+
+/** the index of each open buffer in m_openBuffers, -1 for the other ones */
+	vector<int> m_openPositions;
+
+/** buffers that accept records, indexed by tag and destination */
+	HandleTable m_openTable;
+	vector<int> m_openBuffers;
+
+/** buffers that reached the size threshold, in order */
+	vector<int> m_closedBuffers;
+	int m_firstClosedBuffer;
+
+	vector<int> m_freeBuffers;
+	int m_maximumBuffers;
+
+/** thresholds */
+	int m_flushBytes;
+	int m_flushDelay;
+
+/** statistics */
+	uint64_t m_appendedRecords;
+	uint64_t m_rejectedRecords;
+	uint64_t m_sentMessages;
+	uint64_t m_sentRecords;
+	uint64_t m_sentBytes;
+	uint64_t m_flushes[AGGREGATOR_FLUSH_REASONS];
+
+	uint64_t getKey(Rank destination,MessageTag tag);
+	int getFreeBuffer();
+	void closeBuffer(int buffer,int reason);
+	void sendBuffer(int buffer);
+
+public:
+
+/**
+ * The buffers are held and committed with the ComputeCore.
+ */
+	void constructor(Rank rank,int size,ComputeCore*core);
+	void destructor();
+
+/**
+ * Set the size threshold (in bytes, at most
+ * MAXIMUM_MESSAGE_SIZE_IN_BYTES) and the age threshold (in
+ * microseconds) of the buffers.
+ */
+	void setThresholds(int bytes,int microseconds);
+
+/**
+ * Set the number of buffers, each one is an outbox buffer.
+ * The ComputeCore adds them to its outbox ring, so this must be
+ * called before ComputeCore::run().
+ */
+	void setMaximumNumberOfBuffers(int buffers);
+	int getMaximumNumberOfBuffers();
+
+/**
+ * Append a record of a number of bytes for a destination.
+ * \returns false if all the buffers are in use, the record
+ * must be appended again later.
+ */
+	bool appendBytes(Rank destination,MessageTag tag,const void*record,int bytes);
+
+	template<class Record>
+	bool append(Rank destination,MessageTag tag,const Record&record){
+		return appendBytes(destination,tag,&record,sizeof(Record));
+	}
+
+/**
+ * Send every non-empty buffer in the next calls to flush(), for
+ * instance at the end of a step of an algorithm.
+ */
+	void flushAll();
+
+/**
+ * Send the buffers that are due, but no more than maximumMessages.
+ * This is called by the ComputeCore before it sends its outbox.
+ */
+	void flush(int maximumMessages);
+
+/** true if some records were not sent yet */
+	bool hasBufferedRecords();
+
+	template<class Record>
+	static int getNumberOfRecords(Message*message){
+		return message->getNumberOfBytes()/AGGREGATOR_RECORD_SIZE(sizeof(Record));
+	}
+
+	template<class Record>
+	static void getRecord(Message*message,int index,Record*record){
+		memcpy(record,message->getBufferBytes()+index*AGGREGATOR_RECORD_SIZE(sizeof(Record)),sizeof(Record));
+	}
+
+	uint64_t getNumberOfSentMessages();
+	uint64_t getNumberOfSentRecords();
+	uint64_t getNumberOfFlushes(int reason);
+
+/** the average number of used bytes of the sent messages, from 0 to 1 */
+	double getFillRatio();
+
+	void printStatus();
+};
+
+#endif /* _MessageAggregator_h */
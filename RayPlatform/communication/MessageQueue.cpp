@@ -21,6 +21,8 @@
 
 #include "MessageQueue.h"
 
+#include <RayPlatform/core/atomics.h>
+
 #include <iostream>
 using namespace std;
 
@@ -56,6 +58,8 @@ void MessageQueue::constructor(uint32_t bins){
 	m_size=bins+1;
 	m_headForPopOperations=0;
 	m_tailForPushOperations=0;
+	m_cachedHead=0;
+	m_cachedTail=0;
 
 	m_ring=(Message*)__Malloc(m_size*sizeof(Message),"/MessageQueue",false);
 
@@ -86,34 +90,52 @@ void MessageQueue::constructor(uint32_t bins){
  */
 bool MessageQueue::push(Message*message){
 
-	uint32_t nextTail=increment(m_tailForPushOperations); // not atomic
+	return pushMany(message,1)==1;
+}
 
 /*
- * The queue is full.
- * Maybe there is a pop() call in progress, but the new head
- * has not been published yet so we must wait.
+ * pushMany() is called by the producer only.
  */
-	if(nextTail==m_headForPopOperations)
-		return false;
+uint32_t MessageQueue::pushMany(Message*messages,uint32_t count){
 
-	m_ring[m_tailForPushOperations]=*message; // not atomic
+	uint32_t tail=m_tailForPushOperations;
 
 /*
- * Publish the change to other threads.
- * This must be atomic.
- * Instructions must be executed in-order otherwise,
- * m_tailForPushOperations will publish a draft of the message.
+ * The queue looks full.
+ * Maybe there is a pop() call that has published a new head since then.
  */
-	m_tailForPushOperations=nextTail; // likely atomic if sizeof(SystemBus) >= 32 bits
+	if(getFreeSlots(tail)<count)
+		m_cachedHead=loadAcquire(&m_headForPopOperations);
 
-	return true;
+	uint32_t freeSlots=getFreeSlots(tail);
+
+	if(count>freeSlots)
+		count=freeSlots;
+
+	if(count==0)
+		return 0;
+
+	for(uint32_t i=0;i<count;i++){
+		m_ring[tail]=messages[i];
+		tail=increment(tail);
+	}
+
+/*
+ * Publish the messages to the other thread.
+ * The release store orders the copies above before the new tail.
+ */
+	storeRelease(&m_tailForPushOperations,tail);
+
+	return count;
 }
 
 /**
+ * isFull() is called by the producer only.
+ *
  * \see http://www.codeproject.com/Articles/43510/Lock-Free-Single-Producer-Single-Consumer-Circular
  */
 bool MessageQueue::isFull(){
-	return increment(m_tailForPushOperations) == m_headForPopOperations;
+	return increment(m_tailForPushOperations) == loadAcquire(&m_headForPopOperations);
 }
 
 /*
@@ -123,28 +145,86 @@ bool MessageQueue::isFull(){
  */
 bool MessageQueue::pop(Message*message){
 
+	return popMany(message,1)==1;
+}
+
+/*
+ * popMany() is called by the consumer only.
+ */
+uint32_t MessageQueue::popMany(Message*messages,uint32_t maximum){
+
+	uint32_t head=m_headForPopOperations;
+
+	if(getUsedSlots(head)<maximum)
+		m_cachedTail=loadAcquire(&m_tailForPushOperations);
+
+	uint32_t usedSlots=getUsedSlots(head);
+
+	if(maximum>usedSlots)
+		maximum=usedSlots;
+
 /*
  * We can not pop from am empty list.
  */
-	if(m_headForPopOperations==m_tailForPushOperations)
-		return false;
+	if(maximum==0)
+		return 0;
 
-	*message=m_ring[m_headForPopOperations]; // not atomic
+	for(uint32_t i=0;i<maximum;i++){
+		messages[i]=m_ring[head];
+		head=increment(head);
+	}
 
-	uint32_t nextHead=increment(m_headForPopOperations); // not atomic
-	
 /*
  * Publish the change.
- * Instructions must be executed in-order otherwise,
- * m_tailForPushOperations will publish a draft of the message.
+ * The release store orders the copies above before the new head, otherwise
+ * the producer could overwrite a slot that is being read.
+ */
+	storeRelease(&m_headForPopOperations,head);
+
+	return maximum;
+}
+
+/*
+ * peek() is called by the consumer only.
  */
-	m_headForPopOperations=nextHead; // likely atomic if sizeof(SystemBus) >= 32 bits
+bool MessageQueue::peek(Message*message){
+
+	uint32_t head=m_headForPopOperations;
+
+	if(getUsedSlots(head)==0)
+		m_cachedTail=loadAcquire(&m_tailForPushOperations);
+
+	if(getUsedSlots(head)==0)
+		return false;
+
+	*message=m_ring[head];
 
 	return true;
 }
 
+/*
+ * getNumberOfQueuedMessages() is called by the producer only.
+ * With the acquire load, whatever the consumer did before popping
+ * a message is finished when the producer sees it as popped.
+ */
+uint32_t MessageQueue::getNumberOfQueuedMessages(){
+
+	uint32_t head=loadAcquire(&m_headForPopOperations);
+
+	return (m_tailForPushOperations+m_size-head)%m_size;
+}
+
+/*
+ * hasContent() is called by the consumer only.
+ */
 bool MessageQueue::hasContent(){
-	return m_headForPopOperations!=m_tailForPushOperations;
+
+	if(m_cachedTail!=m_headForPopOperations)
+		return true;
+
+	m_cachedTail=loadAcquire(&m_tailForPushOperations);
+
+	return m_cachedTail!=m_headForPopOperations;
 }
 
 void MessageQueue::destructor(){
@@ -159,6 +239,8 @@ void MessageQueue::destructor(){
 	m_size=0;
 	m_headForPopOperations=0;
 	m_tailForPushOperations=0;
+	m_cachedHead=0;
+	m_cachedTail=0;
 	__Free(m_ring,"/MessageQueue",false);
 	m_ring=NULL;
 
@@ -181,7 +263,7 @@ void MessageQueue::destructor(){
 }
 
 bool MessageQueue::isDead(){
-	return m_dead;
+	return loadAcquire(&m_dead);
 }
 
 #ifdef CONFIG_USE_LOCKING
@@ -217,8 +299,12 @@ void MessageQueue::unlock(){
 
 #endif /* CONFIG_USE_LOCKING */
 
+/*
+ * The release store makes the messages pushed before the
+ * signal visible to the thread that sees it.
+ */
 void MessageQueue::sendKillSignal(){
-	m_dead=true;
+	storeRelease(&m_dead,true);
 }
 
 uint32_t MessageQueue::increment(uint32_t index){
@@ -229,7 +315,23 @@ uint32_t MessageQueue::increment(uint32_t index){
 	assert(index>=0);
 	#endif /* ASSERT */
 
-	return (index+1)%m_size;
+	index++;
+
+	if(index==m_size)
+		index=0;
+
+	return index;
+}
+
+/*
+ * One slot is always empty to distinguish a full queue from an empty one.
+ */
+uint32_t MessageQueue::getFreeSlots(uint32_t tail){
+	return (m_cachedHead+m_size-tail-1)%m_size;
+}
+
+uint32_t MessageQueue::getUsedSlots(uint32_t head){
+	return (m_cachedTail+m_size-head)%m_size;
 }
 
 /*
@@ -44,6 +44,12 @@
 #endif
 #endif /* CONFIG_USE_LOCKING */
 
+/*
+ * The head is written by the consumer and the tail by the producer.
+ * They are on different cache lines to avoid false sharing.
+ */
+#define MESSAGE_QUEUE_CACHE_LINE_SIZE 64
+
 /**
  * \brief This is a message queue as its name implies.
  *
@@ -107,6 +113,12 @@
  *
  * \see http://www.codeproject.com/Articles/43510/Lock-Free-Single-Producer-Single-Consumer-Circular
  *
+ * Memory ordering: the producer writes the slots and then publishes the
+ * tail with a release store. The consumer reads the tail with an acquire
+ * load before reading the slots. The head is published in the same way
+ * by the consumer. pushMany() and popMany() publish a whole batch with
+ * only one release store.
+ *
  * There is also a Ph.D. thesis by Yi Zhang in 2003 about non-blocking algorithms:
  *
  * \see http://www.cse.chalmers.se/~tsigas/papers/Yi-Thesis.pdf
@@ -126,23 +138,32 @@ class MessageQueue{
 	Message*m_ring;
 	uint32_t m_size;
 
+	bool m_dead;
+
+	uint8_t m_padding0[MESSAGE_QUEUE_CACHE_LINE_SIZE];
+
 /*
- * The volatile keyword means:
- *
- * " Generally speaking, the volatile keyword is intended to prevent the compiler from applying any 
- * optimizations on the code that assume values of variables cannot change "on their own."
- *
- * This is necessary to tell the compiler to avoid any reordering of instructions for this
- * variable.
- *
- * \see http://en.wikipedia.org/wiki/Volatile_variable
+ * Written by the consumer.
+ * m_cachedTail is the last tail seen by the consumer, it avoids reading the
+ * cache line of the producer when there are known messages.
  */
-	volatile uint32_t m_headForPopOperations;
-	volatile uint32_t m_tailForPushOperations;
+	uint32_t m_headForPopOperations;
+	uint32_t m_cachedTail;
 
-	bool m_dead;
+	uint8_t m_padding1[MESSAGE_QUEUE_CACHE_LINE_SIZE];
+
+/*
+ * Written by the producer.
+ * m_cachedHead is the last head seen by the producer.
+ */
+	uint32_t m_tailForPushOperations;
+	uint32_t m_cachedHead;
+
+	uint8_t m_padding2[MESSAGE_QUEUE_CACHE_LINE_SIZE];
 
 	uint32_t increment(uint32_t index);
+	uint32_t getFreeSlots(uint32_t tail);
+	uint32_t getUsedSlots(uint32_t head);
 
 public:
 
@@ -151,6 +172,30 @@ public:
 	bool push(Message*message);
 	bool pop(Message*message);
 
+/*
+ * Push as many messages as possible (at most count) and publish them
+ * at once. Returns the number of pushed messages.
+ */
+	uint32_t pushMany(Message*messages,uint32_t count);
+
+/*
+ * Pop at most maximum messages. Returns the number of popped messages.
+ */
+	uint32_t popMany(Message*messages,uint32_t maximum);
+
+/*
+ * Read the first message without popping it, for a consumer that
+ * must be done with the buffer of the message before the producer
+ * sees that it was popped. Called by the consumer only.
+ */
+	bool peek(Message*message);
+
+/*
+ * The number of messages that are not popped yet.
+ * Called by the producer only.
+ */
+	uint32_t getNumberOfQueuedMessages();
+
 	void destructor();
 	bool hasContent();
 
@@ -36,6 +36,8 @@
 #include <time.h> /* for time */
 #include <string.h> /* for memcpy */
 #include <assert.h>
+#include <fstream>
+#include <sstream>
 using namespace std;
 
 /*
@@ -52,6 +54,13 @@ using namespace std;
  */
 #define __ROUTING_TAG_BASE 16384
 
+/*
+ * The tag of a frame of relayed messages. It is below
+ * __ROUTING_TAG_BASE, so it is not a routing tag, and above
+ * the application tags.
+ */
+#define __ROUTING_FRAME_TAG (__ROUTING_TAG_BASE-1)
+
 #define __ROUTING_SOURCE 0
 #define __ROUTING_DESTINATION 1
 #define __ROUTING_OFFSET(count) (count-1)
@@ -79,6 +88,10 @@ void MessageRouter::routeOutcomingMessages(){
 		cout<<"[routeOutcomingMessages] tag= "<<MESSAGE_TAGS[printableTag]<<" value="<<communicationTag<<endl;
 		#endif
 
+		// a frame of relayed messages already has its next rank
+		if(isFrameTag(communicationTag))
+			continue;
+
 		// - first, the message may have been already routed when it was received (also
 		// in a routed version). In this case, nothing must be done.
 		if(isRoutingTag(communicationTag)){
@@ -145,7 +158,7 @@ void MessageRouter::routeOutcomingMessages(){
 		assert(trueDestination < m_size);
 		#endif
 
-		Rank nextRank=m_graph.getNextRankInRoute(trueSource,trueDestination,m_rank);
+		Rank nextRank=selectNextRank(trueSource,trueDestination);
 		aMessage->setDestination(nextRank);
 
 #ifdef CONFIG_ASSERT
@@ -162,10 +175,27 @@ void MessageRouter::routeOutcomingMessages(){
 		#endif
 	}
 
+	// the messages are now in the outbox, their buffers will be
+	// counted as dirty buffers
+	for(int i=0;i<(int)m_pendingRanks.size();i++)
+		m_pendingMessages[m_pendingRanks[i]]=0;
+
+	m_pendingRanks.clear();
+	m_sweptDirtyBuffers=false;
+
 	// check that all messages are routable
+	// with adaptive routing, a message can also go directly to its destination
 	#ifdef CONFIG_ASSERT
 	for(int i=0;i<numberOfMessages;i++){
 		Message*aMessage=m_outbox->at(i);
+
+		if(m_adaptive && isRoutingTag(aMessage->getTag())
+			&& aMessage->getDestination()==aMessage->getRoutingDestination())
+			continue;
+
+		if(m_adaptive && isFrameTag(aMessage->getTag()))
+			continue;
+
 		if(!m_graph.isConnected(aMessage->getSource(),aMessage->getDestination()))
 			cout<<aMessage->getSource()<<" and "<<aMessage->getDestination()<<" are not connected !"<<endl;
 		assert(m_graph.isConnected(aMessage->getSource(),aMessage->getDestination()));
@@ -173,8 +203,96 @@ void MessageRouter::routeOutcomingMessages(){
 	#endif
 }
 
+/**
+ * Without adaptive routing, the next rank is in the routing table.
+ *
+ * Otherwise, the next rank is the least loaded neighbour on a
+ * shortest route. The search starts at a different candidate every
+ * time so that ties are spread over the candidates.
+ * Every rank does this, so a message can leave the route of the routing table.
+ */
+Rank MessageRouter::selectNextRank(Rank trueSource,Rank trueDestination){
+
+	if(!m_adaptive)
+		return m_graph.getNextRankInRoute(trueSource,trueDestination,m_rank);
+
+	m_nextRanks.clear();
+	m_graph.getShortestNextRanks(trueDestination,&m_nextRanks);
+
+	int load=0;
+	Rank nextRank=getLeastLoadedRank(&load);
+
+	// the dirty buffers are only tested when there are many of them,
+	// so the counts may be stale
+	if(m_saturation>0 && load>=m_saturation && !m_sweptDirtyBuffers){
+		m_outboxAllocator->sweepDirtyBuffers();
+		m_sweptDirtyBuffers=true;
+
+		nextRank=getLeastLoadedRank(&load);
+	}
+
+	m_adaptiveHops++;
+
+	if(m_saturation>0 && load>=m_saturation && nextRank!=trueDestination
+		&& getLoad(trueDestination)<m_saturation){
+
+		nextRank=trueDestination;
+		m_directMessages++;
+	}
+
+	addPendingMessage(nextRank);
+
+	return nextRank;
+}
+
+Rank MessageRouter::getLeastLoadedRank(int*load){
+
+	int candidates=m_nextRanks.size();
+	int first=m_roundRobin%candidates;
+	m_roundRobin++;
+
+	Rank bestRank=m_nextRanks[first];
+	int bestLoad=getLoad(bestRank);
+	bool balanced=false;
+
+	for(int i=1;i<candidates;i++){
+		Rank rank=m_nextRanks[(first+i)%candidates];
+		int rankLoad=getLoad(rank);
+
+		if(rankLoad!=bestLoad)
+			balanced=true;
+
+		if(rankLoad<bestLoad){
+			bestRank=rank;
+			bestLoad=rankLoad;
+		}
+	}
+
+	if(balanced)
+		m_balancedHops++;
+
+	(*load)=bestLoad;
+
+	return bestRank;
+}
+
+int MessageRouter::getLoad(Rank rank){
+	return m_outboxAllocator->getNumberOfDirtyBuffers(rank)+m_pendingMessages[rank];
+}
+
+void MessageRouter::addPendingMessage(Rank rank){
+	if(m_pendingMessages[rank]==0)
+		m_pendingRanks.push_back(rank);
+
+	m_pendingMessages[rank]++;
+}
+
 /**
  * route incoming messages
+ * Relayed messages are removed from the inbox, the others stay there
+ * in their arrival order.
+ * Frames are removed too, the messages in them are handled after
+ * the other ones, as long as the inbox has room for them.
  * \returns true if rerouted something.
  */
 bool MessageRouter::routeIncomingMessages(){
@@ -185,13 +303,152 @@ bool MessageRouter::routeIncomingMessages(){
 	cout<<"["<<__func__<<"] inbox.size= "<<numberOfMessages<<endl;
 	#endif
 
+	// the inbox of the previous tick is not used anymore
+	if(m_unpackedOffset==(int)m_unpackedMessages.size()){
+		m_unpackedMessages.clear();
+		m_unpackedOffset=0;
+
+	}else if(m_unpackedOffset*2>=(int)m_unpackedMessages.size()){
+		m_unpackedMessages.erase(m_unpackedMessages.begin(),
+			m_unpackedMessages.begin()+m_unpackedOffset);
+		m_unpackedOffset=0;
+	}
+
 	// we have no message
-	if(numberOfMessages==0)
+	if(numberOfMessages==0 && m_unpackedMessages.size()==0)
 		return false;
 
-	// otherwise, we have exactly one precious message.
+	bool relayedSomething=false;
+
+	int i=0;
+
+	while(i<m_inbox->size()){
+
+		if(isFrameTag(m_inbox->at(i)->getTag())){
+			unpackFrame(m_inbox->at(i));
+			m_inbox->erase(i);
+			continue;
+		}
+
+/*
+ * If a message is routed, the original message needs to be destroyed
+ * with fire. Otherwise, a slave mode or a master mode will pick it up,
+ * which will cause silly behaviors.
+ */
+		if(routeIncomingMessage(m_inbox->at(i))){
+			m_inbox->erase(i);
+			relayedSomething=true;
+		}else{
+			i++;
+		}
+	}
+
+	// like received messages, each one can be relayed or delivered
+	handleUnpackedMessages(m_inbox->getMaximumSize()-m_inbox->size());
+
+	return relayedSomething;
+}
+
+/**
+ * Copy the messages of a frame, because the inbox buffer of the frame
+ * is reused by the next receptions.
+ */
+void MessageRouter::unpackFrame(Message*frame){
+
+	char*data=frame->getBufferBytes();
+	int bytes=frame->getNumberOfBytes();
+	int offset=0;
+
+	while(offset<bytes){
+		int32_t tag=0;
+		int32_t messageBytes=0;
+
+		memcpy(&tag,data+offset,sizeof(tag));
+		memcpy(&messageBytes,data+offset+sizeof(tag),sizeof(messageBytes));
+
+		#ifdef CONFIG_ASSERT
+		assert(isRoutingTag(tag));
+		assert(messageBytes>0);
+		assert(offset+(int)RELAY_FRAME_RECORD_HEADER_SIZE+messageBytes<=bytes);
+		#endif
+
+		int32_t header[4];
+		header[0]=tag;
+		header[1]=frame->getSource();
+		header[2]=frame->getDestination();
+		header[3]=messageBytes;
+
+		int position=m_unpackedMessages.size();
+		int storedBytes=(sizeof(header)+messageBytes+7)&~7;
+
+		m_unpackedMessages.resize(position+storedBytes);
+
+		memcpy(&(m_unpackedMessages[position]),header,sizeof(header));
+		memcpy(&(m_unpackedMessages[position+sizeof(header)]),
+			data+offset+RELAY_FRAME_RECORD_HEADER_SIZE,messageBytes);
+
+		offset+=(RELAY_FRAME_RECORD_HEADER_SIZE+messageBytes+7)&~7;
+
+		m_receivedFramedMessages++;
+	}
+
+	m_receivedFrames++;
+}
+
+/**
+ * A message that is delivered or relayed alone counts like a received
+ * message, and there can be at most <maximumMessages> of them.
+ * A message that goes in a frame uses no inbox or outbox buffer, so
+ * it does not count, otherwise frames would be unpacked one message per
+ * tick with the default receive batch of 1 message.
+ */
+void MessageRouter::handleUnpackedMessages(int maximumMessages){
+
+	int handled=0;
+
+	while(m_unpackedOffset<(int)m_unpackedMessages.size()){
+
+		char*data=&(m_unpackedMessages[m_unpackedOffset]);
+
+		int32_t header[4];
+		memcpy(header,data,sizeof(header));
+
+		Message message;
+		message.setBuffer(data+sizeof(header));
+		message.setNumberOfBytes(header[3]);
+		message.setTag(header[0]);
+		message.setSource(header[1]);
+		message.setDestination(header[2]);
+
+		message.loadMetaData();
 
-	Message*aMessage=m_inbox->at(0);
+		bool isRelayed=message.getRoutingDestination()!=m_rank;
+
+		if(handled>=maximumMessages && !(isRelayed && m_coalescing))
+			break;
+
+		m_unpackedOffset+=(sizeof(header)+header[3]+7)&~7;
+
+		uint64_t framedMessages=m_framedMessages;
+
+		if(!routeIncomingMessage(&message))
+			m_inbox->push_back(&message);
+
+		if(m_framedMessages!=framedMessages)
+			continue;
+
+		handled++;
+
+		// a frame is full
+		if(handled>maximumMessages)
+			break;
+	}
+}
+
+/**
+ * \returns true if the message was relayed to another rank.
+ */
+bool MessageRouter::routeIncomingMessage(Message*aMessage){
 
 	MessageTag tag=aMessage->getTag();
 
@@ -291,7 +548,7 @@ bool MessageRouter::routeIncomingMessages(){
 
 	// at this point, we know that we need to forward
 	// the message to another peer
-	Rank nextRank=m_graph.getNextRankInRoute(trueSource,trueDestination,m_rank);
+	Rank nextRank=selectNextRank(trueSource,trueDestination);
 
 	#ifdef CONFIG_ROUTING_VERBOSITY
 	cout<<"["<<__func__<<"] message has been sent to the next one, trueSource="<<trueSource<<" trueDestination= "<<trueDestination;
@@ -319,6 +576,11 @@ bool MessageRouter::routeIncomingMessages(){
  */
 void MessageRouter::relayMessage(Message*message,Rank destination){
 
+	m_relayedMessages++;
+
+	if(m_coalescing && addToRelayFrame(message,destination))
+		return;
+
 	int count=message->getNumberOfBytes();
 
 	// routed messages always have a payload
@@ -344,7 +606,8 @@ void MessageRouter::relayMessage(Message*message,Rank destination){
 	message->setDestination(destination);
 
 	#ifdef CONFIG_ASSERT
-	assert(m_graph.isConnected(m_rank,destination));
+	assert(m_graph.isConnected(m_rank,destination)
+		|| (m_adaptive && destination==message->getRoutingDestination()));
 	#endif
 
 	// since we used the old message to create this new one,
@@ -362,12 +625,27 @@ bool MessageRouter::isEnabled(){
 
 MessageRouter::MessageRouter(){
 	m_enabled=false;
+	m_threads=1;
+	m_adaptive=false;
+	m_coalescing=false;
+	m_waitingFrameMessages=0;
+	m_unpackedOffset=0;
+}
+
+void MessageRouter::destructor(){
+
+	for(int i=0;i<(int)m_frames.size();i++)
+		m_frames[i].destructor();
+
+	m_frames.clear();
+	m_frameRanks.clear();
+	m_frameIndexes.clear();
 }
 
 void MessageRouter::enable(StaticVector*inbox,StaticVector*outbox,RingAllocator*outboxAllocator,Rank rank,
 	string prefix,int numberOfRanks,string type,int degree){
 
-	m_graph.buildGraph(numberOfRanks,type,rank==MASTER_RANK,degree);
+	m_graph.buildGraph(numberOfRanks,type,rank==MASTER_RANK,degree,m_threads);
 
 	m_size=numberOfRanks;
 
@@ -383,11 +661,197 @@ void MessageRouter::enable(StaticVector*inbox,StaticVector*outbox,RingAllocator*
 	m_deletionTime=0;
 
 	m_prefix=prefix;
+
+	m_adaptive=false;
+	m_saturation=0;
+	m_roundRobin=0;
+	m_sweptDirtyBuffers=false;
+	m_adaptiveHops=0;
+	m_balancedHops=0;
+	m_directMessages=0;
+
+	m_coalescing=false;
+	m_waitingFrameMessages=0;
+	m_unpackedOffset=0;
+	m_relayedMessages=0;
+	m_framedMessages=0;
+	m_sentFrames=0;
+	m_receivedFrames=0;
+	m_receivedFramedMessages=0;
+	m_sentFrameBytes=0;
+}
+
+bool MessageRouter::addToRelayFrame(Message*message,Rank destination){
+
+	if(m_frameIndexes[destination]<0){
+		RelayFrame frame;
+		frame.constructor();
+
+		m_frameIndexes[destination]=m_frames.size();
+		m_frames.push_back(frame);
+		m_frameRanks.push_back(destination);
+	}
+
+	RelayFrame*frame=&(m_frames[m_frameIndexes[destination]]);
+
+	message->setSource(m_rank);
+	message->setDestination(destination);
+
+	// the message is sent alone, and the frame is sent at this tick
+	if(!frame->addMessage(message,getMicroseconds()))
+		return false;
+
+	m_framedMessages++;
+	m_waitingFrameMessages++;
+
+	return true;
+}
+
+void MessageRouter::flushRelayFrames(int maximumFrames){
+
+	if(m_waitingFrameMessages==0)
+		return;
+
+	uint64_t now=getMicroseconds();
+
+	for(int i=0;i<(int)m_frames.size() && maximumFrames>0;i++){
+		RelayFrame*frame=&(m_frames[i]);
+
+		if(frame->getNumberOfMessages()==0)
+			continue;
+
+		// after the computation, there is nothing to wait for
+		bool isDue=frame->isFull() || m_deletionTime!=0
+			|| frame->getNumberOfBytes()>=m_frameBytes
+			|| now-frame->getFirstMessageTime()>=(uint64_t)m_frameDelay;
+
+		if(!isDue)
+			continue;
+
+		m_sentFrames++;
+		m_sentFrameBytes+=frame->getNumberOfBytes();
+		m_waitingFrameMessages-=frame->getNumberOfMessages();
+
+		Message message;
+		message.setTag(__ROUTING_FRAME_TAG);
+		message.setSource(m_rank);
+		message.setDestination(m_frameRanks[i]);
+
+		frame->flush(&message);
+
+		m_outbox->push_back(&message);
+
+		maximumFrames--;
+	}
+}
+
+bool MessageRouter::hasPendingMessages(){
+	return m_waitingFrameMessages>0 || hasUnpackedMessages();
+}
+
+bool MessageRouter::hasUnpackedMessages(){
+	return m_unpackedOffset<(int)m_unpackedMessages.size();
+}
+
+bool MessageRouter::isFrameTag(MessageTag tag){
+	return tag==__ROUTING_FRAME_TAG;
+}
+
+void MessageRouter::enableCoalescing(int bytes,int microseconds){
+
+	#ifdef CONFIG_ASSERT
+	assert(m_enabled);
+	assert(bytes>0);
+	assert(microseconds>=0);
+	#endif
+
+	m_frameIndexes.resize(m_size,-1);
+	m_frameBytes=bytes;
+	m_frameDelay=microseconds;
+	m_coalescing=true;
+
+	cout<<"[MessageRouter] Rank "<<m_rank<<" will pack relayed messages in frames of "<<m_frameBytes;
+	cout<<" bytes or "<<m_frameDelay<<" microseconds"<<endl;
+}
+
+void MessageRouter::setNumberOfThreads(int threads){
+
+	#ifdef CONFIG_ASSERT
+	assert(!m_enabled);
+	assert(threads>=1);
+	#endif
+
+	m_threads=threads;
+}
+
+void MessageRouter::enableAdaptiveRouting(int saturation){
+
+	#ifdef CONFIG_ASSERT
+	assert(m_enabled);
+	assert(saturation>=0);
+	#endif
+
+	m_graph.computeNeighbourDistances(m_rank);
+
+	m_pendingMessages.resize(m_size,0);
+	m_saturation=saturation;
+	m_adaptive=true;
+
+	cout<<"[MessageRouter] Rank "<<m_rank<<" will choose the next rank with the outbox load";
+
+	if(m_saturation>0)
+		cout<<", direct sends after "<<m_saturation<<" outstanding messages";
+
+	cout<<endl;
+}
+
+void MessageRouter::printStatus(){
+
+	if(m_adaptive){
+		cout<<"[MessageRouter] Rank "<<m_rank<<" chose "<<m_adaptiveHops<<" next ranks with the outbox load, ";
+		cout<<m_balancedHops<<" had candidates with different loads, ";
+		cout<<m_directMessages<<" messages were sent directly"<<endl;
+	}
+
+	if(m_coalescing){
+		cout<<"[MessageRouter] Rank "<<m_rank<<" relayed "<<m_relayedMessages<<" messages, ";
+		cout<<m_framedMessages<<" of them in "<<m_sentFrames<<" frames"<<endl;
+	}
+
+	m_graph.printStatus();
 }
 
 void MessageRouter::writeFiles(){
 	if(m_rank==MASTER_RANK)
 		m_graph.writeFiles(m_prefix);
+
+	if(!m_coalescing && m_receivedFrames==0)
+		return;
+
+	// each rank writes its relay statistics
+	ostringstream file;
+	file<<m_prefix<<"Rank"<<m_rank<<".RelayFrames.txt";
+	ofstream f(file.str().c_str());
+
+	double packRatio=0;
+	double frameBytes=0;
+
+	if(m_sentFrames>0){
+		packRatio=m_framedMessages/(0.0+m_sentFrames);
+		frameBytes=m_sentFrameBytes/(0.0+m_sentFrames);
+	}
+
+	f<<"#Metric	Value"<<endl;
+	f<<"RelayedMessages	"<<m_relayedMessages<<endl;
+	f<<"MessagesInFrames	"<<m_framedMessages<<endl;
+	f<<"MessagesSentAlone	"<<m_relayedMessages-m_framedMessages<<endl;
+	f<<"SentFrames	"<<m_sentFrames<<endl;
+	f<<"MessagesPerFrame	"<<packRatio<<endl;
+	f<<"BytesPerFrame	"<<frameBytes<<endl;
+	f<<"ReceivedFrames	"<<m_receivedFrames<<endl;
+	f<<"UnpackedMessages	"<<m_receivedFramedMessages<<endl;
+
+	f.close();
 }
 
 bool MessageRouter::hasCompletedRelayEvents(){
@@ -425,6 +889,14 @@ bool MessageRouter::isRoutingTag(MessageTag tag){
 	return tag>=__ROUTING_TAG_BASE;
 }
 
+MessageTag MessageRouter::getOriginalTag(MessageTag tag){
+
+	if(isRoutingTag(tag))
+		return getMessageTagFromRoutingTag(tag);
+
+	return tag;
+}
+
 MessageTag MessageRouter::getMessageTagFromRoutingTag(MessageTag tag){
 
 	#ifdef CONFIG_ASSERT
@@ -23,6 +23,7 @@
 #define _MessageRouter_h
 
 #include "Message.h"
+#include "RelayFrame.h"
 
 #include <RayPlatform/memory/RingAllocator.h>
 #include <RayPlatform/structures/StaticVector.h>
@@ -84,7 +85,85 @@ class MessageRouter {
  */
 	int m_size;
 
+/**
+ * The number of threads that compute the routes in enable()
+ */
+	int m_threads;
+
+/**
+ * Choose the next rank among the shortest routes with the outbox load
+ */
+	bool m_adaptive;
+
+/**
+ * The number of outstanding messages to a next rank at which
+ * it is considered saturated. 0 means never.
+ */
+	int m_saturation;
+
+/**
+ * The messages routed to each rank since the outbox was last sent,
+ * they are not dirty buffers yet.
+ */
+	vector<int> m_pendingMessages;
+	vector<Rank> m_pendingRanks;
+
+	vector<Rank> m_nextRanks;
+	uint32_t m_roundRobin;
+	bool m_sweptDirtyBuffers;
+
+	uint64_t m_adaptiveHops;
+	uint64_t m_balancedHops;
+	uint64_t m_directMessages;
+
+/**
+ * Pack relayed messages with the same next rank in frames
+ */
+	bool m_coalescing;
+
+/** a frame is sent when it has this many bytes */
+	int m_frameBytes;
+
+/** or when its first message has waited this long */
+	int m_frameDelay;
+
+	vector<RelayFrame> m_frames;
+	vector<Rank> m_frameRanks;
+
+/** the frame for each rank, -1 for none */
+	vector<int> m_frameIndexes;
+
+	int m_waitingFrameMessages;
+
+/**
+ * Messages unpacked from received frames that are not handled yet.
+ * Each one is a header (tag, source, destination, bytes) followed by
+ * the message and its metadata, padded to 8 bytes.
+ * The inbox points in there, so it is only compacted at the
+ * beginning of routeIncomingMessages.
+ */
+	vector<char> m_unpackedMessages;
+	int m_unpackedOffset;
+
+	uint64_t m_relayedMessages;
+	uint64_t m_framedMessages;
+	uint64_t m_sentFrames;
+	uint64_t m_receivedFrames;
+	uint64_t m_receivedFramedMessages;
+	uint64_t m_sentFrameBytes;
+
+	bool addToRelayFrame(Message*message,Rank destination);
+	void unpackFrame(Message*frame);
+	void handleUnpackedMessages(int maximumMessages);
+	bool isFrameTag(MessageTag tag);
+
+	Rank selectNextRank(Rank trueSource,Rank trueDestination);
+	Rank getLeastLoadedRank(int*load);
+	int getLoad(Rank rank);
+	void addPendingMessage(Rank rank);
+
 	void relayMessage(Message*message,Rank destination);
+	bool routeIncomingMessage(Message*message);
 
 	MessageTag getMessageTagFromRoutingTag(MessageTag tag);
 	Rank getSourceFromBuffer(MessageUnit*buffer,int count);
@@ -96,6 +175,9 @@ class MessageRouter {
 public:
 	MessageRouter();
 
+/** free the relay frames */
+	void destructor();
+
 /**
  * Callback method to call before sending messages in the outbox onto the network
  */
@@ -128,6 +210,62 @@ string prefix,int numberOfRanks,string type,int degree);
 
 	ConnectionGraph*getGraph();
 
+/**
+ * Set the number of threads that compute the routes when the router
+ * is enabled. Every rank of a node computes its own routes, so the
+ * ComputeCore shares the cores of the node between its ranks, unless
+ * the option -route-threads <threads> is provided.
+ *
+ * This must be called before enable().
+ */
+	void setNumberOfThreads(int threads);
+
+/**
+ * Choose the next rank with the live outbox load instead of the
+ * routing table: any neighbour on a shortest route to the destination
+ * can be used and the one with the fewest dirty buffers
+ * in the outbox allocator wins.
+ * When all of them have at least <saturation> outstanding messages,
+ * the message is sent directly to its destination instead.
+ *
+ * The messages between two ranks can then take different routes and
+ * arrive out of order. The VirtualCommunicator matches its replies
+ * with their sequence, other protocols must not rely on the order.
+ *
+ * This must be called on all ranks, after enable(). The ComputeCore
+ * calls it when the option -adaptive-routing <saturation> is provided.
+ */
+	void enableAdaptiveRouting(int saturation);
+
+/**
+ * Pack the messages relayed to the same next rank in a frame
+ * instead of sending them one by one. A frame is sent when
+ * it reaches <bytes> bytes or when its first message has waited
+ * <microseconds> microseconds, whichever comes first.
+ * The next rank unpacks the frame.
+ */
+	void enableCoalescing(int bytes,int microseconds);
+
+/**
+ * Put the frames that are due in the outbox, at most <maximumFrames>.
+ * This is called before sending the outbox at each tick.
+ */
+	void flushRelayFrames(int maximumFrames);
+
+/**
+ * Are there frames waiting to be sent or unpacked messages
+ * waiting to be handled ?
+ */
+	bool hasPendingMessages();
+
+/**
+ * Are there messages from frames that are waiting for room in the inbox ?
+ * They are handled before receiving other messages.
+ */
+	bool hasUnpackedMessages();
+
+	void printStatus();
+
 /**
  * Write routing information files.
  */
@@ -135,6 +273,12 @@ string prefix,int numberOfRanks,string type,int degree);
 
 	bool isRoutingTag(MessageTag tag);
 
+/**
+ * Get the tag that an outgoing message had before it was routed.
+ * A frame of relayed messages keeps its tag.
+ */
+	MessageTag getOriginalTag(MessageTag tag);
+
 };
 
 #endif /* _MessageRouter_h */
@@ -0,0 +1,478 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+#include "MessageStreamer.h"
+
+#include <RayPlatform/core/ComputeCore.h>
+#include <RayPlatform/memory/allocator.h>
+
+#include <limits.h> /* for INT_MAX */
+#include <string.h>
+#include <iostream>
+using namespace std;
+
+#ifdef CONFIG_ASSERT
+#include <assert.h>
+#endif
+
+__CreatePlugin(MessageStreamer);
+
+__CreateMessageTagAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_REQUEST);
+__CreateMessageTagAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_READY);
+__CreateMessageTagAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_DATA);
+__CreateMessageTagAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_ACKNOWLEDGEMENT);
+
+MessageStreamer::MessageStreamer(){
+	m_outbox=NULL;
+	m_window=1;
+	m_nextActiveStream=0;
+	m_firstControlMessage=0;
+	m_completedMessageBytes=0;
+
+	m_sentMessages=0;
+	m_sentBytes=0;
+	m_sentChunks=0;
+	m_receivedMessages=0;
+	m_receivedBytes=0;
+	m_receivedChunks=0;
+}
+
+void MessageStreamer::initialize(Rank rank,int size,StaticVector*outbox,int window){
+	m_rank=rank;
+	m_size=size;
+	m_outbox=outbox;
+
+	m_window=window;
+
+	if(m_window<1)
+		m_window=1;
+}
+
+int MessageStreamer::allocateStream(vector<MessageStream>*streams,vector<int>*freeStreams){
+
+	int handle=0;
+
+	if(!freeStreams->empty()){
+		handle=freeStreams->back();
+		freeStreams->pop_back();
+	}else{
+		handle=streams->size();
+		streams->push_back(MessageStream());
+	}
+
+	MessageStream*stream=&(streams->at(handle));
+
+	stream->m_buffer=NULL;
+	stream->m_bytes=0;
+	stream->m_transferredBytes=0;
+	stream->m_peer=0;
+	stream->m_peerStream=-1;
+	stream->m_tag=0;
+	stream->m_state=STREAM_STATE_FREE;
+	stream->m_chunks=0;
+	stream->m_acknowledgedChunks=0;
+
+	return handle;
+}
+
+int MessageStreamer::send(const char*buffer,uint64_t bytes,Rank destination,MessageTag tag){
+
+	#ifdef CONFIG_ASSERT
+	assert(buffer!=NULL || bytes==0);
+	assert(destination>=0 && destination<m_size);
+	#endif
+
+	int handle=allocateStream(&m_outgoingStreams,&m_freeOutgoingStreams);
+
+	MessageStream*stream=&(m_outgoingStreams[handle]);
+
+	// the bytes are only read, they are copied in the chunks
+	stream->m_buffer=(char*)buffer;
+	stream->m_bytes=bytes;
+	stream->m_peer=destination;
+	stream->m_tag=tag;
+	stream->m_state=STREAM_STATE_REQUESTED;
+
+	m_activeOutgoingStreams.push_back(handle);
+
+	return handle;
+}
+
+bool MessageStreamer::test(int handle){
+
+	MessageStream*stream=&(m_outgoingStreams[handle]);
+
+	#ifdef CONFIG_ASSERT
+	assert(stream->m_state!=STREAM_STATE_FREE);
+	#endif
+
+	if(stream->m_state!=STREAM_STATE_COMPLETED)
+		return false;
+
+	stream->m_state=STREAM_STATE_FREE;
+	m_freeOutgoingStreams.push_back(handle);
+
+	return true;
+}
+
+bool MessageStreamer::hasOpenWindow(MessageStream*stream){
+	return stream->m_chunks-stream->m_acknowledgedChunks<m_window;
+}
+
+void MessageStreamer::sendControlMessage(Rank destination,MessageTag tag,MessageUnit first,
+		MessageUnit second,MessageUnit third,int count){
+
+	MessageUnit*buffer=m_core->reserveMessage();
+
+	buffer[0]=first;
+	buffer[1]=second;
+	buffer[2]=third;
+
+	m_core->commitMessage(buffer,count,destination,tag);
+}
+
+/*
+ * The handlers do not know if there is space left in the outbox,
+ * so their messages wait for sendChunks().
+ */
+void MessageStreamer::queueControlMessage(Rank destination,MessageTag tag,MessageUnit first,
+		MessageUnit second,MessageUnit third,int count){
+
+	StreamControlMessage message;
+	message.m_destination=destination;
+	message.m_tag=tag;
+	message.m_units[0]=first;
+	message.m_units[1]=second;
+	message.m_units[2]=third;
+	message.m_count=count;
+
+	m_controlMessages.push_back(message);
+}
+
+void MessageStreamer::sendChunk(int handle){
+
+	MessageStream*stream=&(m_outgoingStreams[handle]);
+
+	uint64_t bytes=stream->m_bytes-stream->m_transferredBytes;
+
+	if(bytes>STREAM_CHUNK_SIZE)
+		bytes=STREAM_CHUNK_SIZE;
+
+	MessageUnit*buffer=m_core->reserveMessage();
+
+	buffer[0]=stream->m_peerStream;
+	buffer[1]=stream->m_transferredBytes;
+
+	memcpy(((char*)buffer)+STREAM_CHUNK_HEADER_SIZE,stream->m_buffer+stream->m_transferredBytes,bytes);
+
+	int count=(STREAM_CHUNK_HEADER_SIZE+bytes+sizeof(MessageUnit)-1)/sizeof(MessageUnit);
+
+	m_core->commitMessage(buffer,count,stream->m_peer,RAYPLATFORM_MESSAGE_TAG_STREAM_DATA);
+
+	stream->m_transferredBytes+=bytes;
+	stream->m_chunks++;
+
+	m_sentChunks++;
+	m_sentBytes+=bytes;
+}
+
+/*
+ * The active streams take turns, one message at a time.
+ * A stream leaves the list when its request is sent (it
+ * comes back when the receiver is ready) and when its last
+ * chunk is sent.
+ */
+void MessageStreamer::sendChunks(int maximumMessages){
+
+	int sent=0;
+	int idleStreams=0;
+
+	// the control messages unblock the peers, they go first
+	while(sent<maximumMessages && m_firstControlMessage<(int)m_controlMessages.size()){
+		StreamControlMessage*message=&(m_controlMessages[m_firstControlMessage]);
+
+		sendControlMessage(message->m_destination,message->m_tag,message->m_units[0],
+			message->m_units[1],message->m_units[2],message->m_count);
+
+		m_firstControlMessage++;
+		sent++;
+	}
+
+	if(m_firstControlMessage==(int)m_controlMessages.size()){
+		m_controlMessages.clear();
+		m_firstControlMessage=0;
+	}
+
+	while(sent<maximumMessages && idleStreams<(int)m_activeOutgoingStreams.size()){
+
+		if(m_nextActiveStream>=(int)m_activeOutgoingStreams.size())
+			m_nextActiveStream=0;
+
+		int handle=m_activeOutgoingStreams[m_nextActiveStream];
+		MessageStream*stream=&(m_outgoingStreams[handle]);
+
+		bool done=false;
+
+		if(stream->m_state==STREAM_STATE_REQUESTED){
+
+			sendControlMessage(stream->m_peer,RAYPLATFORM_MESSAGE_TAG_STREAM_REQUEST,
+				handle,stream->m_tag,stream->m_bytes,3);
+
+			stream->m_state=STREAM_STATE_WAITING;
+			done=true;
+
+		}else if(stream->m_state==STREAM_STATE_STREAMING && hasOpenWindow(stream)){
+
+			sendChunk(handle);
+
+			if(stream->m_transferredBytes==stream->m_bytes){
+				stream->m_state=STREAM_STATE_COMPLETED;
+				m_sentMessages++;
+				done=true;
+			}
+		}else{
+			// the window is closed
+			m_nextActiveStream++;
+			idleStreams++;
+			continue;
+		}
+
+		sent++;
+		idleStreams=0;
+
+		if(done){
+			m_activeOutgoingStreams[m_nextActiveStream]=m_activeOutgoingStreams.back();
+			m_activeOutgoingStreams.pop_back();
+		}else{
+			m_nextActiveStream++;
+		}
+	}
+}
+
+bool MessageStreamer::hasChunksToSend(){
+
+	if(m_firstControlMessage<(int)m_controlMessages.size())
+		return true;
+
+	for(int i=0;i<(int)m_activeOutgoingStreams.size();i++){
+		MessageStream*stream=&(m_outgoingStreams[m_activeOutgoingStreams[i]]);
+
+		if(stream->m_state==STREAM_STATE_REQUESTED || hasOpenWindow(stream))
+			return true;
+	}
+
+	return false;
+}
+
+bool MessageStreamer::getCompletedMessage(Message*message){
+
+	if(m_completedStreams.empty())
+		return false;
+
+	int handle=m_completedStreams[0];
+	m_completedStreams.erase(m_completedStreams.begin());
+
+	MessageStream*stream=&(m_incomingStreams[handle]);
+
+	Message completedMessage(stream->m_buffer,0,m_rank,stream->m_tag,stream->m_peer);
+
+	m_completedMessageBytes=stream->m_bytes;
+
+	if(m_completedMessageBytes<=INT_MAX)
+		completedMessage.setNumberOfBytes(m_completedMessageBytes);
+	else
+		completedMessage.setNumberOfBytes(-1);
+
+	*message=completedMessage;
+
+	// the buffer now belongs to the message
+	stream->m_state=STREAM_STATE_FREE;
+	stream->m_buffer=NULL;
+	m_freeIncomingStreams.push_back(handle);
+
+	m_receivedMessages++;
+
+	return true;
+}
+
+void MessageStreamer::releaseMessage(Message*message){
+	__Free(message->getBuffer(),"RAY_MALLOC_TYPE_MESSAGE_STREAM",false);
+}
+
+uint64_t MessageStreamer::getCompletedMessageBytes(){
+	return m_completedMessageBytes;
+}
+
+/*
+ * The receiver allocates a buffer for the whole message.
+ */
+void MessageStreamer::call_RAYPLATFORM_MESSAGE_TAG_STREAM_REQUEST(Message*message){
+
+	MessageUnit*buffer=message->getBuffer();
+
+	int handle=allocateStream(&m_incomingStreams,&m_freeIncomingStreams);
+
+	MessageStream*stream=&(m_incomingStreams[handle]);
+
+	stream->m_peerStream=buffer[0];
+	stream->m_tag=buffer[1];
+	stream->m_bytes=buffer[2];
+	stream->m_peer=message->getSource();
+
+	// an empty message still needs a buffer
+	uint64_t allocatedBytes=stream->m_bytes;
+
+	if(allocatedBytes<sizeof(MessageUnit))
+		allocatedBytes=sizeof(MessageUnit);
+
+	stream->m_buffer=(char*)__Malloc(allocatedBytes,"RAY_MALLOC_TYPE_MESSAGE_STREAM",false);
+	stream->m_state=STREAM_STATE_STREAMING;
+
+	queueControlMessage(stream->m_peer,RAYPLATFORM_MESSAGE_TAG_STREAM_READY,
+		stream->m_peerStream,handle,0,2);
+
+	if(stream->m_bytes==0){
+		stream->m_state=STREAM_STATE_COMPLETED;
+		m_completedStreams.push_back(handle);
+	}
+}
+
+void MessageStreamer::call_RAYPLATFORM_MESSAGE_TAG_STREAM_READY(Message*message){
+
+	MessageUnit*buffer=message->getBuffer();
+
+	int handle=buffer[0];
+	MessageStream*stream=&(m_outgoingStreams[handle]);
+
+	#ifdef CONFIG_ASSERT
+	assert(stream->m_state==STREAM_STATE_WAITING);
+	#endif
+
+	stream->m_peerStream=buffer[1];
+
+	if(stream->m_bytes==0){
+		stream->m_state=STREAM_STATE_COMPLETED;
+		m_sentMessages++;
+		return;
+	}
+
+	stream->m_state=STREAM_STATE_STREAMING;
+	m_activeOutgoingStreams.push_back(handle);
+}
+
+/*
+ * All the chunks are full, except the last one, so the
+ * offset gives the number of bytes in a chunk.
+ * The receiver acknowledges the chunks a few times per window.
+ */
+void MessageStreamer::call_RAYPLATFORM_MESSAGE_TAG_STREAM_DATA(Message*message){
+
+	MessageUnit*buffer=message->getBuffer();
+
+	int handle=buffer[0];
+	uint64_t offset=buffer[1];
+
+	MessageStream*stream=&(m_incomingStreams[handle]);
+
+	uint64_t bytes=stream->m_bytes-offset;
+
+	if(bytes>STREAM_CHUNK_SIZE)
+		bytes=STREAM_CHUNK_SIZE;
+
+	#ifdef CONFIG_ASSERT
+	assert(stream->m_state==STREAM_STATE_STREAMING);
+	assert(offset+bytes<=stream->m_bytes);
+	assert(message->getNumberOfBytes()>=(int)(STREAM_CHUNK_HEADER_SIZE+bytes));
+	#endif
+
+	memcpy(stream->m_buffer+offset,((char*)buffer)+STREAM_CHUNK_HEADER_SIZE,bytes);
+
+	stream->m_transferredBytes+=bytes;
+	stream->m_chunks++;
+
+	m_receivedChunks++;
+	m_receivedBytes+=bytes;
+
+	if(stream->m_transferredBytes==stream->m_bytes){
+		stream->m_state=STREAM_STATE_COMPLETED;
+		m_completedStreams.push_back(handle);
+		return;
+	}
+
+	int period=m_window/4;
+
+	if(period<1)
+		period=1;
+
+	if(stream->m_chunks%period==0){
+		queueControlMessage(stream->m_peer,RAYPLATFORM_MESSAGE_TAG_STREAM_ACKNOWLEDGEMENT,
+			stream->m_peerStream,stream->m_chunks,0,2);
+	}
+}
+
+void MessageStreamer::call_RAYPLATFORM_MESSAGE_TAG_STREAM_ACKNOWLEDGEMENT(Message*message){
+
+	MessageUnit*buffer=message->getBuffer();
+
+	int handle=buffer[0];
+	int chunks=buffer[1];
+
+	MessageStream*stream=&(m_outgoingStreams[handle]);
+
+	// the acknowledgements can arrive after the last chunk was sent
+	if(stream->m_state!=STREAM_STATE_STREAMING)
+		return;
+
+	// and they can be reordered by the router
+	if(chunks>stream->m_acknowledgedChunks)
+		stream->m_acknowledgedChunks=chunks;
+}
+
+void MessageStreamer::printStatus(){
+
+	if(m_sentChunks==0 && m_receivedChunks==0)
+		return;
+
+	cout<<"[MessageStreamer] Rank "<<m_rank<<" sent "<<m_sentMessages<<" messages (";
+	cout<<m_sentBytes<<" bytes in "<<m_sentChunks<<" chunks), received "<<m_receivedMessages;
+	cout<<" messages ("<<m_receivedBytes<<" bytes in "<<m_receivedChunks<<" chunks)"<<endl;
+}
+
+void MessageStreamer::registerPlugin(ComputeCore*core){
+
+	m_core=core;
+	m_plugin=core->allocatePluginHandle();
+
+	core->setPluginName(m_plugin,"MessageStreamer");
+	core->setPluginDescription(m_plugin,"Transport for messages larger than MAXIMUM_MESSAGE_SIZE_IN_BYTES");
+	core->setPluginAuthors(m_plugin,"RayPlatform contributors");
+	core->setPluginLicense(m_plugin,"GNU Lesser General License version 3");
+
+	__ConfigureMessageTagHandler(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_REQUEST);
+	__ConfigureMessageTagHandler(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_READY);
+	__ConfigureMessageTagHandler(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_DATA);
+	__ConfigureMessageTagHandler(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_ACKNOWLEDGEMENT);
+}
+
+void MessageStreamer::resolveSymbols(ComputeCore*core){
+
+}
@@ -0,0 +1,223 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+#ifndef _MessageStreamer_h
+#define _MessageStreamer_h
+
+#include "Message.h"
+
+#include <RayPlatform/core/types.h>
+#include <RayPlatform/plugins/CorePlugin.h>
+#include <RayPlatform/structures/StaticVector.h>
+#include <RayPlatform/handlers/MessageTagHandler.h>
+
+#include <vector>
+#include <stdint.h>
+using namespace std;
+
+__DeclarePlugin(MessageStreamer);
+
+__DeclareMessageTagAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_REQUEST);
+__DeclareMessageTagAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_READY);
+__DeclareMessageTagAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_DATA);
+__DeclareMessageTagAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_ACKNOWLEDGEMENT);
+
+/*
+ * A chunk is the handle of the stream on the receiver and an offset,
+ * followed by the bytes.
+ */
+#define STREAM_CHUNK_HEADER_SIZE ( 2 * sizeof(MessageUnit) )
+#define STREAM_CHUNK_SIZE ( MAXIMUM_MESSAGE_SIZE_IN_BYTES - STREAM_CHUNK_HEADER_SIZE )
+
+/*
+ * States of a stream.
+ */
+#define STREAM_STATE_FREE 0
+#define STREAM_STATE_REQUESTED 1
+#define STREAM_STATE_WAITING 2
+#define STREAM_STATE_STREAMING 3
+#define STREAM_STATE_COMPLETED 4
+
+/**
+ * A large message that is sent or received.
+ */
+class MessageStream{
+public:
+	char*m_buffer;
+	uint64_t m_bytes;
+
+/** bytes sent or received */
+	uint64_t m_transferredBytes;
+
+/** the destination or the source */
+	Rank m_peer;
+
+/** the handle of the stream on the peer, -1 if not known yet */
+	int m_peerStream;
+
+	MessageTag m_tag;
+	int m_state;
+
+/** chunks sent or received, and chunks acknowledged by the receiver */
+	int m_chunks;
+	int m_acknowledgedChunks;
+};
+
+/**
+ * A READY or ACKNOWLEDGEMENT message of a handler, sent
+ * by sendChunks() when there is space in the outbox.
+ */
+class StreamControlMessage{
+public:
+	Rank m_destination;
+	MessageTag m_tag;
+	MessageUnit m_units[3];
+	int m_count;
+};
+
+/**
+ * Transport for messages larger than MAXIMUM_MESSAGE_SIZE_IN_BYTES.
+ *
+ * The sender asks the destination to allocate a buffer for the whole
+ * message (rendezvous). When the destination is ready, the message is
+ * sent in a pipeline of chunks of STREAM_CHUNK_SIZE bytes, with at
+ * most a window of chunks that are not acknowledged by the receiver.
+ * The chunks are written directly in outbox buffers, so the message is
+ * only copied once on each side.
+ *
+ * When all the chunks are received, the handler of the message tag is
+ * called once with the whole message, like for any other message.
+ * Its buffer is only valid in the handler. The number of bytes of a
+ * Message is an int, so for a message of 2 GiB or more it is -1 and
+ * the handler gets it with getCompletedMessageBytes().
+ *
+ * The ComputeCore sends the chunks before it sends its outbox and
+ * delivers the completed messages after the other received messages.
+ *
+ * \author RayPlatform contributors
+ */
+class MessageStreamer : public CorePlugin {
+
+	MessageTag RAYPLATFORM_MESSAGE_TAG_STREAM_REQUEST;
+	MessageTag RAYPLATFORM_MESSAGE_TAG_STREAM_READY;
+	MessageTag RAYPLATFORM_MESSAGE_TAG_STREAM_DATA;
+	MessageTag RAYPLATFORM_MESSAGE_TAG_STREAM_ACKNOWLEDGEMENT;
+
+	__AddAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_REQUEST);
+	__AddAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_READY);
+	__AddAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_DATA);
+	__AddAdapter(MessageStreamer, RAYPLATFORM_MESSAGE_TAG_STREAM_ACKNOWLEDGEMENT);
+
+	Rank m_rank;
+	int m_size;
+	StaticVector*m_outbox;
+
+/** the number of chunks that can be sent before an acknowledgement */
+	int m_window;
+
+	vector<MessageStream> m_outgoingStreams;
+	vector<int> m_freeOutgoingStreams;
+
+/** streams that have something to send, in round-robin order */
+	vector<int> m_activeOutgoingStreams;
+	int m_nextActiveStream;
+
+	vector<MessageStream> m_incomingStreams;
+	vector<int> m_freeIncomingStreams;
+
+/** control messages of the handlers that are not sent yet */
+	vector<StreamControlMessage> m_controlMessages;
+	int m_firstControlMessage;
+
+/** the number of bytes of the last completed message */
+	uint64_t m_completedMessageBytes;
+
+/** incoming streams that are complete and not delivered yet */
+	vector<int> m_completedStreams;
+
+/** statistics */
+	uint64_t m_sentMessages;
+	uint64_t m_sentBytes;
+	uint64_t m_sentChunks;
+	uint64_t m_receivedMessages;
+	uint64_t m_receivedBytes;
+	uint64_t m_receivedChunks;
+
+	int allocateStream(vector<MessageStream>*streams,vector<int>*freeStreams);
+	bool hasOpenWindow(MessageStream*stream);
+	void sendControlMessage(Rank destination,MessageTag tag,MessageUnit first,MessageUnit second,MessageUnit third,int count);
+	void queueControlMessage(Rank destination,MessageTag tag,MessageUnit first,MessageUnit second,MessageUnit third,int count);
+	void sendChunk(int handle);
+
+public:
+
+	MessageStreamer();
+
+/**
+ * \param window is the number of chunks that can be in flight for a stream
+ */
+	void initialize(Rank rank,int size,StaticVector*outbox,int window);
+
+/**
+ * Send a message of any size. The buffer must not be changed until
+ * test() returns true.
+ * \returns a handle for test()
+ */
+	int send(const char*buffer,uint64_t bytes,Rank destination,MessageTag tag);
+
+/**
+ * Test if all the bytes of a message were sent.
+ * The handle is released when this returns true.
+ */
+	bool test(int handle);
+
+/**
+ * Send the control messages of the handlers, the requests and the
+ * chunks that can be sent, but no more than maximumMessages.
+ */
+	void sendChunks(int maximumMessages);
+
+/** true if sendChunks() has something to send */
+	bool hasChunksToSend();
+
+/**
+ * Get a completed message. The buffer of the message must be given
+ * back with releaseMessage() when its handler returns.
+ */
+	bool getCompletedMessage(Message*message);
+	void releaseMessage(Message*message);
+
+/** the number of bytes of the message given by getCompletedMessage() */
+	uint64_t getCompletedMessageBytes();
+
+	void printStatus();
+
+	void call_RAYPLATFORM_MESSAGE_TAG_STREAM_REQUEST(Message*message);
+	void call_RAYPLATFORM_MESSAGE_TAG_STREAM_READY(Message*message);
+	void call_RAYPLATFORM_MESSAGE_TAG_STREAM_DATA(Message*message);
+	void call_RAYPLATFORM_MESSAGE_TAG_STREAM_ACKNOWLEDGEMENT(Message*message);
+
+	void resolveSymbols(ComputeCore*core);
+	void registerPlugin(ComputeCore*core);
+};
+
+#endif /* _MessageStreamer_h */
@@ -28,6 +28,7 @@
 #include <RayPlatform/memory/allocator.h>
 #include <RayPlatform/core/OperatingSystem.h>
 #include <RayPlatform/core/ComputeCore.h>
+#include <RayPlatform/cryptography/crypto.h>
 
 #include <fstream>
 #include <assert.h>
@@ -46,15 +47,15 @@ using namespace std;
 
 MessagesHandler::MessagesHandler() {
 
-	m_staticBuffer = NULL;
+	m_bufferPool = NULL;
+	m_receptionBuffer = NULL;
 }
 
 MessagesHandler::~MessagesHandler() {
+}
 
-	if(m_staticBuffer != NULL) {
-		free(m_staticBuffer);
-		m_staticBuffer = NULL;
-	}
+void MessagesHandler::setBufferPool(BufferPool*bufferPool){
+	m_bufferPool=bufferPool;
 }
 
 /**
@@ -172,7 +173,10 @@ void MessagesHandler::sendAndReceiveMessagesForRankProcess(ComputeCore**cores,in
  * in order to avoid the situation in which
  * all the buffer for the outbox are dirty/used.
  *
- * TODO: fix mini-rank code.
+ * A message is popped after its buffer is copied, the mini-rank
+ * reuses the buffer once it sees that the message was popped.
+ * When all the buffers are dirty, the messages stay in the queue
+ * until some sends complete.
  */
 void MessagesHandler::sendMessagesForMiniRank(MessageQueue*outbox,RingAllocator*outboxBufferAllocator,
 	int miniRanksPerRank){
@@ -186,9 +190,17 @@ void MessagesHandler::sendMessagesForMiniRank(MessageQueue*outbox,RingAllocator*
 
 	// send messages.
 	while(outbox->hasContent()){
+
+		if(outboxBufferAllocator->getNumberOfAvailableBuffers()==0){
+			outboxBufferAllocator->sweepDirtyBuffers();
+
+			if(outboxBufferAllocator->getNumberOfAvailableBuffers()==0)
+				return;
+		}
+
 		Message message;
 		Message*aMessage=&message;
-		outbox->pop(aMessage);
+		outbox->peek(aMessage);
 
 		int miniRankDestination=aMessage->getDestination();
 		//int miniRankSource=aMessage->getSource();
@@ -256,12 +268,13 @@ void MessagesHandler::sendMessagesForMiniRank(MessageQueue*outbox,RingAllocator*
  */
 		int bufferHandle=outboxBufferAllocator->getBufferHandle(copiedBuffer);
 		bool registeredAlready=outboxBufferAllocator->isRegistered(bufferHandle);
+		bool mustRegister=!registeredAlready;
 
 /*
  * Register the buffer as being dirty.
  */
 
-		if(!registeredAlready) {
+		if(mustRegister) {
 
 #ifdef CONFIG_ASSERT
 			int handle = outboxBufferAllocator->getBufferHandle(copiedBuffer);
@@ -270,9 +283,6 @@ void MessagesHandler::sendMessagesForMiniRank(MessageQueue*outbox,RingAllocator*
 
 			request = this->registerMessageBuffer(copiedBuffer, m_rank, destination,
 					tag, outboxBufferAllocator);
-
-			registeredAlready = true;
-
 		}
 
 		#ifdef CONFIG_ASSERT
@@ -306,19 +316,21 @@ void MessagesHandler::sendMessagesForMiniRank(MessageQueue*outbox,RingAllocator*
 
 /*
  * We can free the dummy request because the buffer is already registered.
+ * The request of a buffer registered above is tested by the sweeps.
  * TODO: instead, there should be a reference count for each buffer.
  */
-		if(registeredAlready)
+		if(!mustRegister)
 			MPI_Request_free(request);
 
+		// the copy is done, the mini-rank can reuse its buffer
+		outbox->pop(aMessage);
+
 		m_sentMessages++;
 	}
 }
 
-#ifdef CONFIG_COMM_PERSISTENT
-
 /*
- * receiveMessages is implemented as recommanded by Mr. George Bosilca from
+ * The persistent ring is implemented as recommanded by Mr. George Bosilca from
 the University of Tennessee (via the Open-MPI mailing list)
 
 De: George Bosilca <bosilca@…>
@@ -334,42 +346,69 @@ Once you use the data related to the receive, just do an MPI_Start on your reque
 This approach will minimize the unexpected messages, and drain the connections faster. 
 Moreover, at the end it is very easy to MPI_Cancel all the receives not yet matched.
 
+ * All the requests match any source and any tag, so MPI matches incoming
+ * messages with them in the order in which they were started. The head is
+ * only advanced when its request is completed and requests are restarted
+ * in ring order, therefore messages are pumped in their arrival order.
  */
-void MessagesHandler::pumpMessageFromPersistentRing(StaticVector*inbox,RingAllocator*inboxAllocator){
+void MessagesHandler::createPersistentRing(int ringSize,int bufferSize){
 
-	/* persistent communication is not enabled by default */
-	int flag=0;
-	MPI_Status status;
-	MPI_Request*request=m_ring+m_head;
-	MPI_Test(request,&flag,&status);
+	#ifdef CONFIG_ASSERT
+	assert(m_ring==NULL);
+	assert(ringSize>=1);
+	assert(bufferSize>=MAXIMUM_MESSAGE_SIZE_IN_BYTES);
+	#endif
 
-	if(flag){
-		// get the length of the message
-		// it is not necessary the same as the one posted with MPI_Recv_init
-		// that one was a lower bound
-		MessageTag  tag=status.MPI_TAG;
-		Rank source=status.MPI_SOURCE;
+	m_ringSize=ringSize;
+	m_ringBufferSize=bufferSize;
+	m_head=0;
+	m_lentRequests=0;
 
-		int count;
-		MPI_Get_count(&status,m_datatype,&count);
-		MessageUnit*filledBuffer=(MessageUnit*)m_buffers+m_head*MAXIMUM_MESSAGE_SIZE_IN_BYTES/sizeof(MessageUnit);
+	m_ring=(MPI_Request*)__Malloc(sizeof(MPI_Request)*m_ringSize,"RAY_MALLOC_TYPE_PERSISTENT_MESSAGE_RING",false);
+	m_buffers=(uint8_t*)__Malloc(m_ringBufferSize*m_ringSize,"RAY_MALLOC_TYPE_PERSISTENT_MESSAGE_BUFFERS",false);
 
-		// copy it in a safe buffer
-		// internal buffers are all of length MAXIMUM_MESSAGE_SIZE_IN_BYTES
-		MessageUnit*incoming=(MessageUnit*)inboxAllocator->allocate(MAXIMUM_MESSAGE_SIZE_IN_BYTES);
+	// post a few receives.
+	for(int i=0;i<m_ringSize;i++){
+		uint8_t*buffer=m_buffers+i*m_ringBufferSize;
+		MPI_Recv_init(buffer,m_ringBufferSize,m_datatype,
+			MPI_ANY_SOURCE,MPI_ANY_TAG,MPI_COMM_WORLD,m_ring+i);
+		MPI_Start(m_ring+i);
+	}
+}
 
-		memcpy(incoming,filledBuffer,count*sizeof(MessageUnit));
+void MessagesHandler::destroyPersistentRing(){
 
-		// the request can start again
-		MPI_Start(m_ring+m_head);
+	if(m_ring==NULL)
+		return;
 
-		// add the message in the internal inbox
-		// this inbox is not the real inbox
-		Message aMessage(incoming,count,m_rank,tag,source);
+/*
+ * Lent requests are not active, they can be freed right away.
+ */
+	for(int i=0;i<m_ringSize;i++){
+
+		int distance=(m_head-i+m_ringSize)%m_ringSize;
+		bool isLent=distance>=1 && distance<=m_lentRequests;
 
-		inbox->push_back(aMessage);
+		if(!isLent){
+			MPI_Status status;
+			MPI_Cancel(m_ring+i);
+			MPI_Wait(m_ring+i,&status);
+		}
+
+		MPI_Request_free(m_ring+i);
 	}
 
+	__Free(m_ring,"RAY_MALLOC_TYPE_PERSISTENT_MESSAGE_RING",false);
+	m_ring=NULL;
+	__Free(m_buffers,"RAY_MALLOC_TYPE_PERSISTENT_MESSAGE_BUFFERS",false);
+	m_buffers=NULL;
+}
+
+void MessagesHandler::restartPersistentRequest(){
+
+	// the request can start again
+	MPI_Start(m_ring+m_head);
+
 	// advance the ring.
 	m_head++;
 
@@ -377,7 +416,83 @@ void MessagesHandler::pumpMessageFromPersistentRing(StaticVector*inbox,RingAlloc
 		m_head = 0;
 }
 
-#endif /* CONFIG_COMM_PERSISTENT */
+/*
+ * The buffer of a completed request is given to the inbox without any copy.
+ * The request is restarted on the next call, when the ComputeCore
+ * has cleared its inbox.
+ */
+void MessagesHandler::pumpMessagesFromPersistentRing(StaticVector*inbox,RingAllocator*inboxAllocator,
+	int maximumMessages){
+
+	if(m_ring==NULL){
+/*
+ * Requests given to the inbox are not active, so more requests
+ * than the number of messages received in one call are needed.
+ */
+		createPersistentRing(m_size+maximumMessages,inboxAllocator->getSize());
+	}
+
+	#ifdef CONFIG_ASSERT
+	assert(maximumMessages<m_ringSize);
+	#endif
+
+/*
+ * The previous messages are consumed, restart their requests.
+ */
+	int lentRequest=(m_head-m_lentRequests+m_ringSize)%m_ringSize;
+
+	while(m_lentRequests>0){
+		MPI_Start(m_ring+lentRequest);
+
+		lentRequest++;
+		if(lentRequest==m_ringSize)
+			lentRequest=0;
+
+		m_lentRequests--;
+	}
+
+	for(int received=0;received<maximumMessages;received++){
+
+		int flag=0;
+		MPI_Status status;
+		MPI_Test(m_ring+m_head,&flag,&status);
+
+		// nothing to receive...
+		if(!flag)
+			return;
+
+		// get the length of the message
+		// it is not necessary the same as the one posted with MPI_Recv_init
+		// that one was an upper bound
+		MessageTag tag=status.MPI_TAG;
+		Rank source=status.MPI_SOURCE;
+
+		int count=-1;
+		MPI_Get_count(&status,m_datatype,&count);
+
+		#ifdef CONFIG_ASSERT
+		assert(count >= 0);
+		assert(count <= m_ringBufferSize);
+		#endif
+
+		char*incoming=(char*)m_buffers+m_head*m_ringBufferSize;
+
+		Message aMessage(incoming,count,m_rank,tag,source);
+		aMessage.setNumberOfBytes(count);
+
+		inbox->push_back(&aMessage);
+
+		m_lentRequests++;
+
+		// advance the ring.
+		m_head++;
+
+		if(m_head == m_ringSize)
+			m_head = 0;
+
+		m_receivedMessages++;
+	}
+}
 
 #ifdef CONFIG_MINI_RANKS
 
@@ -395,7 +510,32 @@ void MessagesHandler::receiveMessagesForMiniRanks(ComputeCore**cores,int miniRan
 	int source=MPI_ANY_SOURCE;
 	int tag=MPI_ANY_TAG;
 
-	MPI_Iprobe(source,tag,MPI_COMM_WORLD,&flag,&status);
+	#ifdef CONFIG_ASSERT
+	assert(m_bufferPool!=NULL);
+	#endif
+
+/*
+ * The message is received in a buffer of the pool of the RankProcess.
+ * If all the buffers are used by the mini-ranks, the reception waits
+ * until some of them are released.
+ */
+	if(m_receptionBuffer == NULL)
+		m_receptionBuffer = (char*)m_bufferPool->allocate();
+
+	if(m_receptionBuffer == NULL)
+		return;
+
+	bool usePersistentRing=m_receiveEngine==RECEIVE_ENGINE_PERSISTENT_RING;
+
+	if(usePersistentRing){
+
+		if(m_ring==NULL)
+			createPersistentRing(m_size,m_bufferPool->getBufferSize());
+
+		MPI_Test(m_ring+m_head,&flag,&status);
+	}else{
+		MPI_Iprobe(source,tag,MPI_COMM_WORLD,&flag,&status);
+	}
 
 	// nothing to receive...
 	if(!flag)
@@ -414,19 +554,27 @@ void MessagesHandler::receiveMessagesForMiniRanks(ComputeCore**cores,int miniRan
 	#ifdef CONFIG_ASSERT
 	assert(count >= 0);
 	assert(count >= 2);// we need mini-rank numbers !
+	assert(count <= m_bufferPool->getBufferSize());
 	#endif
 
-	if(m_staticBuffer == NULL) {
+/*
+ * With the persistent ring, the message is already in the buffer of the
+ * request at the head of the ring, and the request can be restarted
+ * once the message is copied.
+ * Otherwise, the message is received directly in the pool buffer.
+ */
+	char * receivedBuffer = m_receptionBuffer;
 
-		int requiredBytes = MAXIMUM_MESSAGE_SIZE_IN_BYTES + MESSAGE_META_DATA_SIZE;
-		m_staticBuffer = (char*) malloc(requiredBytes);
+	if(usePersistentRing){
 
-#ifdef CONFIG_ASSERT
-		assert(m_staticBuffer != NULL);
-#endif
-	}
+		memcpy(receivedBuffer, (char*)m_buffers + m_head * m_ringBufferSize, count*sizeof(char));
 
-	MPI_Recv(m_staticBuffer,count,datatype,actualSource,actualTag,MPI_COMM_WORLD,&status);
+		restartPersistentRequest();
+
+	}else{
+
+		MPI_Recv(receivedBuffer,count,datatype,actualSource,actualTag,MPI_COMM_WORLD,&status);
+	}
 
 #ifdef GITHUB_ISSUE_220
 	if(actualTag == 17) {
@@ -434,14 +582,14 @@ void MessagesHandler::receiveMessagesForMiniRanks(ComputeCore**cores,int miniRan
 		cout << " bytes." << endl;
 
 		Message dummy;
-		dummy.printBuffer(m_staticBuffer, count);
+		dummy.printBuffer(receivedBuffer, count);
 	}
 #endif
 
 
 	//cout << "DEBUG preloading metadata count= " << count << endl;
 
-	Message newMessage(m_staticBuffer, count, -1, actualTag, -1); // here the count is the number of MessageUnit
+	Message newMessage(receivedBuffer, count, -1, actualTag, -1); // here the count is the number of MessageUnit
 	newMessage.setNumberOfBytes(count);
 
 	newMessage.loadMetaData();
@@ -466,8 +614,6 @@ void MessagesHandler::receiveMessagesForMiniRanks(ComputeCore**cores,int miniRan
 	cout<<" tag is "<<actualTag<<endl;
 	#endif
 
-	char * incoming=NULL;
-
 	ComputeCore*core=cores[miniRankIndex];
 
 /*
@@ -491,27 +637,12 @@ void MessagesHandler::receiveMessagesForMiniRanks(ComputeCore**cores,int miniRan
 	inbox->lock();
 #endif /* CONFIG_USE_LOCKING */
 
-	if(count > 0){
-		incoming=(char*)core->getBufferedInboxAllocator()->allocate(count*sizeof(char));
-
-		#ifdef CONFIG_ASSERT
-		assert(incoming!=NULL);
-		#endif
-
-		memcpy(incoming, m_staticBuffer,count*sizeof(char));
-
-#ifdef GITHUB_ISSUE_220
-		if(actualTag == 17) {
-			cout << "DEBUG copying " << count << " bytes to incoming buffer";
-			cout << endl;
-
-			Message dummy;
-			dummy.printBuffer(incoming, count);
-		}
-#endif
-
-
-	}
+/*
+ * The ownership of the buffer is given to the mini-rank, it will
+ * release it at the end of its tick.
+ */
+	char * incoming=receivedBuffer;
+	m_receptionBuffer=NULL;
 
 	Message aMessage(incoming, count, miniRankDestination, actualTag, miniRankSource);
 	aMessage.setNumberOfBytes(count);
@@ -534,6 +665,8 @@ void MessagesHandler::receiveMessagesForMiniRanks(ComputeCore**cores,int miniRan
 	inbox->unlock();
 #endif /* CONFIG_USE_LOCKING */
 
+	core->wakeUp();
+
 	#ifdef CONFIG_ASSERT
 	// this assertion is not valid for mini-ranks.
 	//assert(aMessage.getDestination() == m_rank);
@@ -798,23 +931,15 @@ void MessagesHandler::probeAndRead(Rank source,MessageTag tag,
 }
 
 void MessagesHandler::initialiseMembers(){
-	#ifdef CONFIG_COMM_PERSISTENT
-	// the ring itself  contain requests ready to receive messages
-	m_ringSize=m_size;
 
-	m_ring=(MPI_Request*)__Malloc(sizeof(MPI_Request)*m_ringSize,"RAY_MALLOC_TYPE_PERSISTENT_MESSAGE_RING",false);
-	m_buffers=(uint8_t*)__Malloc(MAXIMUM_MESSAGE_SIZE_IN_BYTES*m_ringSize,"RAY_MALLOC_TYPE_PERSISTENT_MESSAGE_BUFFERS",false);
+	// the ring is created on the first reception because the size
+	// of the buffers is not known yet
+	m_ring=NULL;
+	m_buffers=NULL;
+	m_ringSize=0;
+	m_ringBufferSize=0;
 	m_head=0;
-
-	// post a few receives.
-	for(int i=0;i<m_ringSize;i++){
-		uint8_t*buffer=m_buffers+i*MAXIMUM_MESSAGE_SIZE_IN_BYTES;
-		MPI_Recv_init(buffer,MAXIMUM_MESSAGE_SIZE_IN_BYTES/sizeof(MessageUnit),m_datatype,
-			MPI_ANY_SOURCE,MPI_ANY_TAG,MPI_COMM_WORLD,m_ring+i);
-		MPI_Start(m_ring+i);
-	}
-
-	#endif /* CONFIG_COMM_PERSISTENT */
+	m_lentRequests=0;
 }
 
 void MessagesHandler::freeLeftovers(){
@@ -823,19 +948,7 @@ void MessagesHandler::freeLeftovers(){
 	destroy_irecv_testany();
 	#endif /* CONFIG_COMM_IRECV_TESTANY */
 
-	#ifdef CONFIG_COMM_PERSISTENT
-
-	for(int i=0;i<m_ringSize;i++){
-		MPI_Cancel(m_ring+i);
-		MPI_Request_free(m_ring+i);
-	}
-
-	__Free(m_ring,"RAY_MALLOC_TYPE_PERSISTENT_MESSAGE_RING",false);
-	m_ring=NULL;
-	__Free(m_buffers,"RAY_MALLOC_TYPE_PERSISTENT_MESSAGE_BUFFERS",false);
-	m_buffers=NULL;
-
-	#endif /* CONFIG_COMM_PERSISTENT */
+	destroyPersistentRing();
 
 	#if 0
 	__Free(m_messageStatistics,"RAY_MALLOC_TYPE_MESSAGE_STATISTICS",false);
@@ -890,6 +1003,27 @@ void MessagesHandler::constructor(int*argc,char***argv){
 	initialiseMembers();
 	m_processorName=serverName;
 
+	negotiateWireFormat();
+	countRanksOnNode();
+
+/*
+ * Select the receive engine.
+ */
+	m_receiveEngine=RECEIVE_ENGINE_PERSISTENT_RING;
+
+	for(int i=0;i<(*argc);i++){
+		if(strcmp((*argv)[i],"-receive-engine")==0 && i+1<(*argc)){
+			const char*engine=(*argv)[i+1];
+
+			if(strcmp(engine,"probe")==0)
+				m_receiveEngine=RECEIVE_ENGINE_PROBE;
+			else if(strcmp(engine,"persistent")==0)
+				m_receiveEngine=RECEIVE_ENGINE_PERSISTENT_RING;
+			else if(m_rank==MASTER_RANK)
+				cout<<"[MessagesHandler] Warning: unknown receive engine "<<engine<<", using persistent"<<endl;
+		}
+	}
+
 
 
 	#ifdef CONFIG_COMM_IRECV_TESTANY
@@ -899,6 +1033,98 @@ void MessagesHandler::constructor(int*argc,char***argv){
 	createBuffers();
 }
 
+/*
+ * A rank built with another wire format would decode headers with the
+ * wrong layout, so this is checked once before any message is sent.
+ * The ranks can run different builds, for instance with several
+ * executables or several architectures: they must agree on the
+ * version of the header, the size of messages and of message units
+ * and the byte order. loadMetaData also checks the version of each
+ * received header.
+ *
+ * Checksums use CRC-32C if every rank has the SSE 4.2 crc32 instruction,
+ * and CRC-32 otherwise.
+ */
+void MessagesHandler::negotiateWireFormat(){
+
+	int hardware=hasHardwareCastagnoliCode32();
+	int allHaveHardware=0;
+
+	MPI_Allreduce(&hardware,&allHaveHardware,1,MPI_INT,MPI_MIN,MPI_COMM_WORLD);
+
+	m_checksumAlgorithm=CHECKSUM_CRC32;
+
+	if(allHaveHardware)
+		m_checksumAlgorithm=CHECKSUM_CRC32C;
+
+	const int parameters=4;
+	const char*names[parameters]={"wire-format version","maximum message size",
+		"message unit size","byte order"};
+
+	uint32_t byteOrder=0x01020304;
+	uint8_t firstByte=0;
+	memcpy(&firstByte,&byteOrder,sizeof(firstByte));
+
+	int values[parameters];
+	values[0]=MESSAGE_WIRE_FORMAT_VERSION;
+	values[1]=MAXIMUM_MESSAGE_SIZE_IN_BYTES;
+	values[2]=sizeof(MessageUnit);
+	values[3]=firstByte;
+
+	int minimums[parameters];
+	int maximums[parameters];
+
+	MPI_Allreduce(values,minimums,parameters,MPI_INT,MPI_MIN,MPI_COMM_WORLD);
+	MPI_Allreduce(values,maximums,parameters,MPI_INT,MPI_MAX,MPI_COMM_WORLD);
+
+	bool agree=true;
+
+	for(int i=0;i<parameters;i++){
+		if(minimums[i]==maximums[i])
+			continue;
+
+		cout<<"Error: rank "<<m_rank<<" uses "<<names[i]<<" "<<values[i];
+		cout<<", but the ranks use "<<minimums[i]<<" to "<<maximums[i]<<endl;
+
+		agree=false;
+	}
+
+	if(!agree)
+		MPI_Abort(MPI_COMM_WORLD,EXIT_WIRE_FORMAT_MISMATCH);
+}
+
+int MessagesHandler::getChecksumAlgorithm(){
+	return m_checksumAlgorithm;
+}
+
+/*
+ * The ranks of a node are the ranks with the same processor name.
+ * The work that uses threads at startup shares the cores of the
+ * node between them.
+ */
+void MessagesHandler::countRanksOnNode(){
+
+	char name[MPI_MAX_PROCESSOR_NAME];
+	memset(name,0,MPI_MAX_PROCESSOR_NAME);
+	strncpy(name,m_processorName.c_str(),MPI_MAX_PROCESSOR_NAME-1);
+
+	vector<char> names((uint64_t)m_size*MPI_MAX_PROCESSOR_NAME);
+
+	MPI_Allgather(name,MPI_MAX_PROCESSOR_NAME,MPI_CHAR,&(names[0]),
+		MPI_MAX_PROCESSOR_NAME,MPI_CHAR,MPI_COMM_WORLD);
+
+	m_ranksOnNode=0;
+
+	for(int i=0;i<m_size;i++){
+		if(strcmp(name,&(names[(uint64_t)i*MPI_MAX_PROCESSOR_NAME]))==0)
+			m_ranksOnNode++;
+	}
+}
+
+int MessagesHandler::getNumberOfRanksOnNode(){
+	return m_ranksOnNode;
+}
+
 void MessagesHandler::createBuffers(){
 
 	#if 0
@@ -930,11 +1156,12 @@ void MessagesHandler::createBuffers(){
 
 void MessagesHandler::destructor(){
 	if(!m_destroyed){
+		// pending persistent receives must be cancelled before finalizing
+		freeLeftovers();
+
 		MPI_Finalize();
 		m_destroyed=true;
 	}
-
-	freeLeftovers();
 }
 
 string*MessagesHandler::getName(){
@@ -1189,7 +1416,21 @@ void MessagesHandler::sendMessages(StaticVector*outbox,RingAllocator*outboxBuffe
 }
 
 
-void MessagesHandler::receiveMessages(StaticVector*inbox,RingAllocator*inboxAllocator){
+/*
+ * Pump up to maximumMessages messages with MPI_Iprobe + MPI_Recv.
+ * The loop stops as soon as MPI_Iprobe is not productive so that an idle
+ * rank still does only one MPI_Iprobe per tick.
+ *
+ * The inbox allocator must have at least maximumMessages buffers since
+ * all the messages of a tick are alive at the same time.
+ */
+void MessagesHandler::receiveMessages(StaticVector*inbox,RingAllocator*inboxAllocator,int maximumMessages){
+
+	if(m_receiveEngine==RECEIVE_ENGINE_PERSISTENT_RING){
+		pumpMessagesFromPersistentRing(inbox,inboxAllocator,maximumMessages);
+		return;
+	}
+
 	// the code here will probe from rank source
 	// with MPI_Iprobe
 
@@ -1197,46 +1438,52 @@ void MessagesHandler::receiveMessages(StaticVector*inbox,RingAllocator*inboxAllo
 	cout<<"call to probeAndRead source="<<source<<""<<endl;
 	#endif /* COMMUNICATION_IS_VERBOSE */
 
+	#ifdef CONFIG_ASSERT
+	assert(maximumMessages>=1);
+	assert(maximumMessages<=inboxAllocator->getNumberOfBuffers());
+	#endif
+
 	int source=MPI_ANY_SOURCE;
 	int tag=MPI_ANY_TAG;
 
-	int flag=0;
-	MPI_Status status;
-	MPI_Iprobe(source,tag,MPI_COMM_WORLD,&flag,&status);
+	for(int received=0;received<maximumMessages;received++){
 
-	// nothing to receive...
-	if(!flag)
-		return;
+		int flag=0;
+		MPI_Status status;
+		MPI_Iprobe(source,tag,MPI_COMM_WORLD,&flag,&status);
 
-	/* read at most one message */
-	MPI_Datatype datatype= m_datatype;
-	int actualTag=status.MPI_TAG;
-	Rank actualSource=status.MPI_SOURCE;
-	int count=-1;
-	MPI_Get_count(&status,datatype,&count);
+		// nothing to receive...
+		if(!flag)
+			return;
 
-	#ifdef CONFIG_ASSERT
-	assert(count >= 0);
-	#endif
+		MPI_Datatype datatype= m_datatype;
+		int actualTag=status.MPI_TAG;
+		Rank actualSource=status.MPI_SOURCE;
+		int count=-1;
+		MPI_Get_count(&status,datatype,&count);
 
-	char * incoming=NULL;
-	if(count > 0){
-		incoming=(char*)inboxAllocator->allocate(count * sizeof(char));
-	}
+		#ifdef CONFIG_ASSERT
+		assert(count >= 0);
+		#endif
 
-	MPI_Recv(incoming,count,datatype,actualSource,actualTag,MPI_COMM_WORLD,&status);
+		char * incoming=NULL;
+		if(count > 0){
+			incoming=(char*)inboxAllocator->allocate(count * sizeof(char));
+		}
 
-	Message aMessage(incoming,count,m_rank,actualTag,actualSource);
-	aMessage.setNumberOfBytes(count);
+		MPI_Recv(incoming,count,datatype,actualSource,actualTag,MPI_COMM_WORLD,&status);
 
-	inbox->push_back(&aMessage);
+		Message aMessage(incoming,count,m_rank,actualTag,actualSource);
+		aMessage.setNumberOfBytes(count);
 
-	#ifdef CONFIG_ASSERT
-	assert(aMessage.getDestination() == m_rank);
-	#endif
+		inbox->push_back(&aMessage);
 
-	m_receivedMessages++;
+		#ifdef CONFIG_ASSERT
+		assert(aMessage.getDestination() == m_rank);
+		#endif
 
+		m_receivedMessages++;
+	}
 }
 
 void MessagesHandler::sendMessagesForComputeCore(StaticVector*outbox,MessageQueue*bufferedOutbox){
@@ -1245,24 +1492,28 @@ void MessagesHandler::sendMessagesForComputeCore(StaticVector*outbox,MessageQueu
 	bufferedOutbox.lock();
 #endif /* CONFIG_USE_LOCKING */
 
-	int messages=outbox->size();
+	uint32_t messages=outbox->size();
 
 /*
  * TODO: I am not sure that it is safe to give our own buffer to
  * the other thread. If the ring is large enough and the communication
  * is steady, probably.
+ *
+ * The whole outbox is published at once, if there is enough room.
  */
-	for(int i=0;i<messages;i++){
-		Message*message=(*outbox)[i];
+	uint32_t pushed=0;
 
 /*
  * If the queue is full, we just retry endlessly, it will work eventually.
  * If not, something is wrong.
  */
-		int ticks=0;
+	int ticks=0;
 
-		while(!bufferedOutbox->push(message)){
+	while(pushed<messages){
 
+		pushed+=bufferedOutbox->pushMany(outbox->at(pushed),messages-pushed);
+
+		if(pushed<messages){
 			if(ticks%CONFIG_MESSAGE_QUEUE_RETRY_WARNING ==0)
 				cout<<"[MessagesHandler] Warning: outbox message queue is full, will retry in a bit... (#"<<ticks<<")"<<endl;
 
@@ -1276,35 +1527,35 @@ void MessagesHandler::sendMessagesForComputeCore(StaticVector*outbox,MessageQueu
 
 }
 
-void MessagesHandler::receiveMessagesForComputeCore(StaticVector*inbox,RingAllocator*inboxAllocator,
-	MessageQueue*bufferedInbox){
+void MessagesHandler::receiveMessagesForComputeCore(StaticVector*inbox,MessageQueue*bufferedInbox,
+	int maximumMessages,int miniRankIndex){
 
 #ifdef CONFIG_USE_LOCKING
 	bufferedInbox->lock();
 #endif /* CONFIG_USE_LOCKING */
 
 /*
- * We need to copy the buffer in our own buffer here
- * because otherwise this is not thread safe.
+ * The messages of the previous tick are consumed, so their
+ * buffers can go back to the pool.
  */
-	if(bufferedInbox->hasContent()){
-		Message message;
-		bufferedInbox->pop(&message);
-
-		int count=message.getNumberOfBytes();
-		char *incoming=(char*)inboxAllocator->allocate(count*sizeof(char));
+	m_bufferPool->releaseHeldBuffers(miniRankIndex);
 
 /*
- * Copy the data, this is slow but required I think.
+ * The buffers are from the pool of the RankProcess, the communication thread
+ * gave them to us, so no copy is needed.
  */
-		memcpy(incoming,message.getBuffer(), count*sizeof(char));
+	int received=0;
 
-/*
- * Update the buffer so that the code is thread-safe.
- */
-		message.setBuffer(incoming);
+	while(received<maximumMessages && bufferedInbox->hasContent()){
+		Message message;
+		bufferedInbox->pop(&message);
+
+		if(message.getBuffer()!=NULL)
+			m_bufferPool->hold(miniRankIndex,message.getBuffer());
 
 		inbox->push_back(&message);
+
+		received++;
 	}
 
 #ifdef CONFIG_USE_LOCKING
@@ -24,6 +24,7 @@
 
 #include "Message.h"
 
+#include <RayPlatform/memory/BufferPool.h>
 #include <RayPlatform/memory/MyAllocator.h>
 #include <RayPlatform/memory/RingAllocator.h>
 #include <RayPlatform/structures/StaticVector.h>
@@ -46,23 +47,17 @@ using namespace std;
      	latency(120): 23 microseconds
      	latency with 1008 cores: 78 (84*12): microseconds (without -route-messages.)
      	with fairness, no starvation
- * - CONFIG_COMM_PERSISTENT (latency(36): , no fairness)
-     	latency(36): 28 micro seconds
-	latency(120): 75 microseconds
-	no fairness, possible starvation
  * - CONFIG_COMM_IRECV_TESTANY (no data)
+ *
+ * The probing models above can be replaced at runtime by the
+ * persistent ring (-receive-engine persistent, this is the default),
+ * see RECEIVE_ENGINE_PERSISTENT_RING below.
  */
 
 /*
  * only one must be set
  */
 
-/*
- * Persistent communication pumps the message more rapidly
- * on some systems
- */
-//#define CONFIG_COMM_PERSISTENT
-
 /**
  *  Use round-robin reception.
  */
@@ -89,6 +84,16 @@ using namespace std;
 class ComputeCore;
 class MessageQueue;
 
+/*
+ * Receive engines that can be selected with -receive-engine.
+ *
+ * RECEIVE_ENGINE_PROBE: MPI_Iprobe + MPI_Recv (-receive-engine probe)
+ * RECEIVE_ENGINE_PERSISTENT_RING: pre-posted persistent receives (MPI_Recv_init)
+ *   tested in order with MPI_Test (-receive-engine persistent)
+ */
+#define RECEIVE_ENGINE_PROBE 0
+#define RECEIVE_ENGINE_PERSISTENT_RING 1
+
 /*
  Open-MPI eager threshold is 4k (4096), and this include Open-MPI's metadata.
  tests show that 4096-100 bytes are sent eagerly, too.
@@ -117,7 +122,7 @@ class MessageQueue;
  * CONFIG_COMM_IPROBE_ANY_SOURCE -> MPI_Iprobe with any source + MPI_Recv
  * CONFIG_COMM_IRECV_TESTANY -> MPI_Irecv + MPI_Testany
  * CONFIG_COMM_IPROBE_ROUND_ROBIN -> MPI_Iprobe with round-robin source + MPI_Recv
- * CONFIG_COMM_PERSISTENT -> MPI_Recv_init + MPI_Test 
+ * -receive-engine persistent -> MPI_Recv_init + MPI_Test (selected at runtime)
  *
  * \author Sébastien Boisvert
  */
@@ -125,10 +130,12 @@ class MessagesHandler{
 
 #ifdef CONFIG_MINI_RANKS
 /*
- * We need a temporary buffer because we don't know yet 
- * for which mini-rank the message is for.
+ * Buffers shared with the mini-ranks, owned by the RankProcess.
+ * We don't know yet for which mini-rank the message is for, so
+ * m_receptionBuffer is taken from the pool before the reception.
  */
-	char * m_staticBuffer;
+	BufferPool * m_bufferPool;
+	char * m_receptionBuffer;
 #endif
 
 	bool m_hasReceivedMessage;
@@ -158,21 +165,21 @@ class MessagesHandler{
 
 	string m_processorName;
 
+	/** the number of MPI ranks with the same processor name */
+	int m_ranksOnNode;
+
+	void countRanksOnNode();
+
 #ifdef CONFIG_COMM_IPROBE_ROUND_ROBIN
 	/** round-robin head */
 	int m_currentRankIndexToTryToReceiveFrom;
 #endif /* CONFIG_COMM_IPROBE_ROUND_ROBIN */
 
-#ifdef CONFIG_COMM_PERSISTENT
+	/** the receive engine, RECEIVE_ENGINE_PROBE or RECEIVE_ENGINE_PERSISTENT_RING */
+	int m_receiveEngine;
 
-	/** the number of buffered messages in the persistent layer */
-	int m_bufferedMessages;
-
-	/** linked lists */
-	MessageNode**m_heads;
-
-	/** linked lists */
-	MessageNode**m_tails;
+	/** CHECKSUM_CRC32 or CHECKSUM_CRC32C */
+	int m_checksumAlgorithm;
 
 	/** the number of persistent requests in the ring */
 	int m_ringSize;
@@ -180,13 +187,18 @@ class MessagesHandler{
 	/** the current persistent request in the ring */
 	int m_head;
 
+	/** the number of ring buffers given to the inbox, they are
+	 * the m_lentRequests requests before m_head */
+	int m_lentRequests;
+
 	/** the ring of persistent requests */
 	MPI_Request*m_ring;
 
 	/** the ring of buffers for persistent requests */
 	uint8_t*m_buffers;
 
-#endif /* CONFIG_COMM_PERSISTENT */
+	/** the size of each buffer in the ring */
+	int m_ringBufferSize;
 
 
 #ifdef CONFIG_COMM_IRECV_TESTANY
@@ -203,10 +215,17 @@ class MessagesHandler{
 
 	void probeAndRead(int source,int tag,ComputeCore**cores,int miniRanksPerRank);
 
-#ifdef CONFIG_COMM_PERSISTENT
-	/** pump a message from the persistent ring */
-	void pumpMessageFromPersistentRing(StaticVector*inbox,RingAllocator*inboxAllocator);
-#endif /* CONFIG_COMM_PERSISTENT */
+	/** post the persistent receives of the ring */
+	void createPersistentRing(int ringSize,int bufferSize);
+
+	/** cancel and free the persistent receives of the ring */
+	void destroyPersistentRing();
+
+	/** restart the persistent request at the head of the ring and advance the head */
+	void restartPersistentRequest();
+
+	/** pump messages from the persistent ring, the ring buffers are given to the inbox */
+	void pumpMessagesFromPersistentRing(StaticVector*inbox,RingAllocator*inboxAllocator,int maximumMessages);
 
 #ifdef CONFIG_COMM_IPROBE_ROUND_ROBIN
 	/** select and fetch a message from the internal messages using a round-robin policy */
@@ -224,6 +243,9 @@ class MessagesHandler{
 
 	void createBuffers();
 
+/** all the ranks must encode message headers and checksums in the same way */
+	void negotiateWireFormat();
+
 
 /**
  *  send a message or more
@@ -256,10 +278,10 @@ public:
 	void sendMessages(StaticVector*outbox,RingAllocator*outboxBufferAllocator);
 
 /**
- * receive one or zero message.
+ * receive at most maximumMessages messages, in arrival order.
  * the others, if any, will be picked up in the next iteration
  */
-	void receiveMessages(StaticVector*inbox,RingAllocator*inboxAllocator);
+	void receiveMessages(StaticVector*inbox,RingAllocator*inboxAllocator,int maximumMessages);
 
 	/** free the ring elements */
 	void freeLeftovers();
@@ -296,8 +318,16 @@ public:
 
 	void sendMessagesForComputeCore(StaticVector*outbox,MessageQueue*bufferedOutbox);
 
-	void receiveMessagesForComputeCore(StaticVector*inbox,RingAllocator*inboxAllocator,
-		MessageQueue*bufferedOutbox);
+	void receiveMessagesForComputeCore(StaticVector*inbox,MessageQueue*bufferedInbox,
+		int maximumMessages,int miniRankIndex);
+
+	void setBufferPool(BufferPool*bufferPool);
+
+/** the checksum algorithm that all the ranks agreed on */
+	int getChecksumAlgorithm();
+
+/** the number of MPI ranks that run on the node of this rank */
+	int getNumberOfRanksOnNode();
 };
 
 #endif /* _MessagesHandler */
@@ -0,0 +1,125 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#include "RelayFrame.h"
+
+#include <RayPlatform/memory/allocator.h>
+
+#include <string.h>
+
+#ifdef CONFIG_ASSERT
+#include <assert.h>
+#endif
+
+void RelayFrame::constructor(){
+	m_buffer=(char*)__Malloc(MAXIMUM_MESSAGE_SIZE_IN_BYTES,"RAY_MALLOC_TYPE_RELAY_FRAME",false);
+	m_bytes=0;
+	m_messages=0;
+	m_firstMessageTime=0;
+	m_full=false;
+}
+
+void RelayFrame::destructor(){
+
+	if(m_buffer==NULL)
+		return;
+
+	__Free(m_buffer,"RAY_MALLOC_TYPE_RELAY_FRAME",false);
+	m_buffer=NULL;
+	m_bytes=0;
+	m_messages=0;
+}
+
+bool RelayFrame::addMessage(Message*message,uint64_t now){
+
+	int bytes=message->getNumberOfBytes();
+
+	// the metadata is not saved yet, so use its maximum size
+	int needed=RELAY_FRAME_RECORD_HEADER_SIZE+bytes+MESSAGE_HEADER_MAXIMUM_SIZE;
+
+	if(m_bytes+needed>MAXIMUM_MESSAGE_SIZE_IN_BYTES){
+		m_full=true;
+		return false;
+	}
+
+	char*record=m_buffer+m_bytes;
+
+	if(bytes>0)
+		memcpy(record+RELAY_FRAME_RECORD_HEADER_SIZE,message->getBuffer(),bytes);
+
+	// save the metadata in the frame
+	Message copy=*message;
+	copy.setBuffer(record+RELAY_FRAME_RECORD_HEADER_SIZE);
+	copy.saveMetaData();
+
+	int32_t tag=message->getTag();
+	int32_t savedBytes=copy.getNumberOfBytes();
+
+	memcpy(record,&tag,sizeof(tag));
+	memcpy(record+sizeof(tag),&savedBytes,sizeof(savedBytes));
+
+	int recordBytes=RELAY_FRAME_RECORD_HEADER_SIZE+savedBytes;
+
+	// keep the records aligned
+	recordBytes=(recordBytes+7)&~7;
+
+	if(m_messages==0)
+		m_firstMessageTime=now;
+
+	m_bytes+=recordBytes;
+	m_messages++;
+
+	#ifdef CONFIG_ASSERT
+	assert(m_bytes<=MAXIMUM_MESSAGE_SIZE_IN_BYTES);
+	#endif
+
+	return true;
+}
+
+void RelayFrame::flush(Message*message){
+
+	#ifdef CONFIG_ASSERT
+	assert(m_messages>0);
+	#endif
+
+	message->setBuffer(m_buffer);
+	message->setNumberOfBytes(m_bytes);
+
+	m_bytes=0;
+	m_messages=0;
+	m_full=false;
+}
+
+int RelayFrame::getNumberOfBytes(){
+	return m_bytes;
+}
+
+int RelayFrame::getNumberOfMessages(){
+	return m_messages;
+}
+
+uint64_t RelayFrame::getFirstMessageTime(){
+	return m_firstMessageTime;
+}
+
+bool RelayFrame::isFull(){
+	return m_full;
+}
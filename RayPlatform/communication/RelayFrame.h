@@ -0,0 +1,86 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _RelayFrame_h
+#define _RelayFrame_h
+
+#include "Message.h"
+
+#include <RayPlatform/core/types.h>
+
+#include <stdint.h>
+
+/*
+ * A record in a frame is a 8-byte header (tag and number of bytes)
+ * followed by the message and its metadata, padded to 8 bytes.
+ */
+#define RELAY_FRAME_RECORD_HEADER_SIZE (2*sizeof(int32_t))
+
+/**
+ * Routed messages waiting at a relay rank for the same next rank.
+ *
+ * They are sent together as one message. Each one keeps its own
+ * metadata (routing, actors and mini-ranks), so that the next rank
+ * can unpack it and handle it like a message it received.
+ *
+ * \author RayPlatform contributors
+ */
+class RelayFrame{
+
+	char*m_buffer;
+
+/** the number of bytes used in m_buffer */
+	int m_bytes;
+
+	int m_messages;
+
+/** time of the first message, in microseconds */
+	uint64_t m_firstMessageTime;
+
+/** set when a message did not fit */
+	bool m_full;
+
+public:
+
+	void constructor();
+	void destructor();
+
+/**
+ * Copy a routed message in the frame. The source and the
+ * destination of the message must be the ones of the frame.
+ * \returns false if there is not enough space left.
+ */
+	bool addMessage(Message*message,uint64_t now);
+
+/**
+ * Prepare the message that carries the frame. The frame is
+ * empty afterwards, but its buffer must not be changed
+ * before the message is copied in the outbox buffer.
+ */
+	void flush(Message*message);
+
+	int getNumberOfBytes();
+	int getNumberOfMessages();
+	uint64_t getFirstMessageTime();
+	bool isFull();
+};
+
+#endif /* _RelayFrame_h */
@@ -36,17 +36,32 @@ using namespace std;
 /** set the number of elements per message for a given tag */
 void VirtualCommunicator::setElementsPerQuery(int tag,int size){
 	#ifdef CONFIG_ASSERT
-	assert(m_elementSizes.count(tag)==0);
 	assert(tag!=INVALID_HANDLE);
+	assert(tag>=0);
+	assert(size>0);
+	#endif
+
+	if((int)m_elementSizes.size()<=tag)
+		m_elementSizes.resize(tag+1,0);
+
+	#ifdef CONFIG_ASSERT
+	assert(m_elementSizes[tag]==0);
 	#endif
 
 	m_elementSizes[tag]=size;
+
+	// give a slot to the tag for its groups
+	if((int)m_tagSlots.size()<=tag)
+		m_tagSlots.resize(tag+1,-1);
+
+	m_tagSlots[tag]=m_slotTags.size();
+	m_slotTags.push_back(tag);
 }
 
 /** get the number of elements per message for a given tag */
 int VirtualCommunicator::getElementsPerQuery(int tag){
 	#ifdef CONFIG_ASSERT
-	assert(m_elementSizes.count(tag)!=0);
+	assert(tag<(int)m_elementSizes.size() && m_elementSizes[tag]!=0);
 	#endif
 
 	return m_elementSizes[tag];
@@ -55,13 +70,23 @@ int VirtualCommunicator::getElementsPerQuery(int tag){
 /**  associate the reply message tag to a message tag */
 void VirtualCommunicator::setReplyType(int query,int reply){
 	#ifdef CONFIG_ASSERT
-	assert(m_replyTagToQueryTag.count(reply)==0);
+	assert(query>=0 && reply>=0);
+	#endif
+
+	if((int)m_replyTagToQueryTag.size()<=reply)
+		m_replyTagToQueryTag.resize(reply+1,-1);
+
+	#ifdef CONFIG_ASSERT
+	assert(m_replyTagToQueryTag[reply]==-1);
 	#endif
 
 	m_replyTagToQueryTag[reply]=query;
 
+	if((int)m_reverseReplyMap.size()<=query)
+		m_reverseReplyMap.resize(query+1,-1);
+
 	#ifdef CONFIG_ASSERT
-	assert(m_reverseReplyMap.count(query) == 0);
+	assert(m_reverseReplyMap[query]==-1);
 	#endif
 
 	m_reverseReplyMap[query]=reply;
@@ -69,10 +94,10 @@ void VirtualCommunicator::setReplyType(int query,int reply){
 
 int VirtualCommunicator::getReplyType(int tag){
 	#ifdef CONFIG_ASSERT
-	if(m_reverseReplyMap.count(tag) == 0){
+	if(tag>=(int)m_reverseReplyMap.size() || m_reverseReplyMap[tag]==-1){
 		cout<<"Error: "<<MESSAGE_TAGS[tag]<<" is not in the reverse-map"<<endl;
 	}
-	assert(m_reverseReplyMap.count(tag) > 0);
+	assert(tag<(int)m_reverseReplyMap.size() && m_reverseReplyMap[tag]!=-1);
 	#endif
 	
 	return m_reverseReplyMap[tag];
@@ -86,7 +111,7 @@ void VirtualCommunicator::pushMessage(WorkerHandle workerId,Message*message){
 	int tag=message->getTag();
 
 	#ifdef CONFIG_ASSERT
-	assert(m_elementSizes.count(tag)>0);
+	assert(tag<(int)m_elementSizes.size() && m_elementSizes[tag]>0);
 	#endif
 
 	int period=m_elementSizes[tag];
@@ -102,12 +127,12 @@ void VirtualCommunicator::pushMessage(WorkerHandle workerId,Message*message){
 
 	m_pushedMessages++;
 	#ifdef CONFIG_ASSERT
-	if(m_elementsForWorkers.count(workerId)>0){
+	if(isMessageProcessed(workerId)){
 		cout<<"Error: there is already a pending message for worker "<<workerId<<", will not add message with tag="<<MESSAGE_TAGS[message->getTag()]<<endl;
 		cout<<"Did you forget to pull a reply with isMessageProcessed and getMessageResponseElements ?"<<endl;
 		cout<<"It is likely if you mix virtual messages with bare messages !"<<endl;
 	}
-	assert(m_elementsForWorkers.count(workerId)==0);
+	assert(!isMessageProcessed(workerId));
 	#endif
 	m_globalPushedMessageStatus=true;
 	m_localPushedMessageStatus=true;
@@ -119,49 +144,40 @@ void VirtualCommunicator::pushMessage(WorkerHandle workerId,Message*message){
 		cout<<"Error: tag="<<message->getTag()<<" destination="<<destination<<" (INVALID)"<<endl;
 	}
 	assert(destination>=0&&destination<m_size);
+	assert(count>0);
 	#endif
 
-	#ifdef CONFIG_ASSERT
-	assert(m_elementSizes.count(tag)>0);
-	#endif
+	int group=getGroup(tag,destination);
 
-	/**  generate   a group key for the message 
- * 	this is used for priority calculation
- * 	*/
-	uint64_t elementId=getMessageUniqueId(destination,tag);
-	int oldPriority=0;
-	/* delete old priority */
-	if(m_messageContent.count(tag)>0&&m_messageContent[tag].count(destination)>0){
-		oldPriority=m_messageContent[tag][destination].size();
-		m_priorityQueue[oldPriority].erase(elementId);
-		if(m_priorityQueue[oldPriority].size()==0){
-			m_priorityQueue.erase(oldPriority);
-		}
-	}
-	int newPriority=oldPriority+count;
-	m_priorityQueue[newPriority].insert(elementId);
+	if(m_groupSlabs[group]==-1)
+		m_groupSlabs[group]=allocateSlab();
 
-	#ifdef CONFIG_ASSERT
-	assert(count>0);
-	#endif
+	int slab=m_groupSlabs[group];
 
 	MessageUnit*buffer=(MessageUnit*)message->getBuffer();
-	for(int i=0;i<count;i++){// count is probably 1...
-		MessageUnit element=buffer[i];
-		m_messageContent[tag][destination].push_back(element);
-	}
+	MessageUnit*elements=&(m_slabElements[slab*m_slabCapacity+m_groupElements[group]]);
+
+	for(int i=0;i<count;i++)// count is probably 1...
+		elements[i]=buffer[i];
+
+	m_groupElements[group]+=count;
 
 	/** add the worker workerId  to the list of workers that pushed a message of type
  * 	tag to message-passing interface  rank destination
  */
-	m_workerCurrentIdentifiers[tag][destination].push_back(workerId);
+	m_slabWorkers[slab*m_slabCapacity+m_groupWorkers[group]]=workerId;
+	m_groupWorkers[group]++;
 
-	#ifdef CONFIG_ASSERT
-	assert(m_elementSizes.count(tag)>0);
-	#endif
+	/* the priority of the group is its number of elements */
+	if(m_groupHeapPositions[group]==-1){
+		m_groupHeapPositions[group]=m_heap.size();
+		m_heap.push_back(group);
+	}
+
+	moveUpInHeap(m_groupHeapPositions[group]);
 
 	/** check if the current size is good enough to flush the whole thing */
-	int currentSize=m_workerCurrentIdentifiers[tag][destination].size();
+	int currentSize=m_groupWorkers[group];
 
 	/*
  *	maximum number of pushed messages
@@ -170,11 +186,10 @@ void VirtualCommunicator::pushMessage(WorkerHandle workerId,Message*message){
 
 	/** this whole block makes sure that the communicator is not overloaded */
 	#ifdef CONFIG_ASSERT
-	assert(m_elementSizes.count(tag)>0);
 	assert(period>=1);
 	assert(threshold<=(int)(MAXIMUM_MESSAGE_SIZE_IN_BYTES/sizeof(MessageUnit)));
 	if(currentSize>threshold){
-		cout<<"Fatal: too much bits, tag= "<<MESSAGE_TAGS[tag]<<" Threshold= "<<threshold<<" pushed messages; Actual= "<<currentSize<<" pushed messages; Period= "<<period<<" MessageUnit/message; Count= "<<count<<" Priority= "<<newPriority<<" Destination: "<<destination<<endl;
+		cout<<"Fatal: too much bits, tag= "<<MESSAGE_TAGS[tag]<<" Threshold= "<<threshold<<" pushed messages; Actual= "<<currentSize<<" pushed messages; Period= "<<period<<" MessageUnit/message; Count= "<<count<<" Priority= "<<m_groupElements[group]<<" Destination: "<<destination<<endl;
 		cout<<"This usually means that you did not use the VirtualCommunicator API correctly."<<endl;
 		cout<<"Be careful not to push too many messages if the VirtualCommunicator is not ready."<<endl;
 		cout<<"IMPORTANT: did you add entries for reply tags.txt and tag sizes ?"<<endl;
@@ -184,11 +199,15 @@ void VirtualCommunicator::pushMessage(WorkerHandle workerId,Message*message){
 
 	if(currentSize>=threshold){
 		// must flush the message
-		flushMessage(tag,destination);
+		flushMessage(group);
 	}
 }
 
-void VirtualCommunicator::flushMessage(int tag,int destination){
+void VirtualCommunicator::flushMessage(int group){
+
+	int tag=m_slotTags[group/m_size];
+	int destination=group%m_size;
+
 	#ifdef CONFIG_DEBUG_VIRTUAL_COMMUNICATOR
 	cout<<"VirtualCommunicator:: sending multiplexed message to "<<destination<<endl;
 	#endif
@@ -196,49 +215,60 @@ void VirtualCommunicator::flushMessage(int tag,int destination){
 	m_flushedMessages++;
 
 	#ifdef CONFIG_ASSERT
-	assert(m_messageContent.count(tag)>0&&m_messageContent[tag].count(destination)>0);
+	assert(m_groupSlabs[group]!=-1);
 	#endif
 
-	// find the priority and erase it
-	int priority=m_messageContent[tag][destination].size();
-	uint64_t elementId=getMessageUniqueId(destination,tag);
-	m_priorityQueue[priority].erase(elementId);
-	if(m_priorityQueue[priority].size()==0){
-		m_priorityQueue.erase(priority);
-	}
+	removeFromHeap(group);
 
-	m_activeDestination=destination;
-	m_activeTag=tag;
-	int currentSize=priority;
+	int currentSize=m_groupElements[group];
+	int slab=m_groupSlabs[group];
 
 	#ifdef CONFIG_ASSERT
 	if(currentSize==0){
 		cout<<"Cannot flush empty buffer!"<<endl;
 	}
 	assert(currentSize>0);
-	int requiredResponseLength=m_workerCurrentIdentifiers[tag][destination].size()*m_elementSizes[tag]*sizeof(MessageUnit);
+	int requiredResponseLength=m_groupWorkers[group]*m_elementSizes[tag]*sizeof(MessageUnit);
 	assert(requiredResponseLength<=MAXIMUM_MESSAGE_SIZE_IN_BYTES);
 	#endif
 
 	MessageUnit*messageContent=(MessageUnit*)m_outboxAllocator->allocate(currentSize*sizeof(MessageUnit));
 
+	MessageUnit*elements=&(m_slabElements[slab*m_slabCapacity]);
+
 	for(int j=0;j<currentSize;j++){
-		messageContent[j]=m_messageContent[tag][destination][j];
+		messageContent[j]=elements[j];
 	}
 
-	m_messageContent[tag].erase(destination);
-	if(m_messageContent[tag].size()==0){
-		m_messageContent.erase(tag);
-	}
+	// the slab waits for the reply with the workers
+	m_slabWorkerCounts[slab]=m_groupWorkers[group];
+	m_slabGroups[slab]=group;
+	m_slabNext[slab]=-1;
+	m_slabPrevious[slab]=m_groupLastInFlight[group];
+
+	if(m_groupLastInFlight[group]==-1)
+		m_groupFirstInFlight[group]=slab;
+	else
+		m_slabNext[m_groupLastInFlight[group]]=slab;
+
+	m_groupLastInFlight[group]=slab;
+
+	m_groupSlabs[group]=-1;
+	m_groupElements[group]=0;
+	m_groupWorkers[group]=0;
 
 	Message aMessage(messageContent,currentSize,destination,tag,m_rank);
+	aMessage.setSequence(slab);
 	m_outbox->push_back(&aMessage);
 
 	m_pendingMessages++;
+
+	if(m_pendingMessages>m_peakPendingMessages)
+		m_peakPendingMessages=m_pendingMessages;
 }
 
 bool VirtualCommunicator::isMessageProcessed(WorkerHandle workerId){
-	return m_elementsForWorkers.count(workerId)>0;
+	return m_replyTable.find(workerId)!=-1;
 }
 
 void VirtualCommunicator::getMessageResponseElements(WorkerHandle workerId,vector<MessageUnit>*out){
@@ -246,17 +276,22 @@ void VirtualCommunicator::getMessageResponseElements(WorkerHandle workerId,vecto
 	assert(isMessageProcessed(workerId));
 	#endif
 
-	for(int i=0;i<(int)(m_elementsForWorkers[workerId].size());i++)
-		out->push_back(m_elementsForWorkers[workerId][i]);
+	int block=m_replyTable.find(workerId);
+	MessageUnit*elements=&(m_replyElements[block*m_replyStride]);
+
+	for(int i=0;i<m_replyCounts[block];i++)
+		out->push_back(elements[i]);
 
-	m_elementsForWorkers.erase(workerId);
+	m_replyTable.erase(workerId);
+	m_freeReplyBlocks.push_back(block);
 
 	#ifdef CONFIG_ASSERT
 	assert(!isMessageProcessed(workerId));
 	#endif
 }
 
-void VirtualCommunicator::constructor(int rank,int size,RingAllocator*outboxAllocator,StaticVector*inbox,StaticVector*outbox){
+void VirtualCommunicator::constructor(int rank,int size,RingAllocator*outboxAllocator,StaticVector*inbox,StaticVector*outbox,
+		int maximumPendingMessages){
 	
 #ifdef CONFIG_DEBUG_VIRTUAL_COMMUNICATOR
 	cout<<"Rank "<<rank<<" Initializing VirtualCommunicator"<<endl;
@@ -270,6 +305,40 @@ void VirtualCommunicator::constructor(int rank,int size,RingAllocator*outboxAllo
 	m_inbox=inbox;
 	m_outbox=outbox;
 	m_pendingMessages=0;
+	m_peakPendingMessages=0;
+
+	m_maximumPendingMessages=maximumPendingMessages;
+
+	if(m_maximumPendingMessages<1)
+		m_maximumPendingMessages=1;
+
+	m_slabCapacity=MAXIMUM_MESSAGE_SIZE_IN_BYTES/sizeof(MessageUnit);
+	m_numberOfSlabs=0;
+	m_slabElements.clear();
+	m_slabWorkers.clear();
+	m_freeSlabs.clear();
+	m_slabNext.clear();
+	m_slabPrevious.clear();
+	m_slabWorkerCounts.clear();
+	m_slabGroups.clear();
+
+	m_groupSlabs.clear();
+	m_groupElements.clear();
+	m_groupWorkers.clear();
+	m_groupHeapPositions.clear();
+	m_groupFirstInFlight.clear();
+	m_groupLastInFlight.clear();
+	m_heap.clear();
+
+	m_replyTable.constructor(1024);
+	m_replyCounts.clear();
+	m_replyElements.clear();
+	m_freeReplyBlocks.clear();
+	m_numberOfReplyBlocks=0;
+	m_replyStride=1;
+
+	m_unansweredQueries.clear();
+	m_numberOfUnansweredQueries=0;
 
 	resetLocalPushedMessageStatus();
 	resetGlobalPushedMessageStatus();
@@ -282,21 +351,118 @@ void VirtualCommunicator::resetCounters(){
 
 }
 
+/**
+ * \returns the in-flight slab of a group that a reply answers, -1 if none
+ */
+int VirtualCommunicator::getInFlightSlab(int group,Message*reply){
+	int sequence=reply->getSequence();
+
+	if(sequence==MESSAGE_NO_SEQUENCE)
+		return m_groupFirstInFlight[group];
+
+	if(sequence<0 || sequence>=m_numberOfSlabs || m_slabGroups[sequence]!=group){
+		cout<<"Rank "<<m_rank<<" Error: VirtualCommunicator received a reply from "<<reply->getSource();
+		cout<<" with sequence "<<sequence<<", but no such query is in flight"<<endl;
+		return -1;
+	}
+
+	return sequence;
+}
+
+void VirtualCommunicator::removeInFlightSlab(int group,int slab){
+	int next=m_slabNext[slab];
+	int previous=m_slabPrevious[slab];
+
+	if(previous==-1)
+		m_groupFirstInFlight[group]=next;
+	else
+		m_slabNext[previous]=next;
+
+	if(next==-1)
+		m_groupLastInFlight[group]=previous;
+	else
+		m_slabPrevious[next]=previous;
+
+	m_slabGroups[slab]=-1;
+}
+
+void VirtualCommunicator::setReplySequences(Message*query,int firstMessage){
+	int sequence=query->getSequence();
+	int tag=query->getTag();
+
+	if(sequence==MESSAGE_NO_SEQUENCE || tag>=(int)m_reverseReplyMap.size() || m_reverseReplyMap[tag]==-1)
+		return;
+
+	uint64_t key=m_reverseReplyMap[tag];
+	key=(key<<32)|query->getSource();
+
+	m_unansweredQueries[key].push_back(sequence);
+	m_numberOfUnansweredQueries++;
+
+	tagReplies(firstMessage);
+}
+
+void VirtualCommunicator::setDeferredReplySequences(){
+	if(m_numberOfUnansweredQueries==0)
+		return;
+
+	tagReplies(0);
+}
+
+/*
+ * A rank answers the queries of another rank in the order in which
+ * they were received, so each reply gets the oldest unanswered query.
+ */
+void VirtualCommunicator::tagReplies(int firstMessage){
+	for(int i=firstMessage;i<m_outbox->size() && m_numberOfUnansweredQueries>0;i++){
+		Message*message=m_outbox->at(i);
+		int tag=message->getTag();
+
+		if(message->getSequence()!=MESSAGE_NO_SEQUENCE
+				|| tag>=(int)m_replyTagToQueryTag.size() || m_replyTagToQueryTag[tag]==-1)
+			continue;
+
+		uint64_t key=tag;
+		key=(key<<32)|message->getDestination();
+
+		map<uint64_t,vector<int> >::iterator queries=m_unansweredQueries.find(key);
+
+		if(queries==m_unansweredQueries.end())
+			continue;
+
+		message->setSequence(queries->second[0]);
+		queries->second.erase(queries->second.begin());
+		m_numberOfUnansweredQueries--;
+
+		if(queries->second.empty())
+			m_unansweredQueries.erase(queries);
+	}
+}
+
+/*
+ * The inbox can contain several messages when the ComputeCore
+ * receives messages in batches. They are scanned in arrival order
+ * and each reply is de-multiplexed to the workers of the in-flight
+ * message that it answers.
+ */
 void VirtualCommunicator::processInbox(vector<WorkerHandle>*activeWorkers){
-	if(m_pendingMessages>0&&m_inbox->size()>0){// we have mail
-		Message*message=m_inbox->at(0);// there is 0 or 1 message in the inbox
+	for(int messageIndex=0;m_pendingMessages>0&&messageIndex<m_inbox->size();messageIndex++){// we have mail
+		Message*message=m_inbox->at(messageIndex);
 		int incomingTag=message->getTag();
 		int source=message->getSource();
-		if(m_replyTagToQueryTag.count(incomingTag)==0){
-			return;
+		if(incomingTag>=(int)m_replyTagToQueryTag.size() || m_replyTagToQueryTag[incomingTag]==-1){
+			continue;
 		}
 
-		#ifdef CONFIG_ASSERT
-		assert(m_replyTagToQueryTag.count(incomingTag)>0);
-		#endif
-
 		int queryTag=m_replyTagToQueryTag[incomingTag];
-		if(m_activeTag==queryTag&&m_activeDestination==source){
+
+		if(queryTag>=(int)m_tagSlots.size() || m_tagSlots[queryTag]==-1)
+			continue;
+
+		int group=getGroup(queryTag,source);
+		int slab=getInFlightSlab(group,message);
+
+		if(slab!=-1){
 			#ifdef CONFIG_DEBUG_VIRTUAL_COMMUNICATOR
 			cout<<"VirtualCommunicator: receiving multiplexed message, de-multiplexing data..."<<endl;
 			#endif
@@ -306,30 +472,30 @@ void VirtualCommunicator::processInbox(vector<WorkerHandle>*activeWorkers){
 			MessageUnit*buffer=(MessageUnit*)message->getBuffer();
 
 			#ifdef CONFIG_ASSERT
-			assert(m_elementSizes.count(queryTag)>0);
+			assert(m_elementSizes[queryTag]>0);
 			#endif
 
 			int elementsPerWorker=m_elementSizes[queryTag];
-			vector<WorkerHandle> workers=m_workerCurrentIdentifiers[m_activeTag][m_activeDestination];
-			m_workerCurrentIdentifiers[m_activeTag][m_activeDestination].clear();
+			WorkerHandle*workers=&(m_slabWorkers[slab*m_slabCapacity]);
+			int numberOfWorkers=m_slabWorkerCounts[slab];
 			
 			#ifdef CONFIG_ASSERT
-			assert(workers.size()>0);
+			assert(numberOfWorkers>0);
 			assert(elementsPerWorker>0);
 			int count=message->getCount();
 			if(count==0){
 				cout<<"QueryTag = "<<queryTag<<endl;
 			}
 			assert(count>0);
-			if(count!=(int)workers.size()*elementsPerWorker){
-				cout<<"Rank="<<m_rank<<" Count="<<count<<" Workers="<<workers.size()<<" ElementsPerWorker="<<elementsPerWorker<<" QueryTag="<<MESSAGE_TAGS[queryTag]<<endl;
+			if(count!=numberOfWorkers*elementsPerWorker){
+				cout<<"Rank="<<m_rank<<" Count="<<count<<" Workers="<<numberOfWorkers<<" ElementsPerWorker="<<elementsPerWorker<<" QueryTag="<<MESSAGE_TAGS[queryTag]<<endl;
 			}
-			assert(count==(int)workers.size()*elementsPerWorker);
+			assert(count==numberOfWorkers*elementsPerWorker);
 			#endif
 
 			// add the workers to a list
 			// so they can be activated again
-			for(int i=0;i<(int)workers.size();i++){
+			for(int i=0;i<numberOfWorkers;i++){
 				WorkerHandle workerId=workers[i];
 				activeWorkers->push_back(workerId);
 
@@ -340,17 +506,14 @@ void VirtualCommunicator::processInbox(vector<WorkerHandle>*activeWorkers){
 				int basePosition=i*elementsPerWorker;
 
 				#ifdef CONFIG_ASSERT
-				if(m_elementsForWorkers.count(workerId)>0){
+				if(isMessageProcessed(workerId)){
 					cout<<"there already are elements for "<<workerId<<endl;
 				}
-				assert(m_elementsForWorkers.count(workerId)==0);
+				assert(!isMessageProcessed(workerId));
 				#endif
 
 				// classify the data and bins
-				for(int j=0;j<elementsPerWorker;j++){
-					uint64_t element=buffer[basePosition+j];
-					m_elementsForWorkers[workerId].push_back(element);
-				}
+				storeReply(workerId,buffer+basePosition,elementsPerWorker);
 
 				// make sure that is someone 
 				// asks if workerId can fetch its thing,
@@ -359,6 +522,10 @@ void VirtualCommunicator::processInbox(vector<WorkerHandle>*activeWorkers){
 				assert(isMessageProcessed(workerId));
 				#endif
 			}
+
+			// the slab is recycled
+			removeInFlightSlab(group,slab);
+			m_freeSlabs.push_back(slab);
 		}
 	}
 
@@ -384,17 +551,17 @@ bool VirtualCommunicator::getGlobalPushedMessageStatus(){
 }
 
 bool VirtualCommunicator::isReady(){
-	return m_pendingMessages==0;
+	return m_pendingMessages<m_maximumPendingMessages;
 }
 
-// force the first encountered thing
+// force the fullest group
 void VirtualCommunicator::forceFlush(){
 
 #ifdef CONFIG_DEBUG_VIRTUAL_COMMUNICATOR
 	cout<<__func__<<endl;
 #endif
 
-	if(m_priorityQueue.size()==0){
+	if(m_heap.empty()){
 
 #ifdef CONFIG_DEBUG_VIRTUAL_COMMUNICATOR
 		cout<<"queue is empty"<<endl;
@@ -402,41 +569,23 @@ void VirtualCommunicator::forceFlush(){
 		return;
 	}
 
-	// if forceFlush is called
-	// and there are no message
-	// the thing will crash 
-	// it is designed like that
-	#ifdef CONFIG_ASSERT
-	assert(!m_priorityQueue.rbegin()->second.empty());
-	#endif
-
-	uint64_t elementId=*(m_priorityQueue.rbegin()->second.begin());
-	int selectedDestination=getDestinationFromMessageUniqueId(elementId);
-	int selectedTag=getTagFromMessageUniqueId(elementId);
-
-	#ifdef CONFIG_ASSERT
-	assert(m_messageContent.count(selectedTag)>0&&m_messageContent[selectedTag].count(selectedDestination)>0);
-	assert(!m_messageContent[selectedTag][selectedDestination].empty());
-	#endif
-
-	flushMessage(selectedTag,selectedDestination);
+	flushMessage(m_heap[0]);
 }
 
 bool VirtualCommunicator::hasMessagesToFlush(){
-	return !m_messageContent.empty();
+	return !m_heap.empty();
 }
 
 bool VirtualCommunicator::nextIsAlmostFull(){
-	if(m_priorityQueue.empty()){
+	if(m_heap.empty()){
 		return false;
 	}
 	
-	uint64_t elementId=*(m_priorityQueue.rbegin()->second.begin());
-	int selectedDestination=getDestinationFromMessageUniqueId(elementId);
-	int selectedTag=getTagFromMessageUniqueId(elementId);
+	int group=m_heap[0];
+	int selectedTag=m_slotTags[group/m_size];
 	
 	int period=m_elementSizes[selectedTag];
-	int currentSize=m_messageContent[selectedTag][selectedDestination].size();
+	int currentSize=m_groupElements[group];
 	int threshold=MAXIMUM_MESSAGE_SIZE_IN_BYTES/8;
 	int value=currentSize*period;
 
@@ -452,21 +601,171 @@ void VirtualCommunicator::printStatistics(){
 
 	cout<<"Rank "<<m_rank<<" : VirtualCommunicator (service provided by VirtualCommunicator): "<<m_pushedMessages;
 	cout<<" virtual messages generated "<<m_flushedMessages;
-	cout<<" real messages ("<<ratio<<"%)"<<endl;
+	cout<<" real messages ("<<ratio<<"%), at most "<<m_peakPendingMessages<<" of "<<m_maximumPendingMessages;
+	cout<<" messages in flight"<<endl;
 }
 
-uint64_t VirtualCommunicator::getMessageUniqueId(Rank destination ,int tag){
-	uint64_t a=tag;
-	a=a*MAX_NUMBER_OF_MPI_PROCESSES+destination;
-	return a;
+int VirtualCommunicator::getGroup(int tag,Rank destination){
+
+	#ifdef CONFIG_ASSERT
+	assert(tag<(int)m_tagSlots.size() && m_tagSlots[tag]!=-1);
+	#endif
+
+	int group=m_tagSlots[tag]*m_size+destination;
+
+	// the groups of a tag are created on its first push
+	if(group>=(int)m_groupSlabs.size()){
+		int groups=m_slotTags.size()*m_size;
+
+		m_groupSlabs.resize(groups,-1);
+		m_groupElements.resize(groups,0);
+		m_groupWorkers.resize(groups,0);
+		m_groupHeapPositions.resize(groups,-1);
+		m_groupFirstInFlight.resize(groups,-1);
+		m_groupLastInFlight.resize(groups,-1);
+	}
+
+	return group;
+}
+
+int VirtualCommunicator::allocateSlab(){
+	if(!m_freeSlabs.empty()){
+		int slab=m_freeSlabs.back();
+		m_freeSlabs.pop_back();
+		return slab;
+	}
+
+	int slab=m_numberOfSlabs++;
+
+	m_slabElements.resize(m_numberOfSlabs*m_slabCapacity);
+	m_slabWorkers.resize(m_numberOfSlabs*m_slabCapacity);
+	m_slabNext.resize(m_numberOfSlabs,-1);
+	m_slabPrevious.resize(m_numberOfSlabs,-1);
+	m_slabWorkerCounts.resize(m_numberOfSlabs,0);
+	m_slabGroups.resize(m_numberOfSlabs,-1);
+
+	return slab;
+}
+
+/*
+ * The fullest group comes first. Ties are broken with the group
+ * number so that the order does not depend on the history of the heap.
+ */
+bool VirtualCommunicator::isHigherInHeap(int group,int otherGroup){
+	if(m_groupElements[group]!=m_groupElements[otherGroup])
+		return m_groupElements[group]>m_groupElements[otherGroup];
+
+	return group<otherGroup;
 }
 
-int VirtualCommunicator::getTagFromMessageUniqueId(uint64_t a){
-	return a/MAX_NUMBER_OF_MPI_PROCESSES;
+void VirtualCommunicator::swapInHeap(int position,int otherPosition){
+	int group=m_heap[position];
+	int otherGroup=m_heap[otherPosition];
+
+	m_heap[position]=otherGroup;
+	m_heap[otherPosition]=group;
+
+	m_groupHeapPositions[otherGroup]=position;
+	m_groupHeapPositions[group]=otherPosition;
 }
 
-Rank VirtualCommunicator::getDestinationFromMessageUniqueId(uint64_t a){
-	int rank=a%MAX_NUMBER_OF_MPI_PROCESSES;
-	return rank;
+void VirtualCommunicator::moveUpInHeap(int position){
+	while(position>0){
+		int parent=(position-1)/2;
+
+		if(!isHigherInHeap(m_heap[position],m_heap[parent]))
+			break;
+
+		swapInHeap(position,parent);
+		position=parent;
+	}
 }
 
+void VirtualCommunicator::moveDownInHeap(int position){
+	int size=m_heap.size();
+
+	while(true){
+		int best=position;
+		int left=2*position+1;
+		int right=left+1;
+
+		if(left<size && isHigherInHeap(m_heap[left],m_heap[best]))
+			best=left;
+		if(right<size && isHigherInHeap(m_heap[right],m_heap[best]))
+			best=right;
+
+		if(best==position)
+			break;
+
+		swapInHeap(position,best);
+		position=best;
+	}
+}
+
+void VirtualCommunicator::removeFromHeap(int group){
+	int position=m_groupHeapPositions[group];
+
+	#ifdef CONFIG_ASSERT
+	assert(position>=0 && position<(int)m_heap.size());
+	#endif
+
+	int last=m_heap.size()-1;
+
+	if(position!=last)
+		swapInHeap(position,last);
+
+	m_heap.pop_back();
+	m_groupHeapPositions[group]=-1;
+
+	if(position<last){
+		moveDownInHeap(position);
+		moveUpInHeap(position);
+	}
+}
+
+void VirtualCommunicator::storeReply(WorkerHandle workerId,MessageUnit*elements,int count){
+
+	if(count>m_replyStride)
+		setReplyStride(count);
+
+	int block=-1;
+
+	if(!m_freeReplyBlocks.empty()){
+		block=m_freeReplyBlocks.back();
+		m_freeReplyBlocks.pop_back();
+	}else{
+		block=m_numberOfReplyBlocks++;
+
+		m_replyCounts.resize(m_numberOfReplyBlocks,0);
+		m_replyElements.resize(m_numberOfReplyBlocks*m_replyStride);
+	}
+
+	MessageUnit*destination=&(m_replyElements[block*m_replyStride]);
+
+	for(int i=0;i<count;i++)
+		destination[i]=elements[i];
+
+	m_replyCounts[block]=count;
+	m_replyTable.insert(workerId,block);
+}
+
+/*
+ * Make the blocks larger, this happens when a reply has more elements
+ * than all the previous ones.
+ */
+void VirtualCommunicator::setReplyStride(int stride){
+
+	#ifdef CONFIG_ASSERT
+	assert(stride>m_replyStride);
+	#endif
+
+	vector<MessageUnit> elements(m_numberOfReplyBlocks*stride);
+
+	for(int block=0;block<m_numberOfReplyBlocks;block++){
+		for(int i=0;i<m_replyCounts[block];i++)
+			elements[block*stride+i]=m_replyElements[block*m_replyStride+i];
+	}
+
+	m_replyElements.swap(elements);
+	m_replyStride=stride;
+}
@@ -28,11 +28,11 @@
 #include <RayPlatform/memory/RingAllocator.h>
 #include <RayPlatform/memory/MyAllocator.h>
 #include <RayPlatform/structures/StaticVector.h>
+#include <RayPlatform/structures/HandleTable.h>
 
 #include <map>
 #include <vector>
 #include <stdint.h>
-#include <queue>
 using namespace std;
 
 /**
@@ -52,51 +52,121 @@ class VirtualCommunicator{
 	uint64_t m_pushedMessages;
 	uint64_t m_flushedMessages;
 
-	// priority, elementId, QueueElement
-	map<int,set<uint64_t> > m_priorityQueue;
-
 	// associates an MPI tag with a length reservation.
 	// for instance, asking the coverage is 1 but asking ingoing edges is 5
-	// key: MPI tag
-	// number of elements per query
+	// index: MPI tag
+	// value: number of elements per query, 0 if the tag is not virtual
 	// getting ingoing edges for a vertex requires 5 because at most there will be 4 and the size is a requirement
-	map<int,int> m_elementSizes;
+	vector<int> m_elementSizes;
+
+	// reply types, indexed by MPI tag, -1 if none
+	vector<int> m_replyTagToQueryTag;
+
+	vector<int> m_reverseReplyMap;
+
+/*
+ * The sequences of the queries received by this rank that are not
+ * answered yet, in the order in which the queries were received,
+ * by (reply tag,source). A handler can answer a query in a later tick.
+ */
+	map<uint64_t,vector<int> > m_unansweredQueries;
+	int m_numberOfUnansweredQueries;
+
+/*
+ * A group holds the elements pushed for a (tag,destination) tuple.
+ * Groups are stored densely: the group of a tuple is
+ * m_tagSlots[tag]*m_size+destination.
+ */
 
-	// indicates to who belongs each elements to communicate, grouped according to m_elementSizes
-	map<int,map<int,vector<WorkerHandle> > > m_workerCurrentIdentifiers;
+	// index: MPI tag, value: slot of the tag, -1 if none
+	vector<int> m_tagSlots;
 
-	// the message contents
-	// first key: MPI tag
-	// second key: MPI destination
-	// vector: contains elements to communicate
-	map<int,map<int,vector<MessageUnit> > > m_messageContent;
+	// index: slot, value: MPI tag
+	vector<int> m_slotTags;
 
-	// response to give to workers
-	map<WorkerHandle,vector<MessageUnit> > m_elementsForWorkers;
+	// the slab of each group, -1 if the group is empty
+	vector<int> m_groupSlabs;
 
-	// reply types.
-	map<int,int> m_replyTagToQueryTag;
+	// number of elements (priority) and of workers in each group
+	vector<int> m_groupElements;
+	vector<int> m_groupWorkers;
 
-	map<int,int> m_reverseReplyMap;
+	// position of each group in m_heap, -1 if absent
+	vector<int> m_groupHeapPositions;
+
+/*
+ * A flushed group keeps its slab until the reply comes back. The query
+ * carries the slab number as its sequence and the ComputeCore puts it
+ * on the reply, so that replies are matched even if the router delivers
+ * them out of order. The in-flight slabs of a group form a list in
+ * sending order, linked by m_slabNext and m_slabPrevious: a reply
+ * without a sequence, which was not sent by the handler of its query,
+ * goes to the oldest one.
+ */
+	vector<int> m_groupFirstInFlight;
+	vector<int> m_groupLastInFlight;
+
+	// indexed binary heap of non-empty groups, the fullest group first
+	vector<int> m_heap;
+
+/*
+ * A slab is the storage of one group: the elements to communicate and
+ * the workers that pushed them. Slabs are recycled and the storage only
+ * grows when more groups than ever are non-empty at the same time.
+ */
+	int m_slabCapacity;
+	int m_numberOfSlabs;
+	vector<MessageUnit> m_slabElements;
+	vector<WorkerHandle> m_slabWorkers;
+	vector<int> m_freeSlabs;
+
+	// for in-flight slabs: neighbours in the list of the group, number of workers, group (-1 if free)
+	vector<int> m_slabNext;
+	vector<int> m_slabPrevious;
+	vector<int> m_slabWorkerCounts;
+	vector<int> m_slabGroups;
+
+/*
+ * Responses to give to workers: the table gives the block of a worker,
+ * a block has room for m_replyStride elements in m_replyElements.
+ */
+	HandleTable m_replyTable;
+	vector<int> m_replyCounts;
+	vector<MessageUnit> m_replyElements;
+	vector<int> m_freeReplyBlocks;
+	int m_replyStride;
+	int m_numberOfReplyBlocks;
 
 	int m_rank;
 	int m_size;
 	RingAllocator*m_outboxAllocator;
 	StaticVector*m_inbox;
 	StaticVector*m_outbox;
-	int m_activeDestination;
-	int m_activeTag;
 	int m_pendingMessages;
 
+	// the window: maximum number of flushed messages awaiting a reply
+	int m_maximumPendingMessages;
+	int m_peakPendingMessages;
+
 	bool m_localPushedMessageStatus;
 	bool m_globalPushedMessageStatus;
-	// flush a message associated to a tag and a destination
-	void flushMessage(int tag,int destination);
+	// flush the message of a group
+	void flushMessage(int group);
+
+	int getGroup(int tag,Rank destination);
+	int allocateSlab();
+	int getInFlightSlab(int group,Message*reply);
+	void removeInFlightSlab(int group,int slab);
 
+	bool isHigherInHeap(int group,int otherGroup);
+	void swapInHeap(int position,int otherPosition);
+	void moveUpInHeap(int position);
+	void moveDownInHeap(int position);
+	void removeFromHeap(int group);
 
-	Rank getDestinationFromMessageUniqueId(uint64_t a);
-	int getTagFromMessageUniqueId(uint64_t a);
-	uint64_t getMessageUniqueId(Rank destination,int tag);
+	void storeReply(WorkerHandle workerId,MessageUnit*elements,int count);
+	void tagReplies(int firstMessage);
+	void setReplyStride(int stride);
 
 public:
 	/**
@@ -104,7 +174,8 @@ public:
  * called once
  * time complexity: constant
  */ 
-	void constructor(int rank,int size,RingAllocator*outboxAllocator,StaticVector*inbox,StaticVector*outbox);
+	void constructor(int rank,int size,RingAllocator*outboxAllocator,StaticVector*inbox,StaticVector*outbox,
+		int maximumPendingMessages);
 	
 	/**
  * associate a resonse tag to a query tag
@@ -134,6 +205,22 @@ public:
  */
 	void processInbox(vector<WorkerHandle>*activeWorkers);
 
+/**
+ * put the sequence of a query on the replies pushed by its handler, the
+ * ones in the outbox from firstMessage. The replies to the earlier queries
+ * from the same rank come first, and a query that is not answered by its
+ * handler is answered by the next reply in the outbox.
+ * time complexity: linear in the number of these messages
+ */
+	void setReplySequences(Message*query,int firstMessage);
+
+/**
+ * put the sequences of the unanswered queries on the replies that were
+ * pushed outside of the handlers, called before the outbox is sent
+ * time complexity: linear in the outbox size if a query is unanswered
+ */
+	void setDeferredReplySequences();
+
 	/**
  * push a worker message
  * may not be sent instantaneously
@@ -142,15 +229,15 @@ public:
  * the VirtualCommunicator is ready.
  * to do so, isReady is called before calling each worker.
  * if a called calls pushMessage and because of that a buffer becomes full, then isReady will return false 
- * for the next call
- * time complexity: log (number of tags) + log(number of MPI ranks)
+ * for the next call if the window of pending messages is full
+ * time complexity: log(number of non-empty groups)
  */
 	
 	void pushMessage(WorkerHandle workerId,Message*message);
 
 	/**
  * return true if the response is ready to be read
- * time complexity: log(number of workers)
+ * time complexity: constant on average
  */
 	bool isMessageProcessed(WorkerHandle workerId);
 	
@@ -161,7 +248,7 @@ public:
  *
  * after reading the response, it is erased from
  * the current object
- * time complexity: log(number of workers)
+ * time complexity: constant on average
  */
 	void getMessageResponseElements(WorkerHandle workerId,vector<MessageUnit>*out);
 	
@@ -169,7 +256,7 @@ public:
  * if all workers are awaiting responses and 
  * none of the buffer is full, then this forces the flushing of a buffer
  * non-empty buffer.
- * time complexity: log(number of priority values)
+ * time complexity: log(number of non-empty groups)
  */
 	void forceFlush();
 
@@ -195,7 +282,8 @@ public:
  */
 	bool getGlobalPushedMessageStatus();
 
-	/** check if the communicator is ready
+	/** check if the communicator is ready, that is if
+ * another message can be flushed without waiting for a reply
  * time complexity: constant
  */
 	bool isReady();
@@ -25,6 +25,7 @@
 #include <RayPlatform/profiling/ProcessStatus.h>
 #include <RayPlatform/cryptography/crypto.h>
 #include <RayPlatform/communication/MessagesHandler.h>
+#include <RayPlatform/core/atomics.h>
 
 #include <stdlib.h>
 #include <string.h> /* for strcpy */
@@ -156,7 +157,12 @@ void ComputeCore::setMessageTagObjectHandler(PluginHandle plugin,MessageTag tag,
 void ComputeCore::run(){
 
 	if(m_doChecksum){
-		cout<<"[RayPlatform] Rank "<<m_rank<<" will compute a CRC32 checksum for any non-empty message." << endl;
+		const char*algorithm="CRC32";
+
+		if(m_checksumAlgorithm==CHECKSUM_CRC32C)
+			algorithm="CRC32C";
+
+		cout<<"[RayPlatform] Rank "<<m_rank<<" will compute a "<<algorithm<<" checksum for any non-empty message." << endl;
 	}
 
 	// ask the router if it is enabled
@@ -164,6 +170,13 @@ void ComputeCore::run(){
 	// problems during configuration
 	m_routerIsEnabled=m_router.isEnabled();
 
+	if(m_adaptiveRoutingSaturation>=0){
+		if(m_routerIsEnabled)
+			m_router.enableAdaptiveRouting(m_adaptiveRoutingSaturation);
+		else if(m_rank==MASTER_RANK)
+			cout<<"[ComputeCore] Warning: -adaptive-routing needs the message router, it is ignored"<<endl;
+	}
+
 	configureEngine();
 
 	if(!m_resolvedSymbols)
@@ -176,9 +189,12 @@ void ComputeCore::run(){
 
 	m_startingTimeMicroseconds = getMicroseconds();
 
-	if(m_routerIsEnabled)
+	if(m_routerIsEnabled){
 		m_router.getGraph()->start(m_rank);
 
+		m_switchMan.setConnectionGraph(m_router.getGraph());
+	}
+
 
 	/*
 	 * Set up signal handler
@@ -206,8 +222,69 @@ void ComputeCore::run(){
 #endif
 
 	if(m_routerIsEnabled)
-		m_router.getGraph()->printStatus();
+		m_router.printStatus();
+
+	m_aggregator.printStatus();
+	m_messageStreamer.printStatus();
+
+	if(m_rank==MASTER_RANK)
+		m_switchMan.printStatus();
+
+	if(m_showCommunicationEvents)
+		printHeaderStatistics();
+
+	if(m_showCommunicationEvents || m_committedOutboxMessages>0)
+		printOutboxStatistics();
+}
+
+/**
+ * Compare the compact message headers with the fixed-size trailer
+ * that was used before.
+ */
+void ComputeCore::printHeaderStatistics(){
+
+	uint64_t totalMessages=0;
+	uint64_t totalBytes=0;
+
+	for(map<MessageTag,uint64_t>::iterator i=m_headerMessages.begin();
+			i!=m_headerMessages.end();i++){
+
+		MessageTag tag=i->first;
+		uint64_t messages=i->second;
+		uint64_t bytes=m_headerBytesSaved[tag];
+
+		// only the frames of relayed messages have no symbol
+		const char*symbol="RoutingFrame";
+
+		if(tag>=0 && tag<MAXIMUM_NUMBER_OF_TAG_HANDLERS)
+			symbol=MESSAGE_TAGS[tag];
+
+		cout<<"[Communication] Rank "<<m_rank<<" header bytes saved for "<<symbol;
+		cout<<": "<<bytes<<" bytes in "<<messages<<" messages ("<<bytes/messages<<" bytes/message)"<<endl;
+
+		totalMessages+=messages;
+		totalBytes+=bytes;
+	}
+
+	cout<<"[Communication] Rank "<<m_rank<<" header bytes saved: "<<totalBytes<<" bytes in ";
+	cout<<totalMessages<<" messages"<<endl;
+}
+
+/**
+ * Show how many bytes sendMessages copied, the messages
+ * built with reserveMessage() and commitMessage() are not copied.
+ */
+void ComputeCore::printOutboxStatistics(){
+
+	uint64_t outboxMessages=m_copiedOutboxMessages+m_committedOutboxMessages;
+	double copiedBytesPerMessage=0;
+
+	if(outboxMessages>0)
+		copiedBytesPerMessage=(0.0+m_copiedOutboxBytes)/outboxMessages;
 
+	cout<<"[Communication] Rank "<<m_rank<<" copied "<<m_copiedOutboxBytes<<" bytes for ";
+	cout<<outboxMessages<<" messages ("<<copiedBytesPerMessage<<" bytes/message), ";
+	cout<<m_committedOutboxMessages<<" messages were built in place"<<endl;
 }
 
 bool ComputeCore::debugModeIsEnabled() {
@@ -254,12 +331,12 @@ void ComputeCore::runVanilla(){
 		usleep(10);
 #endif
 
-		// 1. receive the message (0 or 1 message is received)
-		// blazing fast, receives 0 or 1 message, never more, never less, other messages will wait for the next iteration !
+		// 1. receive the messages (0 to m_receiveBatchSize messages are received)
+		// blazing fast, other messages will wait for the next iteration !
 		receiveMessages();
 
-		// 2. process the received message, if any
-		// consume the one message received, if any, also very fast because it is done with an array mapping tags to function pointers
+		// 2. process the received messages, if any
+		// consume the messages received, if any, also very fast because it is done with an array mapping tags to function pointers
 		processMessages();
 
 		// 3. process data according to current slave and master modes
@@ -389,6 +466,8 @@ void ComputeCore::runWithProfiler(){
 
 				if(profileGranularity)
 					m_profiler.printGranularities(m_rank);
+
+				m_idleBackoff.printStatus(m_rank);
 			}
 
 			m_profiler.clearGranularities();
@@ -477,10 +556,12 @@ void ComputeCore::runWithProfiler(){
 
 		/* collect some statistics for the profiler */
 
-		// 1. receive the message (0 or 1 message is received)
+		// 1. receive the messages (0 to m_receiveBatchSize messages are received)
 		receiveMessages();
 		receivedMessages+=m_inbox.size();
 
+		bool hasReceivedMessages=m_inbox.size()>0;
+
 		for(int i=0;i<(int)m_inbox.size();i++){
 			// stript routing information, if any
 			uint8_t tag=m_inbox[i]->getTag();
@@ -551,11 +632,24 @@ void ComputeCore::runWithProfiler(){
 			sentTagsInProcessData[tag]++;
 		}
 
+		bool hasMessagesToSend=m_outbox.size()>0;
+
 		// 4. send messages
 		sendMessages();
 
 		m_outboxAllocator.resetCount();
 
+		// 5. back off if there is nothing to do
+		// only a message can give some work in that case
+		if(!hasReceivedMessages && !hasMessagesToSend && m_switchMan.isIdle()
+			&& !(m_routerIsEnabled && m_router.hasPendingMessages())
+			&& !m_aggregator.hasBufferedRecords()
+			&& !m_messageStreamer.hasChunksToSend()
+			&& !m_switchMan.hasPendingBroadcasts())
+			m_idleBackoff.idle();
+		else
+			m_idleBackoff.work();
+
 		/* increment ticks */
 		ticks++;
 		globalTicks ++;
@@ -580,18 +674,19 @@ void ComputeCore::runWithProfiler(){
 		m_profiler.printAllGranularities();
 }
 
+/*
+ * Messages are dispatched in their arrival order.
+ * With -receive-batch-size, the inbox can contain more than 1 message.
+ */
 void ComputeCore::processMessages(){
 	#ifdef CONFIG_ASSERT
-	assert(m_inbox.size()>=0&&m_inbox.size()<=1);
+	assert(m_inbox.size()>=0&&m_inbox.size()<=m_maximumNumberOfInboxMessages);
 	#endif
 
-	if(m_inbox.size()==0)
+	// the router may still have messages from frames
+	if(m_inbox.size()==0 && !(m_routerIsEnabled && m_router.hasPendingMessages()))
 		return;
 
-	int i = 0;
-
-	Message * importantMessage = m_inbox.at(i);
-
 	// TODO: don't transport routing metadata if routing is disabled !
 	// save actor metadata
 	//
@@ -599,28 +694,13 @@ void ComputeCore::processMessages(){
 	// in which they were saved !!!
 
 	// if routing is enabled, we want to strip the routing tags if it
-	// is required
+	// is required.
+	// Relayed messages are removed from the inbox by the router.
 	if(m_routerIsEnabled){
-		if(m_router.routeIncomingMessages()){
-			// if the message has routing tag, we don't need to process it...
-
-/*
- * If a message is routed, the original message needs to be destroyed
- * with fire. Otherwise, a slave mode or a master mode will pick it up,
- * which will cause silly behaviors.
- */
-			m_inbox.clear();
+		m_router.routeIncomingMessages();
 
+		if(m_inbox.size()==0)
 			return;
-		}
-	}
-
-	// dispatch the message
-	if(importantMessage->isActorModelMessage(m_size)) {
-
-		// cout << "DEBUG actor message detected ! m_size = " << m_size << endl;
-
-		m_playground.receiveActorMessage(importantMessage);
 	}
 
 	if(m_inbox.size() > 0 && m_showCommunicationEvents){
@@ -633,27 +713,97 @@ void ComputeCore::processMessages(){
 		}
 	}
 
+	for(int i=0;i<(int)m_inbox.size();i++){
 
+		Message*message=m_inbox.at(i);
 
-	Message*message= importantMessage;
-	MessageTag messageTag=message->getTag();
+		// dispatch the message
+		if(message->isActorModelMessage(m_size)) {
 
-	#ifdef CONFIG_ASSERT2
-	assert(messageTag!=INVALID_HANDLE);
-	assert(m_allocatedMessageTags.count(messageTag)>0);
-	string symbol=MESSAGE_TAGS[messageTag];
-	assert(m_messageTagSymbols.count(symbol));
-	assert(m_messageTagSymbols[symbol]==messageTag);
-	#endif
+			// cout << "DEBUG actor message detected ! m_size = " << m_size << endl;
+
+			m_playground.receiveActorMessage(message);
+		}
+
+		// a tree broadcast is relayed and then delivered with its original tag
+		m_switchMan.relayBroadcast(message,&m_outbox);
 
-	// check if the tag is in the list of slave switches
-	m_switchMan.openSlaveModeLocally(messageTag,m_rank);
+		MessageTag messageTag=message->getTag();
 
-	m_messageTagExecutor.callHandler(messageTag,message);
+		#ifdef CONFIG_ASSERT2
+		assert(messageTag!=INVALID_HANDLE);
+		assert(m_allocatedMessageTags.count(messageTag)>0);
+		string symbol=MESSAGE_TAGS[messageTag];
+		assert(m_messageTagSymbols.count(symbol));
+		assert(m_messageTagSymbols[symbol]==messageTag);
+		#endif
+
+		// check if the tag is in the list of slave switches
+		m_switchMan.openSlaveModeLocally(messageTag,m_rank);
+
+		int firstMessage=m_outbox.size();
+
+		m_messageTagExecutor.callHandler(messageTag,message);
+
+		// the replies to a query of a VirtualCommunicator carry its sequence
+		m_virtualCommunicator.setReplySequences(message,firstMessage);
+	}
+
+	// the large messages that were completed by the chunks above
+	Message message;
+
+	while(m_messageStreamer.getCompletedMessage(&message)){
+		MessageTag messageTag=message.getTag();
+
+		m_switchMan.openSlaveModeLocally(messageTag,m_rank);
+		m_messageTagExecutor.callHandler(messageTag,&message);
+
+		m_messageStreamer.releaseMessage(&message);
+	}
 }
 
 void ComputeCore::sendMessages(){
 
+	if(m_miniRanksAreEnabled)
+		releaseQueuedOutboxBuffers();
+
+	// the replies that were not pushed by the handler of their query
+	m_virtualCommunicator.setDeferredReplySequences();
+
+	// frames of relayed messages that are due are sent with the other
+	// messages, their buffers are copied below like the other ones,
+	// so each message in the outbox will need one more buffer
+	if(m_routerIsEnabled){
+		int slots=m_maximumNumberOfOutboxMessages-m_outbox.size();
+		int buffers=m_maximumAllocatedOutboxBuffers-m_outboxAllocator.getCount()-m_outbox.size();
+
+		m_router.flushRelayFrames(min(slots,buffers));
+	}
+
+	// the large broadcasts, a few ranks at a time
+	if(m_switchMan.hasPendingBroadcasts()){
+		int slots=m_maximumNumberOfOutboxMessages-m_outbox.size();
+		int buffers=m_maximumAllocatedOutboxBuffers-m_outboxAllocator.getCount()-m_outbox.size();
+
+		m_switchMan.sendPendingBroadcasts(&m_outbox,min(slots,buffers));
+	}
+
+	// the aggregated records that are due, with the space that is left
+	if(m_aggregator.hasBufferedRecords()){
+		int slots=m_maximumNumberOfOutboxMessages-m_outbox.size();
+		int buffers=m_maximumAllocatedOutboxBuffers-m_outboxAllocator.getCount()-m_outbox.size();
+
+		m_aggregator.flush(min(slots,buffers));
+	}
+
+	// the chunks of large messages, with the space that is left
+	if(m_messageStreamer.hasChunksToSend()){
+		int slots=m_maximumNumberOfOutboxMessages-m_outbox.size();
+		int buffers=m_maximumAllocatedOutboxBuffers-m_outboxAllocator.getCount()-m_outbox.size();
+
+		m_messageStreamer.sendChunks(min(slots,buffers));
+	}
+
 /*
  * Don't do anything when there are no messages
  * at all.
@@ -673,6 +823,13 @@ void ComputeCore::sendMessages(){
 	for(int i = 0 ; i < (int) m_outbox.size() ; ++i) {
 		Message * aMessage = m_outbox.at(i);
 
+		// this one is already in its own outbox buffer, with room for the header
+		if(aMessage->isCommitted()) {
+			m_committedOutboxMessages ++;
+
+			continue;
+		}
+
 		// we need space for routing information
 		// also, if this is a control message sent to all, we need
 		// to allocate new buffers.
@@ -696,8 +853,12 @@ void ComputeCore::sendMessages(){
 			if(aMessage->getBuffer()!=NULL) {
 
 				memcpy(buffer, aMessage->getBuffer(), aMessage->getNumberOfBytes() * sizeof(char));
+
+				m_copiedOutboxBytes += aMessage->getNumberOfBytes();
 			}
 
+			m_copiedOutboxMessages ++;
+
 			aMessage->setBuffer(buffer);
 		}
 	}
@@ -801,8 +962,22 @@ void ComputeCore::sendMessages(){
 			message->setMiniRanks(message->getSource(), message->getDestination());
 		}
 
+		int bytes = message->getNumberOfBytes();
+
 		message->saveMetaData();
 
+		// routed messages are counted with the tag that their handler has
+		if(m_showCommunicationEvents){
+			int headerSize = message->getNumberOfBytes() - bytes;
+			MessageTag tag = message->getTag();
+
+			if(m_routerIsEnabled)
+				tag = m_router.getOriginalTag(tag);
+
+			m_headerBytesSaved[tag] += MESSAGE_LEGACY_META_DATA_SIZE - headerSize;
+			m_headerMessages[tag] ++;
+		}
+
 #ifdef CONFIG_ASSERT
 		testMessage(message);
 #endif
@@ -873,12 +1048,48 @@ void ComputeCore::sendMessages(){
 		m_messagesHandler->sendMessages(&m_outbox,&m_outboxAllocator);
 	}else{
 
+		// the communication thread copies the buffers later
+		for(int i=0;i<(int)m_outbox.size();i++){
+			void*buffer=m_outbox[i]->getBuffer();
+
+			if(buffer!=NULL)
+				m_outboxAllocator.holdBuffer(buffer);
+
+			m_queuedOutboxBuffers.push_back(buffer);
+		}
+
 		m_messagesHandler->sendMessagesForComputeCore(&m_outbox,&m_bufferedOutbox);
 	}
 
 	m_outbox.clear();
 }
 
+/*
+ * The messages are popped in the order in which they were pushed, so
+ * the first buffers are the ones that were copied.
+ */
+void ComputeCore::releaseQueuedOutboxBuffers(){
+
+	int queued=m_queuedOutboxBuffers.size()-m_firstQueuedOutboxBuffer;
+
+	if(queued==0)
+		return;
+
+	int copied=queued-m_bufferedOutbox.getNumberOfQueuedMessages();
+
+	for(int i=0;i<copied;i++){
+		void*buffer=m_queuedOutboxBuffers[m_firstQueuedOutboxBuffer++];
+
+		if(buffer!=NULL)
+			m_outboxAllocator.release(buffer);
+	}
+
+	if(m_firstQueuedOutboxBuffer==(int)m_queuedOutboxBuffers.size()){
+		m_queuedOutboxBuffers.clear();
+		m_firstQueuedOutboxBuffer=0;
+	}
+}
+
 void ComputeCore::addMessageChecksums(){
 
 	int count=m_outbox.size();
@@ -897,7 +1108,7 @@ void ComputeCore::addMessageChecksums(){
 
 		uint8_t*bytes=(uint8_t*)data;
 
-		uint32_t crc32=computeCyclicRedundancyCode32(bytes,numberOfBytes);
+		uint32_t crc32=computeChecksum(m_checksumAlgorithm,bytes,numberOfBytes);
 
 		memcpy(bytes + numberOfBytes, &crc32, sizeof(crc32));
 
@@ -935,7 +1146,7 @@ void ComputeCore::verifyMessageChecksums(){
 
 		// compute the checksum, excluding the reference checksum
 		// from the data
-		crc32 = computeCyclicRedundancyCode32((uint8_t*)bytes, numberOfBytes);
+		crc32 = computeChecksum(m_checksumAlgorithm, (uint8_t*)bytes, numberOfBytes);
 
 		uint32_t expectedChecksum = 0;
 
@@ -963,7 +1174,7 @@ void ComputeCore::verifyMessageChecksums(){
 }
 
 /**
- * receivedMessages receives 0 or 1 messages.
+ * receivedMessages receives 0 to m_receiveBatchSize messages.
  * If more messages are available to be pumped, they will wait until the
  * next ComputeCore cycle.
  */
@@ -974,14 +1185,19 @@ void ComputeCore::receiveMessages(){
  */
 	m_inbox.clear();
 
+	// the messages unpacked from frames were received first
+	if(m_routerIsEnabled && m_router.hasUnpackedMessages())
+		return;
+
 	if(!m_miniRanksAreEnabled){
 /*
  * Implement the old communication model.
  */
-		m_messagesHandler->receiveMessages(&m_inbox,&m_inboxAllocator);
+		m_messagesHandler->receiveMessages(&m_inbox,&m_inboxAllocator,m_receiveBatchSize);
 	}else{
 
-		m_messagesHandler->receiveMessagesForComputeCore(&m_inbox,&m_inboxAllocator,&m_bufferedInbox);
+		m_messagesHandler->receiveMessagesForComputeCore(&m_inbox,&m_bufferedInbox,
+			m_receiveBatchSize,m_rank%m_numberOfMiniRanksPerRank);
 
 	}
 
@@ -992,31 +1208,33 @@ void ComputeCore::receiveMessages(){
 
 	//cout << "DEBUG loading message metadata." << endl;
 
-	Message * importantMessage = m_inbox.at(0);
-
 	// verify checksums and remove them
 	// messages are line onions, you have to peel them from the outside to the inside
 	if(m_doChecksum){
 		verifyMessageChecksums();
 	}
 
-	importantMessage->loadMetaData();
-	importantMessage->saveMetaData();
+	for(int i=0;i<(int)m_inbox.size();i++){
+
+		Message * importantMessage = m_inbox.at(i);
+
+		importantMessage->loadMetaData();
+		importantMessage->saveMetaData();
 
 #ifdef GITHUB_ISSUE_220
-	if(importantMessage->getTag() == 17 && getRank() == 2) {
-		cout << "DEBUG ComputeCore receives message!" << endl;
-		importantMessage->print();
-	}
+		if(importantMessage->getTag() == 17 && getRank() == 2) {
+			cout << "DEBUG ComputeCore receives message!" << endl;
+			importantMessage->print();
+		}
 #endif
 
 #ifdef CONFIG_ASSERT
-	testMessage(importantMessage);
-
-	//testMessage(importantMessage);
+		testMessage(importantMessage);
 #endif
 
-	for(int i=0;i<(int)m_inbox.size();i++){
+		// remove the header now !
+		importantMessage->loadMetaData();
+
 		m_tickLogger.logReceivedMessage(INVALID_HANDLE);
 	}
 
@@ -1028,9 +1246,6 @@ void ComputeCore::receiveMessages(){
 
 	assert(receivedMessages<=m_maximumNumberOfInboxMessages);
 	#endif
-
-	// remove the header now !
-	importantMessage->loadMetaData();
 }
 
 /** process data my calling current slave and master methods */
@@ -1098,6 +1313,7 @@ void ComputeCore::constructor(int argc,char**argv,int miniRankNumber,int numberO
 	m_destroyed=false;
 
 	m_doChecksum=false;
+	m_checksumAlgorithm=m_messagesHandler->getChecksumAlgorithm();
 
 	m_miniRanksAreEnabled=useMiniRanks;
 
@@ -1116,6 +1332,7 @@ void ComputeCore::constructor(int argc,char**argv,int miniRankNumber,int numberO
 	m_resolvedSymbols=false;
 
 	m_hasFatalErrors=false;
+	m_engineIsConfigured=false;
 
 	m_firstRegistration=true;
 
@@ -1129,9 +1346,169 @@ void ComputeCore::constructor(int argc,char**argv,int miniRankNumber,int numberO
 	m_showCommunicationEvents=false;
 	m_profilerVerbose=false;
 
+	m_copiedOutboxBytes=0;
+	m_copiedOutboxMessages=0;
+	m_committedOutboxMessages=0;
+	m_firstQueuedOutboxBuffer=0;
+
+/*
+ * Get the number of messages to receive per tick.
+ */
+	m_receiveBatchSize=1;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-receive-batch-size")==0 && i+1<argc)
+			m_receiveBatchSize=atoi(argv[i+1]);
+	}
+
+	if(m_receiveBatchSize<1)
+		m_receiveBatchSize=1;
+
+/*
+ * Get the idle policy.
+ */
+	m_idlePolicy=IDLE_POLICY_ADAPTIVE;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-idle-policy")==0 && i+1<argc){
+			const char*policy=argv[i+1];
+
+			if(strcmp(policy,"spin")==0)
+				m_idlePolicy=IDLE_POLICY_SPIN;
+			else if(strcmp(policy,"yield")==0)
+				m_idlePolicy=IDLE_POLICY_YIELD;
+			else if(strcmp(policy,"park")==0)
+				m_idlePolicy=IDLE_POLICY_PARK;
+			else if(strcmp(policy,"adaptive")==0)
+				m_idlePolicy=IDLE_POLICY_ADAPTIVE;
+			else
+				cout<<"[ComputeCore] Warning: unknown idle policy "<<policy<<", using adaptive"<<endl;
+		}
+	}
+
+/*
+ * Get the arity of the tree used by the SwitchMan for broadcasts
+ * and completion signals. The flat broadcast (0) is the default because
+ * a relayed broadcast can reach a rank after a message that its root
+ * sent later directly, see Documentation/Message-Routing.txt.
+ */
+	m_broadcastArity=0;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-broadcast-arity")==0 && i+1<argc)
+			m_broadcastArity=atoi(argv[i+1]);
+	}
+
+	if(m_broadcastArity<0)
+		m_broadcastArity=0;
+
+/*
+ * By default, each rank sends its completion signal to the master rank,
+ * after its other messages to the master rank. With a broadcast tree,
+ * -combine-completions sends them up the tree instead, and the messages
+ * that a rank sent to the master rank before completing may then still
+ * be in flight when the master rank counts it as completed.
+ */
+	m_combineCompletions=false;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-combine-completions")==0)
+			m_combineCompletions=true;
+	}
+
+/*
+ * Get the number of aggregated messages of the VirtualCommunicator
+ * that can await their reply at the same time.
+ */
+	m_virtualCommunicatorWindow=8;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-virtual-communicator-window")==0 && i+1<argc)
+			m_virtualCommunicatorWindow=atoi(argv[i+1]);
+	}
+
+	if(m_virtualCommunicatorWindow<1)
+		m_virtualCommunicatorWindow=1;
+
+/*
+ * Get the number of parts of a value that the KeyValueStore
+ * requests at the same time.
+ */
+	m_keyValueStoreWindow=8;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-key-value-store-window")==0 && i+1<argc)
+			m_keyValueStoreWindow=atoi(argv[i+1]);
+	}
+
+	if(m_keyValueStoreWindow<1)
+		m_keyValueStoreWindow=1;
+
 	m_rank=miniRankNumber;
 	m_size=numberOfMiniRanks;
 
+	// with mini-ranks, the communication thread wakes up a parked ComputeCore
+	// when it pushes a message in its buffered inbox
+	m_idleBackoff.constructor(m_idlePolicy,m_miniRanksAreEnabled?&m_bufferedInbox:NULL);
+
+/*
+ * Get the thresholds of the MessageAggregator.
+ */
+	int aggregatorThreshold=MAXIMUM_MESSAGE_SIZE_IN_BYTES;
+	int aggregatorDelay=1000;
+	int aggregatorBuffers=128;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-aggregator-threshold")==0 && i+1<argc)
+			aggregatorThreshold=atoi(argv[i+1]);
+		else if(strcmp(argv[i],"-aggregator-delay")==0 && i+1<argc)
+			aggregatorDelay=atoi(argv[i+1]);
+		else if(strcmp(argv[i],"-aggregator-buffers")==0 && i+1<argc)
+			aggregatorBuffers=atoi(argv[i+1]);
+	}
+
+	m_aggregator.constructor(m_rank,m_size,this);
+	m_aggregator.setThresholds(aggregatorThreshold,aggregatorDelay);
+	m_aggregator.setMaximumNumberOfBuffers(aggregatorBuffers);
+
+	m_streamWindow=64;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-stream-window")==0 && i+1<argc)
+			m_streamWindow=atoi(argv[i+1]);
+	}
+
+/*
+ * Get the saturation of adaptive routing. It only applies when the
+ * application enables the router.
+ */
+	m_adaptiveRoutingSaturation=-1;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-adaptive-routing")==0 && i+1<argc)
+			m_adaptiveRoutingSaturation=atoi(argv[i+1]);
+	}
+
+	if(m_adaptiveRoutingSaturation<-1)
+		m_adaptiveRoutingSaturation=-1;
+
+/*
+ * The routes are computed by every rank at the same time, so the cores
+ * of a node are shared between the ranks that run on it.
+ */
+	int routeThreads=sysconf(_SC_NPROCESSORS_ONLN)/
+		(m_messagesHandler->getNumberOfRanksOnNode()*miniRanksPerRank);
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-route-threads")==0 && i+1<argc)
+			routeThreads=atoi(argv[i+1]);
+	}
+
+	if(routeThreads<1)
+		routeThreads=1;
+
+	m_router.setNumberOfThreads(routeThreads);
+
 	for(int i=0;i<MAXIMUM_NUMBER_OF_MASTER_HANDLERS;i++){
 		strcpy(MASTER_MODES[i],"UnnamedMasterMode");
 	}
@@ -1189,28 +1566,46 @@ void ComputeCore::configureEngine() {
 	bool useMoreBuffers = true;
 
 	// even a message with a NULL buffer requires a buffer for routing
-	if(useMoreBuffers || m_routerIsEnabled || m_miniRanksAreEnabled)
+	if(useMoreBuffers)
 		availableBuffers=m_size*2;
 
 	// this will occur when using the virtual router with a few processes
 	if(availableBuffers<minimumNumberOfBuffers)
 		availableBuffers=minimumNumberOfBuffers;
 
-	m_switchMan.constructor(m_rank,m_size);
+	m_switchMan.constructor(m_rank,m_size,m_broadcastArity,m_combineCompletions);
+
+	m_virtualCommunicator.constructor(m_rank,m_size,&m_outboxAllocator,&m_inbox,&m_outbox,
+		m_virtualCommunicatorWindow);
 
-	m_virtualCommunicator.constructor(m_rank,m_size,&m_outboxAllocator,&m_inbox,&m_outbox);
+	m_keyValueStore.initialize(m_rank, m_size, &m_outboxAllocator, &m_inbox, &m_outbox,
+		m_keyValueStoreWindow);
 
-	m_keyValueStore.initialize(m_rank, m_size, &m_outboxAllocator, &m_inbox, &m_outbox);
+	m_messageStreamer.initialize(m_rank,m_size,&m_outbox,m_streamWindow);
 
 	/***********************************************************************************/
 	/** initialize the VirtualProcessor */
 	m_virtualProcessor.constructor(&m_outbox,&m_inbox,&m_outboxAllocator,
 		&m_virtualCommunicator);
 
-	m_maximumAllocatedInboxBuffers=1;
+	// every received message may produce a reply in the same tick
+	availableBuffers+=m_receiveBatchSize-1;
+
+	// and every received broadcast is relayed to the children of the rank
+	availableBuffers+=m_broadcastArity*m_receiveBatchSize;
+
+	// the VirtualCommunicator can flush its whole window in a tick
+	availableBuffers+=m_virtualCommunicatorWindow;
+
+	// and so can the KeyValueStore
+	availableBuffers+=m_keyValueStoreWindow;
+
+	// all the messages of a batch are alive at the same time, so
+	// each of them needs its own inbox buffer
+	m_maximumAllocatedInboxBuffers=m_receiveBatchSize;
 	m_maximumAllocatedOutboxBuffers=availableBuffers;
 
-	m_maximumNumberOfInboxMessages=1;
+	m_maximumNumberOfInboxMessages=m_receiveBatchSize;
 	m_maximumNumberOfOutboxMessages=availableBuffers;
 
 	// broadcasting messages
@@ -1302,7 +1697,15 @@ void ComputeCore::configureEngine() {
 		maximumMessageSizeInBytes,
 		"RAY_MALLOC_TYPE_INBOX_ALLOCATOR",false);
 
-	m_outboxAllocator.constructor(m_maximumAllocatedOutboxBuffers,
+	// the buffers held by the MessageAggregator are not part of the
+	// buffers of a tick, and neither are the buffers in the message
+	// queue of the communication thread
+	int heldOutboxBuffers=m_aggregator.getMaximumNumberOfBuffers();
+
+	if(m_miniRanksAreEnabled)
+		heldOutboxBuffers+=m_maximumNumberOfOutboxMessages;
+
+	m_outboxAllocator.constructor(m_maximumAllocatedOutboxBuffers+heldOutboxBuffers,
 		maximumMessageSizeInBytes,
 		"RAY_MALLOC_TYPE_OUTBOX_ALLOCATOR",false);
 
@@ -1312,10 +1715,6 @@ void ComputeCore::configureEngine() {
 		cout<<"Building buffered inbox allocator."<<endl;
 		#endif
 
-		m_bufferedInboxAllocator.constructor(m_maximumAllocatedOutboxBuffers,
-			maximumMessageSizeInBytes,
-			"RAY_MALLOC_TYPE_INBOX_ALLOCATOR/Buffered",false);
-
 		m_bufferedOutboxAllocator.constructor(m_maximumAllocatedOutboxBuffers,
 			maximumMessageSizeInBytes,
 			"RAY_MALLOC_TYPE_OUTBOX_ALLOCATOR/Buffered",false);
@@ -1327,6 +1726,8 @@ void ComputeCore::configureEngine() {
 	cout<<"[ComputeCore] allocated "<<m_maximumAllocatedOutboxBuffers<<" buffers of size "<<maximumMessageSizeInBytes<<" for outbox messages"<<endl;
 	#endif
 
+	// the communication thread can use the message queues now
+	storeRelease(&m_engineIsConfigured,true);
 }
 
 void ComputeCore::enableCheckSums(){
@@ -1395,6 +1796,14 @@ VirtualCommunicator*ComputeCore::getVirtualCommunicator(){
 	return &m_virtualCommunicator;
 }
 
+MessageAggregator*ComputeCore::getMessageAggregator(){
+	return &m_aggregator;
+}
+
+MessageStreamer*ComputeCore::getMessageStreamer(){
+	return &m_messageStreamer;
+}
+
 void ComputeCore::registerPlugin(CorePlugin*plugin){
 
 	if(m_firstRegistration){
@@ -1405,6 +1814,7 @@ void ComputeCore::registerPlugin(CorePlugin*plugin){
 
 		registerPlugin(&m_switchMan);
 		registerPlugin(&m_keyValueStore);
+		registerPlugin(&m_messageStreamer);
 
 	}
 
@@ -1458,9 +1868,6 @@ void ComputeCore::destructor(){
 
 	m_inboxAllocator.clear();
 
-	if(m_miniRanksAreEnabled)
-		m_bufferedInboxAllocator.clear();
-
 	#ifdef CONFIG_DEBUG_CORE
 	cout<<"Rank "<<m_rank<<" is cleaning the outbox allocator."<<endl;
 	#endif
@@ -1474,6 +1881,10 @@ void ComputeCore::destructor(){
 		m_bufferedInbox.destructor();
 		m_bufferedOutbox.destructor();
 	}
+
+	m_aggregator.destructor();
+	m_idleBackoff.destructor();
+	m_router.destructor();
 }
 
 void ComputeCore::stop(){
@@ -2216,6 +2627,31 @@ void ComputeCore::sendEmptyMessageToAll(MessageTag tag){
 	m_switchMan.sendToAll(&m_outbox,m_rank,tag);
 }
 
+MessageUnit*ComputeCore::reserveMessage(){
+	return (MessageUnit*)m_outboxAllocator.allocate(MAXIMUM_MESSAGE_SIZE_IN_BYTES);
+}
+
+MessageUnit*ComputeCore::holdMessage(){
+	return (MessageUnit*)m_outboxAllocator.hold();
+}
+
+void ComputeCore::commitMessage(MessageUnit*buffer,int count,Rank destination,MessageTag tag){
+
+	#ifdef CONFIG_ASSERT
+	assert(buffer!=NULL);
+	assert(count>=0 && count<=(int)(MAXIMUM_MESSAGE_SIZE_IN_BYTES/sizeof(MessageUnit)));
+	assert(m_outboxAllocator.getBufferHandle(buffer)<m_outboxAllocator.getNumberOfBuffers());
+
+	for(int i=0;i<(int)m_outbox.size();i++)
+		assert(m_outbox[i]->getBuffer()!=buffer);
+	#endif
+
+	// the flag follows the message when the outbox is reordered
+	Message message(buffer,count,destination,tag,m_rank);
+	message.setCommitted(true);
+	m_outbox.push_back(&message);
+}
+
 void ComputeCore::setObjectSymbol(PluginHandle plugin,void*object,const char* symbol){
 
 	if(!validationPluginAllocated(plugin))
@@ -2311,8 +2747,20 @@ RingAllocator*ComputeCore::getBufferedOutboxAllocator(){
 	return &m_bufferedOutboxAllocator;
 }
 
-RingAllocator*ComputeCore::getBufferedInboxAllocator(){
-	return &m_bufferedInboxAllocator;
+int ComputeCore::getReceiveBatchSize(){
+	return m_receiveBatchSize;
+}
+
+bool ComputeCore::engineIsConfigured(){
+	return loadAcquire(&m_engineIsConfigured);
+}
+
+IdleBackoff*ComputeCore::getIdleBackoff(){
+	return &m_idleBackoff;
+}
+
+void ComputeCore::wakeUp(){
+	m_idleBackoff.wakeUp();
 }
 
 int ComputeCore::getMiniRanksPerRank(){
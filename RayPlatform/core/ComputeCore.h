@@ -27,6 +27,7 @@
  */
 #include "types.h"
 #include "OperatingSystem.h"
+#include "IdleBackoff.h"
 
 #include <RayPlatform/handlers/MessageTagHandler.h>
 #include <RayPlatform/handlers/MessageTagExecutor.h>
@@ -46,6 +47,8 @@
 #include <RayPlatform/communication/MessagesHandler.h>
 #include <RayPlatform/communication/VirtualCommunicator.h>
 #include <RayPlatform/communication/MessageQueue.h>
+#include <RayPlatform/communication/MessageAggregator.h>
+#include <RayPlatform/communication/MessageStreamer.h>
 
 #include <RayPlatform/memory/RingAllocator.h>
 #include <RayPlatform/plugins/CorePlugin.h>
@@ -81,6 +84,10 @@ class ComputeCore{
 
 	KeyValueStore m_keyValueStore;
 
+/** the number of parts of a value that the KeyValueStore requests
+ * at the same time, set with -key-value-store-window (the default is 8) */
+	int m_keyValueStoreWindow;
+
 /*
  * This is the middleware communication layer.
  * All messages go through it.
@@ -105,7 +112,6 @@ class ComputeCore{
 	MessageQueue m_bufferedInbox;
 	MessageQueue m_bufferedOutbox;
 	RingAllocator m_bufferedOutboxAllocator;
-	RingAllocator m_bufferedInboxAllocator;
 
 	bool m_outboxIsFull;
 
@@ -114,6 +120,10 @@ class ComputeCore{
 
 	bool m_resolvedSymbols;
 	bool m_hasFatalErrors;
+
+/** true when configureEngine() has built the message queues,
+ * read by the communication thread */
+	bool m_engineIsConfigured;
 	
 	bool m_hasFirstMode;
 	bool m_firstRegistration;
@@ -150,6 +160,42 @@ class ComputeCore{
 /** the maximum number of inbox messages */
 	int m_maximumNumberOfInboxMessages;
 
+/** the maximum number of messages received in one tick
+ * set with -receive-batch-size, the default is 1 */
+	int m_receiveBatchSize;
+
+/** what to do when there is nothing to do,
+ * set with -idle-policy spin|yield|park|adaptive, the default is adaptive */
+	IdleBackoff m_idleBackoff;
+	int m_idlePolicy;
+
+/** the number of children of a rank in the broadcast tree of the SwitchMan,
+ * set with -broadcast-arity, the default is 0 (flat broadcast) */
+	int m_broadcastArity;
+
+/** combine the completion signals along the broadcast tree,
+ * set with -combine-completions */
+	bool m_combineCompletions;
+
+/** the number of aggregated messages of the VirtualCommunicator that
+ * can await their reply, set with -virtual-communicator-window,
+ * the default is 8 */
+	int m_virtualCommunicatorWindow;
+
+/** the aggregation of small records, the thresholds are set
+ * with -aggregator-threshold (bytes, the default is
+ * MAXIMUM_MESSAGE_SIZE_IN_BYTES) and -aggregator-delay
+ * (microseconds, the default is 1000), and the number of
+ * outbox buffers that it can hold with -aggregator-buffers
+ * (the default is 128) */
+	MessageAggregator m_aggregator;
+
+/** the transport of the messages larger than MAXIMUM_MESSAGE_SIZE_IN_BYTES,
+ * the number of chunks in flight for a message is set with -stream-window
+ * (the default is 64) */
+	MessageStreamer m_messageStreamer;
+	int m_streamWindow;
+
 	/** the virtual communicator of the MPI rank */
 	VirtualCommunicator m_virtualCommunicator;
 
@@ -161,6 +207,22 @@ class ComputeCore{
 	Rank m_rank;
 	int m_size;
 	bool m_showCommunicationEvents;
+
+/** header bytes saved by the compact header, per message tag,
+ * counted with -show-communication-events */
+	map<MessageTag,uint64_t> m_headerBytesSaved;
+	map<MessageTag,uint64_t> m_headerMessages;
+
+/** with mini-ranks, the outbox buffers in m_bufferedOutbox, in order,
+ * they are held until the communication thread has copied them */
+	vector<void*> m_queuedOutboxBuffers;
+	int m_firstQueuedOutboxBuffer;
+
+/** bytes copied in new buffers by sendMessages */
+	uint64_t m_copiedOutboxBytes;
+	uint64_t m_copiedOutboxMessages;
+	uint64_t m_committedOutboxMessages;
+
 	bool m_profilerVerbose;
 	bool m_runProfiler;
 
@@ -177,6 +239,10 @@ class ComputeCore{
 	MessageRouter m_router;
 	bool m_routerIsEnabled;
 
+/** the saturation of adaptive routing, set with -adaptive-routing,
+ * -1 if it is not used */
+	int m_adaptiveRoutingSaturation;
+
 	StaticVector m_outbox;
 	StaticVector m_inbox;
 
@@ -209,6 +275,9 @@ class ComputeCore{
 
 	void receiveMessages();
 	void sendMessages();
+	void releaseQueuedOutboxBuffers();
+	void printHeaderStatistics();
+	void printOutboxStatistics();
 	void processData();
 	void processMessages();
 
@@ -241,6 +310,9 @@ class ComputeCore{
 
 	bool m_doChecksum;
 
+	/** CHECKSUM_CRC32 or CHECKSUM_CRC32C, negotiated by the MessagesHandler */
+	int m_checksumAlgorithm;
+
 	void verifyMessageChecksums();
 	void addMessageChecksums();
 
@@ -278,10 +350,33 @@ public:
 
 	void sendEmptyMessageToAll(MessageTag tag);
 
+/** get a buffer of the outbox ring to build a message in place,
+ * it has room for MAXIMUM_MESSAGE_SIZE_IN_BYTES bytes of payload and
+ * for the header. The message must be committed in the same tick. */
+	MessageUnit*reserveMessage();
+
+/** get a buffer of the outbox ring that is not reused before it is
+ * committed, to build a message over several ticks. The ring has
+ * room for the buffers of the MessageAggregator only. */
+	MessageUnit*holdMessage();
+
+/** put a message built in a reserved buffer in the outbox,
+ * the message is sent without being copied again.
+ * A reserved buffer is committed once. */
+	void commitMessage(MessageUnit*buffer,int count,Rank destination,MessageTag tag);
+
 	RingAllocator*getOutboxAllocator();
 	RingAllocator*getInboxAllocator();
 	RingAllocator*getBufferedOutboxAllocator();
-	RingAllocator*getBufferedInboxAllocator();
+	int getReceiveBatchSize();
+	IdleBackoff*getIdleBackoff();
+
+/** true when the message queues of the mini-rank can be used,
+ * called by the communication thread */
+	bool engineIsConfigured();
+
+/** wake up the ComputeCore if it is parked, called by the communication thread */
+	void wakeUp();
 
 	bool*getLife();
 
@@ -289,6 +384,8 @@ public:
 
 	VirtualProcessor*getVirtualProcessor();
 	VirtualCommunicator*getVirtualCommunicator();
+	MessageAggregator*getMessageAggregator();
+	MessageStreamer*getMessageStreamer();
 
 	void setMaximumNumberOfOutboxBuffers(int maxNumberOfBuffers);
 	
@@ -0,0 +1,197 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#include "IdleBackoff.h"
+#include "OperatingSystem.h"
+#include "atomics.h"
+
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <iostream>
+using namespace std;
+
+void IdleBackoff::constructor(int policy,MessageQueue*inbox){
+
+	m_policy=policy;
+	m_inbox=inbox;
+
+	m_parked=0;
+	m_idleTicks=0;
+	m_parkingMicroseconds=1;
+	m_pollingStartingTime=0;
+
+	m_spinningTicks=0;
+	m_yields=0;
+	m_parks=0;
+	m_pollingMicroseconds=0;
+	m_parkedMicroseconds=0;
+
+	pthread_mutex_init(&m_mutex,NULL);
+	pthread_cond_init(&m_condition,NULL);
+}
+
+void IdleBackoff::destructor(){
+
+	pthread_cond_destroy(&m_condition);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+void IdleBackoff::finishPolling(){
+
+	m_pollingMicroseconds+=getMicroseconds()-m_pollingStartingTime;
+}
+
+void IdleBackoff::work(){
+
+	if(m_idleTicks==0)
+		return;
+
+	finishPolling();
+
+	m_idleTicks=0;
+	m_parkingMicroseconds=1;
+}
+
+void IdleBackoff::idle(){
+
+	if(m_idleTicks==0)
+		m_pollingStartingTime=getMicroseconds();
+
+	m_idleTicks++;
+
+	bool adaptive=m_policy==IDLE_POLICY_ADAPTIVE;
+
+	if(m_policy==IDLE_POLICY_PARK
+		|| (adaptive && m_idleTicks>IDLE_BACKOFF_SPINNING_TICKS+IDLE_BACKOFF_YIELDING_TICKS)){
+
+		park();
+
+	}else if(m_policy==IDLE_POLICY_YIELD
+		|| (adaptive && m_idleTicks>IDLE_BACKOFF_SPINNING_TICKS)){
+
+		sched_yield();
+		m_yields++;
+
+	}else{
+		m_spinningTicks++;
+	}
+}
+
+/*
+ * With mini-ranks, m_parked is set before checking the inbox one last time,
+ * and the communication thread checks m_parked after pushing a message.
+ * The full barriers on both sides make sure that at least one of them sees
+ * the write of the other, so a message can not be missed.
+ * The wait is also bounded, just in case.
+ */
+void IdleBackoff::park(){
+
+	finishPolling();
+
+	uint64_t startingTime=getMicroseconds();
+
+	if(m_inbox!=NULL){
+
+		pthread_mutex_lock(&m_mutex);
+
+		storeRelease(&m_parked,1);
+		__sync_synchronize();
+
+		if(!m_inbox->hasContent()){
+
+			struct timeval now;
+			gettimeofday(&now,NULL);
+
+			uint64_t deadline=now.tv_usec+IDLE_BACKOFF_MAXIMUM_PARKING_MICROSECONDS;
+
+			struct timespec timeout;
+			timeout.tv_sec=now.tv_sec+deadline/1000000;
+			timeout.tv_nsec=(deadline%1000000)*1000;
+
+			pthread_cond_timedwait(&m_condition,&m_mutex,&timeout);
+		}
+
+		storeRelease(&m_parked,0);
+
+		pthread_mutex_unlock(&m_mutex);
+
+	}else{
+
+		usleep(m_parkingMicroseconds);
+
+		if(m_parkingMicroseconds<IDLE_BACKOFF_MAXIMUM_PARKING_MICROSECONDS)
+			m_parkingMicroseconds*=2;
+	}
+
+	uint64_t endingTime=getMicroseconds();
+
+	m_parks++;
+	m_parkedMicroseconds+=endingTime-startingTime;
+
+	m_pollingStartingTime=endingTime;
+}
+
+void IdleBackoff::wakeUp(){
+
+	__sync_synchronize();
+
+	if(!loadAcquire(&m_parked))
+		return;
+
+	pthread_mutex_lock(&m_mutex);
+	pthread_cond_signal(&m_condition);
+	pthread_mutex_unlock(&m_mutex);
+}
+
+int IdleBackoff::getPolicy(){
+	return m_policy;
+}
+
+uint64_t IdleBackoff::getSpinningTicks(){
+	return m_spinningTicks;
+}
+
+uint64_t IdleBackoff::getYields(){
+	return m_yields;
+}
+
+uint64_t IdleBackoff::getParks(){
+	return m_parks;
+}
+
+uint64_t IdleBackoff::getPollingMicroseconds(){
+	return m_pollingMicroseconds;
+}
+
+uint64_t IdleBackoff::getParkedMicroseconds(){
+	return m_parkedMicroseconds;
+}
+
+void IdleBackoff::printStatus(Rank rank){
+
+	cout<<"Rank "<<rank<<" IdleBackoff: SpinningTicks= "<<m_spinningTicks;
+	cout<<" Yields= "<<m_yields<<" Parks= "<<m_parks;
+	cout<<" PollingMicroseconds= "<<m_pollingMicroseconds;
+	cout<<" ParkedMicroseconds= "<<m_parkedMicroseconds<<endl;
+}
@@ -0,0 +1,121 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _IdleBackoff_h
+#define _IdleBackoff_h
+
+#include "types.h"
+
+#include <RayPlatform/communication/MessageQueue.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+/*
+ * Policies for -idle-policy.
+ */
+#define IDLE_POLICY_SPIN 0
+#define IDLE_POLICY_YIELD 1
+#define IDLE_POLICY_PARK 2
+#define IDLE_POLICY_ADAPTIVE 3
+
+/*
+ * With the adaptive policy, the first idle ticks spin,
+ * the next ones yield, and the other ones park.
+ */
+#define IDLE_BACKOFF_SPINNING_TICKS 256
+#define IDLE_BACKOFF_YIELDING_TICKS 1024
+
+/*
+ * A parked ComputeCore waits for a message at most this long.
+ */
+#define IDLE_BACKOFF_MAXIMUM_PARKING_MICROSECONDS 1024
+
+/**
+ * Back-off for a ComputeCore that has nothing to do.
+ *
+ * A tick is idle when no message was received or sent and when
+ * the master mode and the slave mode are RAY_MASTER_MODE_DO_NOTHING
+ * and RAY_SLAVE_MODE_DO_NOTHING. Only a new message can give work
+ * to the ComputeCore in that case.
+ *
+ * With mini-ranks, a parked ComputeCore sleeps on a condition variable and
+ * the communication thread wakes it up when it pushes a message in its inbox.
+ * Otherwise, a parked ComputeCore sleeps for a duration that doubles
+ * up to IDLE_BACKOFF_MAXIMUM_PARKING_MICROSECONDS, because the messages
+ * are only received by the ComputeCore itself.
+ *
+ * \author RayPlatform contributors
+ */
+class IdleBackoff{
+
+	int m_policy;
+
+/** the inbox that wakes up the ComputeCore, NULL without mini-ranks */
+	MessageQueue*m_inbox;
+
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_condition;
+
+/** set while the ComputeCore waits on m_condition */
+	int m_parked;
+
+	int m_idleTicks;
+	int m_parkingMicroseconds;
+	uint64_t m_pollingStartingTime;
+
+/** counters */
+	uint64_t m_spinningTicks;
+	uint64_t m_yields;
+	uint64_t m_parks;
+	uint64_t m_pollingMicroseconds;
+	uint64_t m_parkedMicroseconds;
+
+	void park();
+	void finishPolling();
+
+public:
+
+	void constructor(int policy,MessageQueue*inbox);
+	void destructor();
+
+/** called after a tick with work */
+	void work();
+
+/** called after an idle tick */
+	void idle();
+
+/** called by the communication thread after it pushed a message in the inbox */
+	void wakeUp();
+
+	int getPolicy();
+	uint64_t getSpinningTicks();
+	uint64_t getYields();
+	uint64_t getParks();
+
+/** time spent idle but not parked (spinning or yielding) */
+	uint64_t getPollingMicroseconds();
+	uint64_t getParkedMicroseconds();
+
+	void printStatus(Rank rank);
+};
+
+#endif /* _IdleBackoff_h */
@@ -25,6 +25,8 @@
 /* EXIT_SUCCESS 0 (defined in stdlib.h) */
 #define EXIT_NEEDS_ARGUMENTS 5
 #define EXIT_NO_MORE_MEMORY 42
+#define EXIT_WIRE_FORMAT_MISMATCH 43
+#define EXIT_STATIC_VECTOR_IS_FULL 44
 
 
 /** only this file knows the operating system */
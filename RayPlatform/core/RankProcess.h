@@ -25,6 +25,7 @@
 #include "MiniRank.h"
 
 #include <RayPlatform/communication/MessagesHandler.h>
+#include <RayPlatform/memory/BufferPool.h>
 #include <RayPlatform/core/types.h> /* for CONFIG_MINI_RANKS */
 
 #if defined(CONFIG_DEBUG_MPI_RANK) || defined(ASSERT)
@@ -43,6 +44,7 @@ using namespace std;
 
 #define MAXIMUM_NUMBER_OF_MINIRANKS_PER_RANK 64
 #include <pthread.h>
+#include <sched.h>
 
 #else
 
@@ -71,6 +73,12 @@ class RankProcess{
  */
 	MessagesHandler m_messagesHandler;
 
+/*
+ * Buffers for received messages, shared by the communication
+ * thread and the mini-ranks.
+ */
+	BufferPool m_bufferPool;
+
 	MiniRank*m_miniRanks[MAXIMUM_NUMBER_OF_MINIRANKS_PER_RANK];
 
 #ifdef CONFIG_MINI_RANKS
@@ -258,6 +266,29 @@ void RankProcess<Application>::startMiniRanks(){
 			m_numberOfMiniRanksPerRank,&m_messagesHandler);
 	}
 
+/*
+ * The communication thread receives messages directly in the pool and
+ * the mini-ranks give the buffers back at the end of their ticks.
+ * There are as many buffers as the number of buffers that each
+ * mini-rank had for its buffered inbox before.
+ */
+	int buffers=numberOfMiniRanks*2;
+
+	if(buffers<128)
+		buffers=128;
+
+	int maximumHeldBuffers=1;
+
+	for(int i=0;i<m_numberOfInstalledMiniRanks;i++){
+		if(m_cores[i]->getReceiveBatchSize()>maximumHeldBuffers)
+			maximumHeldBuffers=m_cores[i]->getReceiveBatchSize();
+	}
+
+	m_bufferPool.constructor(buffers,MAXIMUM_MESSAGE_SIZE_IN_BYTES + MESSAGE_META_DATA_SIZE,
+		m_numberOfInstalledMiniRanks,maximumHeldBuffers);
+
+	m_messagesHandler.setBufferPool(&m_bufferPool);
+
 	for(int i=0;i<m_numberOfInstalledMiniRanks;i++){
 
 		#ifdef CONFIG_DEBUG_MPI_RANK
@@ -281,6 +312,15 @@ void RankProcess<Application>::startMiniRanks(){
 		pthread_create(m_threads+i,NULL,Rank_startMiniRank,m_miniRanks[i]);
 	}
 
+/*
+ * The message queues of a mini-rank are built when it starts to run,
+ * the messages that arrive before that wait in MPI.
+ */
+	for(int i=0;i<m_numberOfInstalledMiniRanks;i++){
+		while(!m_cores[i]->engineIsConfigured())
+			sched_yield();
+	}
+
 	m_communicate=true;
 
 	while(m_communicate){
@@ -299,6 +339,8 @@ void RankProcess<Application>::destructor(){
 
 	getMessagesHandler()->destructor();
 
+	m_bufferPool.destructor();
+
 	m_destroyed=true;
 }
 
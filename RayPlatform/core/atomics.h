@@ -0,0 +1,80 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _atomics_h
+#define _atomics_h
+
+/*
+ * Atomic operations shared by the communication thread and the mini-ranks.
+ *
+ * gcc >= 4.7 (and clang, and the Intel compiler) provide the __atomic builtins,
+ * they are available with -ansi too.
+ * Otherwise, the older __sync builtins (full memory barriers) are used.
+ *
+ * \see http://gcc.gnu.org/onlinedocs/gcc/_005f_005fatomic-Builtins.html
+ */
+
+template<class Type>
+inline Type loadAcquire(Type*variable){
+#if defined(__ATOMIC_ACQUIRE)
+	return __atomic_load_n(variable,__ATOMIC_ACQUIRE);
+#else
+	Type value=*(volatile Type*)variable;
+	__sync_synchronize();
+	return value;
+#endif
+}
+
+template<class Type>
+inline void storeRelease(Type*variable,Type value){
+#if defined(__ATOMIC_RELEASE)
+	__atomic_store_n(variable,value,__ATOMIC_RELEASE);
+#else
+	__sync_synchronize();
+	*(volatile Type*)variable=value;
+#endif
+}
+
+/*
+ * Returns the new value.
+ */
+template<class Type>
+inline Type addAndFetch(Type*variable,Type value){
+#if defined(__ATOMIC_ACQ_REL)
+	return __atomic_add_fetch(variable,value,__ATOMIC_ACQ_REL);
+#else
+	return __sync_add_and_fetch(variable,value);
+#endif
+}
+
+/*
+ * Returns the new value.
+ */
+template<class Type>
+inline Type subtractAndFetch(Type*variable,Type value){
+#if defined(__ATOMIC_ACQ_REL)
+	return __atomic_sub_fetch(variable,value,__ATOMIC_ACQ_REL);
+#else
+	return __sync_sub_and_fetch(variable,value);
+#endif
+}
+
+#endif /* _atomics_h */
@@ -30,6 +30,23 @@
 uint64_t uniform_hashing_function_1_64_64(uint64_t key);
 uint64_t uniform_hashing_function_2_64_64(uint64_t key);
 
+/* checksum algorithms for messages */
+#define CHECKSUM_CRC32 0
+#define CHECKSUM_CRC32C 1
+
+/** CRC-32 (IEEE 802.3) */
 uint32_t computeCyclicRedundancyCode32(uint8_t * bytes, uint32_t numberOfBytes);
 
+/** CRC-32C (Castagnoli), with the SSE 4.2 crc32 instruction when available */
+uint32_t computeCastagnoliCode32(uint8_t * bytes, uint32_t numberOfBytes);
+
+/** CRC-32C (Castagnoli) with the lookup tables only, the hardware code must match it */
+uint32_t computeCastagnoliCode32WithTables(uint8_t * bytes, uint32_t numberOfBytes);
+
+/** true if the processor has the SSE 4.2 crc32 instruction */
+bool hasHardwareCastagnoliCode32();
+
+/** compute a checksum with CHECKSUM_CRC32 or CHECKSUM_CRC32C */
+uint32_t computeChecksum(int algorithm, uint8_t * bytes, uint32_t numberOfBytes);
+
 #endif
@@ -0,0 +1,181 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#include "BufferPool.h"
+#include "allocator.h"
+
+#include <RayPlatform/core/atomics.h>
+
+#include <stdlib.h>
+
+#ifdef CONFIG_ASSERT
+#include <assert.h>
+#endif /* ASSERT */
+
+BufferPool::BufferPool(){
+
+	m_buffers=NULL;
+	m_references=NULL;
+	m_heldBuffers=NULL;
+	m_numberOfHeldBuffers=NULL;
+}
+
+void BufferPool::constructor(int numberOfBuffers,int bufferSize,int numberOfOwners,int maximumHeldBuffers){
+
+	#ifdef CONFIG_ASSERT
+	assert(numberOfBuffers>0);
+	assert(bufferSize>0);
+	assert(numberOfOwners>0);
+	assert(maximumHeldBuffers>0);
+	#endif /* ASSERT */
+
+	m_numberOfBuffers=numberOfBuffers;
+	m_bufferSize=bufferSize;
+	m_numberOfOwners=numberOfOwners;
+	m_maximumHeldBuffers=maximumHeldBuffers;
+	m_head=0;
+
+	m_buffers=(uint8_t*)__Malloc(m_numberOfBuffers*m_bufferSize,"RAY_MALLOC_TYPE_BUFFER_POOL",false);
+	m_references=(uint32_t*)__Malloc(m_numberOfBuffers*sizeof(uint32_t),"RAY_MALLOC_TYPE_BUFFER_POOL",false);
+
+	for(int i=0;i<m_numberOfBuffers;i++)
+		m_references[i]=0;
+
+	m_heldBuffers=(uint8_t**)__Malloc(m_numberOfOwners*m_maximumHeldBuffers*sizeof(uint8_t*),
+		"RAY_MALLOC_TYPE_BUFFER_POOL",false);
+	m_numberOfHeldBuffers=(int*)__Malloc(m_numberOfOwners*sizeof(int),"RAY_MALLOC_TYPE_BUFFER_POOL",false);
+
+	for(int i=0;i<m_numberOfOwners;i++)
+		m_numberOfHeldBuffers[i]=0;
+}
+
+void BufferPool::destructor(){
+
+	if(m_buffers==NULL)
+		return;
+
+	__Free(m_buffers,"RAY_MALLOC_TYPE_BUFFER_POOL",false);
+	m_buffers=NULL;
+	__Free(m_references,"RAY_MALLOC_TYPE_BUFFER_POOL",false);
+	m_references=NULL;
+	__Free(m_heldBuffers,"RAY_MALLOC_TYPE_BUFFER_POOL",false);
+	m_heldBuffers=NULL;
+	__Free(m_numberOfHeldBuffers,"RAY_MALLOC_TYPE_BUFFER_POOL",false);
+	m_numberOfHeldBuffers=NULL;
+}
+
+/*
+ * Only the communication thread allocates, so a buffer seen with a
+ * reference count of 0 can not be taken by someone else.
+ * The acquire load orders the last use of the buffer by its previous
+ * owner before the new use.
+ */
+void*BufferPool::allocate(){
+
+	for(int i=0;i<m_numberOfBuffers;i++){
+
+		int handle=m_head;
+
+		m_head++;
+		if(m_head==m_numberOfBuffers)
+			m_head=0;
+
+		if(loadAcquire(m_references+handle)==0){
+			storeRelease(m_references+handle,(uint32_t)1);
+
+			return m_buffers+handle*m_bufferSize;
+		}
+	}
+
+	return NULL;
+}
+
+int BufferPool::getBufferHandle(void*buffer){
+
+	int handle=((uint8_t*)buffer-m_buffers)/m_bufferSize;
+
+	#ifdef CONFIG_ASSERT
+	assert(contains(buffer));
+	assert(m_buffers+handle*m_bufferSize==buffer);
+	#endif /* ASSERT */
+
+	return handle;
+}
+
+void BufferPool::addReference(void*buffer){
+
+	int handle=getBufferHandle(buffer);
+
+	#ifdef CONFIG_ASSERT
+	assert(loadAcquire(m_references+handle)>0);
+	#endif /* ASSERT */
+
+	addAndFetch(m_references+handle,(uint32_t)1);
+}
+
+void BufferPool::release(void*buffer){
+
+	int handle=getBufferHandle(buffer);
+
+	#ifdef CONFIG_ASSERT
+	assert(loadAcquire(m_references+handle)>0);
+	#endif /* ASSERT */
+
+	subtractAndFetch(m_references+handle,(uint32_t)1);
+}
+
+void BufferPool::hold(int owner,void*buffer){
+
+	#ifdef CONFIG_ASSERT
+	assert(owner>=0 && owner<m_numberOfOwners);
+	assert(m_numberOfHeldBuffers[owner]<m_maximumHeldBuffers);
+	assert(contains(buffer));
+	#endif /* ASSERT */
+
+	m_heldBuffers[owner*m_maximumHeldBuffers+m_numberOfHeldBuffers[owner]]=(uint8_t*)buffer;
+	m_numberOfHeldBuffers[owner]++;
+}
+
+void BufferPool::releaseHeldBuffers(int owner){
+
+	#ifdef CONFIG_ASSERT
+	assert(owner>=0 && owner<m_numberOfOwners);
+	#endif /* ASSERT */
+
+	uint8_t**heldBuffers=m_heldBuffers+owner*m_maximumHeldBuffers;
+
+	for(int i=0;i<m_numberOfHeldBuffers[owner];i++)
+		release(heldBuffers[i]);
+
+	m_numberOfHeldBuffers[owner]=0;
+}
+
+bool BufferPool::contains(void*buffer){
+	return (uint8_t*)buffer>=m_buffers && (uint8_t*)buffer<m_buffers+m_numberOfBuffers*m_bufferSize;
+}
+
+int BufferPool::getBufferSize(){
+	return m_bufferSize;
+}
+
+int BufferPool::getNumberOfBuffers(){
+	return m_numberOfBuffers;
+}
@@ -0,0 +1,93 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _BufferPool_h
+#define _BufferPool_h
+
+#include <stdint.h>
+
+/**
+ * A pool of reference-counted buffers shared by the communication
+ * thread and the mini-ranks of a RankProcess.
+ *
+ * The communication thread allocates a buffer, receives a message in it
+ * and gives it to a mini-rank through its MessageQueue inbox. The
+ * mini-rank holds the buffer during its tick and releases it when
+ * the tick ends. The buffer is available again when its reference count
+ * drops to 0.
+ *
+ * allocate() must only be called by the communication thread.
+ * hold() and releaseHeldBuffers() must only be called by the owner.
+ * addReference() and release() can be called by any thread.
+ *
+ * \author RayPlatform contributors
+ */
+class BufferPool{
+
+	int m_numberOfBuffers;
+	int m_bufferSize;
+
+	uint8_t*m_buffers;
+
+/** the reference count of each buffer, 0 means available */
+	uint32_t*m_references;
+
+/** the next buffer to check in allocate() */
+	int m_head;
+
+	int m_numberOfOwners;
+	int m_maximumHeldBuffers;
+
+/** buffers held by each owner, m_maximumHeldBuffers per owner */
+	uint8_t**m_heldBuffers;
+	int*m_numberOfHeldBuffers;
+
+	int getBufferHandle(void*buffer);
+
+public:
+
+	BufferPool();
+
+	void constructor(int numberOfBuffers,int bufferSize,int numberOfOwners,int maximumHeldBuffers);
+	void destructor();
+
+/**
+ * Get an available buffer with a reference count of 1.
+ * Returns NULL if all the buffers are in use.
+ */
+	void*allocate();
+
+	void addReference(void*buffer);
+	void release(void*buffer);
+
+/**
+ * Remember that the owner uses the buffer until releaseHeldBuffers()
+ * is called.
+ */
+	void hold(int owner,void*buffer);
+	void releaseHeldBuffers(int owner);
+
+	bool contains(void*buffer);
+	int getBufferSize();
+	int getNumberOfBuffers();
+};
+
+#endif /* _BufferPool_h */
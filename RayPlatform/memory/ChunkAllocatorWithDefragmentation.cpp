@@ -34,6 +34,23 @@ using namespace std;
 void ChunkAllocatorWithDefragmentation::defragment(){
 }
 
+uint64_t ChunkAllocatorWithDefragmentation::getOperations(int operationCode){
+	uint64_t operations=0;
+
+	for(int i=0;i<m_numberOfLanes;i++){
+		DefragmentationLane*lane=m_defragmentationLanes[i];
+
+		for(int group=0;group<GROUPS_PER_LANE;group++){
+			DefragmentationGroup*theGroup=lane->getGroup(group);
+
+			if(theGroup->isOnline())
+				operations+=theGroup->getOperations(operationCode);
+		}
+	}
+
+	return operations;
+}
+
 /**
 * print allocator information
 */
@@ -212,6 +229,18 @@ void*ChunkAllocatorWithDefragmentation::getPointer(SmartPointer a){
 	return m_defragmentationLanes[correctLaneId]->getGroup(groupInLane)->getPointer(smallSmartPointer,m_bytesPerElement);
 }
 
+void ChunkAllocatorWithDefragmentation::prefetch(SmartPointer a){
+	if(a==SmartPointer_NULL)
+		return;
+
+	int group=a/ELEMENTS_PER_GROUP;
+	int correctLaneId=group/GROUPS_PER_LANE;
+	int groupInLane=group%GROUPS_PER_LANE;
+
+	SmallSmartPointer smallSmartPointer=a%ELEMENTS_PER_GROUP;
+	m_defragmentationLanes[correctLaneId]->getGroup(groupInLane)->prefetchPointer(smallSmartPointer);
+}
+
 // empty constructor
 ChunkAllocatorWithDefragmentation::ChunkAllocatorWithDefragmentation(){}
 
@@ -98,10 +98,22 @@ public:
  */
 	void*getPointer(SmartPointer a);
 
+/**
+ * prefetch the meta-data that getPointer reads, so that
+ * resolving many SmartPointer objects has less cache misses
+ */
+	void prefetch(SmartPointer a);
+
 	ChunkAllocatorWithDefragmentation();
 	~ChunkAllocatorWithDefragmentation();
 
 	void defragment();
+
+/**
+ * get the sum of the operations of the DefragmentationGroup objects,
+ * operationCode is __OPERATION_ALLOCATE, __OPERATION_DEALLOCATE or __OPERATION_DEFRAGMENT
+ */
+	uint64_t getOperations(int operationCode);
 };
 
 #endif
@@ -381,6 +381,10 @@ void*DefragmentationGroup::getPointer(SmallSmartPointer a,int bytesPerElement){
 	return pointer;
 }
 
+void DefragmentationGroup::prefetchPointer(SmallSmartPointer a){
+	__Prefetch(m_allocatedOffsets+a);
+}
+
 /**
  * Set pointers to NULL
  */
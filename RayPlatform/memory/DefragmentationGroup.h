@@ -41,6 +41,16 @@
  */
 typedef uint16_t SmallSmartPointer;
 
+/**
+ * Software prefetch of the cache line of an address.
+ * \see http://gcc.gnu.org/onlinedocs/gcc/Other-Builtins.html
+ */
+#if defined (__GNUC__)
+#define __Prefetch(address) __builtin_prefetch(address)
+#else
+#define __Prefetch(address)
+#endif
+
 #define __OPERATION_ALLOCATE 0x0
 #define __OPERATION_DEALLOCATE 0x1
 #define __OPERATION_DEFRAGMENT 0x2
@@ -141,6 +151,11 @@ public:
  * 	translate a SmallSmartPointer to an actual pointer
  */
 	void*getPointer(SmallSmartPointer a,int bytesPerElement);
+
+	/**
+ * 	prefetch what getPointer will read
+ */
+	void prefetchPointer(SmallSmartPointer a);
 	
 	/**
  * 	return yes if activated
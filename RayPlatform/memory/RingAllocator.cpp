@@ -33,6 +33,7 @@ using namespace std;
 
 #define BUFFER_STATE_AVAILABLE 0x0
 #define BUFFER_STATE_DIRTY 0x1
+#define BUFFER_STATE_HELD 0x2
 
 #define __NOT_SET -1
 
@@ -166,8 +167,8 @@ void*RingAllocator::allocate(int a){
 
 	// first half of the circle
 	// from origin to N-1
-	while(m_bufferStates[m_current] == BUFFER_STATE_DIRTY
-	&& m_current < m_chunks){
+	while(m_current < m_chunks
+	&& m_bufferStates[m_current] != BUFFER_STATE_AVAILABLE){
 
 		m_current++;
 
@@ -180,15 +181,15 @@ void*RingAllocator::allocate(int a){
 	}
 
 	// from 0 to origin-1
-	while(m_bufferStates[m_current] == BUFFER_STATE_DIRTY
-	&& m_current < origin){
+	while(m_current < origin
+	&& m_bufferStates[m_current] != BUFFER_STATE_AVAILABLE){
 
 		m_current++;
 	}
 
 	// if all buffers are dirty, we throw a runtime error
 	#ifdef CONFIG_ASSERT
-	if(m_current==origin && m_bufferStates[m_current]==BUFFER_STATE_DIRTY){
+	if(m_current==origin && m_bufferStates[m_current]!=BUFFER_STATE_AVAILABLE){
 		cout<<"Error: all buffers are dirty !, chunks: "<<m_chunks<<endl;
 		assert(m_current!=origin);
 	}
@@ -213,6 +214,46 @@ void*RingAllocator::allocate(int a){
 	return address;
 }
 
+void*RingAllocator::hold(){
+
+	void*buffer=allocate(m_max);
+
+	// a held buffer is not counted in the allocations of the tick
+	m_count--;
+
+	holdBuffer(buffer);
+
+	return buffer;
+}
+
+void RingAllocator::holdBuffer(void*buffer){
+
+	int bufferNumber=getBufferHandle(buffer);
+
+	if(m_bufferStates[bufferNumber]==BUFFER_STATE_HELD)
+		return;
+
+	#ifdef CONFIG_ASSERT
+	assert(m_bufferStates[bufferNumber]==BUFFER_STATE_AVAILABLE);
+	assert(m_availableBuffers>=1);
+	#endif
+
+	m_bufferStates[bufferNumber]=BUFFER_STATE_HELD;
+	m_availableBuffers--;
+}
+
+void RingAllocator::release(void*buffer){
+
+	int bufferNumber=getBufferHandle(buffer);
+
+	#ifdef CONFIG_ASSERT
+	assert(m_bufferStates[bufferNumber]==BUFFER_STATE_HELD);
+	#endif
+
+	m_bufferStates[bufferNumber]=BUFFER_STATE_AVAILABLE;
+	m_availableBuffers++;
+}
+
 void RingAllocator::salvageBuffer(void*buffer){
 	int bufferNumber=getBufferHandle(buffer);
 
@@ -233,12 +274,18 @@ void RingAllocator::salvageBuffer(void*buffer){
 void RingAllocator::markBufferAsDirty(void*buffer){
 	int bufferNumber=getBufferHandle(buffer);
 
+	bool held=m_bufferStates[bufferNumber]==BUFFER_STATE_HELD;
+
 	m_bufferStates[bufferNumber]= BUFFER_STATE_DIRTY;
 
 	#ifdef CONFIG_RING_VERBOSE
 	cout<<"[RingAllocator::markBufferAsDirty] "<<bufferNumber<<" -> BUFFER_STATE_DIRTY"<<endl;
 	#endif
 
+	// a held buffer is already counted as unavailable
+	if(held)
+		return;
+
 	#ifdef CONFIG_ASSERT
 	assert(m_availableBuffers>=1);
 	#endif
@@ -297,6 +344,10 @@ int RingAllocator::getCount(){
 	return m_count;
 }
 
+int RingAllocator::getNumberOfAvailableBuffers(){
+	return m_availableBuffers;
+}
+
 int RingAllocator::getNumberOfBuffers(){
 	return m_chunks;
 }
@@ -364,6 +415,7 @@ void RingAllocator::checkDirtyBuffer(int index){
 	void*buffer=m_dirtyBuffers[index].getBuffer();
 	salvageBuffer(buffer);
 	m_numberOfDirtyBuffers--;
+	m_dirtyBuffersPerDestination[m_dirtyBuffers[index].getDestination()]--;
 
 	#ifdef COMMUNICATION_IS_VERBOSE
 	cout<<"From checkDirtyBuffer flag= "<<flag<<endl;
@@ -388,6 +440,20 @@ void RingAllocator::cleanDirtyBuffers(){
 	assert(m_numberOfDirtyBuffers>0);
 	#endif
 
+	sweepDirtyBuffers();
+
+	if(m_numberOfDirtyBuffers>0 && m_numberOfDirtyBuffers>=m_minimumNumberOfDirtyBuffersForWarning){
+		cout<<"[MessagesHandler] Warning: dirty buffers are still dirty after linear sweep."<<endl;
+		printDirtyBuffers();
+	}
+}
+
+void RingAllocator::sweepDirtyBuffers(){
+
+	// nothing was sent yet
+	if(m_dirtyBuffers==NULL)
+		return;
+
 	m_linearSweeps++;
 
 	// update the dirty buffer list.
@@ -402,11 +468,13 @@ void RingAllocator::cleanDirtyBuffers(){
 
 		checkDirtyBuffer(i);
 	}
+}
 
-	if(m_numberOfDirtyBuffers>=m_minimumNumberOfDirtyBuffersForWarning){
-		cout<<"[MessagesHandler] Warning: dirty buffers are still dirty after linear sweep."<<endl;
-		printDirtyBuffers();
-	}
+int RingAllocator::getNumberOfDirtyBuffers(Rank destination){
+	if(destination>=(int)m_dirtyBuffersPerDestination.size())
+		return 0;
+
+	return m_dirtyBuffersPerDestination[destination];
 }
 
 #define CONFIG_DIRTY_MESSAGE_SUPPORT
@@ -481,6 +549,11 @@ void RingAllocator::setRegisteredBufferAttributes(void * buffer,
 	dirtyBuffer.setDestination(destination);
 	dirtyBuffer.setTag(tag);
 
+	if(destination>=(int)m_dirtyBuffersPerDestination.size())
+		m_dirtyBuffersPerDestination.resize(destination+1,0);
+
+	m_dirtyBuffersPerDestination[destination]++;
+
 	m_rank = source;
 }
 
@@ -27,6 +27,7 @@
 #include <RayPlatform/core/types.h> 
 
 #include <set>
+#include <vector>
 #include <stdint.h>
 #include <mpi.h>
 using namespace std;
@@ -58,6 +59,9 @@ class RingAllocator{
 	int m_maximumDirtyBuffers;
 	int m_dirtyBufferSlots;
 
+/** the number of dirty buffers for each destination */
+	vector<int> m_dirtyBuffersPerDestination;
+
 
 /** the number of call to allocate() since the last hard reset */
 	int m_count;
@@ -110,6 +114,24 @@ public:
 /** allocate memory */
 	void*allocate(int a);
 
+/**
+ * Get a buffer that allocate() does not return until it is
+ * released or until it is registered for a send. A held buffer
+ * can stay in use for many ticks.
+ */
+	void*hold();
+
+/**
+ * Hold a buffer that was returned by allocate().
+ */
+	void holdBuffer(void*buffer);
+
+/**
+ * Give back a held buffer that was not registered, for instance
+ * when another thread has copied it.
+ */
+	void release(void*buffer);
+
 /**
  * Gets the size of each buffer
  */
@@ -118,6 +140,9 @@ public:
 	void clear();
 	void resetCount();
 	int getCount();
+
+/** the number of buffers that are neither dirty nor held */
+	int getNumberOfAvailableBuffers();
 /**
  * returns the number of buffers in the ring
  */
@@ -130,6 +155,20 @@ public:
 
 	void checkDirtyBuffer(int i);
 	void cleanDirtyBuffers();
+
+/**
+ * Test all the dirty buffers now, even if there are
+ * only a few of them.
+ */
+	void sweepDirtyBuffers();
+
+/**
+ * Get the number of buffers that are still dirty
+ * because of messages sent to a rank.
+ * The value is updated by the sweeps, so it may count
+ * messages that have completed since the last one.
+ */
+	int getNumberOfDirtyBuffers(Rank destination);
 	void initializeDirtyBuffers();
 	DirtyBuffer*getDirtyBuffers();
 	MPI_Request*registerBuffer(void*buffer);
@@ -32,13 +32,12 @@ using namespace std;
 /**
  * wrapper around malloc
  */
-void*__Malloc(int c,const char*description,bool show){
+void*__Malloc(uint64_t c,const char*description,bool show){
 	#ifdef CONFIG_ASSERT
 	if(c==0){
 		cout<<"Requested "<<c<<" bytes of type "<<description<<endl;
 	}
 	assert(c!=0);
-	assert(c>0);
 	#endif
 
 	void*a=NULL;
@@ -52,7 +51,7 @@ void*__Malloc(int c,const char*description,bool show){
 	assert(a!=NULL);
 
 	if(show){
-		printf("%s %i\t%s\t%i bytes, ret\t%p\t%s\n",__FILE__,__LINE__,__func__,c,a,description);
+		printf("%s %i\t%s\t%llu bytes, ret\t%p\t%s\n",__FILE__,__LINE__,__func__,(unsigned long long)c,a,description);
 		fflush(stdout);
 	}
 	return a;
@@ -19,10 +19,12 @@ see <http://www.gnu.org/licenses/>
 
 */
 
+#include <stdint.h>
+
 /**
  * allocate c bytes of type mallocType
  */
-void*__Malloc(int c,const char*description,bool show);
+void*__Malloc(uint64_t c,const char*description,bool show);
 
 /**
  * free bytes of mallocType
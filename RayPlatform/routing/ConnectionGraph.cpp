@@ -23,6 +23,10 @@
 
 #include <RayPlatform/core/OperatingSystem.h>
 
+#ifdef CONFIG_ASSERT
+#include <assert.h>
+#endif
+
 enum {
 __COMPLETE,
 __GROUP,
@@ -242,8 +246,89 @@ void ConnectionGraph::getIncomingConnections(Rank source,vector<Rank>*connection
 	m_implementation->getIncomingConnections(source,connections);
 }
 
+#define NEIGHBOUR_UNREACHABLE 65535
+
+/**
+ * One breadth-first search per neighbour. The degree is small
+ * for the graphs that need routing, so this is cheap.
+ */
+void ConnectionGraph::computeNeighbourDistances(Rank rank){
+
+	m_neighbours.clear();
+	m_neighbourDistances.clear();
+
+	// every rank is a neighbour
+	if(m_typeCode==__COMPLETE)
+		return;
+
+	vector<vector<Rank> > connections;
+	connections.resize(m_size);
+
+	for(Rank vertex=0;vertex<m_size;vertex++)
+		m_implementation->getOutcomingConnections(vertex,&(connections[vertex]));
+
+	for(int i=0;i<(int)connections[rank].size();i++){
+		if(connections[rank][i]!=rank)
+			m_neighbours.push_back(connections[rank][i]);
+	}
+
+	m_neighbourDistances.resize(m_neighbours.size()*m_size,NEIGHBOUR_UNREACHABLE);
+
+	vector<Rank> queue;
+
+	for(int neighbour=0;neighbour<(int)m_neighbours.size();neighbour++){
+		uint16_t*distances=&(m_neighbourDistances[neighbour*m_size]);
+
+		queue.clear();
+		queue.push_back(m_neighbours[neighbour]);
+		distances[m_neighbours[neighbour]]=0;
+
+		for(int head=0;head<(int)queue.size();head++){
+			Rank vertex=queue[head];
+
+			for(int j=0;j<(int)connections[vertex].size();j++){
+				Rank next=connections[vertex][j];
+
+				if(distances[next]!=NEIGHBOUR_UNREACHABLE)
+					continue;
+
+				distances[next]=distances[vertex]+1;
+				queue.push_back(next);
+			}
+		}
+	}
+
+	if(m_verbose)
+		cout<<"[ConnectionGraph] computed the distances from the "<<m_neighbours.size()<<" neighbours of rank "<<rank<<endl;
+}
+
+void ConnectionGraph::getShortestNextRanks(Rank destination,vector<Rank>*nextRanks){
+
+	#ifdef CONFIG_ASSERT
+	assert(m_neighbours.size()>0);
+	#endif
+
+	int shortest=NEIGHBOUR_UNREACHABLE;
+
+	for(int neighbour=0;neighbour<(int)m_neighbours.size();neighbour++){
+		int distance=m_neighbourDistances[neighbour*m_size+destination];
+
+		if(distance<shortest){
+			shortest=distance;
+			nextRanks->clear();
+		}
+
+		if(distance==shortest)
+			nextRanks->push_back(m_neighbours[neighbour]);
+	}
+
+	#ifdef CONFIG_ASSERT
+	assert(shortest!=NEIGHBOUR_UNREACHABLE);
+	#endif
+}
+
 void ConnectionGraph::buildGraph(int numberOfRanks,string type,bool verbosity,
-int degree){
+int degree,int threads){
 	m_verbose=verbosity;
 
 	m_size=numberOfRanks;
@@ -302,14 +387,34 @@ int degree){
 
 	m_type=type;
 	
+	uint64_t startingTime=getMicroseconds();
+	uint64_t startingMemory=getMemoryUsageInKiBytes();
+
 	// TODO: replace by a switch case to avoid virtual calls
 	m_implementation->setVerbosity(m_verbose);
+	m_implementation->setNumberOfThreads(threads);
 
 	// TODO: replace by a switch case to avoid virtual calls
 	m_implementation->makeConnections(m_size);
 
 	// TODO: replace by a switch case to avoid virtual calls
 	m_implementation->makeRoutes();
+
+	if(m_verbose){
+		double seconds=(getMicroseconds()-startingTime)/1000000.0;
+		uint64_t memory=getMemoryUsageInKiBytes();
+
+		cout<<"[ConnectionGraph] built the "<<m_type<<" graph for "<<m_size<<" ranks in "<<seconds<<" seconds";
+		cout<<", route tables: "<<m_implementation->getRouteTableBytes()/1024<<" KiB";
+		cout<<", memory growth: ";
+
+		if(memory>=startingMemory)
+			cout<<memory-startingMemory;
+		else
+			cout<<0;
+
+		cout<<" KiB"<<endl;
+	}
 }
 
 /**
@@ -71,6 +71,18 @@ class ConnectionGraph{
  */
 	int m_size;
 
+/**
+ * The ranks that can be reached directly by the rank given
+ * to computeNeighbourDistances, without itself.
+ */
+	vector<Rank> m_neighbours;
+
+/**
+ * The number of hops from each neighbour to each rank.
+ * The index is neighbourIndex*m_size+rank.
+ */
+	vector<uint16_t> m_neighbourDistances;
+
 	/************************************************/
 	/** methods to build connections */
 
@@ -92,8 +104,8 @@ public:
 
 	void writeFiles(string prefix);
 
-/** build the graph. */
-	void buildGraph(int numberOfVertices,string method,bool verbosity,int degree);
+/** build the graph, computing the routes with a number of threads. */
+	void buildGraph(int numberOfVertices,string method,bool verbosity,int degree,int threads);
 
 
 	/** get the number of paths that contain rank from 0 to any vertex 
@@ -106,6 +118,19 @@ public:
 
 	void getIncomingConnections(Rank i,vector<Rank>*connections);
 
+/**
+ * Compute the number of hops from each neighbour of a rank to
+ * every rank. This is required by getShortestNextRanks.
+ */
+	void computeNeighbourDistances(Rank rank);
+
+/**
+ * Get the neighbours of the rank given to computeNeighbourDistances
+ * that are on a shortest route to a destination that is not a neighbour.
+ * Any of them can be used as the next rank.
+ */
+	void getShortestNextRanks(Rank destination,vector<Rank>*nextRanks);
+
 	void printStatus();
 	void start(Rank rank);
 };
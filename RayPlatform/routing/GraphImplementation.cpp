@@ -21,11 +21,17 @@
 
 #include "GraphImplementation.h"
 
+#include <RayPlatform/cryptography/crypto.h>
+
 #include <iostream>
-#include <stdlib.h> /* srand, rand */
-#include <algorithm> /* random_shuffle */
 using namespace std;
 
+#include <pthread.h>
+
+#ifdef CONFIG_ASSERT
+#include <assert.h>
+#endif
+
 void GraphImplementation::getOutcomingConnections(Rank source,vector<Rank>*connections){
 	for(set<Rank>::iterator i=m_outcomingConnections[source].begin();
 		i!=m_outcomingConnections[source].end();i++){
@@ -40,146 +46,160 @@ void GraphImplementation::getIncomingConnections(Rank source,vector<Rank>*connec
 	}
 }
 
+#define UNREACHABLE_DISTANCE 65535
+
 /**
- * Dijkstra's algorithm
- * All weights are 1
- *
- * furthermore, we minimize saturation of vertices
- * by minimizing the relay points
+ * The searches from the sources are independent,
+ * so they are distributed on the processor cores.
  */
-void GraphImplementation::findShortestPath(Rank source,Rank destination,vector<Rank>*route){
+class SearchWorker{
+public:
+	GraphImplementation*m_graph;
+	int m_firstSource;
+	int m_step;
+};
 
-	// same vertex
-	if(source==destination){
-		route->push_back(source);
-		route->push_back(destination);
-		return;
-	}
+void*GraphImplementation_startSearches(void*argument){
 
-	// assign tentative distances
-	map<Rank,Distance> tentativeDistances;
-	
-	for(Rank i=0;i<m_size;i++)
-		tentativeDistances[i]=9999;
+	SearchWorker*worker=(SearchWorker*)argument;
 
-	tentativeDistances[source]=0;
+	worker->m_graph->searchFromSources(worker->m_firstSource,worker->m_step);
 
-	map<Rank,Rank> previousVertices;
+	return argument;
+}
+
+void GraphImplementation::computeDistances(){
+
+	m_outcomingLists.clear();
+	m_incomingLists.clear();
+	m_outcomingLists.resize(m_size);
+	m_incomingLists.resize(m_size);
 
-	// create a set of unvisited vertices
-	set<Rank> unvisited;
+	for(Rank rank=0;rank<m_size;rank++){
+		getOutcomingConnections(rank,&(m_outcomingLists[rank]));
+		getIncomingConnections(rank,&(m_incomingLists[rank]));
+	}
+
+	m_distances.clear();
+	m_distances.resize((uint32_t)m_size*m_size,UNREACHABLE_DISTANCE);
 
-	for(Rank i=0;i<m_size;i++)
-		unvisited.insert(i);
+	int threads=m_threads;
 
-	// create a current vertex
-	Rank current=source;
+	if(threads>m_size)
+		threads=m_size;
+	if(threads<1)
+		threads=1;
 
-	// create an index of distances
-	map<Distance,set<Rank> > verticesWithDistance;
+	vector<pthread_t> identifiers(threads);
+	vector<SearchWorker> workers(threads);
 
-	for(map<Rank,Distance>::iterator i=tentativeDistances.begin();i!=tentativeDistances.end();i++){
-		verticesWithDistance[i->second].insert(i->first);
+	for(int i=0;i<threads;i++){
+		workers[i].m_graph=this;
+		workers[i].m_firstSource=i;
+		workers[i].m_step=threads;
 	}
 
-	while(!unvisited.empty()){
-	
-		// calculate the tentative distance
-		// of each neighbors of the current
-		vector<int> connections;
-
-		getOutcomingConnections(current,&connections);
-
-		for(vector<Rank>::iterator neighbor=connections.begin();
-			neighbor!=connections.end();neighbor++){
-			Rank theNeighbor=*neighbor;
-
-			// we are only interested in unvisited neighbors
-			if(unvisited.count(theNeighbor)>0){
-				Distance newDistance=tentativeDistances[current]+1;
-				Distance oldDistance=tentativeDistances[theNeighbor];
-
-				// the new distance is better
-				// if the oldDistance for theNeighbor and the newDistance
-				// for theNeighbor in respect to current are equal, then
-				// choose the one having the previousVertex with the least
-				// relay events. The previous vertex is current or the one
-				// stored in previousVertices
-				if(newDistance < oldDistance || 
-					// distances are equal and current has less relay events
-				(newDistance==oldDistance && previousVertices.count(theNeighbor)>0
-				&& m_relayEvents[current] < m_relayEvents[previousVertices[theNeighbor]])){
-
-					tentativeDistances[theNeighbor]=newDistance;
-					previousVertices[theNeighbor]=current;
-
-					// update the distance index
-					verticesWithDistance[oldDistance].erase(theNeighbor);
-					verticesWithDistance[newDistance].insert(theNeighbor);
-				}
-			}
-		}
+	// the current thread does its share too
+	for(int i=1;i<threads;i++)
+		pthread_create(&(identifiers[i]),NULL,GraphImplementation_startSearches,&(workers[i]));
+
+	GraphImplementation_startSearches(&(workers[0]));
 
-		// mark the current vertex as not used
-		unvisited.erase(current);
+	for(int i=1;i<threads;i++)
+		pthread_join(identifiers[i],NULL);
+
+	if(m_verbose)
+		cout<<"Computed distances from "<<m_size<<" sources with "<<threads<<" threads"<<endl;
+}
 
-		// remove it as well from the index
-		Distance theDistance=tentativeDistances[current];
-		verticesWithDistance[theDistance].erase(current);
+/**
+ * Breadth-first searches from firstSource, firstSource+step, ...
+ * Each search writes its own row in m_distances.
+ */
+void GraphImplementation::searchFromSources(int firstSource,int step){
 
-		if(verticesWithDistance[theDistance].size()==0)
-			verticesWithDistance.erase(theDistance);
+	vector<Rank> queue;
+	queue.reserve(m_size);
 
-		// the next current is the one in unvisited vertices
-		// with the lowest distance
-		
-		Distance bestDistance=-1;
+	for(Rank source=firstSource;source<m_size;source+=step){
 
-		// here we find the next current vertex
-		// find it using the index
-		// the index contains only unvisited vertices
-		for(map<Distance,set<Rank> >::iterator myIterator=verticesWithDistance.begin();
-			myIterator!=verticesWithDistance.end();myIterator++){
+		uint16_t*distances=&(m_distances[(uint32_t)source*m_size]);
 
-			Distance theDistance=myIterator->first;
+		queue.clear();
+		queue.push_back(source);
+		distances[source]=0;
 
-			// we are done if all the remaining distances are greater
-			if(bestDistance!=-1 && theDistance > bestDistance)
-				break;
+		for(int head=0;head<(int)queue.size();head++){
+			Rank vertex=queue[head];
+			vector<Rank>*neighbors=&(m_outcomingLists[vertex]);
 
-			// find a vertex with the said distance
-			for(set<Rank>::iterator i=myIterator->second.begin();
-				i!=myIterator->second.end();i++){
-				Rank vertex=*i;
+			for(int i=0;i<(int)neighbors->size();i++){
+				Rank neighbor=(*neighbors)[i];
 
-				// the distance is lower or no distance
-				// was processed so far
-				if(theDistance < bestDistance || bestDistance==-1){
-					current=vertex;
-					bestDistance=tentativeDistances[vertex];
+				if(distances[neighbor]!=UNREACHABLE_DISTANCE)
+					continue;
 
-					// we can break because all the other remaining 
-					// for this distance have the same distance (obviously)
-					break;
-				}
+				distances[neighbor]=distances[vertex]+1;
+				queue.push_back(neighbor);
 			}
 		}
 	}
+}
+
+/**
+ * Shortest path that minimizes the saturation of vertices
+ * by minimizing the relay points.
+ *
+ * This is the path of Dijkstra's algorithm with weights of 1 when vertices
+ * are visited by increasing rank and when a tie on the distance goes to the
+ * previous vertex with fewer relay events.
+ * Going back from the destination, the previous vertex is thus the one
+ * one step closer to the source with the fewest relay events, and the
+ * lowest rank among those.
+ *
+ * The distances are computed for all sources on the first call.
+ */
+void GraphImplementation::findShortestPath(Rank source,Rank destination,vector<Rank>*route){
+
+	// same vertex
+	if(source==destination){
+		route->push_back(source);
+		route->push_back(destination);
+		return;
+	}
+
+	if(m_distances.size()==0)
+		computeDistances();
+
+	uint16_t*distances=&(m_distances[(uint32_t)source*m_size]);
+
+	/** this should not happen... */
+	if(distances[destination]==UNREACHABLE_DISTANCE){
+		cout<<"Error, current has no previous vertex:";
+		cout<<" there is no route between "<<source<<" and "<<destination<<endl;
+		return;
+	}
 
 	// generate the route
-	current=destination;
+	Rank current=destination;
+
 	while(current!=source){
 		route->push_back(current);
 
-		/** this should not happen... */
-		if(previousVertices.count(current)==0){
-			cout<<"Error, current has no previous vertex:";
-			cout<<" there is no route between "<<source<<" and "<<destination<<endl;
-			route->clear();
-			return;
+		vector<Rank>*candidates=&(m_incomingLists[current]);
+		Rank previous=-1;
+
+		for(int i=0;i<(int)candidates->size();i++){
+			Rank candidate=(*candidates)[i];
+
+			if(distances[candidate]+1!=distances[current])
+				continue;
+
+			if(previous==-1 || m_relayEvents[candidate]<m_relayEvents[previous])
+				previous=candidate;
 		}
 
-		current=previousVertices[current];
+		current=previous;
 	}
 
 	route->push_back(source);
@@ -208,6 +228,47 @@ void GraphImplementation::getRoute(Rank source,Rank destination,vector<Rank>*rou
 	}
 }
 
+#define SHUFFLE_LOOKAHEAD 16
+
+/**
+ * Fisher-Yates shuffle.
+ *
+ * The element at position i is swapped with an element at a position
+ * drawn in [0,i]. The draw is a hash of the seed and of i, so the
+ * permutation is the same on every rank and with any standard library.
+ * The draws are also known in advance: the elements that the next
+ * swaps use are prefetched, because with millions of pairs each swap
+ * is otherwise a cache miss.
+ */
+void GraphImplementation::shuffle(uint32_t*elements,uint32_t size,uint32_t seed){
+
+	if(size<2)
+		return;
+
+	uint64_t key=((uint64_t)seed)<<32;
+
+	// the draws of the positions from lowestDraw to the current one
+	uint32_t draws[SHUFFLE_LOOKAHEAD];
+	uint32_t lowestDraw=size;
+
+	for(uint32_t position=size-1;position>0;position--){
+
+		while(lowestDraw>1 && lowestDraw+SHUFFLE_LOOKAHEAD>position+1){
+			lowestDraw--;
+
+			uint32_t other=uniform_hashing_function_1_64_64(key|lowestDraw)%(lowestDraw+1);
+			draws[lowestDraw%SHUFFLE_LOOKAHEAD]=other;
+			__builtin_prefetch(elements+other,1);
+		}
+
+		uint32_t other=draws[position%SHUFFLE_LOOKAHEAD];
+
+		uint32_t element=elements[position];
+		elements[position]=elements[other];
+		elements[other]=element;
+	}
+}
+
 /**
  * Compute the routing tables.
  * This is done for all pairs of ranks
@@ -218,44 +279,37 @@ void GraphImplementation::computeRoutes(){
 		m_relayEvents.push_back(0);
 	}
 
-	// append empty routes
-	for(Rank i=0;i<m_size;i++){
-		vector<map<Rank,Rank> > a;
-		for(Rank j=0;j<m_size;j++){
-			map<Rank,Rank> b;
-			a.push_back(b);
-		}
-		m_routes.push_back(a);
-	}
+	uint32_t numberOfPairs=m_size*m_size;
+
+	m_routeStarts.clear();
+	m_routeLengths.clear();
+	m_routeRelays.clear();
+
+	m_routeStarts.resize(numberOfPairs,0);
+	m_routeLengths.resize(numberOfPairs,0);
 
 	#ifdef CONFIG_ROUTER_VERBOSITY
 	int step=m_size/60+1;
 	#endif
 
 	// make a liste of pairs
-	vector<vector<Rank> > pairs;
+	// a pair is source*m_size+destination
+	vector<uint32_t> pairs;
 
-	for(Rank source=0;source<m_size;source++){
-		for(Rank destination=0;destination<m_size;destination++){
-			vector<Rank> pair;
-			pair.push_back(source);
-			pair.push_back(destination);
-			pairs.push_back(pair);
-		}
-	}
+	for(uint32_t pair=0;pair<numberOfPairs;pair++)
+		pairs.push_back(pair);
 
 	// shuffle the list
 	// we need the same seed on all ranks
 	// we shuffle a lot 
-	for(int i=0;i<32;i++){
-		srand(i*i + i*i*i);
-		std::random_shuffle(pairs.begin(),pairs.end());
-	}
+	for(int i=0;i<32;i++)
+		shuffle(&(pairs[0]),numberOfPairs,i*i + i*i*i);
 
 	if(m_verbose)
 		cout<<"Computing routes, please wait..."<<endl;
 
 	int done=0;
+	vector<Rank> route;
 
 	// compute routes using the random order
 	for(int i=0;i<(int)pairs.size();i++){
@@ -263,17 +317,28 @@ void GraphImplementation::computeRoutes(){
 		if(done%100==0 && m_verbose)
 			cout<<"makeRoutes "<<done<<"/"<<pairs.size()<<" "<<done/(0.0+pairs.size())*100<<"%"<<endl;
 
-		Rank source=pairs[i][0];
-		Rank destination=pairs[i][1];
-
-		vector<Rank> route;
+		Rank source=pairs[i]/m_size;
+		Rank destination=pairs[i]%m_size;
 
+		route.clear();
 		computeRoute(source,destination,&route);
 
-		for(int i=0;i<(int)route.size()-1;i++){
-			// add the route
-			m_routes[source][destination][route[i]]=route[i+1];
-		}
+		// add the route, without the source and the destination
+		uint32_t pair=pairs[i];
+		int relays=0;
+
+		if(route.size()>2)
+			relays=route.size()-2;
+
+		#ifdef CONFIG_ASSERT
+		assert(relays<=65535);
+		#endif
+
+		m_routeStarts[pair]=m_routeRelays.size();
+		m_routeLengths[pair]=relays;
+
+		for(int i=1;i<=relays;i++)
+			m_routeRelays.push_back(route[i]);
 
 		// add the relay information
 		// the relay ranks are all the ranks in the route
@@ -289,6 +354,45 @@ void GraphImplementation::computeRoutes(){
 	}
 
 	cout<<"makeRoutes "<<done<<"/"<<pairs.size()<<" "<<done/(0.0+pairs.size())*100<<"%"<<endl;
+
+	// the distances are not needed anymore
+	vector<uint16_t> noDistances;
+	m_distances.swap(noDistances);
+
+	m_outcomingLists.clear();
+	m_incomingLists.clear();
+}
+
+Rank GraphImplementation::getNextRankInStoredRoute(Rank source,Rank destination,Rank rank){
+
+	uint32_t pair=source*m_size+destination;
+	uint32_t start=m_routeStarts[pair];
+	int relays=m_routeLengths[pair];
+
+	// the rank is the source or a relay
+	int position=0;
+
+	if(rank!=source){
+		while(position<relays && m_routeRelays[start+position]!=rank)
+			position++;
+
+		#ifdef CONFIG_ASSERT
+		assert(position<relays);
+		#endif
+
+		position++;
+	}
+
+	if(position<relays)
+		return m_routeRelays[start+position];
+
+	return destination;
+}
+
+uint64_t GraphImplementation::getRouteTableBytes(){
+	return m_routeStarts.capacity()*sizeof(uint32_t)
+		+m_routeLengths.capacity()*sizeof(uint16_t)
+		+m_routeRelays.capacity()*sizeof(Rank);
 }
 
 void GraphImplementation::computeRelayEvents(){
@@ -304,11 +408,13 @@ void GraphImplementation::computeRelayEvents(){
 		m_relayEventsFrom0.push_back(0);
 	}
 
+	vector<Rank> route;
+
 	for(Rank source=0;source<m_size;source++){
 		if(source%100==0)
 			cout<<source<<"/"<<m_size<<endl;
 		for(Rank destination=0;destination<m_size;destination++){
-			vector<Rank> route;
+			route.clear();
 			getRoute(source,destination,&route);
 
 			// add the relay information
@@ -351,3 +457,7 @@ void GraphImplementation::setVerbosity(bool verbosity){
 	m_verbose=verbosity;
 }
 
+void GraphImplementation::setNumberOfThreads(int threads){
+	m_threads=threads;
+}
+
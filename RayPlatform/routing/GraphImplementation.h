@@ -44,19 +44,25 @@ class GraphImplementation{
 protected:
 	bool m_verbose;
 
+/** the number of threads that compute the distances */
+	int m_threads;
+
 	int m_size;
 
-/** 
+/**
  * routes contained in the route tables
  *
- * data:
+ * Only the relays of a route are stored, since the source and the
+ * destination are known. The relays of the pair (source,destination)
+ * are m_routeLengths[pair] ranks starting at m_routeRelays[m_routeStarts[pair]],
+ * with pair = source*m_size+destination.
  *
- * source
- * 	destination
- * 		vertex1
- * 			vertex2
+ * This replaces a map per pair, which used gigabytes with thousands of ranks.
+ * Pairs are indexed with 32 bits.
  */
-	vector<vector<map<Rank,Rank> > > m_routes;
+	vector<uint32_t> m_routeStarts;
+	vector<uint16_t> m_routeLengths;
+	vector<Rank> m_routeRelays;
 
 /**
  * number of relays
@@ -84,13 +90,35 @@ protected:
  */
 	vector<set<Rank> > m_incomingConnections;
 
+/**
+ * Distances between all pairs of vertices (source*m_size+destination),
+ * obtained with one breadth-first search per source.
+ * They only exist while computeRoutes runs.
+ */
+	vector<uint16_t> m_distances;
+
+/** connections as lists, for the searches */
+	vector<vector<Rank> > m_outcomingLists;
+	vector<vector<Rank> > m_incomingLists;
+
+	void computeDistances();
+	void searchFromSources(int firstSource,int step);
+
+	friend void*GraphImplementation_startSearches(void*argument);
+
 	void computeRoutes();
 
+	/** get the next rank in a route stored by computeRoutes */
+	Rank getNextRankInStoredRoute(Rank source,Rank destination,Rank rank);
+
 	/** find the shortest path between a source and a destination */
 	void findShortestPath(Rank source,Rank destination,vector<Rank>*route);
 
 	void computeRelayEvents();
 
+/** shuffle elements, the permutation only depends on the seed */
+	void shuffle(uint32_t*elements,uint32_t size,uint32_t seed);
+
 	virtual void computeRoute(Rank a,Rank b,vector<Rank>*route) = 0;
 	
 public:
@@ -111,11 +139,15 @@ public:
 /**
  * Get the connections for a source
  */
-	void getOutcomingConnections(Rank source,vector<Rank>*connections);
+	virtual void getOutcomingConnections(Rank source,vector<Rank>*connections);
 
-	void getIncomingConnections(Rank rank,vector<Rank>*connections);
+	virtual void getIncomingConnections(Rank rank,vector<Rank>*connections);
 
 	void setVerbosity(bool verbosity);
+	void setNumberOfThreads(int threads);
+
+/** the number of bytes used by the route tables */
+	uint64_t getRouteTableBytes();
 
 	int getRelays(Rank rank);
 	int getRelaysTo0(Rank rank);
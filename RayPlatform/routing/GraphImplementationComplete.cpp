@@ -23,25 +23,23 @@
 
 /**
  * complete graph
+ *
+ * The connections are not stored, because every rank is connected
+ * to every other rank. With thousands of ranks, the sets used gigabytes.
  */
 void GraphImplementationComplete::makeConnections(int n){
 	m_size=n;
+}
 
-	for(int i=0;i<m_size;i++){
-		set<Rank> b;
-		m_incomingConnections.push_back(b);
-		m_outcomingConnections.push_back(b);
+void GraphImplementationComplete::getOutcomingConnections(Rank source,vector<Rank>*connections){
+	for(Rank rank=0;rank<m_size;rank++){
+		if(rank!=source)
+			connections->push_back(rank);
 	}
+}
 
-	for(Rank i=0;i<m_size;i++){
-		for(Rank j=0;j<m_size;j++){
-			if(i==j)
-				continue;
-
-			m_outcomingConnections[i].insert(j);
-			m_incomingConnections[j].insert(i);
-		}
-	}
+void GraphImplementationComplete::getIncomingConnections(Rank rank,vector<Rank>*connections){
+	getOutcomingConnections(rank,connections);
 }
 
 void GraphImplementationComplete::computeRoute(Rank a,Rank b,vector<Rank>*route){
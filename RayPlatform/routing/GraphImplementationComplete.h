@@ -40,6 +40,9 @@ public:
 
 	void makeConnections(int n);
 	void makeRoutes();
+
+	void getOutcomingConnections(Rank source,vector<Rank>*connections);
+	void getIncomingConnections(Rank rank,vector<Rank>*connections);
 };
 
 #endif
@@ -160,11 +160,7 @@ void GraphImplementationDeBruijn::computeRoute(Rank source,Rank destination,vect
 Rank GraphImplementationDeBruijn::getNextRankInRoute(Rank source,Rank destination,Rank rank){
 	#ifdef CONFIG_ROUTING_DE_BRUIJN_COMPUTE_ROUTES
 
-	#ifdef CONFIG_ASSERT
-	assert(m_routes[source][destination].count(rank)==1);
-	#endif
-
-	return m_routes[source][destination][rank];
+	return getNextRankInStoredRoute(source,destination,rank);
 
 	#else /* compute it right away */
 
@@ -45,8 +45,8 @@ int GraphImplementationGroup::getIntermediateRank(Rank rank){
  *
  * this method populates these attributes:
  *
- * 	- m_connections
- * 	- m_routes
+ * 	- m_outcomingConnections
+ * 	- m_incomingConnections
  */
 void GraphImplementationGroup::makeConnections(int n){
 	m_coresPerNode=8;
@@ -121,18 +121,28 @@ void GraphImplementationGroup::computeRoute(Rank a,Rank b,vector<Rank>*route){
 	findShortestPath(a,b,route);
 }
 
+/**
+ * Shortest paths are unique in this graph, so the next rank is
+ * computed right away instead of being stored for every pair.
+ */
 void GraphImplementationGroup::makeRoutes(){
-	computeRoutes();
-
 	computeRelayEvents();
 }
 
 Rank GraphImplementationGroup::getNextRankInRoute(Rank source,Rank destination,Rank rank){
-	#ifdef CONFIG_ASSERT
-	assert(m_routes[source][destination].count(rank)==1);
-	#endif
 
-	return m_routes[source][destination][rank];
+	// case 1 and case 2: no routing required
+	if(isConnected(rank,destination))
+		return destination;
+
+	// go to the intermediate rank of the group
+	int intermediateRank=getIntermediateRank(rank);
+
+	if(rank!=intermediateRank)
+		return intermediateRank;
+
+	// go to the intermediate rank of the destination
+	return getIntermediateRank(destination);
 }
 
 bool GraphImplementationGroup::isConnected(Rank source,Rank destination){
@@ -170,11 +170,7 @@ void GraphImplementationKautz::computeRoute(Rank source,Rank destination,vector<
 Rank GraphImplementationKautz::getNextRankInRoute(Rank source,Rank destination,Rank rank){
 	#ifdef CONFIG_ROUTING_DE_KAUTZ_COMPUTE_ROUTES
 
-	#ifdef CONFIG_ASSERT
-	assert(m_routes[source][destination].count(rank)==1);
-	#endif
-
-	return m_routes[source][destination][rank];
+	return getNextRankInStoredRoute(source,destination,rank);
 
 	#else /* compute it right away */
 
@@ -22,7 +22,6 @@
 #include "GraphImplementationRandom.h"
 
 #include <math.h> /* for log */
-#include <algorithm> /* random_shuffle */
 #include <assert.h>
 
 void GraphImplementationRandom::makeConnections(int n){
@@ -36,7 +35,7 @@ void GraphImplementationRandom::makeConnections(int n){
 
 	// create a set of all edges
 	vector<vector<Rank> > edges;
-	vector<int> identifiers;
+	vector<uint32_t> identifiers;
 	int k=0;
 	for(Rank i=0;i<m_size;i++){
 		for(Rank j=0;j<m_size;j++){
@@ -62,10 +61,8 @@ void GraphImplementationRandom::makeConnections(int n){
 
 	// shuffle the edges
 	// we shuffle a lot
-	for(int i=0;i<32;i++){
-		srand(i*i*i+2*i);
-		std::random_shuffle(identifiers.begin(),identifiers.end());
-	}
+	for(int i=0;i<32 && !identifiers.empty();i++)
+		shuffle(&(identifiers[0]),identifiers.size(),i*i*i+2*i);
 
 	// add the edges
 	int connectionsPerVertex=(int) (log(m_size)/log(2));
@@ -91,11 +88,7 @@ void GraphImplementationRandom::computeRoute(Rank a,Rank b,vector<Rank>*route){
 }
 
 Rank GraphImplementationRandom::getNextRankInRoute(Rank source,Rank destination,Rank rank){
-	#ifdef CONFIG_ASSERT
-	assert(m_routes[source][destination].count(rank)==1);
-	#endif
-
-	return m_routes[source][destination][rank];
+	return getNextRankInStoredRoute(source,destination,rank);
 }
 
 void GraphImplementationRandom::makeRoutes(){
@@ -22,6 +22,7 @@
 
 #include <RayPlatform/core/OperatingSystem.h>
 #include <RayPlatform/core/ComputeCore.h>
+#include <RayPlatform/routing/ConnectionGraph.h>
 
 #include <iostream>
 #include <assert.h>
@@ -35,7 +36,7 @@ __CreatePlugin(SwitchMan);
 __CreateMessageTagAdapter(SwitchMan,RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL);
 __CreateSlaveModeAdapter(SwitchMan,RAY_SLAVE_MODE_STOP);
 
-void SwitchMan::constructor(Rank rank,int numberOfCores){
+void SwitchMan::constructor(Rank rank,int numberOfCores,int broadcastArity,bool combineCompletions){
 
 	#ifdef CONFIG_ASSERT
 	assert(rank>=0);
@@ -44,6 +45,55 @@ void SwitchMan::constructor(Rank rank,int numberOfCores){
 
 	m_rank=rank;
 	m_size=numberOfCores;
+
+	m_broadcastArity=broadcastArity;
+
+	if(m_broadcastArity<0)
+		m_broadcastArity=0;
+
+	// the signals are combined along the broadcast tree
+	m_combineCompletions=combineCompletions && m_broadcastArity>0;
+
+	if(combineCompletions && !m_combineCompletions && m_rank==MASTER_RANK)
+		cout<<"[SwitchMan] Warning: completion signals are only combined with a broadcast tree"<<endl;
+
+	m_currentPendingBroadcast=0;
+	m_nextBroadcastDestination=0;
+
+/*
+ * In a k-ary tree rooted at MASTER_RANK, the descendants of a rank at
+ * a given depth are contiguous, so the subtree is counted level by level.
+ */
+	m_subtreeSize=1;
+	m_completionParent=MASTER_RANK;
+
+	if(m_combineCompletions){
+		if(m_rank!=MASTER_RANK)
+			m_completionParent=(m_rank-1)/m_broadcastArity;
+
+		m_subtreeSize=0;
+
+		int first=m_rank;
+		int last=m_rank;
+
+		while(first<m_size){
+			if(last>=m_size)
+				last=m_size-1;
+
+			m_subtreeSize+=last-first+1;
+
+			first=first*m_broadcastArity+1;
+			last=last*m_broadcastArity+m_broadcastArity;
+		}
+	}
+
+	m_subtreeCompletions=0;
+
+	m_waitingForCompletions=false;
+	m_completedMasterModes=0;
+	m_totalCompletionMicroseconds=0;
+	m_maximumCompletionMicroseconds=0;
+
 	reset();
 
 	#ifdef CONFIG_ASSERT
@@ -65,7 +115,21 @@ bool SwitchMan::allRanksAreReady(){
 	runAssertions();
 	#endif
 
-	return m_counter==m_size;
+	bool ready=(m_counter==m_size);
+
+	if(ready && m_waitingForCompletions){
+		uint64_t elapsed=getMicroseconds()-m_openingTime;
+
+		m_completedMasterModes++;
+		m_totalCompletionMicroseconds+=elapsed;
+
+		if(elapsed>m_maximumCompletionMicroseconds)
+			m_maximumCompletionMicroseconds=elapsed;
+
+		m_waitingForCompletions=false;
+	}
+
+	return ready;
 }
 
 void SwitchMan::closeSlaveMode(Rank source){
@@ -134,7 +198,10 @@ void SwitchMan::closeSlaveModeLocally(StaticVector*outbox,Rank source){
 	cout<<"[SwitchMan::closeSlaveModeLocally] Closing locally slave mode on rank "<<source<<endl;
 	#endif
 
-	sendEmptyMessage(outbox,source,MASTER_RANK,RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL);
+	if(!m_combineCompletions)
+		sendEmptyMessage(outbox,source,MASTER_RANK,RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL);
+	else
+		reportCompletions(outbox,1);
 
 	// set the slave mode to do nothing
 	// that is not productive...
@@ -164,12 +231,13 @@ void SwitchMan::openMasterMode(StaticVector*outbox,Rank source){
 	#endif
 
 	// open the slave mode on each MPI rank
-	for(Rank i=0;i<m_size;i++){
-		openSlaveMode(tag,outbox,source,i);
-	}
+	sendToAll(outbox,source,tag);
 
 	// reset the counter
 	reset();
+
+	m_openingTime=getMicroseconds();
+	m_waitingForCompletions=true;
 }
 
 void SwitchMan::closeMasterMode(){
@@ -215,10 +283,254 @@ void SwitchMan::sendToAll(StaticVector*outbox,Rank source,MessageTag tag){
 	sendMessageToAll(NULL,0,outbox,source,tag);
 }
 
+/*
+ * With a broadcast tree, the source only sends the message to itself and
+ * to its children. The others get a RAY_MPI_TAG_SWITCHMAN_BROADCAST message
+ * that carries the original tag and the root in front of the payload and
+ * that is relayed by relayBroadcast when it is received.
+ *
+ * A payload that leaves no room for the tag and the root is sent
+ * directly to every rank. These messages are sent by
+ * sendPendingBroadcasts with the room that is left at each tick,
+ * so that they do not take the room of the relayed messages.
+ * The broadcasts that follow wait behind it, so that they are received
+ * in the same order.
+ */
 void SwitchMan::sendMessageToAll(MessageUnit*buffer,int count,StaticVector*outbox,Rank source,MessageTag tag){
-	for(int i=0;i<m_size;i++){
-		sendMessage(buffer,count,outbox,source,i,tag);
+
+	int maximumCount=MAXIMUM_MESSAGE_SIZE_IN_BYTES/sizeof(MessageUnit);
+
+	if(m_broadcastArity==0 || m_size==1){
+		for(int i=0;i<m_size;i++){
+			sendMessage(buffer,count,outbox,source,i,tag);
+		}
+		return;
+	}
+
+	if(count+2>maximumCount || hasPendingBroadcasts()){
+
+		// the payloads of the broadcasts that were sent are copied in outbox buffers already
+		if(!hasPendingBroadcasts()){
+			m_pendingBroadcastUnits.clear();
+			m_pendingBroadcastOffsets.clear();
+			m_pendingBroadcastCounts.clear();
+			m_pendingBroadcastTags.clear();
+			m_pendingBroadcastSources.clear();
+			m_currentPendingBroadcast=0;
+		}
+
+		m_pendingBroadcastOffsets.push_back(m_pendingBroadcastUnits.size());
+		m_pendingBroadcastCounts.push_back(count);
+		m_pendingBroadcastTags.push_back(tag);
+		m_pendingBroadcastSources.push_back(source);
+
+		for(int i=0;i<count;i++)
+			m_pendingBroadcastUnits.push_back(buffer[i]);
+
+		return;
 	}
+
+	#ifdef CONFIG_ASSERT
+	assert(source==m_rank);
+	assert(count>=0);
+	#endif
+
+	MessageUnit*wrapped=(MessageUnit*)m_core->getOutboxAllocator()->allocate((count+2)*sizeof(MessageUnit));
+
+	wrapped[0]=tag;
+	wrapped[1]=source;
+
+	for(int i=0;i<count;i++)
+		wrapped[2+i]=buffer[i];
+
+	sendMessage(buffer,count,outbox,source,source,tag);
+
+	forwardBroadcast(wrapped,count+2,outbox,source);
+}
+
+bool SwitchMan::hasPendingBroadcasts(){
+	return m_currentPendingBroadcast<(int)m_pendingBroadcastCounts.size();
+}
+
+/*
+ * The payloads stay in m_pendingBroadcastUnits until the ComputeCore
+ * has copied the messages in outbox buffers, so they are only released
+ * by the next large broadcast.
+ */
+void SwitchMan::sendPendingBroadcasts(StaticVector*outbox,int maximumMessages){
+
+	int sent=0;
+
+	while(sent<maximumMessages && hasPendingBroadcasts()){
+		int broadcast=m_currentPendingBroadcast;
+		MessageUnit*buffer=NULL;
+
+		if(m_pendingBroadcastCounts[broadcast]>0)
+			buffer=&(m_pendingBroadcastUnits[m_pendingBroadcastOffsets[broadcast]]);
+
+		sendMessage(buffer,m_pendingBroadcastCounts[broadcast],outbox,m_pendingBroadcastSources[broadcast],
+			m_nextBroadcastDestination,m_pendingBroadcastTags[broadcast]);
+
+		sent++;
+		m_nextBroadcastDestination++;
+
+		if(m_nextBroadcastDestination==m_size){
+			m_nextBroadcastDestination=0;
+			m_currentPendingBroadcast++;
+		}
+	}
+}
+
+void SwitchMan::relayBroadcast(Message*message,StaticVector*outbox){
+
+	if(message->getTag()!=RAY_MPI_TAG_SWITCHMAN_BROADCAST)
+		return;
+
+	MessageUnit*buffer=message->getBuffer();
+	int count=message->getCount();
+
+	#ifdef CONFIG_ASSERT
+	assert(count>=2);
+	assert((int)buffer[1]<m_size);
+	#endif
+
+	Rank root=buffer[1];
+
+	forwardBroadcast(buffer,count,outbox,root);
+
+	// deliver it locally as if the root had sent it directly
+	message->setTag(buffer[0]);
+	message->setSource(root);
+	message->setBuffer(buffer+2);
+	message->setCount(count-2);
+}
+
+Rank SwitchMan::getTreeIndex(Rank rank,Rank root){
+	return (rank-root+m_size)%m_size;
+}
+
+Rank SwitchMan::getTreeRank(int index,Rank root){
+	return (index+root)%m_size;
+}
+
+void SwitchMan::forwardBroadcast(MessageUnit*buffer,int count,StaticVector*outbox,Rank root){
+
+	int index=getTreeIndex(m_rank,root);
+
+	int first=index*m_broadcastArity+1;
+	int last=index*m_broadcastArity+m_broadcastArity;
+
+	for(int child=first;child<=last && child<m_size;child++){
+		sendMessage(buffer,count,outbox,m_rank,getTreeRank(child,root),
+			RAY_MPI_TAG_SWITCHMAN_BROADCAST);
+	}
+}
+
+/*
+ * The completion signals go up a tree rooted at MASTER_RANK: the k-ary
+ * tree of the broadcast or, with a graph, the routes to MASTER_RANK.
+ * A rank sends one signal with the size of its subtree once it and all
+ * its descendants are done, so MASTER_RANK receives at most k signals.
+ *
+ * The signal of a rank no longer follows its other messages to
+ * MASTER_RANK, so these can still be in flight when allRanksAreReady
+ * returns true. This is why it is only done with -combine-completions.
+ */
+void SwitchMan::reportCompletions(StaticVector*outbox,int completions){
+
+	if(m_rank==MASTER_RANK){
+		m_counter+=completions;
+
+		#ifdef CONFIG_ASSERT
+		runAssertions();
+		#endif
+
+		return;
+	}
+
+	m_subtreeCompletions+=completions;
+
+	#ifdef CONFIG_ASSERT
+	assert(m_subtreeCompletions<=m_subtreeSize);
+	#endif
+
+	if(m_subtreeCompletions<m_subtreeSize)
+		return;
+
+	MessageUnit*buffer=(MessageUnit*)m_core->getOutboxAllocator()->allocate(sizeof(MessageUnit));
+	buffer[0]=m_subtreeCompletions;
+
+	sendMessage(buffer,1,outbox,m_rank,m_completionParent,RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL);
+
+	m_subtreeCompletions=0;
+}
+
+int SwitchMan::getBroadcastArity(){
+	return m_broadcastArity;
+}
+
+/*
+ * With message routing, a rank can only talk to its neighbours: any other
+ * message is relayed. The parent of a rank is then the first hop of its
+ * route to MASTER_RANK, so each completion signal travels over one link
+ * and the signals are combined by the ranks that would relay them anyway.
+ *
+ * Every rank walks the routes of all the ranks to count its subtree.
+ * This is done once, when the graph is started.
+ */
+void SwitchMan::setConnectionGraph(ConnectionGraph*graph){
+
+	if(!m_combineCompletions)
+		return;
+
+	vector<Rank> parents;
+
+	for(Rank rank=0;rank<m_size;rank++){
+		if(rank==MASTER_RANK)
+			parents.push_back(MASTER_RANK);
+		else
+			parents.push_back(graph->getNextRankInRoute(rank,MASTER_RANK,rank));
+	}
+
+	int subtreeSize=0;
+
+	for(Rank rank=0;rank<m_size;rank++){
+		Rank current=rank;
+		int hops=0;
+
+		while(current!=MASTER_RANK && current!=m_rank && hops<m_size){
+			current=parents[current];
+			hops++;
+		}
+
+		// the routes must form a tree, otherwise keep the k-ary tree
+		if(hops==m_size){
+			cout<<"[SwitchMan] Warning: the routes to rank "<<MASTER_RANK<<" are not a tree, ";
+			cout<<"completion signals will use the "<<m_broadcastArity<<"-ary tree"<<endl;
+			return;
+		}
+
+		if(current==m_rank)
+			subtreeSize++;
+	}
+
+	#ifdef CONFIG_ASSERT
+	assert(subtreeSize>=1);
+	assert(m_rank!=MASTER_RANK || subtreeSize==m_size);
+	#endif
+
+	m_completionParent=parents[m_rank];
+	m_subtreeSize=subtreeSize;
+}
+
+void SwitchMan::printStatus(){
+
+	if(m_completedMasterModes==0)
+		return;
+
+	cout<<"[SwitchMan] Rank "<<m_rank<<" completed "<<m_completedMasterModes<<" master modes on ";
+	cout<<m_size<<" ranks, average latency: "<<m_totalCompletionMicroseconds/m_completedMasterModes;
+	cout<<" microseconds, maximum latency: "<<m_maximumCompletionMicroseconds<<" microseconds"<<endl;
 }
 
 void SwitchMan::openSlaveModeLocally(MessageTag tag,Rank rank){
@@ -281,6 +593,10 @@ void SwitchMan::setMasterMode(MasterMode mode){
 		m_lastMasterMode=mode;
 }
 
+bool SwitchMan::isIdle(){
+	return m_masterMode==RAY_MASTER_MODE_DO_NOTHING && m_slaveMode==RAY_SLAVE_MODE_DO_NOTHING;
+}
+
 int*SwitchMan::getMasterModePointer(){
 	void*pointer= &m_masterMode;
 	return(int*)pointer;
@@ -304,7 +620,14 @@ int SwitchMan::getSize(){
 
 /* the switch man do the accounting for ready ranks */
 void SwitchMan::call_RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL(Message*message){
-	closeSlaveMode(message->getSource());
+
+	// an empty signal comes from a single rank
+	if(!m_combineCompletions || message->getCount()==0){
+		closeSlaveMode(message->getSource());
+		return;
+	}
+
+	reportCompletions(m_core->getOutbox(),message->getBuffer()[0]);
 }
 
 void SwitchMan::call_RAY_SLAVE_MODE_STOP(){
@@ -334,6 +657,10 @@ void SwitchMan::registerPlugin(ComputeCore*core){
 
 	core->setMessageTagSymbol(m_plugin,RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL,"RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL");
 
+	// no handler: these messages are unwrapped by relayBroadcast before the dispatch
+	RAY_MPI_TAG_SWITCHMAN_BROADCAST=core->allocateMessageTagHandle(m_plugin);
+	core->setMessageTagSymbol(m_plugin,RAY_MPI_TAG_SWITCHMAN_BROADCAST,"RAY_MPI_TAG_SWITCHMAN_BROADCAST");
+
 	// set default modes
 	// these symbols are resolved already
 	
@@ -349,6 +676,7 @@ void SwitchMan::resolveSymbols(ComputeCore*core){
 	RAY_MASTER_MODE_DO_NOTHING=core->getMasterModeFromSymbol(m_plugin,"RAY_MASTER_MODE_DO_NOTHING");
 
 	RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL=core->getMessageTagFromSymbol(m_plugin,"RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL");
+	RAY_MPI_TAG_SWITCHMAN_BROADCAST=core->getMessageTagFromSymbol(m_plugin,"RAY_MPI_TAG_SWITCHMAN_BROADCAST");
 
 	__BindPlugin(SwitchMan);
 	
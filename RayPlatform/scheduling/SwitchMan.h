@@ -35,6 +35,7 @@
 using namespace std;
 
 class ComputeCore;
+class ConnectionGraph;
 class SwitchMan;
 
 __DeclareMessageTagAdapter(SwitchMan,RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL);
@@ -54,6 +55,7 @@ class SwitchMan: public CorePlugin {
 	ComputeCore*m_core;
 
 	MessageTag RAY_MPI_TAG_SWITCHMAN_COMPLETION_SIGNAL;
+	MessageTag RAY_MPI_TAG_SWITCHMAN_BROADCAST;
 
 	MasterMode RAY_MASTER_MODE_DO_NOTHING;
 	SlaveMode RAY_SLAVE_MODE_DO_NOTHING;
@@ -77,6 +79,49 @@ class SwitchMan: public CorePlugin {
 /** a counter to check progression */
 	int m_counter;
 
+/** number of children of each rank in the broadcast and completion trees,
+ * 0 means that rank 0 talks to every rank directly */
+	int m_broadcastArity;
+
+/** true when the completion signals are combined along the tree,
+ * otherwise each rank reports directly to MASTER_RANK */
+	bool m_combineCompletions;
+
+/** the rank that receives the completion signals of this subtree */
+	Rank m_completionParent;
+
+/** number of ranks in the completion subtree rooted at this rank */
+	int m_subtreeSize;
+
+/** completions received from the subtree and not yet sent to the parent */
+	int m_subtreeCompletions;
+
+/** time at which the current master mode was opened */
+	uint64_t m_openingTime;
+
+/** true between openMasterMode and the moment all ranks are ready */
+	bool m_waitingForCompletions;
+
+/*
+ * A broadcast that is too large for the tree is sent to every rank
+ * directly, a few messages per tick: its payload is copied here and
+ * the ComputeCore takes the messages when it has room in its outbox.
+ */
+	vector<MessageUnit> m_pendingBroadcastUnits;
+	vector<int> m_pendingBroadcastOffsets;
+	vector<int> m_pendingBroadcastCounts;
+	vector<MessageTag> m_pendingBroadcastTags;
+	vector<Rank> m_pendingBroadcastSources;
+
+/** the broadcast being sent and its next destination */
+	int m_currentPendingBroadcast;
+	Rank m_nextBroadcastDestination;
+
+/** statistics on the time needed to complete master modes */
+	uint64_t m_completedMasterModes;
+	uint64_t m_totalCompletionMicroseconds;
+	uint64_t m_maximumCompletionMicroseconds;
+
 /** a list of switches describing the order of the master modes */
 	map<MasterMode,MasterMode> m_switches;
 
@@ -89,10 +134,24 @@ class SwitchMan: public CorePlugin {
 /** run some assertions */
 	void runAssertions();
 
+/** the position of a rank in a tree rooted at root */
+	Rank getTreeIndex(Rank rank,Rank root);
+
+/** the rank at a position in a tree rooted at root */
+	Rank getTreeRank(int index,Rank root);
+
+/** send a wrapped broadcast to the children of this rank in the tree rooted at root */
+	void forwardBroadcast(MessageUnit*buffer,int count,StaticVector*outbox,Rank root);
+
+/** account for completed ranks and report them to the parent once the whole subtree is done */
+	void reportCompletions(StaticVector*outbox,int completions);
+
 public:
 
-/** the switchman is constructed with a number of cores */
-	void constructor(int rank,int numberOfRanks);
+/** the switchman is constructed with a number of cores,
+ * the arity of the broadcast tree and whether the completion
+ * signals are combined along this tree */
+	void constructor(int rank,int numberOfRanks,int broadcastArity,bool combineCompletions);
 
 /** reset */
 	void reset();
@@ -154,6 +213,9 @@ public:
 /** get the master mode pointer */
 	int*getMasterModePointer();
 
+/** returns true if the master mode and the slave mode do nothing */
+	bool isIdle();
+
 /** changes the master mode manually */
 	void setMasterMode(MasterMode mode);
 
@@ -163,6 +225,27 @@ public:
 /** send a message to all MPI ranks, possibly with data */
 	void sendMessageToAll(MessageUnit*buffer,int count,StaticVector*outbox,Rank source,MessageTag tag);
 
+/** are there large broadcasts that are not completely sent ? */
+	bool hasPendingBroadcasts();
+
+/** put at most maximumMessages messages of the large broadcasts in the outbox,
+ * this is called before sending the outbox at each tick */
+	void sendPendingBroadcasts(StaticVector*outbox,int maximumMessages);
+
+/** relay a received tree broadcast to the children of this rank and
+ * turn it back into the original message for local delivery */
+	void relayBroadcast(Message*message,StaticVector*outbox);
+
+/** get the arity of the broadcast tree */
+	int getBroadcastArity();
+
+/** send the completion signals along the routes of the graph instead
+ * of the k-ary tree */
+	void setConnectionGraph(ConnectionGraph*graph);
+
+/** print the completion latency of master modes */
+	void printStatus();
+
 	void addMasterMode(MasterMode masterMode);
 
 	vector<MasterMode>*getMasterModeOrder();
@@ -31,61 +31,30 @@ using namespace std;
 
 /* #define DEBUG_VIRTUAL_PROCESSOR */
 
+/** called at the end of each pass on the ready workers */
 void VirtualProcessor::updateStates(){
 	#ifdef DEBUG_VIRTUAL_PROCESSOR
-	cout<<"Removing "<<m_workersDone.size()<<" workers done."<<endl;
+	cout<<"Removing "<<m_sizes[VIRTUAL_PROCESSOR_DONE]<<" workers done."<<endl;
 	#endif
 
-	// erase completed jobs
-	for(int i=0;i<(int)m_workersDone.size();i++){
-		WorkerHandle workerId=m_workersDone[i];
+	/* the workers done were destroyed by their owner, free their slots */
+	while(m_heads[VIRTUAL_PROCESSOR_DONE]!=-1){
+		int slot=m_heads[VIRTUAL_PROCESSOR_DONE];
 
-		#ifdef CONFIG_ASSERT
-		assert(m_activeWorkers.count(workerId)>0);
-		assert(m_aliveWorkers.count(workerId)>0);
-		#endif
+		m_slots.erase(m_handles[slot]);
+		m_workers[slot]=NULL;
 
-		m_activeWorkers.erase(workerId);
-		m_aliveWorkers.erase(workerId);
+		moveToList(slot,VIRTUAL_PROCESSOR_FREE);
 
 		m_completedJobs++;
 	}
-	m_workersDone.clear();
-
-	#ifdef DEBUG_VIRTUAL_PROCESSOR
-	cout<<"Moving "<<m_waitingWorkers.size()<<" workers to sleep mode."<<endl;
-	#endif
-
-	/** make some worker sleep */
-	for(int i=0;i<(int)m_waitingWorkers.size();i++){
-		WorkerHandle workerId=m_waitingWorkers[i];
-
-		#ifdef CONFIG_ASSERT
-		assert(m_activeWorkers.count(workerId)>0);
-		#endif
-
-		m_activeWorkers.erase(workerId);
-	}
-	m_waitingWorkers.clear();
-
-	#ifdef DEBUG_VIRTUAL_PROCESSOR
-	cout<<"Moving "<<m_activeWorkersToRestore.size()<<" workers to active mode"<<endl;
-	#endif
-
-	/** wake up some workers */
-	for(int i=0;i<(int)m_activeWorkersToRestore.size();i++){
-		WorkerHandle workerId=m_activeWorkersToRestore[i];
-		m_activeWorkers.insert(workerId);
-	}
-
-	m_activeWorkersToRestore.clear();
 
 	m_virtualCommunicator->resetGlobalPushedMessageStatus();
 
 	#ifdef DEBUG_VIRTUAL_PROCESSOR
-	int activeWorkers=m_activeWorkers.size();
-	int aliveWorkers=m_aliveWorkers.size();
-	int sleepingWorkers=aliveWorkers-activeWorkers;
+	int activeWorkers=m_sizes[VIRTUAL_PROCESSOR_READY];
+	int aliveWorkers=getNumberOfAliveWorkers();
+	int sleepingWorkers=m_sizes[VIRTUAL_PROCESSOR_SLEEPING];
 	cout<<"VirtualProcessor statistics: active: "<<activeWorkers<<" sleeping: "<<sleepingWorkers<<" total: "<<aliveWorkers<<endl;
 	#endif
 }
@@ -105,6 +74,23 @@ void VirtualProcessor::constructor(StaticVector*outbox,StaticVector*inbox,RingAl
 
 	/** the maximum number of workers on this VirtualProcessor */
 	m_maximumAliveWorkers=32768; /* 2**15 */
+	m_maximumWorkers=0;
+	m_workerSwitches=0;
+	m_currentSlot=-1;
+
+	m_workers.clear();
+	m_handles.clear();
+	m_lists.clear();
+	m_next.clear();
+	m_previous.clear();
+
+	for(int list=0;list<VIRTUAL_PROCESSOR_LISTS;list++){
+		m_heads[list]=-1;
+		m_tails[list]=-1;
+		m_sizes[list]=0;
+	}
+
+	m_slots.constructor(1024);
 
 	reset();
 }
@@ -114,91 +100,67 @@ bool VirtualProcessor::run(){
 
 	if(!m_initiatedIterator){
 
-		m_activeWorkerIterator=m_activeWorkers.begin();
+		m_nextSlot=m_heads[VIRTUAL_PROCESSOR_READY];
 		m_initiatedIterator=true;
 	}
 
 	/** fetch the message from the inbox and de-multiplex it if necessary */
 	m_virtualCommunicator->processInbox(&m_activeWorkersToRestore);
 
+	/** wake up the workers that received their reply */
+	for(int i=0;i<(int)m_activeWorkersToRestore.size();i++){
+		int slot=m_slots.find(m_activeWorkersToRestore[i]);
+
+		#ifdef CONFIG_ASSERT
+		assert(slot!=-1);
+		assert(m_lists[slot]==VIRTUAL_PROCESSOR_SLEEPING);
+		#endif
+
+		moveToList(slot,VIRTUAL_PROCESSOR_READY);
+	}
+
+	m_activeWorkersToRestore.clear();
+
 	/** if the VirtualCommunicator is not ready, return immediately */
 	if(!m_virtualCommunicator->isReady()){
 		return false;
 	}
 
 	/** make the current worker work */
-	if(m_activeWorkerIterator!=m_activeWorkers.end()){
-		WorkerHandle workerId=*m_activeWorkerIterator;
+	if(m_nextSlot!=-1){
+		int slot=m_nextSlot;
 
-		/** save the current worker identifier */
-		m_currentWorker=workerId;
+		/** save the current worker */
+		m_currentSlot=slot;
 
 		#ifdef CONFIG_ASSERT
-		if(m_aliveWorkers.count(workerId)==0){
-			cout<<"Error: "<<workerId<<" is not in alive workers "<<m_activeWorkers.size()<<endl;
-		}
-		assert(m_aliveWorkers.count(workerId)>0);
-		assert(!m_aliveWorkers[workerId]->isDone());
+		assert(m_lists[slot]==VIRTUAL_PROCESSOR_READY);
+		assert(m_workers[slot]!=NULL);
+		assert(!m_workers[slot]->isDone());
 		#endif
 		m_virtualCommunicator->resetLocalPushedMessageStatus();
 
 		/* make the worker work a little bit */
-		m_aliveWorkers[workerId]->work();
+		m_workers[slot]->work();
+		m_workerSwitches++;
 
-		//force the worker to work until he finishes or pushes something on the stack
-		/*
-		while(!m_aliveWorkers[workerId]->isDone()&&!m_virtualCommunicator->getLocalPushedMessageStatus()){
-		}
-		*/
+		// the slot is moved below, get its successor first
+		m_nextSlot=m_next[slot];
 
 		if(m_virtualCommunicator->getLocalPushedMessageStatus()){
-			m_waitingWorkers.push_back(workerId);
-		}else if(m_aliveWorkers[workerId]->isDone()){
-			m_workersDone.push_back(workerId);
+			moveToList(slot,VIRTUAL_PROCESSOR_SLEEPING);
+		}else if(m_workers[slot]->isDone()){
+			moveToList(slot,VIRTUAL_PROCESSOR_DONE);
 		} 
 
-		m_activeWorkerIterator++;
-
 		return true;
 	}else{
 		updateStates();
 
-#if 0
-		//  add one worker to active workers
-		//  reason is that those already in the pool don't communicate anymore -- 
-		//  as for they need responses.
-		if(!m_virtualCommunicator->getGlobalPushedMessageStatus() && m_activeWorkers.empty()){
-			/** if no more worker will be added, we need to forceFlush */
-
-			bool noMoreWorkerCanBeAdded=false;
-
-			/* we have a full array of idle workers */
-			if(!canAddWorker()){
-				noMoreWorkerCanBeAdded=true;
-			}
-
-			/* we have space to add further workers, but no workers will be added in the future */
-			if(canAddWorker() && !m_moreTasksAreComing){
-				noMoreWorkerCanBeAdded=true;
-			}
-
-			/* we have to force-flush something to get rid of these endless waiting */
-			if(noMoreWorkerCanBeAdded){
-				#ifdef DEBUG_VIRTUAL_PROCESSOR
-				cout<<"VirtualProcessor: calling forceFlush on VirtualCommunicator"<<endl;
-				#endif
-
-				m_virtualCommunicator->forceFlush();
-			}
-		}
-#endif
-
-		// always flush a message every time we looped over every actors
-		// if no message was flushed.
 		if(!m_virtualCommunicator->getGlobalPushedMessageStatus())
 			m_virtualCommunicator->forceFlush();
 
-		m_activeWorkerIterator=m_activeWorkers.begin();
+		m_nextSlot=m_heads[VIRTUAL_PROCESSOR_READY];
 
 		return false;
 	}
@@ -209,15 +171,16 @@ bool VirtualProcessor::run(){
 /** get the current worker */
 Worker*VirtualProcessor::getCurrentWorker(){
 	#ifdef CONFIG_ASSERT
-	assert(m_aliveWorkers.count(m_currentWorker) > 0);
+	assert(m_currentSlot>=0 && m_currentSlot<(int)m_workers.size());
+	assert(m_workers[m_currentSlot]!=NULL);
 	#endif
 
-	return m_aliveWorkers[m_currentWorker];
+	return m_workers[m_currentSlot];
 }
 
 /** can a worker be added ? */
 bool VirtualProcessor::canAddWorker(){
-	return (int)m_aliveWorkers.size() < m_maximumAliveWorkers;
+	return getNumberOfAliveWorkers() < m_maximumAliveWorkers;
 }
 
 /** add a worker */
@@ -229,15 +192,32 @@ void VirtualProcessor::addWorker(Worker*worker){
 	WorkerHandle workerId=worker->getWorkerIdentifier();
 
 	#ifdef CONFIG_ASSERT
-	if(m_aliveWorkers.count(workerId)>0)
+	if(m_slots.find(workerId)!=-1)
 		cout<<"Worker "<<workerId<<" already here"<<endl;
-	assert(m_aliveWorkers.count(workerId) == 0);
+	assert(m_slots.find(workerId)==-1);
 	#endif
 
-	m_aliveWorkers[workerId]=worker;
-	m_activeWorkers.insert(workerId);
+	int slot=m_heads[VIRTUAL_PROCESSOR_FREE];
+
+	if(slot!=-1){
+		removeFromList(slot);
+	}else{
+		slot=m_workers.size();
+
+		m_workers.push_back(NULL);
+		m_handles.push_back(0);
+		m_lists.push_back(-1);
+		m_next.push_back(-1);
+		m_previous.push_back(-1);
+	}
+
+	m_workers[slot]=worker;
+	m_handles[slot]=workerId;
+	m_slots.insert(workerId,slot);
+
+	appendToList(slot,VIRTUAL_PROCESSOR_READY);
 
-	int population=m_aliveWorkers.size();
+	int population=getNumberOfAliveWorkers();
 	if(population>m_maximumWorkers){
 		m_maximumWorkers=population;
 	}
@@ -250,17 +230,66 @@ void VirtualProcessor::noMoreTasksAreComing(){
 void VirtualProcessor::reset(){
 	m_moreTasksAreComing=true;
 	m_initiatedIterator=false;
+	m_nextSlot=-1;
 	m_completedJobs=0;
 }
 
 bool VirtualProcessor::hasWorkToDo(){
-	return m_aliveWorkers.size()>0;
+	return getNumberOfAliveWorkers()>0;
 }
 
 void VirtualProcessor::printStatistics(){
-	cout<<"VirtualProcessor: completed jobs: "<<m_completedJobs<<endl;
+	cout<<"VirtualProcessor: completed jobs: "<<m_completedJobs<<" worker switches: "<<m_workerSwitches<<endl;
 
 	m_virtualCommunicator->printStatistics();
 }
 
+int VirtualProcessor::getNumberOfAliveWorkers(){
+	return m_sizes[VIRTUAL_PROCESSOR_READY]+m_sizes[VIRTUAL_PROCESSOR_SLEEPING]
+		+m_sizes[VIRTUAL_PROCESSOR_DONE];
+}
+
+void VirtualProcessor::appendToList(int slot,int list){
+	int tail=m_tails[list];
+
+	m_lists[slot]=list;
+	m_next[slot]=-1;
+	m_previous[slot]=tail;
 
+	if(tail==-1)
+		m_heads[list]=slot;
+	else
+		m_next[tail]=slot;
+
+	m_tails[list]=slot;
+	m_sizes[list]++;
+}
+
+void VirtualProcessor::removeFromList(int slot){
+	int list=m_lists[slot];
+
+	#ifdef CONFIG_ASSERT
+	assert(list>=0 && list<VIRTUAL_PROCESSOR_LISTS);
+	#endif
+
+	int previous=m_previous[slot];
+	int next=m_next[slot];
+
+	if(previous==-1)
+		m_heads[list]=next;
+	else
+		m_next[previous]=next;
+
+	if(next==-1)
+		m_tails[list]=previous;
+	else
+		m_previous[next]=previous;
+
+	m_sizes[list]--;
+	m_lists[slot]=-1;
+}
+
+void VirtualProcessor::moveToList(int slot,int list){
+	removeFromList(slot);
+	appendToList(slot,list);
+}
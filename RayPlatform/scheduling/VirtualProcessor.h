@@ -24,11 +24,18 @@
 #include <RayPlatform/memory/RingAllocator.h>
 #include <RayPlatform/scheduling/Worker.h>
 #include <RayPlatform/structures/StaticVector.h>
+#include <RayPlatform/structures/HandleTable.h>
 
-#include <set>
 #include <vector>
 using namespace std;
 
+/* the lists of worker slots */
+#define VIRTUAL_PROCESSOR_READY 0
+#define VIRTUAL_PROCESSOR_SLEEPING 1
+#define VIRTUAL_PROCESSOR_DONE 2
+#define VIRTUAL_PROCESSOR_FREE 3
+#define VIRTUAL_PROCESSOR_LISTS 4
+
 /* workflow:
 
 design by Sébastien Boisvert
@@ -83,22 +90,41 @@ work()
 */
 class VirtualProcessor{
 
-	WorkerHandle m_currentWorker;
+/** the slot of the current worker */
+	int m_currentSlot;
 
 	bool m_moreTasksAreComing;
 
 	bool m_initiatedIterator;
-	set<WorkerHandle> m_activeWorkers;
-	set<WorkerHandle>::iterator m_activeWorkerIterator;
+
+/** the next ready slot to run in the current pass, -1 at the end of the pass */
+	int m_nextSlot;
+
 	int m_completedJobs;
 	int m_maximumAliveWorkers;
 	int m_maximumWorkers;
+	uint64_t m_workerSwitches;
 	bool m_communicatorWasTriggered;
-	vector<WorkerHandle> m_workersDone;
-	vector<WorkerHandle> m_waitingWorkers;
 	vector<WorkerHandle> m_activeWorkersToRestore;
 
-	map<WorkerHandle,Worker*> m_aliveWorkers;
+/*
+ * Each worker has a slot. A slot is in exactly one list at any time:
+ * the ready workers, the sleeping workers (they wait for a reply of the
+ * VirtualCommunicator), the workers done during the current pass, or the
+ * free slots. The lists are doubly linked through the slots, so moving a
+ * worker is O(1).
+ */
+	vector<Worker*> m_workers;
+	vector<WorkerHandle> m_handles;
+	vector<int> m_lists;
+	vector<int> m_next;
+	vector<int> m_previous;
+	int m_heads[VIRTUAL_PROCESSOR_LISTS];
+	int m_tails[VIRTUAL_PROCESSOR_LISTS];
+	int m_sizes[VIRTUAL_PROCESSOR_LISTS];
+
+/** the slot of each worker handle */
+	HandleTable m_slots;
 
 	StaticVector*m_inbox;
 	StaticVector*m_outbox;
@@ -107,6 +133,11 @@ class VirtualProcessor{
 
 	void updateStates();
 
+	void appendToList(int slot,int list);
+	void removeFromList(int slot);
+	void moveToList(int slot,int list);
+	int getNumberOfAliveWorkers();
+
 public:
 	/** actually initialize the VirtualProcessor */
 	void constructor(StaticVector*outbox,StaticVector*inbox,RingAllocator*outboxAllocator,
@@ -23,6 +23,7 @@
 #include "KeyValueStore.h"
 
 #include <RayPlatform/core/ComputeCore.h>
+#include <RayPlatform/core/OperatingSystem.h>
 #include <RayPlatform/cryptography/crypto.h>
 
 #include <string.h> /* for memcpy */
@@ -40,6 +41,8 @@ __CreateMessageTagAdapter(KeyValueStore, RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT
 
 KeyValueStore::KeyValueStore() {
 
+	m_window = 1;
+
 	clear();
 }
 
@@ -52,10 +55,12 @@ void KeyValueStore::pullRemoteKey(const string & key, const Rank & rank, KeyValu
 
 	request.initialize(key, rank);
 	request.setTypeToPullRequest();
+	request.startTransfer(getMicroseconds());
 
 }
 
-void KeyValueStore::initialize(Rank rank, int size, RingAllocator * outboxAllocator, StaticVector * inbox, StaticVector * outbox) {
+void KeyValueStore::initialize(Rank rank, int size, RingAllocator * outboxAllocator, StaticVector * inbox, StaticVector * outbox,
+		int window) {
 
 	m_rank = rank;
 	m_size = size;
@@ -63,6 +68,11 @@ void KeyValueStore::initialize(Rank rank, int size, RingAllocator * outboxAlloca
 	m_inbox = inbox;
 	m_outbox = outbox;
 
+	m_window = window;
+
+	if(m_window < 1)
+		m_window = 1;
+
 	int chunkSize = 33554432; // 32 MiB    4194304 is 4 MiB
 	m_memoryAllocator.constructor(chunkSize, "/allocator/KeyValueStore.DRAM", false);
 }
@@ -186,11 +196,72 @@ KeyValueStoreItem * KeyValueStore::getLocalItemFromKey(const char * key, int key
 	return &(m_items[keyObject]);
 }
 
+/*
+ * A reply has the same header as its request, the rest of
+ * the message is for the bytes of the value.
+ */
+int KeyValueStore::getPartSize(int keyLength) const {
+
+	return MAXIMUM_MESSAGE_SIZE_IN_BYTES - (keyLength + 1 + 2 * sizeof(uint32_t));
+}
+
+/*
+ * Each message in the outbox also needs a buffer when
+ * the ComputeCore sends it.
+ */
+int KeyValueStore::getAvailableOutboxMessages() {
+
+	int slots = m_outbox->getMaximumSize() - m_outbox->size();
+	int buffers = m_outboxAllocator->getNumberOfBuffers() - m_outboxAllocator->getCount() - m_outbox->size();
+
+	if(buffers < slots)
+		return buffers;
+
+	return slots;
+}
+
+void KeyValueStore::sendPartRequest(const char * key, KeyValueStoreItem * item, Rank source) {
+
+	char * buffer=(char *) m_outboxAllocator->allocate(MAXIMUM_MESSAGE_SIZE_IN_BYTES);
+
+	uint32_t valueSize = item->getValueLength();
+	uint32_t offset = item->getOffset();
+
+#ifdef KeyValueStore_DEBUG_NOW
+	cout << "[DEBUG] KeyValueStore::sendPartRequest key= " << key << " valueSize= " << valueSize;
+	cout << " offset= " << offset;
+	cout << endl;
+#endif /* KeyValueStore_DEBUG_NOW */
+
+	int outputPosition = 0;
+
+	outputPosition += dumpMessageHeader(key, valueSize, offset, buffer);
+
+	int units = outputPosition / sizeof(MessageUnit);
+	if(outputPosition % sizeof(MessageUnit))
+		units ++;
+
+	Message aMessage((MessageUnit*)buffer, units, source,
+		                       RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT_PART, m_rank);
+
+	m_outbox->push_back(&aMessage);
+
+	// this will mark the part as being being currently fetched.
+	item->sendMessage(getPartSize(strlen(key)));
+
+#ifdef KeyValueStore_DEBUG_NOW
+	cout << "[DEBUG] message RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT_PART sent to " << source;
+	cout << endl;
+#endif
+}
+
 /**
  * This method sends RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT_PART to another rank.
  * The chunk is received in a message RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT_PART_REPLY.
  *
- * If the new offset is lower than the value length, then the transfer is not complete.
+ * The first part is requested alone because its reply gives the length of the value.
+ * After that, up to m_window parts are requested at the same time, as long as
+ * there is room in the outbox.
  */
 bool KeyValueStore::pullRemoteKeyWithLength(const char * key, int keyLength, Rank source) {
 
@@ -214,48 +285,35 @@ bool KeyValueStore::pullRemoteKeyWithLength(const char * key, int keyLength, Ran
 	}
 
 	// the transfer has completed.
-	if(item != NULL && item->isItemReady()){
+	if(item->isItemReady()){
 
 #if 0
 		cout << "[DEBUG] item is ready to be used." << endl;
 #endif
 
 		return true;
+	}
 
-	} else if(item != NULL && !item->messageWasSent()) {
-
-		char * buffer=(char *) m_outboxAllocator->allocate(MAXIMUM_MESSAGE_SIZE_IN_BYTES);
-
-		uint32_t valueSize = item->getValueLength();
-		uint32_t offset = item->getOffset();
-
-#ifdef KeyValueStore_DEBUG_NOW
-		cout << "[DEBUG] KeyValueStore::pullRemoteKeyWithLength key= " << key << " valueSize= " << valueSize;
-		cout << " offset= " << offset;
-		cout << endl;
-#endif /* KeyValueStore_DEBUG_NOW */
-
-		int outputPosition = 0;
+	// the first part
+	if(item->getOffset() == 0) {
 
-		outputPosition += dumpMessageHeader(key, valueSize, offset, buffer);
+		if(getAvailableOutboxMessages() > 0)
+			sendPartRequest(key, item, source);
 
-		int units = outputPosition / sizeof(MessageUnit);
-		if(outputPosition % sizeof(MessageUnit))
-			units ++;
+		return false;
+	}
 
-		Message aMessage((MessageUnit*)buffer, units, source,
-			                       RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT_PART, m_rank);
+	// the length of the value is not known yet
+	if(item->getValue() == NULL)
+		return false;
 
-		m_outbox->push_back(&aMessage);
+	int available = getAvailableOutboxMessages();
 
-		// this will mark the item as being being currently fetched.
-		item->sendMessage();
+	while(available > 0 && item->getOutstandingMessages() < m_window
+			&& item->getOffset() < item->getValueLength()) {
 
-#ifdef KeyValueStore_DEBUG_NOW
-		cout << "[DEBUG] message RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT_PART sent to " << source;
-		cout << endl;
-#endif
-		return false;
+		sendPartRequest(key, item, source);
+		available --;
 	}
 
 	return false;
@@ -510,7 +568,7 @@ void KeyValueStore::call_RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT_PART_REPLY(Mess
 
 	// if we have 0 bytes to copy, we have nothing left to do.
 	if(item->getValueLength() == 0) {
-		item->receiveMessage();
+		item->receiveMessage(0);
 		return;
 	}
 
@@ -541,25 +599,20 @@ void KeyValueStore::call_RAYPLATFORM_MESSAGE_TAG_DOWNLOAD_OBJECT_PART_REPLY(Mess
 	cout << " inputPosition= " << inputPosition << " bytesToCopy= " << bytesToCopy << endl;
 #endif
 
-	// copy into the buffer what we received from
-	// a remote rank
-	memcpy(value + offset, buffer + inputPosition, bytesToCopy);
-
 #ifdef CONFIG_ASSERT
 	assert((int)(offset + bytesToCopy) <= (int)item->getValueLength());
 #endif
 
-	uint32_t newOffset = offset + bytesToCopy;
+	// copy into the buffer what we received from
+	// a remote rank, the parts can arrive in any order
+	memcpy(value + offset, buffer + inputPosition, bytesToCopy);
 
-	item->setDownloadedSize(newOffset);
+	item->receiveMessage(bytesToCopy);
 
 #ifdef KeyValueStore_DEBUG_NOW
-	cout << "[DEBUG] setDownloadedSize " << newOffset << endl;
+	cout << "[DEBUG] getDownloadedSize " << item->getDownloadedSize() << endl;
 #endif
 
-	// update data for next message
-	item->receiveMessage();
-
 	// the progression will occur with a call to pullRemoteKey by the end-user
 	// code.
 }
@@ -575,11 +628,14 @@ bool KeyValueStore::test(KeyValueStoreRequest & request) {
 
 	if(request.isAPullRequest()) {
 
-		if(pullRemoteKeyWithLength(key.c_str(), key.length(), rank)) {
+		bool completed = pullRemoteKeyWithLength(key.c_str(), key.length(), rank);
 
-			return true;
-		}
+		KeyValueStoreItem * item = getLocalItemFromKey(key.c_str(), key.length());
+
+		if(item != NULL)
+			request.setProgress(item->getDownloadedSize(), item->getValueLength(), completed, getMicroseconds());
 
+		return completed;
 	}
 
 	return false;
@@ -82,12 +82,19 @@ class KeyValueStore : public CorePlugin {
 	StaticVector*m_inbox;
 	StaticVector*m_outbox;
 
+/** the number of parts of a value that can be requested at the same time */
+	int m_window;
+
 	bool getStringKey(const char * key, int keyLength, string & keyObject);
 	int dumpMessageHeader(const char* key, uint32_t valueLength, uint32_t offset, char * buffer) const;
 	int loadMessageHeader(string & key, uint32_t & valueLength, uint32_t & offset, const char * buffer) const;
 
 	KeyValueStoreItem * getLocalItemFromKey(const char * key, int keyLength);
 
+	int getPartSize(int keyLength) const;
+	int getAvailableOutboxMessages();
+	void sendPartRequest(const char * key, KeyValueStoreItem * item, Rank source);
+
 	bool pushLocalKeyWithLength(const char * key, int keyLength, Rank destination);
 
 	/**
@@ -112,7 +119,12 @@ public:
 
 	KeyValueStore();
 
-	void initialize(Rank rank, int size, RingAllocator * outboxAllocator, StaticVector * inbox, StaticVector * outbox);
+	/**
+	 * \param window is the number of parts of a value that are requested
+	 * before the first one is received
+	 */
+	void initialize(Rank rank, int size, RingAllocator * outboxAllocator, StaticVector * inbox, StaticVector * outbox,
+		int window);
 
 	/**
 	 * Insert a local key
@@ -150,11 +162,15 @@ public:
 	 * After this calling this method, the test method needs to be called using the request
 	 * object.
 	 *
+	 * The first part of the value gives its length, then a window of parts
+	 * is requested, and the parts are placed in the value by their offset.
+	 * The request object shows the progress and the bandwidth of the transfer.
+	 *
 	 */
 	void pullRemoteKey(const string & key, const Rank & source, KeyValueStoreRequest & request);
 
 	/**
-	 * Test a request for completion
+	 * Test a request for completion, and update its progress
 	 */
 	bool test(KeyValueStoreRequest & request);
 
@@ -21,6 +21,8 @@ KeyValueStoreItem::KeyValueStoreItem(char * value, int valueSize) {
 	m_value = value;
 	m_valueSize = valueSize;
 	m_downloadedSize = valueSize;
+	m_requestedSize = valueSize;
+	m_outstandingMessages = 0;
 
 	m_ready = true;
 }
@@ -51,39 +53,39 @@ bool KeyValueStoreItem::isItemReady() const {
 	return m_ready == true;
 }
 
-void KeyValueStoreItem::setDownloadedSize(int downloadedSize) {
-
-#ifdef CONFIG_ASSERT
-	assert(downloadedSize <= m_valueSize);
-#endif
-
-	m_downloadedSize = downloadedSize;
+int KeyValueStoreItem::getDownloadedSize() const {
+	return m_downloadedSize;
 }
 
-void KeyValueStoreItem::sendMessage() {
-
-#ifdef CONFIG_ASSERT
-	assert(m_messageWasSent == false);
-#endif
+/*
+ * A part of the value was requested.
+ */
+void KeyValueStoreItem::sendMessage(int bytes) {
 
-	m_messageWasSent = true;
+	m_requestedSize += bytes;
+	m_outstandingMessages ++;
 	m_ready = false;
 }
 
-void KeyValueStoreItem::receiveMessage() {
+/*
+ * The parts can be received in any order.
+ */
+void KeyValueStoreItem::receiveMessage(int bytes) {
 
 #ifdef CONFIG_ASSERT
-	assert(m_messageWasSent == true);
+	assert(m_outstandingMessages > 0);
+	assert(m_downloadedSize + bytes <= m_valueSize);
 #endif
 
-	m_messageWasSent = false;
+	m_outstandingMessages --;
+	m_downloadedSize += bytes;
 
-	if(m_downloadedSize == m_valueSize)
+	if(m_downloadedSize == m_valueSize && m_outstandingMessages == 0)
 		markItemAsReady();
 }
 
-bool KeyValueStoreItem::messageWasSent() const {
-	return m_messageWasSent;
+int KeyValueStoreItem::getOutstandingMessages() const {
+	return m_outstandingMessages;
 }
 
 void KeyValueStoreItem::setValue(char * value) {
@@ -97,9 +99,11 @@ void KeyValueStoreItem::setValueLength(int valueSize) {
 void KeyValueStoreItem::startDownload() {
 
 	m_ready = false;
-	m_messageWasSent = false;
+	m_downloadedSize = 0;
+	m_requestedSize = 0;
+	m_outstandingMessages = 0;
 }
 
 int KeyValueStoreItem::getOffset() const {
-	return m_downloadedSize;
+	return m_requestedSize;
 }
@@ -16,8 +16,16 @@ class KeyValueStoreItem {
 
 	char * m_value;
 	int m_valueSize;
+
+/** the number of bytes received */
 	int m_downloadedSize;
-	bool m_messageWasSent;
+
+/** the offset of the next part to request */
+	int m_requestedSize;
+
+/** the parts that were requested, but not received yet */
+	int m_outstandingMessages;
+
 	bool m_ready;
 
 	void markItemAsReady();
@@ -32,15 +40,15 @@ public:
 
 	bool isItemReady() const;
 
-	void sendMessage();
-	void receiveMessage();
+	void sendMessage(int bytes);
+	void receiveMessage(int bytes);
 
-	bool messageWasSent() const;
+	int getOutstandingMessages() const;
 
 	void setValue(char * value);
 	void setValueLength(int size);
 
-	void setDownloadedSize(int downloadedSize);
+	int getDownloadedSize() const;
 
 	void startDownload();
 
@@ -27,6 +27,8 @@
 
 KeyValueStoreRequest::KeyValueStoreRequest() {
 	m_type = KEY_VALUE_STORE_OPERATION_NONE;
+
+	startTransfer(0);
 }
 
 void KeyValueStoreRequest::initialize(const string & key, const Rank & rank) {
@@ -64,3 +66,58 @@ const string & KeyValueStoreRequest::getKey() const {
 
 	return m_key;
 }
+
+void KeyValueStoreRequest::startTransfer(uint64_t time) {
+
+	m_transferredBytes = 0;
+	m_totalBytes = 0;
+	m_completed = false;
+
+	m_startingTime = time;
+	m_lastTime = time;
+}
+
+/*
+ * Nothing changes after the completion, the elapsed time is
+ * therefore the duration of the transfer.
+ */
+void KeyValueStoreRequest::setProgress(uint64_t transferredBytes, uint64_t totalBytes, bool completed, uint64_t time) {
+
+	if(m_completed)
+		return;
+
+	m_transferredBytes = transferredBytes;
+	m_totalBytes = totalBytes;
+	m_completed = completed;
+	m_lastTime = time;
+}
+
+uint64_t KeyValueStoreRequest::getTransferredBytes() const {
+
+	return m_transferredBytes;
+}
+
+uint64_t KeyValueStoreRequest::getTotalBytes() const {
+
+	return m_totalBytes;
+}
+
+bool KeyValueStoreRequest::isCompleted() const {
+
+	return m_completed;
+}
+
+uint64_t KeyValueStoreRequest::getElapsedMicroseconds() const {
+
+	return m_lastTime - m_startingTime;
+}
+
+uint64_t KeyValueStoreRequest::getBandwidth() const {
+
+	uint64_t elapsed = getElapsedMicroseconds();
+
+	if(elapsed == 0)
+		return 0;
+
+	return m_transferredBytes * 1000000 / elapsed;
+}
@@ -27,6 +27,8 @@
 #include <string>
 using namespace std;
 
+#include <stdint.h>
+
 /**
  * A key-value store request.
  *
@@ -38,6 +40,15 @@ class KeyValueStoreRequest {
 	string m_key;
 	Rank m_rank;
 
+/** progress of the transfer, the total is 0 until it is known */
+	uint64_t m_transferredBytes;
+	uint64_t m_totalBytes;
+	bool m_completed;
+
+/** microseconds at the start and at the last progress */
+	uint64_t m_startingTime;
+	uint64_t m_lastTime;
+
 public:
 
 	KeyValueStoreRequest();
@@ -49,6 +60,19 @@ public:
 	bool isAPullRequest() const;
 	bool isAPushRequest() const;
 	const string & getKey() const;
+
+	void startTransfer(uint64_t time);
+	void setProgress(uint64_t transferredBytes, uint64_t totalBytes, bool completed, uint64_t time);
+
+	uint64_t getTransferredBytes() const;
+	uint64_t getTotalBytes() const;
+	bool isCompleted() const;
+
+/** microseconds from the start to the last progress (or the completion) */
+	uint64_t getElapsedMicroseconds() const;
+
+/** bytes per second */
+	uint64_t getBandwidth() const;
 };
 
 #endif
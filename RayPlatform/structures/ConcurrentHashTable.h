@@ -0,0 +1,361 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ConcurrentHashTable_H
+#define _ConcurrentHashTable_H
+
+#include "MyHashTable.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <iostream>
+using namespace std;
+
+#ifdef CONFIG_ASSERT
+#include <assert.h>
+#endif
+
+/**
+ * the number of shards of a ConcurrentHashTable is at most 2^CONCURRENT_HASH_TABLE_MAXIMUM_SHARD_BITS
+ */
+#define CONCURRENT_HASH_TABLE_MAXIMUM_SHARD_BITS 16
+
+/**
+ * A MyHashTable shared by the threads of a process, for instance by the
+ * mini-ranks of a RankProcess (-mini-ranks-per-rank). Without it, each
+ * mini-rank holds its own MyHashTable.
+ *
+ * The keys are distributed on shards with the high bits of hash_function_2(),
+ * and each shard is a MyHashTable with its own
+ * ChunkAllocatorWithDefragmentation and its own lock. The MyHashTable
+ * of a shard uses the low bits of the same hash, so the shards are
+ * as well balanced as the buckets.
+ *
+ * There are no optimistic reads. An insert can move elements, and so
+ * can the incremental resize and the defragmentation of a shard, so a
+ * reader always holds the lock of the shard while it reads.
+ * With more shards than threads, a lock is rarely contended. But each
+ * shard has its own allocator, which allocates ELEMENTS_PER_GROUP elements
+ * at once, so a shard costs a few MiB even when it is almost empty.
+ * A few shards per thread is usually enough.
+ *
+ * A pointer to an element is only valid while the lock of its shard is held.
+ * find() and insert() copy the VALUE. For in-place updates, findAndLock()
+ * and insertAndLock() return the pointer with the lock held, and unlock()
+ * releases it.
+ *
+ * The table must be constructed before the threads that share it are
+ * started. With mini-ranks, RankProcess::constructor creates the Application
+ * objects in the main thread and RankProcess::run starts them, so the table
+ * can be constructed by the first Application object or by main() between
+ * these two calls. The ComputeCore objects of a RankProcess are the
+ * mini-ranks whose numbers have the same quotient by getMiniRanksPerRank().
+ *
+ * \author RayPlatform contributors
+ */
+template<class KEY,class VALUE>
+class ConcurrentHashTable{
+
+/**
+ * A shard, the padding keeps the lock of a shard
+ * and the counters of the next one on different cache lines
+ */
+	class Shard{
+	public:
+		pthread_mutex_t m_lock;
+		MyHashTable<KEY,VALUE> m_table;
+
+		/** the number of lock acquisitions that had to wait */
+		uint64_t m_contendedLocks;
+		uint64_t m_locks;
+
+		char m_padding[64];
+	};
+
+	Shard*m_shards;
+	int m_numberOfShards;
+	int m_shardBits;
+
+	Shard*getShard(KEY*key);
+	void lockShard(Shard*shard);
+
+public:
+
+	/**
+ * build the shards, buckets is the total for all the shards,
+ * shards is rounded up to a power of 2
+ */
+	void constructor(uint64_t buckets,const char*mallocType,bool showMalloc,int rank,
+		int bucketsPerGroup,double loadFactorThreshold,int shards);
+
+	void destructor();
+
+	/**
+ * copy the VALUE of a key in value, returns false if the key is absent
+ */
+	bool find(KEY*key,VALUE*value);
+
+	/**
+ * insert or replace the VALUE of a key,
+ * returns true if the key was absent
+ */
+	bool insert(KEY*key,VALUE*value);
+
+	/**
+ * erase a key
+ * returns true if the key was in the table
+ */
+	bool erase(KEY*key);
+
+	/**
+ * lock the shard of a key and return its VALUE, or NULL if the key is absent.
+ * unlock() must be called in both cases.
+ */
+	VALUE*findAndLock(KEY*key);
+
+	/**
+ * lock the shard of a key and return its VALUE, the key is inserted if it is absent.
+ * unlock() must be called.
+ */
+	VALUE*insertAndLock(KEY*key);
+
+	/**
+ * unlock the shard of a key locked by findAndLock or insertAndLock
+ */
+	void unlock(KEY*key);
+
+	/**
+ * get the number of keys, the shards are locked one after the other
+ */
+	uint64_t size();
+
+	int getNumberOfShards();
+
+	void completeResizing();
+
+	void defragment();
+
+	void printStatistics();
+};
+
+template<class KEY,class VALUE>
+void ConcurrentHashTable<KEY,VALUE>::constructor(uint64_t buckets,const char*mallocType,bool showMalloc,int rank,
+		int bucketsPerGroup,double loadFactorThreshold,int shards){
+
+	m_shardBits=0;
+	while(m_shardBits<CONCURRENT_HASH_TABLE_MAXIMUM_SHARD_BITS && (1<<m_shardBits)<shards)
+		m_shardBits++;
+
+	m_numberOfShards=1<<m_shardBits;
+
+	uint64_t bucketsPerShard=buckets/m_numberOfShards;
+	if(bucketsPerShard<2)
+		bucketsPerShard=2;
+
+	m_shards=new Shard[m_numberOfShards];
+
+	for(int i=0;i<m_numberOfShards;i++){
+		pthread_mutex_init(&(m_shards[i].m_lock),NULL);
+		m_shards[i].m_table.constructor(bucketsPerShard,mallocType,showMalloc,rank,
+			bucketsPerGroup,loadFactorThreshold);
+		m_shards[i].m_contendedLocks=0;
+		m_shards[i].m_locks=0;
+	}
+}
+
+template<class KEY,class VALUE>
+void ConcurrentHashTable<KEY,VALUE>::destructor(){
+	for(int i=0;i<m_numberOfShards;i++){
+		m_shards[i].m_table.destructor();
+		pthread_mutex_destroy(&(m_shards[i].m_lock));
+	}
+
+	delete [] m_shards;
+	m_shards=NULL;
+	m_numberOfShards=0;
+}
+
+/**
+ * the MyHashTable of a shard uses the low bits of hash_function_2()
+ */
+template<class KEY,class VALUE>
+typename ConcurrentHashTable<KEY,VALUE>::Shard*ConcurrentHashTable<KEY,VALUE>::getShard(KEY*key){
+	if(m_shardBits==0)
+		return m_shards;
+
+	uint64_t hash=key->hash_function_2();
+	return m_shards+(hash>>(64-m_shardBits));
+}
+
+template<class KEY,class VALUE>
+void ConcurrentHashTable<KEY,VALUE>::lockShard(Shard*shard){
+	bool contended=false;
+
+	if(pthread_mutex_trylock(&(shard->m_lock))!=0){
+		pthread_mutex_lock(&(shard->m_lock));
+		contended=true;
+	}
+
+	shard->m_locks++;
+
+	if(contended)
+		shard->m_contendedLocks++;
+}
+
+template<class KEY,class VALUE>
+bool ConcurrentHashTable<KEY,VALUE>::find(KEY*key,VALUE*value){
+	Shard*shard=getShard(key);
+	lockShard(shard);
+
+	VALUE*entry=shard->m_table.find(key);
+
+	if(entry!=NULL)
+		*value=*entry;
+
+	pthread_mutex_unlock(&(shard->m_lock));
+
+	return entry!=NULL;
+}
+
+template<class KEY,class VALUE>
+bool ConcurrentHashTable<KEY,VALUE>::insert(KEY*key,VALUE*value){
+	Shard*shard=getShard(key);
+	lockShard(shard);
+
+	uint64_t sizeBefore=shard->m_table.size();
+	VALUE*entry=shard->m_table.insert(key);
+	*entry=*value;
+	bool inserted=shard->m_table.size()>sizeBefore;
+
+	/* the assignment replaced the hash kept by the VALUE, if any */
+	MyHashTableHashCache<KEY,VALUE>::setHash(entry,key->hash_function_2());
+
+	#ifdef CONFIG_ASSERT
+	assert(entry->getKey()==*key);
+	#endif
+
+	pthread_mutex_unlock(&(shard->m_lock));
+
+	return inserted;
+}
+
+template<class KEY,class VALUE>
+bool ConcurrentHashTable<KEY,VALUE>::erase(KEY*key){
+	Shard*shard=getShard(key);
+	lockShard(shard);
+
+	bool erased=shard->m_table.erase(key);
+
+	pthread_mutex_unlock(&(shard->m_lock));
+
+	return erased;
+}
+
+template<class KEY,class VALUE>
+VALUE*ConcurrentHashTable<KEY,VALUE>::findAndLock(KEY*key){
+	Shard*shard=getShard(key);
+	lockShard(shard);
+
+	return shard->m_table.find(key);
+}
+
+template<class KEY,class VALUE>
+VALUE*ConcurrentHashTable<KEY,VALUE>::insertAndLock(KEY*key){
+	Shard*shard=getShard(key);
+	lockShard(shard);
+
+	return shard->m_table.insert(key);
+}
+
+template<class KEY,class VALUE>
+void ConcurrentHashTable<KEY,VALUE>::unlock(KEY*key){
+	Shard*shard=getShard(key);
+	pthread_mutex_unlock(&(shard->m_lock));
+}
+
+template<class KEY,class VALUE>
+uint64_t ConcurrentHashTable<KEY,VALUE>::size(){
+	uint64_t total=0;
+
+	for(int i=0;i<m_numberOfShards;i++){
+		pthread_mutex_lock(&(m_shards[i].m_lock));
+		total+=m_shards[i].m_table.size();
+		pthread_mutex_unlock(&(m_shards[i].m_lock));
+	}
+
+	return total;
+}
+
+template<class KEY,class VALUE>
+int ConcurrentHashTable<KEY,VALUE>::getNumberOfShards(){
+	return m_numberOfShards;
+}
+
+template<class KEY,class VALUE>
+void ConcurrentHashTable<KEY,VALUE>::completeResizing(){
+	for(int i=0;i<m_numberOfShards;i++){
+		pthread_mutex_lock(&(m_shards[i].m_lock));
+		m_shards[i].m_table.completeResizing();
+		pthread_mutex_unlock(&(m_shards[i].m_lock));
+	}
+}
+
+template<class KEY,class VALUE>
+void ConcurrentHashTable<KEY,VALUE>::defragment(){
+	for(int i=0;i<m_numberOfShards;i++){
+		pthread_mutex_lock(&(m_shards[i].m_lock));
+		m_shards[i].m_table.defragment();
+		pthread_mutex_unlock(&(m_shards[i].m_lock));
+	}
+}
+
+template<class KEY,class VALUE>
+void ConcurrentHashTable<KEY,VALUE>::printStatistics(){
+	uint64_t keys=0;
+	uint64_t buckets=0;
+	uint64_t locks=0;
+	uint64_t contendedLocks=0;
+	uint64_t smallestShard=0;
+	uint64_t largestShard=0;
+
+	for(int i=0;i<m_numberOfShards;i++){
+		pthread_mutex_lock(&(m_shards[i].m_lock));
+
+		uint64_t shardSize=m_shards[i].m_table.size();
+		keys+=shardSize;
+		buckets+=m_shards[i].m_table.capacity();
+		locks+=m_shards[i].m_locks;
+		contendedLocks+=m_shards[i].m_contendedLocks;
+
+		if(i==0 || shardSize<smallestShard)
+			smallestShard=shardSize;
+		if(i==0 || shardSize>largestShard)
+			largestShard=shardSize;
+
+		pthread_mutex_unlock(&(m_shards[i].m_lock));
+	}
+
+	cout<<"ConcurrentHashTable, Shards: "<<m_numberOfShards<<", Keys: "<<keys<<", Buckets: "<<buckets;
+	cout<<", SmallestShard: "<<smallestShard<<", LargestShard: "<<largestShard;
+	cout<<", Locks: "<<locks<<", ContendedLocks: "<<contendedLocks<<endl;
+}
+
+#endif
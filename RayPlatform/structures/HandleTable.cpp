@@ -0,0 +1,149 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#include "HandleTable.h"
+
+#ifdef CONFIG_ASSERT
+#include <assert.h>
+#endif
+
+void HandleTable::constructor(int buckets){
+	#ifdef CONFIG_ASSERT
+	assert(buckets>0 && (buckets&(buckets-1))==0);
+	#endif
+
+	m_keys.clear();
+	m_values.clear();
+
+	m_keys.resize(buckets,0);
+	m_values.resize(buckets,-1);
+	m_size=0;
+}
+
+/* handles are often consecutive, so they are mixed first */
+int HandleTable::getBucket(uint64_t key){
+	uint64_t hash=key*0x9e3779b97f4a7c15ULL;
+	return (hash>>32)&(m_values.size()-1);
+}
+
+int HandleTable::find(uint64_t key){
+	int mask=m_values.size()-1;
+	int bucket=getBucket(key);
+
+	while(m_values[bucket]!=-1){
+		if(m_keys[bucket]==key)
+			return m_values[bucket];
+
+		bucket=(bucket+1)&mask;
+	}
+
+	return -1;
+}
+
+void HandleTable::insert(uint64_t key,int value){
+	#ifdef CONFIG_ASSERT
+	assert(value>=0);
+	assert(find(key)==-1);
+	#endif
+
+	// keep the load factor under 1/2
+	if(2*(m_size+1)>(int)m_values.size())
+		grow();
+
+	int mask=m_values.size()-1;
+	int bucket=getBucket(key);
+
+	while(m_values[bucket]!=-1)
+		bucket=(bucket+1)&mask;
+
+	m_keys[bucket]=key;
+	m_values[bucket]=value;
+	m_size++;
+}
+
+/*
+ * Backward-shift deletion: the entries that follow the erased one are
+ * moved back so that no probe sequence is broken.
+ */
+void HandleTable::erase(uint64_t key){
+	int mask=m_values.size()-1;
+	int hole=getBucket(key);
+
+	while(m_keys[hole]!=key || m_values[hole]==-1){
+		#ifdef CONFIG_ASSERT
+		assert(m_values[hole]!=-1);
+		#endif
+
+		hole=(hole+1)&mask;
+	}
+
+	m_values[hole]=-1;
+	m_size--;
+
+	int current=hole;
+
+	while(true){
+		current=(current+1)&mask;
+
+		if(m_values[current]==-1)
+			break;
+
+		int home=getBucket(m_keys[current]);
+
+		// the entry can move to the hole if its home is not in (hole,current]
+		bool canMove=(hole<=current)?(home<=hole || home>current):(home<=hole && home>current);
+
+		if(!canMove)
+			continue;
+
+		m_keys[hole]=m_keys[current];
+		m_values[hole]=m_values[current];
+		m_values[current]=-1;
+
+		hole=current;
+	}
+}
+
+void HandleTable::grow(){
+	vector<uint64_t> keys;
+	vector<int> values;
+
+	keys.swap(m_keys);
+	values.swap(m_values);
+
+	constructor(2*values.size());
+
+	for(int bucket=0;bucket<(int)values.size();bucket++){
+		if(values[bucket]!=-1)
+			insert(keys[bucket],values[bucket]);
+	}
+}
+
+int HandleTable::size(){
+	return m_size;
+}
+
+void HandleTable::clear(){
+	for(int bucket=0;bucket<(int)m_values.size();bucket++)
+		m_values[bucket]=-1;
+
+	m_size=0;
+}
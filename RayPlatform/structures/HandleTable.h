@@ -0,0 +1,69 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _HandleTable
+#define _HandleTable
+
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+/**
+ * A table that associates 64-bit handles (for instance a WorkerHandle)
+ * to non-negative integers (for instance the index of a slot).
+ *
+ * This is an open-addressing hash table with linear probing. It grows
+ * when it is half full and erase uses backward-shift deletion, so
+ * there are no tombstones. Once it has grown, insert and erase don't
+ * allocate memory.
+ *
+ * \author RayPlatform contributors
+ */
+class HandleTable{
+	vector<uint64_t> m_keys;
+
+	/* -1 for an empty bucket */
+	vector<int> m_values;
+
+	int m_size;
+
+	int getBucket(uint64_t key);
+	void grow();
+
+public:
+
+/** initialize the table with a number of buckets (a power of 2) */
+	void constructor(int buckets);
+
+/** returns the value of a key, or -1 if the key is absent */
+	int find(uint64_t key);
+
+/** associate a value (>=0) to a key that is absent */
+	void insert(uint64_t key,int value);
+
+/** remove a key that is present */
+	void erase(uint64_t key);
+
+	int size();
+	void clear();
+};
+
+#endif
@@ -39,7 +39,11 @@
  */
 #define MAX_SAVED_PROBE 16
 
+/** the number of keys prefetched together by findBatch and insertBatch */
+#define MY_HASH_TABLE_BATCH_SIZE 16
+
 #include "MyHashTableGroup.h"
+#include "MyHashTableHashCache.h"
 
 #include <RayPlatform/memory/ChunkAllocatorWithDefragmentation.h>
 #include <RayPlatform/memory/allocator.h> /* for __Malloc */
@@ -65,6 +69,8 @@ using namespace std;
  *
  * getKey()
  *
+ * a VALUE can also keep the hash of its key, see MyHashTableHashCache.
+ *
  * the number of buckets can not be exceeded. 
  * based on the description at
  * \see http://google-sparsehash.googlecode.com/svn/trunk/doc/implementation.html
@@ -74,6 +80,10 @@ using namespace std;
  * probing depth is usually low because incremental resizing is triggered at load >= 70.0%
  * and double hashing eases exploration of bucket landscapes.
  *
+ * an erased key leaves a tombstone in its bucket so that the probe sequences that
+ * pass there are not broken. Tombstones are counted in the load and they are not
+ * transferred by the incremental resizing, which therefore also cleans them.
+ *
  * \author Sébastien Boisvert
  * \date 2012-08-07 This class was reviewed by David Weese <weese@campus.fu-berlin.de>
  */
@@ -116,6 +126,11 @@ class MyHashTable{
  * the number of buckets in the theater */
 	uint64_t m_totalNumberOfBuckets;
 
+	/**
+ * m_totalNumberOfBuckets-1, the number of buckets is a power of 2
+ * so that a hash modulo the number of buckets is a mask */
+	uint64_t m_bucketMask;
+
 	/**
          * Number of utilised buckets 
          */
@@ -130,6 +145,16 @@ class MyHashTable{
  */
 	uint64_t m_size;
 
+	/**
+ * 	number of buckets with a tombstone
+ */
+	uint64_t m_tombstoneBuckets;
+
+	/**
+ * 	number of erased keys
+ */
+	uint64_t m_erasedKeys;
+
 	/**
  * 	groups of buckets
  */
@@ -140,6 +165,13 @@ class MyHashTable{
  */
 	int m_numberOfBucketsInGroup;
 
+	/**
+ * the number of buckets per group is a power of 2 too,
+ * a bucket is in group bucket>>m_groupShift
+ * at position bucket&m_bucketInGroupMask */
+	int m_groupShift;
+	uint64_t m_bucketInGroupMask;
+
 	/**
  * 	number of groups 
  */
@@ -168,8 +200,31 @@ class MyHashTable{
 
 
 /*
- * find a key, but specify if the auxiliary table should be searched also */
-	VALUE*findKey(KEY*key,bool checkAuxiliary);
+ * find a key, but specify if the auxiliary table should be searched also
+ * hash is key->hash_function_2(), it does not depend on the size of a table */
+	VALUE*findKey(KEY*key,uint64_t hash,bool checkAuxiliary);
+
+/*
+ * insert a key whose hash_function_2() is already computed */
+	VALUE*insertKey(KEY*key,uint64_t hash);
+
+/*
+ * find a bucket given a key and its hash_function_2() */
+	void findBucketWithHash(KEY*key,uint64_t hash,uint64_t*probe,int*group,int*bucketInGroup);
+
+/*
+ * the stride of double hashing, it is computed on probe 1 */
+	uint64_t getStride(KEY*key);
+
+/*
+ * prefetch, in stages, what the first two probes of each key touch:
+ * the group headers, then the allocator meta-data of the vectors,
+ * then the elements */
+	void prefetchFirstProbes(KEY*keys,uint64_t*hashes,int n);
+
+/*
+ * erase a key whose hash_function_2() is already computed */
+	bool eraseKey(KEY*key,uint64_t hash);
 
 public:
 	
@@ -199,6 +254,27 @@ public:
  * insert a key */
 	VALUE*insert(KEY*key);
 
+	/**
+ * find n keys, out[i] is the result of find(keys+i)
+ * The hashes of a batch are computed first and the memory of the
+ * first probes is prefetched before any key is resolved, so the cache
+ * misses of different keys overlap.
+ */
+	void findBatch(KEY*keys,int n,VALUE**out);
+
+	/**
+ * insert n keys, out[i] is the result of find(keys+i) once all the keys
+ * are inserted (an insert can move the elements inserted before it,
+ * so the pointers are only valid after the last insertion)
+ * out can be NULL.
+ */
+	void insertBatch(KEY*keys,int n,VALUE**out);
+
+	/**
+ * erase a key
+ * returns true if the key was in the table */
+	bool erase(KEY*key);
+
 /**
  * 	find a bucket given a key
  * 	This uses double hashing for open addressing.
@@ -233,7 +309,15 @@ public:
 	void printProbeStatistics();
 
 /**
- * callback function for immediate defragmentation
+ * get the number of operations of the allocator of the values, with
+ * __OPERATION_ALLOCATE, __OPERATION_DEALLOCATE or __OPERATION_DEFRAGMENT.
+ * The operations of a table replaced by a resize are not counted.
+ */
+	uint64_t getAllocatorOperations(int operationCode);
+
+/**
+ * callback function for immediate defragmentation,
+ * the groups give back their unused capacity
  */
 	void defragment();
 
@@ -245,8 +329,8 @@ public:
 /* get a bucket */
 template<class KEY,class VALUE>
 VALUE*MyHashTable<KEY,VALUE>::at(uint64_t bucket){
-	int group=bucket/m_numberOfBucketsInGroup;
-	int bucketInGroup=bucket%m_numberOfBucketsInGroup;
+	int group=bucket>>m_groupShift;
+	int bucketInGroup=bucket&m_bucketInGroupMask;
 
 	#ifdef CONFIG_ASSERT
 	assert(m_groups[group].getBit(bucketInGroup)==1);
@@ -270,13 +354,18 @@ void MyHashTable<KEY,VALUE>::growIfNecessary(){
 		return;
 
 	/**  check if a growth is necessary */
-	double loadFactor=(0.0+m_utilisedBuckets)/m_totalNumberOfBuckets;
+	/** tombstones make the probe sequences longer too */
+	double loadFactor=(0.0+m_utilisedBuckets+m_tombstoneBuckets)/m_totalNumberOfBuckets;
 	if(loadFactor<m_maximumLoadFactor)
 		return;
 
 	/** double the size */
 	uint64_t newSize=m_totalNumberOfBuckets*2;
 
+	/** if the load is mostly tombstones, the table is only rebuilt to clean them */
+	if(m_utilisedBuckets<m_maximumLoadFactor/2*m_totalNumberOfBuckets)
+		newSize=m_totalNumberOfBuckets;
+
 	/** nothing to do because shrinking is not implemented */
 	if(newSize<m_totalNumberOfBuckets)
 		return;
@@ -308,7 +397,7 @@ void MyHashTable<KEY,VALUE>::growIfNecessary(){
 	//printStatistics();
 
 	#ifdef CONFIG_ASSERT
-	assert(newSize>m_totalNumberOfBuckets);
+	assert(newSize>=m_totalNumberOfBuckets);
 	#endif
 }
 
@@ -317,9 +406,9 @@ void MyHashTable<KEY,VALUE>::growIfNecessary(){
  */
 template<class KEY,class VALUE>
 void MyHashTable<KEY,VALUE>::resize(){
+	/** erase() can empty the old table during the resize */
 	#ifdef CONFIG_ASSERT
 	assert(m_resizing==true);
-	assert(m_utilisedBuckets>0);
 	#endif
 
  /*
@@ -378,10 +467,18 @@ void MyHashTable<KEY,VALUE>::resize(){
  * 	thus, T>=1
  *
  * 	Here, we choose T=2
+ *
+ * 	When the table is rebuilt with the same size to clean the tombstones,
+ * 	the main table has at most 0.7*N/2 items (0.35*N). With T=8, the
+ * 	auxiliary table has at most 0.35*N + N/8 = 0.475*N items upon completion,
+ * 	which is lower than 0.7*N.
  * 	*/
 
 	int toProcess=2;
 
+	if(m_auxiliaryTableForIncrementalResize->capacity()==capacity())
+		toProcess=8;
+
 	int i=0;
 	while(i<toProcess && m_currentBucketToTransfer<capacity()){
 		/** if the bucket is available, it means that it is empty */
@@ -395,11 +492,18 @@ void MyHashTable<KEY,VALUE>::resize(){
 			KEY keyValue=entry->getKey();
 			KEY*key=&keyValue;
 
+			/** the hash does not depend on the number of buckets */
+			uint64_t hash=MyHashTableHashCache<KEY,VALUE>::getHash(entry);
+
+			#ifdef CONFIG_ASSERT
+			assert(hash==key->hash_function_2());
+			#endif
+
 			#ifdef CONFIG_ASSERT
 			uint64_t probe;
 			int group;
 			int bucketInGroup;
-			findBucketWithKey(key,&probe,&group,&bucketInGroup);
+			findBucketWithHash(key,hash,&probe,&group,&bucketInGroup);
 			uint64_t globalBucket=group*m_numberOfBucketsInGroup+bucketInGroup;
 			
 			if(globalBucket!=m_currentBucketToTransfer)
@@ -411,9 +515,8 @@ void MyHashTable<KEY,VALUE>::resize(){
 			assert(find(key)!=NULL);
 			#endif
 
-			/** remove the key too */
-			/* actually, can not remove anything because otherwise it will make the double hashing 
- * 			fails */
+			/** the key is not removed from the main table because it is
+ * 			destroyed upon completion, erase() removes it from both tables */
 
 			/** save the size before for further use */
 			#ifdef CONFIG_ASSERT
@@ -426,7 +529,7 @@ void MyHashTable<KEY,VALUE>::resize(){
 			#endif
 
 			/* this pointer  will remain valid until the next insert. */
-			VALUE*insertedEntry=m_auxiliaryTableForIncrementalResize->insert(key);
+			VALUE*insertedEntry=m_auxiliaryTableForIncrementalResize->insertKey(key,hash);
 		
 			/** affect the value */
 			(*insertedEntry)=*entry;
@@ -457,10 +560,12 @@ void MyHashTable<KEY,VALUE>::resize(){
 		/** copy important stuff  */
 		m_groups=m_auxiliaryTableForIncrementalResize->m_groups;
 		m_totalNumberOfBuckets=m_auxiliaryTableForIncrementalResize->m_totalNumberOfBuckets;
+		m_bucketMask=m_auxiliaryTableForIncrementalResize->m_bucketMask;
 		m_allocator=m_auxiliaryTableForIncrementalResize->m_allocator;
 		m_numberOfGroups=m_auxiliaryTableForIncrementalResize->m_numberOfGroups;
 		m_utilisedBuckets=m_auxiliaryTableForIncrementalResize->m_utilisedBuckets;
 		m_size=m_auxiliaryTableForIncrementalResize->m_size;
+		m_tombstoneBuckets=m_auxiliaryTableForIncrementalResize->m_tombstoneBuckets;
 
 		#ifdef CONFIG_ASSERT
 		assert(m_size == m_utilisedBuckets);
@@ -517,6 +622,17 @@ void MyHashTable<KEY,VALUE>::constructor(uint64_t buckets,const char*mallocType,
 		cout<<"Changed buckets to "<<buckets<<endl;
 	}
 
+	/* a group has at most 64 buckets, one bit per bucket in a uint64_t */
+	int groupShift=0;
+	while(groupShift<6 && (2<<groupShift)<=bucketsPerGroup)
+		groupShift++;
+
+	if((1<<groupShift)!=bucketsPerGroup){
+		cout<<"Warning: the number of buckets per group must be a power of 2 between 1 and 64"<<endl;
+		bucketsPerGroup=1<<groupShift;
+		cout<<"Changed buckets per group to "<<bucketsPerGroup<<endl;
+	}
+
 	/** this is the maximum acceptable load factor. */
 	/** based on Figure 42 on page 531 of
  * 	The Art of Computer Programming, Second Edition, by Donald E. Knuth
@@ -549,16 +665,21 @@ void MyHashTable<KEY,VALUE>::constructor(uint64_t buckets,const char*mallocType,
 	/* use the provided number of buckets */
 	/* the number of buckets is a power of 2 */
 	m_totalNumberOfBuckets=buckets;
+	m_bucketMask=m_totalNumberOfBuckets-1;
 
 	m_size=0;
 
 	m_utilisedBuckets=0;
+	m_tombstoneBuckets=0;
+	m_erasedKeys=0;
 
 	/* the number of buckets in a group
  * 	this is arbitrary I believe... 
  * 	in my case, 64 is the number of bits in a uint64_t
  * 	*/
 	m_numberOfBucketsInGroup=bucketsPerGroup;
+	m_groupShift=groupShift;
+	m_bucketInGroupMask=m_numberOfBucketsInGroup-1;
 
 	/**
  * 	compute the required number of groups 
@@ -597,8 +718,8 @@ void MyHashTable<KEY,VALUE>::constructor(uint64_t buckets,const char*mallocType,
 /** return yes if the bucket is empty, no otherwise */
 template<class KEY,class VALUE>
 bool MyHashTable<KEY,VALUE>::isAvailable(uint64_t bucket){
-	int group=bucket/m_numberOfBucketsInGroup;
-	int bucketInGroup=bucket%m_numberOfBucketsInGroup;
+	int group=bucket>>m_groupShift;
+	int bucketInGroup=bucket&m_bucketInGroupMask;
 	
 	#ifdef CONFIG_ASSERT
 	assert(bucket<m_totalNumberOfBuckets);
@@ -617,6 +738,31 @@ MyHashTable<KEY,VALUE>::MyHashTable(){}
 template<class KEY,class VALUE>
 MyHashTable<KEY,VALUE>::~MyHashTable(){}
 
+/**
+ * the stride of double hashing for a key
+ */
+template<class KEY,class VALUE>
+uint64_t MyHashTable<KEY,VALUE>::getStride(KEY*key){
+	/**  page 529 
+ * 		between 1 and M-1 exclusive
+		odd number
+ * 	*/
+
+	/** h2 can not be 0 and can not be even */
+	uint64_t h2=(key->hash_function_1()&m_bucketMask)|1;
+
+	/** check boundaries */
+	#ifdef CONFIG_ASSERT
+	assert(h2!=0);
+	assert(h2%2!=0);
+	assert(h2%2 == 1);
+	assert(h2>=1);
+	assert(h2<m_totalNumberOfBuckets);
+	#endif
+
+	return h2;
+}
+
 /**
  * find a bucket
  *
@@ -639,6 +785,11 @@ MyHashTable<KEY,VALUE>::~MyHashTable(){}
  */
 template<class KEY,class VALUE>
 void MyHashTable<KEY,VALUE>::findBucketWithKey(KEY*key,uint64_t*probe,int*group,int*bucketInGroup){
+	findBucketWithHash(key,key->hash_function_2(),probe,group,bucketInGroup);
+}
+
+template<class KEY,class VALUE>
+void MyHashTable<KEY,VALUE>::findBucketWithHash(KEY*key,uint64_t hash,uint64_t*probe,int*group,int*bucketInGroup){
 	/** 
  * 	double hashing is based on 
  * 	page 529 
@@ -648,19 +799,25 @@ void MyHashTable<KEY,VALUE>::findBucketWithKey(KEY*key,uint64_t*probe,int*group,
  */
 	(*probe)=0; 
 
+	/** the first tombstone in the probe sequence */
+	bool foundTombstone=false;
+	uint64_t tombstoneProbe=0;
+	int tombstoneGroup=0;
+	int tombstoneBucketInGroup=0;
+
 	/** between 0 and M-1 -- M is m_totalNumberOfBuckets */
-	uint64_t h1=key->hash_function_2()%m_totalNumberOfBuckets;
+	uint64_t h1=hash&m_bucketMask;
 
 	/* first probe is 0 */
 	/** double hashing is computed on probe 1, not on 0 */
 	uint64_t h2=0;
 	uint64_t bucket=0;
 
-	bucket=(h1+(*probe)*h2)%m_totalNumberOfBuckets;
+	bucket=h1;
 
 	/** use double hashing */
-	(*group)=bucket/m_numberOfBucketsInGroup;
-	(*bucketInGroup)=bucket%m_numberOfBucketsInGroup;
+	(*group)=bucket>>m_groupShift;
+	(*bucketInGroup)=bucket&m_bucketInGroupMask;
 
 	#ifdef CONFIG_ASSERT
 	assert(bucket<m_totalNumberOfBuckets);
@@ -668,10 +825,18 @@ void MyHashTable<KEY,VALUE>::findBucketWithKey(KEY*key,uint64_t*probe,int*group,
 	assert(*bucketInGroup<m_numberOfBucketsInGroup);
 	#endif
 
-	/** probe bucket */
-	while(m_groups[*group].bucketIsUtilisedBySomeoneElse(*bucketInGroup,key,&m_allocator)
+	/** probe bucket, a tombstone does not end the probe sequence */
+	while((m_groups[*group].bucketIsUtilisedBySomeoneElse(*bucketInGroup,key,&m_allocator)
+		|| m_groups[*group].isTombstone(*bucketInGroup))
 		&& ((*probe)+1) < m_totalNumberOfBuckets){
 
+		if(!foundTombstone && m_groups[*group].isTombstone(*bucketInGroup)){
+			foundTombstone=true;
+			tombstoneProbe=*probe;
+			tombstoneGroup=*group;
+			tombstoneBucketInGroup=*bucketInGroup;
+		}
+
 		(*probe)++;
 		
 		/** the stride and the number of buckets are relatively prime because
@@ -690,37 +855,14 @@ void MyHashTable<KEY,VALUE>::findBucketWithKey(KEY*key,uint64_t*probe,int*group,
 
 		/** only compute the double hashing once */
 		if((*probe)==1){
-			/**  page 529 
- * 				between 1 and M-1 exclusive
-				odd number
- * 			*/
+			h2=getStride(key);
 
-			h2=key->hash_function_1()%m_totalNumberOfBuckets;
-			
-			/** h2 can not be 0 */
-			if(h2 == 0)
-				h2=1;
-
-			/** h2 can not be even */
-			if(h2%2 == 0)
-				h2--; 
-
-			/** check boundaries */
 			#ifdef CONFIG_ASSERT
-			assert(h2!=0);
-			assert(h2%2!=0);
-			assert(h2%2 == 1);
-			assert(h2>=1);
-
-/*
-			if(h2>=m_totalNumberOfBuckets)
-				cout<<"h2= "<<h2<<" Buckets= "<<m_totalNumberOfBuckets<<endl;
-*/
-			assert(h2<m_totalNumberOfBuckets);
 			assert((*probe)<m_totalNumberOfBuckets);
 			#endif
 		}
 
+
 		#ifdef CONFIG_ASSERT
 		assert(h2!=0);
 		#endif
@@ -728,13 +870,11 @@ void MyHashTable<KEY,VALUE>::findBucketWithKey(KEY*key,uint64_t*probe,int*group,
 		/** use double hashing */
 		//bucket=(h1+(*probe)*h2)%m_totalNumberOfBuckets;
 		
-		if(h2>bucket)
-			bucket+=m_totalNumberOfBuckets;
-
-		bucket-=h2;
+		/** the subtraction wraps around */
+		bucket=(bucket-h2)&m_bucketMask;
 
-		(*group)=bucket/m_numberOfBucketsInGroup;
-		(*bucketInGroup)=bucket%m_numberOfBucketsInGroup;
+		(*group)=bucket>>m_groupShift;
+		(*bucketInGroup)=bucket&m_bucketInGroupMask;
 
 		/** sanity checks */
 		#ifdef CONFIG_ASSERT
@@ -744,6 +884,15 @@ void MyHashTable<KEY,VALUE>::findBucketWithKey(KEY*key,uint64_t*probe,int*group,
 		#endif
 	}
 
+	/** the key is not in the table, so it can be inserted in the first tombstone */
+	if(foundTombstone && (m_groups[*group].getBit(*bucketInGroup)==0
+		|| m_groups[*group].bucketIsUtilisedBySomeoneElse(*bucketInGroup,key,&m_allocator))){
+
+		(*probe)=tombstoneProbe;
+		(*group)=tombstoneGroup;
+		(*bucketInGroup)=tombstoneBucketInGroup;
+	}
+
 	/** sanity checks */
 	#ifdef CONFIG_ASSERT
 	assert(bucket<m_totalNumberOfBuckets);
@@ -756,11 +905,11 @@ void MyHashTable<KEY,VALUE>::findBucketWithKey(KEY*key,uint64_t*probe,int*group,
  * finds a key
  */
 template<class KEY,class VALUE>
-VALUE*MyHashTable<KEY,VALUE>::findKey(KEY*key,bool checkAuxiliary){ /* for verbosity */
+VALUE*MyHashTable<KEY,VALUE>::findKey(KEY*key,uint64_t hash,bool checkAuxiliary){ /* for verbosity */
 
 	if(m_resizing && checkAuxiliary){
 		/* check the new one first */
-		VALUE*result=m_auxiliaryTableForIncrementalResize->find(key);
+		VALUE*result=m_auxiliaryTableForIncrementalResize->findKey(key,hash,true);
 		if(result!=NULL)
 			return result;
 	}
@@ -769,7 +918,7 @@ VALUE*MyHashTable<KEY,VALUE>::findKey(KEY*key,bool checkAuxiliary){ /* for verbo
 	uint64_t probe;
 	int group;
 	int bucketInGroup;
-	findBucketWithKey(key,&probe,&group,&bucketInGroup);
+	findBucketWithHash(key,hash,&probe,&group,&bucketInGroup);
 
 	#ifdef CONFIG_ASSERT
 	assert(group<m_numberOfGroups);
@@ -807,7 +956,110 @@ VALUE*MyHashTable<KEY,VALUE>::find(KEY*key){
 	assert(key!=NULL);
 	#endif
 
-	return findKey(key,true);
+	return findKey(key,key->hash_function_2(),true);
+}
+
+/**
+ * Each probe chases m_groups[group], then the lane and the group of the
+ * allocator to translate the SmartPointer of the vector, then the element.
+ * These are dependent loads, so for a single key they are all cache misses
+ * one after the other. Here each stage is done for all the keys before the
+ * next stage starts, so that the loads of a stage overlap.
+ */
+template<class KEY,class VALUE>
+void MyHashTable<KEY,VALUE>::prefetchFirstProbes(KEY*keys,uint64_t*hashes,int n){
+	int groups[2*MY_HASH_TABLE_BATCH_SIZE];
+	int buckets[2*MY_HASH_TABLE_BATCH_SIZE];
+
+	#ifdef CONFIG_ASSERT
+	assert(n<=MY_HASH_TABLE_BATCH_SIZE);
+	#endif
+
+	/* 
+	 * around 1 key in 4 is not in the bucket of its first probe when the
+	 * load is high, so the second probe is also prefetched
+	 */
+	int probes=0;
+
+	for(int i=0;i<n;i++){
+		uint64_t bucket=hashes[i]&m_bucketMask;
+		uint64_t h2=getStride(keys+i);
+
+		for(int probe=0;probe<2;probe++){
+			groups[probes]=bucket>>m_groupShift;
+			buckets[probes]=bucket&m_bucketInGroupMask;
+
+			__Prefetch(m_groups+groups[probes]);
+			probes++;
+
+			/* same as in findBucketWithHash */
+			bucket=(bucket-h2)&m_bucketMask;
+		}
+	}
+
+	for(int i=0;i<probes;i++)
+		m_groups[groups[i]].prefetchVector(&m_allocator);
+
+	for(int i=0;i<probes;i++)
+		m_groups[groups[i]].prefetchBucket(buckets[i],&m_allocator);
+}
+
+template<class KEY,class VALUE>
+void MyHashTable<KEY,VALUE>::findBatch(KEY*keys,int n,VALUE**out){
+	#ifdef CONFIG_ASSERT
+	assert(n>=0);
+	assert(n==0 || (keys!=NULL && out!=NULL));
+	#endif
+
+	uint64_t hashes[MY_HASH_TABLE_BATCH_SIZE];
+
+	for(int first=0;first<n;first+=MY_HASH_TABLE_BATCH_SIZE){
+		int count=n-first;
+		if(count>MY_HASH_TABLE_BATCH_SIZE)
+			count=MY_HASH_TABLE_BATCH_SIZE;
+
+		for(int i=0;i<count;i++)
+			hashes[i]=keys[first+i].hash_function_2();
+
+		/* the new table is checked first */
+		if(m_resizing)
+			m_auxiliaryTableForIncrementalResize->prefetchFirstProbes(keys+first,hashes,count);
+
+		prefetchFirstProbes(keys+first,hashes,count);
+
+		for(int i=0;i<count;i++)
+			out[first+i]=findKey(keys+first+i,hashes[i],true);
+	}
+}
+
+template<class KEY,class VALUE>
+void MyHashTable<KEY,VALUE>::insertBatch(KEY*keys,int n,VALUE**out){
+	#ifdef CONFIG_ASSERT
+	assert(n>=0);
+	assert(n==0 || keys!=NULL);
+	#endif
+
+	uint64_t hashes[MY_HASH_TABLE_BATCH_SIZE];
+
+	for(int first=0;first<n;first+=MY_HASH_TABLE_BATCH_SIZE){
+		int count=n-first;
+		if(count>MY_HASH_TABLE_BATCH_SIZE)
+			count=MY_HASH_TABLE_BATCH_SIZE;
+
+		for(int i=0;i<count;i++)
+			hashes[i]=keys[first+i].hash_function_2();
+
+		if(m_resizing)
+			m_auxiliaryTableForIncrementalResize->prefetchFirstProbes(keys+first,hashes,count);
+
+		prefetchFirstProbes(keys+first,hashes,count);
+
+		for(int i=0;i<count;i++)
+			insertKey(keys+first+i,hashes[i]);
+	}
+
+	if(out!=NULL)
+		findBatch(keys,n,out);
 }
 
 /**
@@ -817,6 +1069,15 @@ VALUE*MyHashTable<KEY,VALUE>::find(KEY*key){
  */
 template<class KEY,class VALUE>
 VALUE*MyHashTable<KEY,VALUE>::insert(KEY*key){
+	#ifdef CONFIG_ASSERT
+	assert(key!=NULL);
+	#endif
+
+	return insertKey(key,key->hash_function_2());
+}
+
+template<class KEY,class VALUE>
+VALUE*MyHashTable<KEY,VALUE>::insertKey(KEY*key,uint64_t hash){
 	/** do incremental resizing */
 	if(m_resizing){
 		resize();
@@ -827,7 +1088,7 @@ VALUE*MyHashTable<KEY,VALUE>::insert(KEY*key){
 		// Case 1. If a key is already in the new one, then the new one is 
 		// responsible, regardless if it was in the old one or not 
 
-		VALUE*fromAuxiliary=m_auxiliaryTableForIncrementalResize->findKey(key,false);
+		VALUE*fromAuxiliary=m_auxiliaryTableForIncrementalResize->findKey(key,hash,false);
 
 		if(fromAuxiliary!=NULL){
 			return fromAuxiliary;
@@ -838,9 +1099,9 @@ VALUE*MyHashTable<KEY,VALUE>::insert(KEY*key){
 		//
 		/* check if key is not in the main table
  		 * 		insert it in the other one */
-		if(findKey(key,false)==NULL){
+		if(findKey(key,hash,false)==NULL){
 			uint64_t sizeBefore=m_auxiliaryTableForIncrementalResize->m_utilisedBuckets;
-			VALUE*e=m_auxiliaryTableForIncrementalResize->insert(key);
+			VALUE*e=m_auxiliaryTableForIncrementalResize->insertKey(key,hash);
 			if(m_auxiliaryTableForIncrementalResize->m_utilisedBuckets>sizeBefore){
 				m_size++;
 			}
@@ -859,7 +1120,7 @@ VALUE*MyHashTable<KEY,VALUE>::insert(KEY*key){
 	uint64_t probe;
 	int group;
 	int bucketInGroup;
-	findBucketWithKey(key,&probe,&group,&bucketInGroup);
+	findBucketWithHash(key,hash,&probe,&group,&bucketInGroup);
 
 	#ifdef CONFIG_ASSERT
 	assert(group<m_numberOfGroups);
@@ -868,6 +1129,7 @@ VALUE*MyHashTable<KEY,VALUE>::insert(KEY*key){
 
 	/* actually insert something somewhere */
 	bool inserted=false;
+	bool tombstone=m_groups[group].isTombstone(bucketInGroup);
 	VALUE*entry=m_groups[group].insert(m_numberOfBucketsInGroup,bucketInGroup,key,&m_allocator,&inserted);
 
 	/* check that nothing failed elsewhere */
@@ -882,8 +1144,14 @@ VALUE*MyHashTable<KEY,VALUE>::insert(KEY*key){
 
 	/* increment the elements if an insertion occured */
 	if(inserted){
+		MyHashTableHashCache<KEY,VALUE>::setHash(entry,hash);
+
 		m_utilisedBuckets++;
 		m_size++;
+
+		if(tombstone)
+			m_tombstoneBuckets--;
+
 		/* update the maximum number of probes */
 		if(probe>(MAX_SAVED_PROBE-1))
 			probe=(MAX_SAVED_PROBE-1);
@@ -904,6 +1172,52 @@ VALUE*MyHashTable<KEY,VALUE>::insert(KEY*key){
 	return entry;
 }
 
+/**
+ * erases a key
+ * during incremental resizing, a key that was transferred is in both tables
+ */
+template<class KEY,class VALUE>
+bool MyHashTable<KEY,VALUE>::erase(KEY*key){
+	#ifdef CONFIG_ASSERT
+	assert(key!=NULL);
+	#endif
+
+	return eraseKey(key,key->hash_function_2());
+}
+
+template<class KEY,class VALUE>
+bool MyHashTable<KEY,VALUE>::eraseKey(KEY*key,uint64_t hash){
+	bool erased=false;
+
+	if(m_resizing && m_auxiliaryTableForIncrementalResize->eraseKey(key,hash))
+		erased=true;
+
+	uint64_t probe;
+	int group;
+	int bucketInGroup;
+	findBucketWithHash(key,hash,&probe,&group,&bucketInGroup);
+
+	if(m_groups[group].find(bucketInGroup,key,&m_allocator)!=NULL){
+		m_groups[group].erase(m_numberOfBucketsInGroup,bucketInGroup,key,&m_allocator);
+
+		m_utilisedBuckets--;
+		m_tombstoneBuckets++;
+
+		erased=true;
+	}
+
+	if(erased){
+		m_size--;
+		m_erasedKeys++;
+	}
+
+	#ifdef CONFIG_ASSERT
+	assert(findKey(key,hash,true)==NULL);
+	#endif
+
+	return erased;
+}
+
 /** destroy the hash table */
 template<class KEY,class VALUE>
 void MyHashTable<KEY,VALUE>::destructor(){
@@ -927,6 +1241,7 @@ void MyHashTable<KEY,VALUE>::printProbeStatistics(){
 
 	double loadFactor=(0.0+m_utilisedBuckets)/m_totalNumberOfBuckets*100;
 	cout<<"Rank "<<m_rank<<": MyHashTable, BucketGroups: "<<m_numberOfGroups<<", BucketsPerGroup: "<<m_numberOfBucketsInGroup<<", LoadFactor: "<<loadFactor<<"%, OccupiedBuckets: "<<m_utilisedBuckets<<"/"<<m_totalNumberOfBuckets<<endl;
+	cout<<"Rank "<<m_rank<<": Tombstones: "<<m_tombstoneBuckets<<", ErasedKeys: "<<m_erasedKeys<<endl;
 	cout<<"Rank "<<m_rank<<": incremental resizing in progress: ";
 	if(m_resizing)
 		cout<<"yes";
@@ -942,11 +1257,69 @@ void MyHashTable<KEY,VALUE>::printProbeStatistics(){
 
 	cout<<endl;
 
-	cout<<"Memory usage"<<endl;
+	/** the probe depth of a lookup for each key, tombstones included */
+	uint64_t lookupProbes[MAX_SAVED_PROBE];
+	for(int i=0;i<MAX_SAVED_PROBE;i++)
+		lookupProbes[i]=0;
+
+	for(uint64_t bucket=0;bucket<m_totalNumberOfBuckets;bucket++){
+		if(isAvailable(bucket))
+			continue;
+
+		KEY key=at(bucket)->getKey();
+		uint64_t probe;
+		int group;
+		int bucketInGroup;
+		findBucketWithKey(&key,&probe,&group,&bucketInGroup);
+
+		if(probe>(MAX_SAVED_PROBE-1))
+			probe=(MAX_SAVED_PROBE-1);
+		lookupProbes[probe]++;
+	}
+
+	cout<<"Rank "<<m_rank<<" LookupProbeStatistics: ";
+	for(int i=0;i<MAX_SAVED_PROBE;i++){
+		if(lookupProbes[i]!=0)
+			cout<<" "<<i<<" -> "<<lookupProbes[i]<<"";
+	}
+
+	cout<<endl;
+
+	uint64_t capacity=0;
+	for(int i=0;i<m_numberOfGroups;i++)
+		capacity+=m_groups[i].getCapacity();
+
+	uint64_t groupBytes=m_numberOfGroups*sizeof(MyHashTableGroup<KEY,VALUE>);
+	uint64_t valueBytes=m_utilisedBuckets*sizeof(VALUE);
+	uint64_t unusedBytes=(capacity-m_utilisedBuckets)*sizeof(VALUE);
+	cout<<"Memory usage: "<<groupBytes<<" bytes for groups, "<<valueBytes<<" bytes for values, ";
+	cout<<unusedBytes<<" bytes of unused capacity"<<endl;
+	cout<<"Allocator operations: "<<m_allocator.getOperations(__OPERATION_ALLOCATE)<<" allocate, ";
+	cout<<m_allocator.getOperations(__OPERATION_DEALLOCATE)<<" deallocate, ";
+	cout<<m_allocator.getOperations(__OPERATION_DEFRAGMENT)<<" defragment"<<endl;
 
 	m_allocator.print();
 }
 
+template<class KEY,class VALUE>
+uint64_t MyHashTable<KEY,VALUE>::getAllocatorOperations(int operationCode){
+	uint64_t operations=m_allocator.getOperations(operationCode);
+
+	if(m_resizing)
+		operations+=m_auxiliaryTableForIncrementalResize->getAllocatorOperations(operationCode);
+
+	return operations;
+}
+
+template<class KEY,class VALUE>
+void MyHashTable<KEY,VALUE>::defragment(){
+	for(int i=0;i<m_numberOfGroups;i++)
+		m_groups[i].shrink(&m_allocator);
+
+	if(m_resizing)
+		m_auxiliaryTableForIncrementalResize->defragment();
+}
+
 template<class KEY,class VALUE>
 void MyHashTable<KEY,VALUE>::completeResizing(){
 	while(m_resizing)
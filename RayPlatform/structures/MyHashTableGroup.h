@@ -60,11 +60,23 @@ class MyHashTableGroup{
  */
 	SmartPointer m_vector;
 
+	/**
+ * 	the number of VALUEs that fit in m_vector,
+ * 	it grows geometrically and shrink() gives back the rest
+ */
+	uint8_t m_capacity;
+
 	/**
  * 	the bitmap containing the presence of absence  of a bucket 
  */
 	uint64_t m_bitmap;
 
+	/**
+ * 	the bitmap of the buckets that had a key that was erased,
+ * 	these buckets are empty, but a probe sequence does not stop there
+ */
+	uint64_t m_tombstones;
+
 	/**
  * 	set a bit
  */
@@ -115,6 +127,40 @@ public:
  */
 	VALUE*find(int bucket,KEY*key,ChunkAllocatorWithDefragmentation*allocator);
 
+	/**
+ * 	erase the key of a bucket, the bucket becomes a tombstone
+ * 	should only be called if key is in the bucket
+ */
+	void erase(int numberOfBucketsInGroup,int bucket,KEY*key,ChunkAllocatorWithDefragmentation*allocator);
+
+	/**
+ * 	is the bucket a tombstone ?
+ */
+	bool isTombstone(int bucket);
+
+	/**
+ * 	reallocate the vector without unused capacity
+ */
+	void shrink(ChunkAllocatorWithDefragmentation*allocator);
+
+	int getCapacity();
+
+	/**
+ * 	prefetch the allocator meta-data of the vector
+ */
+	void prefetchVector(ChunkAllocatorWithDefragmentation*allocator);
+
+	/**
+ * 	prefetch the element of a bucket, the meta-data of the vector
+ * 	should be prefetched before with prefetchVector
+ */
+	void prefetchBucket(int bucket,ChunkAllocatorWithDefragmentation*allocator);
+
+	/**
+ * 	the capacity of a vector for a number of elements
+ */
+	static int getCapacityForElements(int elements,int numberOfBucketsInGroup);
+
 };
 
 /** sets the bit in the correct byte */
@@ -180,6 +226,7 @@ template<class KEY,class VALUE>
 void MyHashTableGroup<KEY,VALUE>::constructor(int numberOfBucketsInGroup,ChunkAllocatorWithDefragmentation*allocator){
 	/** we start with an empty m_vector */
 	m_vector=SmartPointer_NULL;
+	m_capacity=0;
 
 	/* the number of buckets in a group must be a multiple of 8 */
 	/* why ? => to save memory -- not to waste memory */
@@ -190,6 +237,7 @@ void MyHashTableGroup<KEY,VALUE>::constructor(int numberOfBucketsInGroup,ChunkAl
 
 	/** set all bits to 0 */
 	m_bitmap=0;
+	m_tombstones=0;
 }
 
 /**
@@ -235,6 +283,9 @@ VALUE*MyHashTableGroup<KEY,VALUE>::insert(int numberOfBucketsInGroup,int bucket,
 	/* the bucket is not occupied */
 	setBit(bucket,1);
 
+	/* a tombstone is reused */
+	m_tombstones&=~(((uint64_t)1)<<bucket);
+
 	#ifdef CONFIG_ASSERT
 	assert(getUsedBuckets()==usedBucketsBefore+1);
 	#endif
@@ -244,30 +295,45 @@ VALUE*MyHashTableGroup<KEY,VALUE>::insert(int numberOfBucketsInGroup,int bucket,
 	for(int i=bucket+1;i<numberOfBucketsInGroup;i++)
 		bucketsAfter+=getBit(i);
 
-	/* will allocate a new vector with one more element */
 	int requiredElements=(bucketsBefore+1+bucketsAfter);
-	SmartPointer newVector=allocator->allocate(requiredElements);
 
-	VALUE*newVectorPointer=(VALUE*)allocator->getPointer(newVector);
 	VALUE*vectorPointer=(VALUE*)allocator->getPointer(m_vector);
 
-	/* copy the buckets before */
-	for(int i=0;i<bucketsBefore;i++)
-		newVectorPointer[i]=vectorPointer[i];
+	/* there is room in the vector, the buckets after are moved by one */
+	if(requiredElements<=m_capacity){
 
-	/* copy the buckets after */
-	for(int i=0;i<bucketsAfter;i++)
-		newVectorPointer[bucketsBefore+1+i]=vectorPointer[bucketsBefore+i];
+		for(int i=bucketsAfter-1;i>=0;i--)
+			vectorPointer[bucketsBefore+1+i]=vectorPointer[bucketsBefore+i];
 
-	/* assign the new bucket */
-	newVectorPointer[bucketsBefore].setKey(*key);
-	
-	/* garbage the old vector, ChunkAllocatorWithDefragmentation will reuse it */
-	if(m_vector!=SmartPointer_NULL)
-		allocator->deallocate(m_vector);
+	/* otherwise, allocate a larger vector */
+	}else{
+		int capacity=getCapacityForElements(requiredElements,numberOfBucketsInGroup);
+		SmartPointer newVector=allocator->allocate(capacity);
 
-	/* assign the vector */
-	m_vector=newVector;
+		VALUE*newVectorPointer=(VALUE*)allocator->getPointer(newVector);
+		vectorPointer=(VALUE*)allocator->getPointer(m_vector);
+
+		/* copy the buckets before */
+		for(int i=0;i<bucketsBefore;i++)
+			newVectorPointer[i]=vectorPointer[i];
+
+		/* copy the buckets after */
+		for(int i=0;i<bucketsAfter;i++)
+			newVectorPointer[bucketsBefore+1+i]=vectorPointer[bucketsBefore+i];
+
+		/* garbage the old vector, ChunkAllocatorWithDefragmentation will reuse it */
+		if(m_vector!=SmartPointer_NULL)
+			allocator->deallocate(m_vector);
+
+		/* assign the vector */
+		m_vector=newVector;
+		m_capacity=capacity;
+
+		vectorPointer=(VALUE*)allocator->getPointer(m_vector);
+	}
+
+	/* assign the new bucket */
+	vectorPointer[bucketsBefore].setKey(*key);
 
 	/* check that everything is OK now ! */
 	#ifdef CONFIG_ASSERT
@@ -293,8 +359,8 @@ VALUE*MyHashTableGroup<KEY,VALUE>::insert(int numberOfBucketsInGroup,int bucket,
 	/** tell the caller that we inserted something  somewhere */
 	*inserted=true;
 
-	newVectorPointer=(VALUE*)allocator->getPointer(m_vector);
-	return newVectorPointer+bucketsBefore;
+	vectorPointer=(VALUE*)allocator->getPointer(m_vector);
+	return vectorPointer+bucketsBefore;
 }
 
 /** checks that the bucket is not utilised by someone else than key */
@@ -376,6 +442,122 @@ VALUE*MyHashTableGroup<KEY,VALUE>::find(int bucket,KEY*key,ChunkAllocatorWithDef
 	return vectorPointer+bucketsBefore;
 }
 
+template<class KEY,class VALUE>
+void MyHashTableGroup<KEY,VALUE>::prefetchVector(ChunkAllocatorWithDefragmentation*allocator){
+	if(m_vector!=SmartPointer_NULL)
+		allocator->prefetch(m_vector);
+}
+
+template<class KEY,class VALUE>
+void MyHashTableGroup<KEY,VALUE>::prefetchBucket(int bucket,ChunkAllocatorWithDefragmentation*allocator){
+	if(getBit(bucket)==0)
+		return;
+
+	VALUE*vectorPointer=(VALUE*)allocator->getPointer(m_vector);
+	__Prefetch(vectorPointer+getBucketsBefore(bucket));
+}
+
+/**
+ * erases a key from a group
+ * the buckets after are moved back by one
+ */
+template<class KEY,class VALUE>
+void MyHashTableGroup<KEY,VALUE>::erase(int numberOfBucketsInGroup,int bucket,KEY*key,
+	ChunkAllocatorWithDefragmentation*allocator){
+
+	#ifdef CONFIG_ASSERT
+	assert(getBit(bucket)==1);
+	assert(!bucketIsUtilisedBySomeoneElse(bucket,key,allocator));
+	#endif
+
+	int bucketsBefore=getBucketsBefore(bucket);
+
+	setBit(bucket,0);
+	m_tombstones|=(((uint64_t)1)<<bucket);
+
+	int bucketsAfter=0;
+	for(int i=bucket+1;i<numberOfBucketsInGroup;i++)
+		bucketsAfter+=getBit(i);
+
+	/* the last key of the group gives back its vector */
+	if(bucketsBefore+bucketsAfter==0){
+		allocator->deallocate(m_vector);
+		m_vector=SmartPointer_NULL;
+		m_capacity=0;
+	}else{
+		VALUE*vectorPointer=(VALUE*)allocator->getPointer(m_vector);
+
+		for(int i=0;i<bucketsAfter;i++)
+			vectorPointer[bucketsBefore+i]=vectorPointer[bucketsBefore+1+i];
+
+		/* a vector that is less than half full is not kept */
+		if(2*(bucketsBefore+bucketsAfter)<m_capacity)
+			shrink(allocator);
+	}
+
+	#ifdef CONFIG_ASSERT
+	assert(getBit(bucket)==0);
+	assert(isTombstone(bucket));
+	assert(find(bucket,key,allocator)==NULL);
+	#endif
+}
+
+template<class KEY,class VALUE>
+void MyHashTableGroup<KEY,VALUE>::shrink(ChunkAllocatorWithDefragmentation*allocator){
+
+	int usedBuckets=getUsedBuckets();
+
+	if(usedBuckets==m_capacity)
+		return;
+
+	#ifdef CONFIG_ASSERT
+	assert(usedBuckets>0);
+	assert(usedBuckets<m_capacity);
+	#endif
+
+	SmartPointer newVector=allocator->allocate(usedBuckets);
+
+	VALUE*newVectorPointer=(VALUE*)allocator->getPointer(newVector);
+	VALUE*vectorPointer=(VALUE*)allocator->getPointer(m_vector);
+
+	for(int i=0;i<usedBuckets;i++)
+		newVectorPointer[i]=vectorPointer[i];
+
+	allocator->deallocate(m_vector);
+
+	m_vector=newVector;
+	m_capacity=usedBuckets;
+}
+
+template<class KEY,class VALUE>
+int MyHashTableGroup<KEY,VALUE>::getCapacity(){
+	return m_capacity;
+}
+
+/**
+ * The capacities are 1, 2, 3, 5, 8, 12, 18, 27, 41, 62 and numberOfBucketsInGroup.
+ * With a growth of 1.5, a group of 64 buckets gets a new vector 10 times
+ * instead of 64 times and at most a third of a vector is unused.
+ */
+template<class KEY,class VALUE>
+int MyHashTableGroup<KEY,VALUE>::getCapacityForElements(int elements,int numberOfBucketsInGroup){
+
+	int capacity=1;
+
+	while(capacity<elements)
+		capacity+=(capacity+1)/2;
+
+	if(capacity>numberOfBucketsInGroup)
+		capacity=numberOfBucketsInGroup;
+
+	return capacity;
+}
+
+template<class KEY,class VALUE>
+bool MyHashTableGroup<KEY,VALUE>::isTombstone(int bucket){
+	return (m_tombstones>>bucket)&1;
+}
+
 #ifdef __hardware_debugging_gnuc
 template<class KEY,class VALUE>
 void MyHashTableGroup<KEY,VALUE>::__hash_print64(uint64_t a){
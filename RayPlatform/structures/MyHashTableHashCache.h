@@ -0,0 +1,58 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _MyHashTableHashCache_H
+#define _MyHashTableHashCache_H
+
+#include <stdint.h>
+
+/**
+ * Where MyHashTable gets the hash_function_2() of the key of a stored VALUE.
+ *
+ * By default, the hash is computed again from the key. A VALUE
+ * that has room for it can keep the hash instead, so that the incremental
+ * resize moves the elements without hashing any key. To do so, specialize
+ * this class for KEY and VALUE, for instance:
+ *
+ * template<>
+ * class MyHashTableHashCache<Kmer,Vertex>{
+ * public:
+ * 	static void setHash(Vertex*value,uint64_t hash){ value->m_hash=hash; }
+ * 	static uint64_t getHash(Vertex*value){ return value->m_hash; }
+ * };
+ *
+ * setHash is called once, when the key is inserted. The hash must then
+ * survive the assignments of the application to the VALUE.
+ *
+ * \author RayPlatform contributors
+ */
+template<class KEY,class VALUE>
+class MyHashTableHashCache{
+public:
+	static void setHash(VALUE*value,uint64_t hash){}
+
+	static uint64_t getHash(VALUE*value){
+		KEY key=value->getKey();
+		return key.hash_function_2();
+	}
+};
+
+#endif
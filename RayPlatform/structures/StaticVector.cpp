@@ -22,9 +22,13 @@
 #include "StaticVector.h"
 
 #include <RayPlatform/memory/allocator.h>
+#include <RayPlatform/core/OperatingSystem.h>
 
+#include <iostream>
 #include <assert.h>
 #include <string.h>
+#include <stdlib.h>
+using namespace std;
 
 void StaticVector::constructor(int size,const char* type,bool show){
 	strcpy(m_type,type);
@@ -50,14 +54,39 @@ Message*StaticVector::at(int i){
 }
 
 // The message is be passed as a pointer.
+// Writing past the end would corrupt the heap, so a full vector is fatal.
 void StaticVector::push_back(Message*a){
+	if(m_size==m_maxSize){
+		cout<<"Critical exception: "<<m_type<<" is full, its capacity is "<<m_maxSize<<" messages."<<endl;
+		exit(EXIT_STATIC_VECTOR_IS_FULL);
+	}
+
 	m_messages[m_size++]=*a;
 }
 
+/*
+ * This is O(n), but the inbox only holds a few messages.
+ */
+void StaticVector::erase(int i){
+	#ifdef CONFIG_ASSERT
+	assert(i>=0);
+	assert(i<m_size);
+	#endif
+
+	for(int j=i+1;j<m_size;j++)
+		m_messages[j-1]=m_messages[j];
+
+	m_size--;
+}
+
 int StaticVector::size(){
 	return m_size;
 }
 
+int StaticVector::getMaximumSize(){
+	return m_maxSize;
+}
+
 void StaticVector::clear(){
 	m_size=0;
 }
@@ -43,7 +43,11 @@ public:
 
 	// Messages are passed by reference or pointer.
 	void push_back(Message*a);
+
+	// Remove a message, the messages after it are shifted to keep the order.
+	void erase(int i);
 	int size();
+	int getMaximumSize();
 	void clear();
 	void constructor(int size,const char*type,bool show);
 
@@ -18,6 +18,7 @@ obj-y += RayPlatform/memory/DefragmentationGroup.o
 obj-y += RayPlatform/memory/ChunkAllocatorWithDefragmentation.o
 obj-y += RayPlatform/memory/DefragmentationLane.o
 obj-y += RayPlatform/memory/DirtyBuffer.o
+obj-y += RayPlatform/memory/BufferPool.o
 
 # routing stuff for option -route-messages
 obj-y += RayPlatform/routing/ConnectionGraph.o
@@ -35,10 +36,13 @@ obj-y += RayPlatform/routing/Torus.o
 obj-y += RayPlatform/communication/mpi_tags.o
 obj-y += RayPlatform/communication/VirtualCommunicator.o
 obj-y += RayPlatform/communication/BufferedData.o
+obj-y += RayPlatform/communication/MessageAggregator.o
+obj-y += RayPlatform/communication/MessageStreamer.o
 obj-y += RayPlatform/communication/Message.o
 obj-y += RayPlatform/communication/MessagesHandler.o
 obj-y += RayPlatform/communication/MessageQueue.o
 obj-y += RayPlatform/communication/MessageRouter.o
+obj-y += RayPlatform/communication/RelayFrame.o
 
 # scheduling
 obj-y += RayPlatform/scheduling/VirtualProcessor.o
@@ -52,6 +56,7 @@ obj-y += RayPlatform/core/slave_modes.o
 obj-y += RayPlatform/core/OperatingSystem.o
 obj-y += RayPlatform/core/master_modes.o
 obj-y += RayPlatform/core/statistics.o
+obj-y += RayPlatform/core/IdleBackoff.o
 
 # modular plugin architecture
 obj-y += RayPlatform/plugins/CorePlugin.o
@@ -59,6 +64,7 @@ obj-y += RayPlatform/plugins/RegisteredPlugin.o
 
 # structures
 obj-y += RayPlatform/structures/StaticVector.o 
+obj-y += RayPlatform/structures/HandleTable.o
 
 # profiling
 obj-y += RayPlatform/profiling/Profiler.o
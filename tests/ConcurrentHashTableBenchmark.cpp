@@ -0,0 +1,244 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Scaling benchmark for ConcurrentHashTable.
+ *
+ * A table is filled with keys, then 1, 2, 4, ... threads share a fixed
+ * number of operations on it: 80% find(), 10% insertAndLock() to update
+ * a VALUE in place and 10% insert() or erase() of keys owned by the
+ * thread. The operations per second and the speedup over one thread
+ * are reported for each number of threads. The speedup can not exceed
+ * the number of processors of the machine.
+ *
+ * Usage: ConcurrentHashTableBenchmark [-threads <maximum>] [-operations <n>] [-keys <n>] [-shards <n>]
+ *
+ * The defaults are 64 threads at most, 4000000 operations for each
+ * number of threads, 1000000 keys and 64 shards.
+ */
+
+#include <RayPlatform/structures/ConcurrentHashTable.h>
+#include <RayPlatform/cryptography/crypto.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <vector>
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_BUCKETS_PER_GROUP 64
+#define BENCHMARK_LOAD_FACTOR 0.7
+
+class BenchmarkKey{
+public:
+	uint64_t m_value;
+
+	uint64_t hash_function_1() const{
+		return uniform_hashing_function_1_64_64(m_value);
+	}
+
+	uint64_t hash_function_2() const{
+		return uniform_hashing_function_2_64_64(m_value);
+	}
+
+	void print(){
+		cout<<"BenchmarkKey "<<m_value<<endl;
+	}
+
+	bool operator==(const BenchmarkKey&key) const{
+		return m_value==key.m_value;
+	}
+
+	bool operator!=(const BenchmarkKey&key) const{
+		return m_value!=key.m_value;
+	}
+};
+
+class BenchmarkValue{
+public:
+	BenchmarkKey m_key;
+	uint64_t m_value;
+
+	BenchmarkKey getKey(){
+		return m_key;
+	}
+
+	void setKey(BenchmarkKey key){
+		m_key=key;
+		m_value=0;
+	}
+};
+
+typedef ConcurrentHashTable<BenchmarkKey,BenchmarkValue> BenchmarkTable;
+
+class BenchmarkThread{
+public:
+	BenchmarkTable*m_table;
+	pthread_barrier_t*m_barrier;
+	int m_thread;
+	uint64_t m_operations;
+	uint64_t m_keys;
+	uint64_t m_errors;
+};
+
+void*runThread(void*argument){
+
+	BenchmarkThread*thread=(BenchmarkThread*)argument;
+	BenchmarkTable*table=thread->m_table;
+
+	BenchmarkKey key;
+	BenchmarkValue value;
+
+	pthread_barrier_wait(thread->m_barrier);
+
+	for(uint64_t i=0;i<thread->m_operations;i++){
+		uint64_t random=uniform_hashing_function_1_64_64((((uint64_t)thread->m_thread)<<40)|i);
+		int operation=(random>>32)%10;
+
+		key.m_value=random%thread->m_keys;
+
+		if(operation<8){
+			if(!table->find(&key,&value))
+				thread->m_errors++;
+
+		}else if(operation==8){
+			BenchmarkValue*entry=table->insertAndLock(&key);
+			entry->m_value++;
+			table->unlock(&key);
+
+		}else{
+			// the keys of a thread are above the shared keys, each one is inserted then erased
+			key.m_value=thread->m_keys+(((uint64_t)thread->m_thread)<<40)+i/2;
+
+			if(i%2==0){
+				value.setKey(key);
+				table->insert(&key,&value);
+			}else{
+				table->erase(&key);
+			}
+		}
+	}
+
+	return NULL;
+}
+
+int main(int argc,char**argv){
+
+	int maximumThreads=64;
+	uint64_t operations=4000000;
+	uint64_t keys=1000000;
+	int shards=64;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-threads")==0 && i+1<argc)
+			maximumThreads=atoi(argv[i+1]);
+		else if(strcmp(argv[i],"-operations")==0 && i+1<argc)
+			operations=strtoull(argv[i+1],NULL,10);
+		else if(strcmp(argv[i],"-keys")==0 && i+1<argc)
+			keys=strtoull(argv[i+1],NULL,10);
+		else if(strcmp(argv[i],"-shards")==0 && i+1<argc)
+			shards=atoi(argv[i+1]);
+	}
+
+	if(keys<1)
+		keys=1;
+
+	uint64_t buckets=1024;
+
+	while(keys>=BENCHMARK_LOAD_FACTOR*buckets)
+		buckets*=2;
+
+	BenchmarkTable table;
+	table.constructor(buckets,"RAY_MALLOC_TYPE_BENCHMARK",false,0,
+		BENCHMARK_BUCKETS_PER_GROUP,BENCHMARK_LOAD_FACTOR,shards);
+
+	for(uint64_t i=0;i<keys;i++){
+		BenchmarkKey key;
+		key.m_value=i;
+
+		BenchmarkValue value;
+		value.setKey(key);
+
+		table.insert(&key,&value);
+	}
+
+	cout<<"ConcurrentHashTable: "<<keys<<" keys, "<<table.getNumberOfShards()<<" shards, ";
+	cout<<operations<<" operations for each number of threads, "<<sysconf(_SC_NPROCESSORS_ONLN)<<" processors"<<endl;
+
+	uint64_t errors=0;
+	double operationsPerSecondWithOneThread=0;
+
+	for(int threads=1;threads<=maximumThreads;threads*=2){
+
+		pthread_barrier_t barrier;
+		pthread_barrier_init(&barrier,NULL,threads+1);
+
+		vector<BenchmarkThread> states(threads);
+		vector<pthread_t> identifiers(threads);
+
+		for(int i=0;i<threads;i++){
+			states[i].m_table=&table;
+			states[i].m_barrier=&barrier;
+			states[i].m_thread=i;
+			states[i].m_operations=operations/threads;
+			states[i].m_keys=keys;
+			states[i].m_errors=0;
+		}
+
+		for(int i=0;i<threads;i++)
+			pthread_create(&(identifiers[i]),NULL,runThread,&(states[i]));
+
+		pthread_barrier_wait(&barrier);
+		uint64_t startingTime=getMicroseconds();
+
+		for(int i=0;i<threads;i++){
+			pthread_join(identifiers[i],NULL);
+			errors+=states[i].m_errors;
+		}
+
+		double seconds=(getMicroseconds()-startingTime)/1000000.0;
+		double operationsPerSecond=(operations/threads)*threads/seconds;
+
+		if(threads==1)
+			operationsPerSecondWithOneThread=operationsPerSecond;
+
+		cout<<threads<<" threads: "<<operationsPerSecond<<" operations/s, speedup ";
+		cout<<operationsPerSecond/operationsPerSecondWithOneThread<<endl;
+
+		pthread_barrier_destroy(&barrier);
+	}
+
+	table.destructor();
+
+	if(errors>0){
+		cout<<"Error: "<<errors<<" keys were not found"<<endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
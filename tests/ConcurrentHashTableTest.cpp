@@ -0,0 +1,333 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+/*
+ * Multithreaded test for ConcurrentHashTable.
+ *
+ * The threads run a fixed list of operations on one table at the same
+ * time:
+ *
+ * - insertAndLock() on keys shared by all the threads, to increment
+ *   counters in place
+ * - findAndLock() and find() on the shared keys, which are inserted
+ *   before the threads start, the VALUE must be consistent while the
+ *   lock is held and when it is copied
+ * - insert() and erase() on keys owned by each thread
+ *
+ * The final content does not depend on the order of the operations, so
+ * it is compared with the same operations run by one thread in a table
+ * with one shard. The keys of the threads make the shards grow, so
+ * they are resized while the threads use them.
+ *
+ * Usage: ConcurrentHashTableTest [threads] [operations per thread]
+ */
+
+#include <RayPlatform/structures/ConcurrentHashTable.h>
+#include <RayPlatform/cryptography/crypto.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <vector>
+#include <iostream>
+using namespace std;
+
+#define TEST_SHARED_KEYS 20000
+#define TEST_SHARDS 16
+#define TEST_BUCKETS 1024
+#define TEST_BUCKETS_PER_GROUP 64
+#define TEST_LOAD_FACTOR 0.7
+
+class TestKey{
+public:
+	uint64_t m_value;
+
+	uint64_t hash_function_1() const{
+		return uniform_hashing_function_1_64_64(m_value);
+	}
+
+	uint64_t hash_function_2() const{
+		return uniform_hashing_function_2_64_64(m_value);
+	}
+
+	void print(){
+		cout<<"TestKey "<<m_value<<endl;
+	}
+
+	bool operator==(const TestKey&key) const{
+		return m_value==key.m_value;
+	}
+
+	bool operator!=(const TestKey&key) const{
+		return m_value!=key.m_value;
+	}
+};
+
+/*
+ * m_check is always m_sum*3+m_count, a reader that sees another
+ * combination saw a VALUE that was changed without the lock.
+ */
+class TestValue{
+public:
+	TestKey m_key;
+	uint64_t m_count;
+	uint64_t m_sum;
+	uint64_t m_check;
+
+	TestKey getKey(){
+		return m_key;
+	}
+
+/* a new bucket can hold the bytes of a moved one */
+	void setKey(TestKey key){
+		m_key=key;
+		m_count=0;
+		m_sum=0;
+		m_check=0;
+	}
+
+	void add(uint64_t value){
+		m_count++;
+		m_sum+=value;
+		m_check=m_sum*3+m_count;
+	}
+
+	bool isConsistent(){
+		return m_check==m_sum*3+m_count;
+	}
+};
+
+typedef ConcurrentHashTable<TestKey,TestValue> TestTable;
+
+class TestThread{
+public:
+	TestTable*m_table;
+	int m_thread;
+	uint64_t m_operations;
+	uint64_t m_errors;
+};
+
+/*
+ * The operation i of a thread, the same in the concurrent and in the
+ * serial runs.
+ */
+void runOperation(TestTable*table,int thread,uint64_t i,uint64_t*errors){
+
+	uint64_t random=uniform_hashing_function_1_64_64((((uint64_t)thread)<<40)|i);
+
+	TestKey key;
+	key.m_value=random%TEST_SHARED_KEYS;
+
+	int operation=(random>>32)%8;
+
+	if(operation<=3){
+		TestValue*value=table->insertAndLock(&key);
+		value->add(random>>48);
+		table->unlock(&key);
+
+	}else if(operation==4){
+		// the shared keys are inserted before the threads start
+		TestValue*value=table->findAndLock(&key);
+
+		if(value==NULL || value->getKey()!=key || !value->isConsistent())
+			(*errors)++;
+		else
+			value->add(1);
+
+		table->unlock(&key);
+
+	}else if(operation==5){
+		TestValue value;
+
+		if(!table->find(&key,&value) || value.getKey()!=key || !value.isConsistent())
+			(*errors)++;
+
+	}else{
+		// the keys of a thread are above the shared keys
+		TestKey ownKey;
+		ownKey.m_value=TEST_SHARED_KEYS+(((uint64_t)thread)<<32)+i/2;
+
+		TestValue value;
+		value.setKey(ownKey);
+		value.add(i);
+
+		if(i%2==0){
+			if(!table->insert(&ownKey,&value))
+				(*errors)++;
+		}else if(i%6==1){
+			// the key is absent if the operation i-1 was not an insert()
+			TestValue copy;
+			bool present=table->find(&ownKey,&copy);
+
+			if(table->erase(&ownKey)!=present)
+				(*errors)++;
+		}else{
+			// the key was inserted by the operation i-1 if it was also an insert()
+			TestValue copy;
+			if(table->find(&ownKey,&copy) && copy.m_sum!=i-1)
+				(*errors)++;
+		}
+	}
+}
+
+void insertSharedKeys(TestTable*table){
+
+	for(uint64_t i=0;i<TEST_SHARED_KEYS;i++){
+		TestKey key;
+		key.m_value=i;
+
+		TestValue value;
+		value.setKey(key);
+		value.add(i);
+
+		table->insert(&key,&value);
+	}
+}
+
+void*runThread(void*argument){
+
+	TestThread*thread=(TestThread*)argument;
+
+	for(uint64_t i=0;i<thread->m_operations;i++)
+		runOperation(thread->m_table,thread->m_thread,i,&(thread->m_errors));
+
+	return NULL;
+}
+
+/*
+ * Every key of the serial table must have the same VALUE
+ * in the concurrent one, and both must have the same size.
+ */
+uint64_t compareTables(TestTable*concurrent,TestTable*serial,int threads,uint64_t operations){
+
+	uint64_t errors=0;
+	uint64_t keys=0;
+
+	vector<TestKey> candidates;
+
+	for(uint64_t i=0;i<TEST_SHARED_KEYS;i++){
+		TestKey key;
+		key.m_value=i;
+		candidates.push_back(key);
+	}
+
+	for(int thread=0;thread<threads;thread++){
+		for(uint64_t i=0;i<operations;i+=2){
+			TestKey key;
+			key.m_value=TEST_SHARED_KEYS+(((uint64_t)thread)<<32)+i/2;
+			candidates.push_back(key);
+		}
+	}
+
+	for(int i=0;i<(int)candidates.size();i++){
+		TestValue expected;
+		TestValue actual;
+
+		bool inSerial=serial->find(&(candidates[i]),&expected);
+		bool inConcurrent=concurrent->find(&(candidates[i]),&actual);
+
+		if(inSerial)
+			keys++;
+
+		if(inSerial!=inConcurrent){
+			errors++;
+		}else if(inSerial && (actual.m_count!=expected.m_count || actual.m_sum!=expected.m_sum
+				|| !actual.isConsistent())){
+			errors++;
+		}
+	}
+
+	if(keys!=serial->size() || concurrent->size()!=serial->size()){
+		cout<<"Error: "<<concurrent->size()<<" keys instead of "<<serial->size()<<endl;
+		errors++;
+	}
+
+	return errors;
+}
+
+int main(int argc,char**argv){
+
+	int threads=4;
+	uint64_t operations=300000;
+
+	if(argc>1)
+		threads=atoi(argv[1]);
+	if(argc>2)
+		operations=strtoull(argv[2],NULL,10);
+
+	TestTable concurrent;
+	concurrent.constructor(TEST_BUCKETS,"RAY_MALLOC_TYPE_TEST",false,0,
+		TEST_BUCKETS_PER_GROUP,TEST_LOAD_FACTOR,TEST_SHARDS);
+
+	insertSharedKeys(&concurrent);
+
+	vector<TestThread> states(threads);
+	vector<pthread_t> identifiers(threads);
+
+	for(int i=0;i<threads;i++){
+		states[i].m_table=&concurrent;
+		states[i].m_thread=i;
+		states[i].m_operations=operations;
+		states[i].m_errors=0;
+	}
+
+	for(int i=0;i<threads;i++)
+		pthread_create(&(identifiers[i]),NULL,runThread,&(states[i]));
+
+	uint64_t errors=0;
+
+	for(int i=0;i<threads;i++){
+		pthread_join(identifiers[i],NULL);
+		errors+=states[i].m_errors;
+	}
+
+	TestTable serial;
+	serial.constructor(TEST_BUCKETS,"RAY_MALLOC_TYPE_TEST",false,0,
+		TEST_BUCKETS_PER_GROUP,TEST_LOAD_FACTOR,1);
+
+	insertSharedKeys(&serial);
+
+	for(int thread=0;thread<threads;thread++){
+		for(uint64_t i=0;i<operations;i++)
+			runOperation(&serial,thread,i,&errors);
+	}
+
+	errors+=compareTables(&concurrent,&serial,threads,operations);
+
+	// the elements are moved, the content must stay the same
+	concurrent.completeResizing();
+	concurrent.defragment();
+
+	errors+=compareTables(&concurrent,&serial,threads,operations);
+
+	concurrent.printStatistics();
+
+	cout<<"ConcurrentHashTable: "<<threads<<" threads, "<<operations<<" operations per thread, ";
+	cout<<serial.size()<<" keys, "<<errors<<" errors ";
+	cout<<(errors==0?"PASSED":"FAILED")<<endl;
+
+	concurrent.destructor();
+	serial.destructor();
+
+	return errors==0?EXIT_SUCCESS:EXIT_FAILURE;
+}
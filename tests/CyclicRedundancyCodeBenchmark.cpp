@@ -0,0 +1,137 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Throughput micro-benchmark for the CRC-32 and CRC-32C kernels of
+ * crypto.cpp, on messages of MAXIMUM_MESSAGE_SIZE_IN_BYTES bytes like
+ * the ones checksummed with -compute-checksums.
+ *
+ * The byte-at-a-time table walk, that crypto.cpp used before the
+ * slicing-by-16 kernels, is measured too as the baseline.
+ *
+ * Usage: CyclicRedundancyCodeBenchmark [-megabytes <n>]
+ *
+ * The default is 1024 MB per kernel.
+ */
+
+#include <RayPlatform/cryptography/crypto.h>
+#include <RayPlatform/core/types.h>
+
+#include <sys/time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_MESSAGES 64
+
+uint32_t g_table[256];
+
+void constructTable(){
+	for(uint32_t byte=0;byte<256;byte++){
+		uint32_t value=byte;
+
+		for(int bit=0;bit<8;bit++)
+			value=(value>>1)^((value&1)?0xedb88320:0);
+
+		g_table[byte]=value;
+	}
+}
+
+/** the byte-at-a-time table walk */
+uint32_t computeCyclicRedundancyCode32WithOneTable(uint8_t*bytes,uint32_t numberOfBytes){
+	uint32_t checksum=0xffffffff;
+
+	for(uint32_t i=0;i<numberOfBytes;i++)
+		checksum=(checksum>>8)^g_table[(checksum^bytes[i])&0xff];
+
+	return checksum^0xffffffff;
+}
+
+double getSeconds(){
+	struct timeval now;
+	gettimeofday(&now,NULL);
+
+	return now.tv_sec+now.tv_usec/1000000.0;
+}
+
+/** returns the checksum of the last message so that the loop is not optimized away */
+uint32_t benchmark(const char*name,uint32_t (*kernel)(uint8_t*,uint32_t),uint8_t*messages,uint64_t megabytes){
+
+	uint64_t iterations=megabytes*1024*1024/MAXIMUM_MESSAGE_SIZE_IN_BYTES;
+	uint32_t checksum=0;
+
+	double start=getSeconds();
+
+	for(uint64_t i=0;i<iterations;i++){
+		uint8_t*message=messages+(i%BENCHMARK_MESSAGES)*MAXIMUM_MESSAGE_SIZE_IN_BYTES;
+		checksum^=kernel(message,MAXIMUM_MESSAGE_SIZE_IN_BYTES);
+	}
+
+	double seconds=getSeconds()-start;
+	double bytes=iterations*(double)MAXIMUM_MESSAGE_SIZE_IN_BYTES;
+
+	cout<<name<<": "<<bytes/seconds/1000000<<" MB/s, "<<seconds*1000000000/iterations<<" ns/message"<<endl;
+
+	return checksum;
+}
+
+int main(int argc,char**argv){
+
+	uint64_t megabytes=1024;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-megabytes")==0 && i+1<argc)
+			megabytes=strtoull(argv[i+1],NULL,10);
+	}
+
+	constructTable();
+
+	uint8_t*messages=(uint8_t*)malloc(BENCHMARK_MESSAGES*MAXIMUM_MESSAGE_SIZE_IN_BYTES);
+
+	srand(42);
+
+	for(int i=0;i<BENCHMARK_MESSAGES*MAXIMUM_MESSAGE_SIZE_IN_BYTES;i++)
+		messages[i]=rand()%256;
+
+	uint32_t checksum=0;
+
+	cout<<"Message size: "<<MAXIMUM_MESSAGE_SIZE_IN_BYTES<<" bytes"<<endl;
+
+	checksum+=benchmark("CRC-32, one table",computeCyclicRedundancyCode32WithOneTable,messages,megabytes);
+	checksum+=benchmark("CRC-32, slicing-by-16",computeCyclicRedundancyCode32,messages,megabytes);
+	checksum+=benchmark("CRC-32C, slicing-by-16",computeCastagnoliCode32WithTables,messages,megabytes);
+
+	if(hasHardwareCastagnoliCode32())
+		checksum+=benchmark("CRC-32C, SSE 4.2",computeCastagnoliCode32,messages,megabytes);
+	else
+		cout<<"CRC-32C, SSE 4.2: not available on this processor"<<endl;
+
+	cout<<"Sum of the checksums: "<<hex<<checksum<<dec<<endl;
+
+	free(messages);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Test for the CRC-32 and CRC-32C kernels of crypto.cpp.
+ *
+ * - the check values of "123456789": cbf43926 for CRC-32 and e3069283
+ *   for CRC-32C
+ * - the slicing-by-16 kernels against a bitwise reference, for every
+ *   length up to a few slices and every alignment
+ * - the SSE 4.2 CRC-32C against the CRC-32C of the tables, when the
+ *   processor has the crc32 instruction. negotiateWireFormat picks
+ *   CRC-32C only if all the ranks have it, but the checksums of all
+ *   the ranks must match anyway.
+ *
+ * Usage: CyclicRedundancyCodeTest [random buffers]
+ */
+
+#include <RayPlatform/cryptography/crypto.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <iostream>
+using namespace std;
+
+#define TEST_MAXIMUM_LENGTH 200
+#define TEST_ALIGNMENTS 16
+#define TEST_LARGE_BUFFER 4096
+
+uint32_t computeBitwise(uint32_t polynomial,uint8_t*bytes,uint32_t numberOfBytes){
+
+	uint32_t checksum=0xffffffff;
+
+	for(uint32_t i=0;i<numberOfBytes;i++){
+		checksum^=bytes[i];
+
+		for(int bit=0;bit<8;bit++)
+			checksum=(checksum>>1)^((checksum&1)?polynomial:0);
+	}
+
+	return checksum^0xffffffff;
+}
+
+uint32_t computeCyclicRedundancyCode32WithBits(uint8_t*bytes,uint32_t numberOfBytes){
+	return computeBitwise(0xedb88320,bytes,numberOfBytes);
+}
+
+uint32_t computeCastagnoliCode32WithBits(uint8_t*bytes,uint32_t numberOfBytes){
+	return computeBitwise(0x82f63b78,bytes,numberOfBytes);
+}
+
+bool checkCode(const char*name,uint32_t code,uint32_t expected,int length,int alignment){
+	if(code==expected)
+		return true;
+
+	cout<<"Error: "<<name<<" is "<<hex<<code<<", expected "<<expected<<dec;
+	cout<<" ("<<length<<" bytes at offset "<<alignment<<")"<<endl;
+
+	return false;
+}
+
+/*
+ * compare every kernel with the bitwise reference
+ */
+bool checkBuffer(uint8_t*bytes,int length,int alignment){
+	bool success=true;
+
+	uint32_t crc32=computeCyclicRedundancyCode32WithBits(bytes,length);
+	uint32_t crc32c=computeCastagnoliCode32WithBits(bytes,length);
+
+	if(!checkCode("CRC-32",computeCyclicRedundancyCode32(bytes,length),crc32,length,alignment))
+		success=false;
+
+	if(!checkCode("CRC-32C tables",computeCastagnoliCode32WithTables(bytes,length),crc32c,length,alignment))
+		success=false;
+
+	// with the crc32 instruction if the processor has it
+	if(!checkCode("CRC-32C",computeCastagnoliCode32(bytes,length),crc32c,length,alignment))
+		success=false;
+
+	if(!checkCode("CRC-32 checksum",computeChecksum(CHECKSUM_CRC32,bytes,length),crc32,length,alignment))
+		success=false;
+
+	if(!checkCode("CRC-32C checksum",computeChecksum(CHECKSUM_CRC32C,bytes,length),crc32c,length,alignment))
+		success=false;
+
+	return success;
+}
+
+int main(int argc,char**argv){
+
+	int randomBuffers=1000;
+
+	if(argc>1)
+		randomBuffers=atoi(argv[1]);
+
+	bool success=true;
+
+	uint8_t check[]={'1','2','3','4','5','6','7','8','9'};
+
+	if(!checkCode("CRC-32 of 123456789",computeCyclicRedundancyCode32(check,9),0xcbf43926,9,0))
+		success=false;
+
+	if(!checkCode("CRC-32C of 123456789",computeCastagnoliCode32(check,9),0xe3069283,9,0))
+		success=false;
+
+	if(!checkCode("CRC-32C tables of 123456789",computeCastagnoliCode32WithTables(check,9),0xe3069283,9,0))
+		success=false;
+
+	if(!checkCode("CRC-32 of nothing",computeCyclicRedundancyCode32(check,0),0,0,0))
+		success=false;
+
+	if(!checkCode("CRC-32C of nothing",computeCastagnoliCode32(check,0),0,0,0))
+		success=false;
+
+	uint8_t buffer[TEST_LARGE_BUFFER+TEST_ALIGNMENTS];
+
+	srand(42);
+
+	for(int i=0;i<TEST_LARGE_BUFFER+TEST_ALIGNMENTS;i++)
+		buffer[i]=rand()%256;
+
+	// the tails of the slices and of the 64-bit words, at every alignment
+	for(int alignment=0;alignment<TEST_ALIGNMENTS;alignment++){
+		for(int length=0;length<=TEST_MAXIMUM_LENGTH;length++){
+			if(!checkBuffer(buffer+alignment,length,alignment))
+				success=false;
+		}
+	}
+
+	for(int i=0;i<randomBuffers;i++){
+		int alignment=rand()%TEST_ALIGNMENTS;
+		int length=rand()%(TEST_LARGE_BUFFER+1);
+
+		for(int j=0;j<length;j++)
+			buffer[alignment+j]=rand()%256;
+
+		if(!checkBuffer(buffer+alignment,length,alignment))
+			success=false;
+	}
+
+	cout<<"Cyclic redundancy codes: check values, "<<TEST_ALIGNMENTS*(TEST_MAXIMUM_LENGTH+1);
+	cout<<" short buffers and "<<randomBuffers<<" random buffers, CRC-32C ";
+	cout<<(hasHardwareCastagnoliCode32()?"with":"without")<<" the crc32 instruction ";
+	cout<<(success?"PASSED":"FAILED")<<endl;
+
+	return success?EXIT_SUCCESS:EXIT_FAILURE;
+}
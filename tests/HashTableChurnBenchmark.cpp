@@ -0,0 +1,186 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Churn benchmark for MyHashTable::erase.
+ *
+ * The table holds a sliding window of live keys: each step inserts a
+ * new key, erases the oldest live key and finds a random live key. The
+ * erased keys leave tombstones, so the table is rebuilt with the same
+ * size from time to time to clean them.
+ *
+ * The steps per second, the rebuilds and the growth of the data segment
+ * are reported, then printProbeStatistics prints the load, the
+ * tombstones, the probe depths and the memory usage of the table.
+ *
+ * Usage: HashTableChurnBenchmark [-steps <n>] [-window <live keys>]
+ *
+ * The defaults are 2000000 steps and 250000 live keys.
+ */
+
+#include <RayPlatform/structures/MyHashTable.h>
+#include <RayPlatform/cryptography/crypto.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_BUCKETS 1024
+#define BENCHMARK_BUCKETS_PER_GROUP 64
+#define BENCHMARK_LOAD_FACTOR 0.7
+
+class BenchmarkKey{
+public:
+	uint64_t m_value;
+
+	uint64_t hash_function_1() const{
+		return uniform_hashing_function_1_64_64(m_value);
+	}
+
+	uint64_t hash_function_2() const{
+		return uniform_hashing_function_2_64_64(m_value);
+	}
+
+	void print(){
+		cout<<"BenchmarkKey "<<m_value<<endl;
+	}
+
+	bool operator==(const BenchmarkKey&key) const{
+		return m_value==key.m_value;
+	}
+
+	bool operator!=(const BenchmarkKey&key) const{
+		return m_value!=key.m_value;
+	}
+};
+
+class BenchmarkValue{
+public:
+	BenchmarkKey m_key;
+	uint64_t m_value;
+
+	BenchmarkKey getKey(){
+		return m_key;
+	}
+
+	void setKey(BenchmarkKey key){
+		m_key=key;
+		m_value=0;
+	}
+};
+
+int main(int argc,char**argv){
+
+	uint64_t steps=2000000;
+	uint64_t window=250000;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-steps")==0 && i+1<argc)
+			steps=strtoull(argv[i+1],NULL,10);
+		else if(strcmp(argv[i],"-window")==0 && i+1<argc)
+			window=strtoull(argv[i+1],NULL,10);
+	}
+
+	if(window<1)
+		window=1;
+
+	uint64_t startingMemory=getMemoryUsageInKiBytes();
+
+	MyHashTable<BenchmarkKey,BenchmarkValue> table;
+	table.constructor(BENCHMARK_BUCKETS,"RAY_MALLOC_TYPE_BENCHMARK",false,0,
+		BENCHMARK_BUCKETS_PER_GROUP,BENCHMARK_LOAD_FACTOR);
+
+	BenchmarkKey key;
+	uint64_t errors=0;
+
+	for(uint64_t i=0;i<window;i++){
+		key.m_value=i;
+		table.insert(&key)->m_value=i;
+	}
+
+	table.completeResizing();
+
+	uint64_t filledMemory=getMemoryUsageInKiBytes();
+	uint64_t rebuilds=0;
+	uint64_t growths=0;
+	uint64_t capacity=table.capacity();
+	bool resizing=false;
+
+	uint64_t startingTime=getMicroseconds();
+
+	for(uint64_t step=0;step<steps;step++){
+		uint64_t newest=window+step;
+
+		key.m_value=newest;
+		table.insert(&key)->m_value=newest;
+
+		key.m_value=step;
+		if(!table.erase(&key))
+			errors++;
+
+		key.m_value=step+1+uniform_hashing_function_1_64_64(step)%window;
+		BenchmarkValue*value=table.find(&key);
+
+		if(value==NULL || value->m_value!=key.m_value)
+			errors++;
+
+		/* a resize starts in insert() */
+		if(table.needsToCompleteResizing()!=resizing){
+			resizing=!resizing;
+
+			if(!resizing){
+				if(table.capacity()==capacity)
+					rebuilds++;
+				else
+					growths++;
+
+				capacity=table.capacity();
+			}
+		}
+	}
+
+	double seconds=(getMicroseconds()-startingTime)/1000000.0;
+
+	cout<<"MyHashTable churn: "<<steps<<" steps (insert, erase, find) with "<<window<<" live keys in ";
+	cout<<seconds<<" s, "<<steps/seconds<<" steps/s, "<<rebuilds<<" rebuilds with the same size, ";
+	cout<<growths<<" growths, "<<table.capacity()<<" buckets"<<endl;
+
+	cout<<"Data segment: "<<(filledMemory-startingMemory)/1024<<" MiB after the first insertions, ";
+	cout<<(getMemoryUsageInKiBytes()-startingMemory)/1024<<" MiB after the churn"<<endl;
+
+	table.toggleVerbosity();
+	table.printProbeStatistics();
+
+	table.destructor();
+
+	if(errors>0){
+		cout<<"Error: "<<errors<<" failed erase or find calls"<<endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Insert-heavy benchmark for MyHashTable.
+ *
+ * Random keys are inserted in a table that has enough buckets for all
+ * of them, so that no resize happens and all the allocator operations
+ * come from the growth of the groups. The inserts per second and the
+ * operations of the ChunkAllocatorWithDefragmentation of the values
+ * (allocate, deallocate and defragment, summed over its
+ * DefragmentationGroup objects) are reported. Then defragment() gives
+ * back the unused capacity of the groups and its cost is reported.
+ *
+ * Usage: HashTableInsertBenchmark [-inserts <n>] [-buckets <n>]
+ *
+ * The default is 2000000 inserts. With -buckets, the table starts with
+ * this number of buckets and can grow, and the operations of the tables
+ * replaced by a resize are not counted.
+ */
+
+#include <RayPlatform/structures/MyHashTable.h>
+#include <RayPlatform/cryptography/crypto.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_BUCKETS_PER_GROUP 64
+#define BENCHMARK_LOAD_FACTOR 0.7
+
+class BenchmarkKey{
+public:
+	uint64_t m_value;
+
+	uint64_t hash_function_1() const{
+		return uniform_hashing_function_1_64_64(m_value);
+	}
+
+	uint64_t hash_function_2() const{
+		return uniform_hashing_function_2_64_64(m_value);
+	}
+
+	void print(){
+		cout<<"BenchmarkKey "<<m_value<<endl;
+	}
+
+	bool operator==(const BenchmarkKey&key) const{
+		return m_value==key.m_value;
+	}
+
+	bool operator!=(const BenchmarkKey&key) const{
+		return m_value!=key.m_value;
+	}
+};
+
+class BenchmarkValue{
+public:
+	BenchmarkKey m_key;
+	uint64_t m_value;
+
+	BenchmarkKey getKey(){
+		return m_key;
+	}
+
+	void setKey(BenchmarkKey key){
+		m_key=key;
+		m_value=0;
+	}
+};
+
+typedef MyHashTable<BenchmarkKey,BenchmarkValue> BenchmarkTable;
+
+void printOperations(BenchmarkTable*table,uint64_t inserts){
+	uint64_t allocations=table->getAllocatorOperations(__OPERATION_ALLOCATE);
+	uint64_t deallocations=table->getAllocatorOperations(__OPERATION_DEALLOCATE);
+	uint64_t defragmentations=table->getAllocatorOperations(__OPERATION_DEFRAGMENT);
+
+	cout<<"Allocator operations: "<<allocations<<" allocate, "<<deallocations<<" deallocate, ";
+	cout<<defragmentations<<" defragment";
+
+	if(inserts>0)
+		cout<<" ("<<(0.0+allocations+deallocations+defragmentations)/inserts<<" per insert)";
+
+	cout<<endl;
+}
+
+int main(int argc,char**argv){
+
+	uint64_t inserts=2000000;
+	uint64_t buckets=0;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-inserts")==0 && i+1<argc)
+			inserts=strtoull(argv[i+1],NULL,10);
+		else if(strcmp(argv[i],"-buckets")==0 && i+1<argc)
+			buckets=strtoull(argv[i+1],NULL,10);
+	}
+
+	if(buckets==0){
+		buckets=1024;
+
+		while(inserts>=BENCHMARK_LOAD_FACTOR*buckets)
+			buckets*=2;
+	}
+
+	BenchmarkTable table;
+	table.constructor(buckets,"RAY_MALLOC_TYPE_BENCHMARK",false,0,
+		BENCHMARK_BUCKETS_PER_GROUP,BENCHMARK_LOAD_FACTOR);
+
+	BenchmarkKey key;
+	uint64_t startingMemory=getMemoryUsageInKiBytes();
+	uint64_t startingTime=getMicroseconds();
+
+	for(uint64_t i=0;i<inserts;i++){
+		key.m_value=uniform_hashing_function_2_64_64(i);
+		table.insert(&key)->m_value=i;
+	}
+
+	double seconds=(getMicroseconds()-startingTime)/1000000.0;
+
+	cout<<"MyHashTable inserts: "<<inserts<<" keys in "<<buckets<<" buckets";
+
+	if(table.capacity()!=buckets)
+		cout<<" (now "<<table.capacity()<<")";
+
+	cout<<", "<<seconds<<" s, "<<inserts/seconds<<" inserts/s, ";
+	cout<<(getMemoryUsageInKiBytes()-startingMemory)/1024<<" MiB of data segment"<<endl;
+
+	printOperations(&table,inserts);
+
+	startingTime=getMicroseconds();
+
+	table.defragment();
+
+	seconds=(getMicroseconds()-startingTime)/1000000.0;
+
+	cout<<"defragment(): "<<seconds<<" s"<<endl;
+
+	printOperations(&table,inserts);
+
+	uint64_t errors=0;
+
+	for(uint64_t i=0;i<inserts;i++){
+		key.m_value=uniform_hashing_function_2_64_64(i);
+		BenchmarkValue*value=table.find(&key);
+
+		if(value==NULL || value->m_value!=i)
+			errors++;
+	}
+
+	table.destructor();
+
+	if(errors>0){
+		cout<<"Error: "<<errors<<" keys were not found after defragment()"<<endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
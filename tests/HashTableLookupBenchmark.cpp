@@ -0,0 +1,278 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Lookup benchmark for MyHashTable::find and MyHashTable::findBatch.
+ *
+ * A table is filled with random keys, then the same random lookups are
+ * done one key at a time with find() and in batches of
+ * MY_HASH_TABLE_BATCH_SIZE keys with findBatch(). Half of the looked up
+ * keys are in the table. The time and the last-level cache misses
+ * (PERF_COUNT_HW_CACHE_MISSES of perf_event_open, on Linux) per lookup
+ * are reported. The misses are not available if the kernel does not
+ * allow the performance counters, see
+ * /proc/sys/kernel/perf_event_paranoid.
+ *
+ * Usage: HashTableLookupBenchmark [-entries <n>] [-lookups <n>]
+ *
+ * The defaults are 10000000 entries and 10000000 lookups. A table of
+ * 100000000 entries needs about 2.5 GiB.
+ */
+
+#include <RayPlatform/structures/MyHashTable.h>
+#include <RayPlatform/cryptography/crypto.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <vector>
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_BUCKETS_PER_GROUP 64
+#define BENCHMARK_LOAD_FACTOR 0.7
+
+class BenchmarkKey{
+public:
+	uint64_t m_value;
+
+	uint64_t hash_function_1() const{
+		return uniform_hashing_function_1_64_64(m_value);
+	}
+
+	uint64_t hash_function_2() const{
+		return uniform_hashing_function_2_64_64(m_value);
+	}
+
+	void print(){
+		cout<<"BenchmarkKey "<<m_value<<endl;
+	}
+
+	bool operator==(const BenchmarkKey&key) const{
+		return m_value==key.m_value;
+	}
+
+	bool operator!=(const BenchmarkKey&key) const{
+		return m_value!=key.m_value;
+	}
+};
+
+class BenchmarkValue{
+public:
+	BenchmarkKey m_key;
+	uint64_t m_value;
+
+	BenchmarkKey getKey(){
+		return m_key;
+	}
+
+	void setKey(BenchmarkKey key){
+		m_key=key;
+		m_value=0;
+	}
+};
+
+typedef MyHashTable<BenchmarkKey,BenchmarkValue> BenchmarkTable;
+
+/** the cache misses of this process, with a performance counter */
+class CacheMissCounter{
+	int m_descriptor;
+
+public:
+	void constructor(){
+		m_descriptor=-1;
+
+		#ifdef __linux__
+		struct perf_event_attr attributes;
+		memset(&attributes,0,sizeof(attributes));
+		attributes.type=PERF_TYPE_HARDWARE;
+		attributes.size=sizeof(attributes);
+		attributes.config=PERF_COUNT_HW_CACHE_MISSES;
+		attributes.disabled=1;
+		attributes.exclude_kernel=1;
+		attributes.exclude_hv=1;
+
+		m_descriptor=syscall(__NR_perf_event_open,&attributes,0,-1,-1,0);
+		#endif
+	}
+
+	void destructor(){
+		#ifdef __linux__
+		if(m_descriptor>=0)
+			close(m_descriptor);
+		#endif
+
+		m_descriptor=-1;
+	}
+
+	bool isAvailable(){
+		return m_descriptor>=0;
+	}
+
+	void start(){
+		#ifdef __linux__
+		if(!isAvailable())
+			return;
+
+		ioctl(m_descriptor,PERF_EVENT_IOC_RESET,0);
+		ioctl(m_descriptor,PERF_EVENT_IOC_ENABLE,0);
+		#endif
+	}
+
+	uint64_t stop(){
+		uint64_t count=0;
+
+		#ifdef __linux__
+		if(!isAvailable())
+			return 0;
+
+		ioctl(m_descriptor,PERF_EVENT_IOC_DISABLE,0);
+
+		if(read(m_descriptor,&count,sizeof(count))!=sizeof(count))
+			count=0;
+		#endif
+
+		return count;
+	}
+};
+
+void printResult(const char*name,uint64_t lookups,double seconds,uint64_t misses,uint64_t found,
+	CacheMissCounter*counter){
+
+	cout<<name<<": "<<seconds*1000000000/lookups<<" ns/lookup, ";
+
+	if(counter->isAvailable())
+		cout<<(0.0+misses)/lookups<<" cache misses/lookup";
+	else
+		cout<<"cache misses not available";
+
+	cout<<", "<<found<<" keys found"<<endl;
+}
+
+int main(int argc,char**argv){
+
+	uint64_t entries=10000000;
+	uint64_t lookups=10000000;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-entries")==0 && i+1<argc)
+			entries=strtoull(argv[i+1],NULL,10);
+		else if(strcmp(argv[i],"-lookups")==0 && i+1<argc)
+			lookups=strtoull(argv[i+1],NULL,10);
+	}
+
+	/* round down to whole batches */
+	lookups-=lookups%MY_HASH_TABLE_BATCH_SIZE;
+
+	if(lookups==0)
+		lookups=MY_HASH_TABLE_BATCH_SIZE;
+
+	uint64_t buckets=1024;
+
+	while(entries>=BENCHMARK_LOAD_FACTOR*buckets)
+		buckets*=2;
+
+	BenchmarkTable table;
+	table.constructor(buckets,"RAY_MALLOC_TYPE_BENCHMARK",false,0,
+		BENCHMARK_BUCKETS_PER_GROUP,BENCHMARK_LOAD_FACTOR);
+
+	BenchmarkKey key;
+	uint64_t startingTime=getMicroseconds();
+
+	/* the keys in the table are the even numbers, hashed */
+	for(uint64_t i=0;i<entries;i++){
+		key.m_value=uniform_hashing_function_1_64_64(2*i);
+		table.insert(&key)->m_value=i;
+	}
+
+	cout<<"MyHashTable lookups: "<<entries<<" entries in "<<buckets<<" buckets, filled in ";
+	cout<<(getMicroseconds()-startingTime)/1000000.0<<" s, "<<lookups<<" lookups"<<endl;
+
+	vector<BenchmarkKey> keys(lookups);
+
+	for(uint64_t i=0;i<lookups;i++){
+		uint64_t number=uniform_hashing_function_2_64_64(i)%(2*entries);
+		keys[i].m_value=uniform_hashing_function_1_64_64(number);
+	}
+
+	CacheMissCounter counter;
+	counter.constructor();
+
+	/* one key at a time */
+	uint64_t found=0;
+
+	counter.start();
+	startingTime=getMicroseconds();
+
+	for(uint64_t i=0;i<lookups;i++){
+		if(table.find(&keys[i])!=NULL)
+			found++;
+	}
+
+	double seconds=(getMicroseconds()-startingTime)/1000000.0;
+	uint64_t misses=counter.stop();
+
+	printResult("find()",lookups,seconds,misses,found,&counter);
+
+	uint64_t foundWithFind=found;
+
+	/* batches */
+	BenchmarkValue*values[MY_HASH_TABLE_BATCH_SIZE];
+	found=0;
+
+	counter.start();
+	startingTime=getMicroseconds();
+
+	for(uint64_t i=0;i<lookups;i+=MY_HASH_TABLE_BATCH_SIZE){
+		table.findBatch(&keys[i],MY_HASH_TABLE_BATCH_SIZE,values);
+
+		for(int j=0;j<MY_HASH_TABLE_BATCH_SIZE;j++){
+			if(values[j]!=NULL)
+				found++;
+		}
+	}
+
+	seconds=(getMicroseconds()-startingTime)/1000000.0;
+	misses=counter.stop();
+
+	printResult("findBatch()",lookups,seconds,misses,found,&counter);
+
+	counter.destructor();
+	table.destructor();
+
+	if(found!=foundWithFind){
+		cout<<"Error: find() found "<<foundWithFind<<" keys and findBatch() found "<<found<<" keys"<<endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,263 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Benchmark for the probing and the resize of MyHashTable.
+ *
+ * The keys have 4 words, like the k-mers of an assembler, so hashing a
+ * key is not free. For each VALUE, the benchmark reports:
+ *
+ * - insert: the inserts in a table that has enough buckets for them
+ * - find: the lookups of the keys that were inserted
+ * - resize: a full resize, from the insert that starts it at the
+ *   maximum load to the end of completeResizing()
+ *
+ * The VALUE of the first table computes the hash of its key again when
+ * the resize moves it. The VALUE of the second table keeps the hash with
+ * a specialization of MyHashTableHashCache.
+ *
+ * The benchmark only uses the API that MyHashTable had before the
+ * probing with masks, so it can be built against an older tree for the
+ * numbers before the change; without MyHashTableHashCache.h, only the
+ * first table is measured.
+ *
+ * Usage: HashTableResizeBenchmark [-keys <n>]
+ *
+ * The default is 2000000 keys.
+ */
+
+#include <RayPlatform/structures/MyHashTable.h>
+#include <RayPlatform/cryptography/crypto.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_BUCKETS_PER_GROUP 64
+#define BENCHMARK_LOAD_FACTOR 0.7
+#define BENCHMARK_KEY_WORDS 4
+
+class BenchmarkKey{
+public:
+	uint64_t m_words[BENCHMARK_KEY_WORDS];
+
+	void set(uint64_t number){
+		for(int i=0;i<BENCHMARK_KEY_WORDS;i++)
+			m_words[i]=uniform_hashing_function_1_64_64(number*BENCHMARK_KEY_WORDS+i);
+	}
+
+	uint64_t hash_function_1() const{
+		uint64_t hash=0;
+
+		for(int i=0;i<BENCHMARK_KEY_WORDS;i++)
+			hash=uniform_hashing_function_1_64_64(hash^m_words[i]);
+
+		return hash;
+	}
+
+	uint64_t hash_function_2() const{
+		uint64_t hash=0;
+
+		for(int i=0;i<BENCHMARK_KEY_WORDS;i++)
+			hash=uniform_hashing_function_2_64_64(hash^m_words[i]);
+
+		return hash;
+	}
+
+	void print(){
+		cout<<"BenchmarkKey "<<m_words[0]<<endl;
+	}
+
+	bool operator==(const BenchmarkKey&key) const{
+		for(int i=0;i<BENCHMARK_KEY_WORDS;i++){
+			if(m_words[i]!=key.m_words[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	bool operator!=(const BenchmarkKey&key) const{
+		return !(*this==key);
+	}
+};
+
+class BenchmarkValue{
+public:
+	BenchmarkKey m_key;
+	uint64_t m_value;
+
+	BenchmarkKey getKey(){
+		return m_key;
+	}
+
+	void setKey(BenchmarkKey key){
+		m_key=key;
+		m_value=0;
+	}
+};
+
+#ifdef _MyHashTableHashCache_H
+
+/** a VALUE that keeps the hash of its key */
+class CachedBenchmarkValue{
+public:
+	BenchmarkKey m_key;
+	uint64_t m_value;
+	uint64_t m_hash;
+
+	BenchmarkKey getKey(){
+		return m_key;
+	}
+
+	void setKey(BenchmarkKey key){
+		m_key=key;
+		m_value=0;
+	}
+};
+
+template<>
+class MyHashTableHashCache<BenchmarkKey,CachedBenchmarkValue>{
+public:
+	static void setHash(CachedBenchmarkValue*value,uint64_t hash){
+		value->m_hash=hash;
+	}
+
+	static uint64_t getHash(CachedBenchmarkValue*value){
+		return value->m_hash;
+	}
+};
+
+#endif /* _MyHashTableHashCache_H */
+
+uint64_t getBuckets(uint64_t keys){
+	uint64_t buckets=1024;
+
+	while(keys>=BENCHMARK_LOAD_FACTOR*buckets)
+		buckets*=2;
+
+	return buckets;
+}
+
+/** returns the number of errors */
+template<class VALUE>
+uint64_t benchmark(const char*name,uint64_t keys){
+
+	uint64_t errors=0;
+	BenchmarkKey key;
+
+	MyHashTable<BenchmarkKey,VALUE> table;
+	table.constructor(getBuckets(keys),"RAY_MALLOC_TYPE_BENCHMARK",false,0,
+		BENCHMARK_BUCKETS_PER_GROUP,BENCHMARK_LOAD_FACTOR);
+
+	uint64_t startingTime=getMicroseconds();
+
+	for(uint64_t i=0;i<keys;i++){
+		key.set(i);
+		table.insert(&key)->m_value=i;
+	}
+
+	double insertSeconds=(getMicroseconds()-startingTime)/1000000.0;
+
+	startingTime=getMicroseconds();
+
+	for(uint64_t i=0;i<keys;i++){
+		key.set(i);
+		VALUE*value=table.find(&key);
+
+		if(value==NULL || value->m_value!=i)
+			errors++;
+	}
+
+	double findSeconds=(getMicroseconds()-startingTime)/1000000.0;
+
+	table.destructor();
+
+	/* fill a table up to its maximum load, the next insert starts a resize */
+	MyHashTable<BenchmarkKey,VALUE> resizedTable;
+	uint64_t buckets=getBuckets(keys)/2;
+	resizedTable.constructor(buckets,"RAY_MALLOC_TYPE_BENCHMARK",false,0,
+		BENCHMARK_BUCKETS_PER_GROUP,BENCHMARK_LOAD_FACTOR);
+
+	uint64_t inserted=0;
+
+	while(!resizedTable.needsToCompleteResizing()){
+		uint64_t number=inserted;
+		inserted++;
+
+		key.set(number);
+
+		/* the time before the insert that starts the resize is kept */
+		startingTime=getMicroseconds();
+		resizedTable.insert(&key)->m_value=number;
+	}
+
+	resizedTable.completeResizing();
+
+	double resizeSeconds=(getMicroseconds()-startingTime)/1000000.0;
+
+	for(uint64_t i=0;i<inserted;i++){
+		key.set(i);
+		VALUE*value=resizedTable.find(&key);
+
+		if(value==NULL || value->m_value!=i)
+			errors++;
+	}
+
+	cout<<name<<": insert "<<insertSeconds*1000000000/keys<<" ns, find "<<findSeconds*1000000000/keys<<" ns, ";
+	cout<<"resize of "<<inserted<<" keys from "<<buckets<<" to "<<resizedTable.capacity()<<" buckets ";
+	cout<<resizeSeconds<<" s"<<endl;
+
+	resizedTable.destructor();
+
+	return errors;
+}
+
+int main(int argc,char**argv){
+
+	uint64_t keys=2000000;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-keys")==0 && i+1<argc)
+			keys=strtoull(argv[i+1],NULL,10);
+	}
+
+	uint64_t errors=0;
+
+	errors+=benchmark<BenchmarkValue>("MyHashTable, hash computed again",keys);
+
+	#ifdef _MyHashTableHashCache_H
+	errors+=benchmark<CachedBenchmarkValue>("MyHashTable, hash kept in the value",keys);
+	#endif
+
+	if(errors>0){
+		cout<<"Error: "<<errors<<" keys were not found"<<endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
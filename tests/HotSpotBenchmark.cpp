@@ -0,0 +1,398 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Hot spot benchmark for the message router.
+ *
+ * Each rank keeps a window of echo messages in flight toward its
+ * partner and measures their round trip times. With the all-to-one
+ * pattern, every rank other than 0 sends to rank 0. With the transpose
+ * pattern, the ranks form a square grid and rank (i,j) sends to rank
+ * (j,i); the ranks on the diagonal and outside of the grid send to
+ * rank <ranks>-1-rank.
+ *
+ * At the end, the round trip times of all the ranks are merged in a
+ * histogram with 4 buckets per power of 2, and rank 0 prints the median,
+ * the 99th percentile (the upper bound of their bucket) and the maximum.
+ *
+ * Usage:
+ *
+ * mpiexec -n <ranks> tests/HotSpotBenchmark [-pattern all-to-one|transpose] [-pings <n>] [-window <n>]
+ *	[-route-messages <type> <degree>] [-adaptive-routing <saturation>]
+ *
+ * The defaults are all-to-one, 1000 pings per rank, a window of 4 and
+ * no message routing. -adaptive-routing is handled by the ComputeCore.
+ */
+
+#include <RayPlatform/core/ComputeCore.h>
+#include <RayPlatform/core/MiniRank.h>
+#include <RayPlatform/core/RankProcess.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_ALL_TO_ONE 0
+#define BENCHMARK_TRANSPOSE 1
+#define BENCHMARK_BUCKETS 128
+
+/* the histogram message: the buckets, the count, the sum and the maximum */
+#define BENCHMARK_HISTOGRAM_COUNT BENCHMARK_BUCKETS
+#define BENCHMARK_HISTOGRAM_SUM (BENCHMARK_BUCKETS+1)
+#define BENCHMARK_HISTOGRAM_MAXIMUM (BENCHMARK_BUCKETS+2)
+#define BENCHMARK_HISTOGRAM_UNITS (BENCHMARK_BUCKETS+3)
+
+int g_pattern=BENCHMARK_ALL_TO_ONE;
+int g_pings=1000;
+int g_window=4;
+const char*g_routingType=NULL;
+int g_routingDegree=2;
+
+/** the upper bound, in microseconds, of a bucket of the histogram */
+double getBucketBound(int bucket){
+	return pow(2.0,(bucket+1)/4.0);
+}
+
+int getBucket(uint64_t microseconds){
+	int bucket=0;
+
+	while(bucket<BENCHMARK_BUCKETS-1 && getBucketBound(bucket)<microseconds)
+		bucket++;
+
+	return bucket;
+}
+
+/** returns -1 if the rank sends nothing */
+Rank getPartner(Rank rank,int size){
+	if(size<2)
+		return -1;
+
+	if(g_pattern==BENCHMARK_ALL_TO_ONE)
+		return rank==MASTER_RANK?-1:MASTER_RANK;
+
+	int side=(int)sqrt((double)size);
+
+	while((side+1)*(side+1)<=size)
+		side++;
+
+	Rank partner=-1;
+
+	if(rank<side*side)
+		partner=(rank%side)*side+rank/side;
+
+	if(partner==-1 || partner==rank)
+		partner=size-1-rank;
+
+	if(partner==rank)
+		partner=(rank+1)%size;
+
+	return partner;
+}
+
+class HotSpot;
+
+__DeclarePlugin(HotSpot);
+
+__DeclareMasterModeAdapter(HotSpot,RAY_MASTER_MODE_HOT_SPOT);
+__DeclareSlaveModeAdapter(HotSpot,RAY_SLAVE_MODE_HOT_SPOT);
+__DeclareMessageTagAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PING);
+__DeclareMessageTagAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PONG);
+__DeclareMessageTagAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_HISTOGRAM);
+__DeclareMessageTagAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_STOP);
+
+class HotSpot: public CorePlugin{
+
+	__AddAdapter(HotSpot,RAY_MASTER_MODE_HOT_SPOT);
+	__AddAdapter(HotSpot,RAY_SLAVE_MODE_HOT_SPOT);
+	__AddAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PING);
+	__AddAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PONG);
+	__AddAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_HISTOGRAM);
+	__AddAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_STOP);
+
+	MasterMode RAY_MASTER_MODE_HOT_SPOT;
+	SlaveMode RAY_SLAVE_MODE_HOT_SPOT;
+	MessageTag RAY_MPI_TAG_HOT_SPOT_START;
+	MessageTag RAY_MPI_TAG_HOT_SPOT_PING;
+	MessageTag RAY_MPI_TAG_HOT_SPOT_PONG;
+	MessageTag RAY_MPI_TAG_HOT_SPOT_HISTOGRAM;
+	MessageTag RAY_MPI_TAG_HOT_SPOT_STOP;
+
+	ComputeCore*m_core;
+
+	bool m_started;
+	bool m_done;
+	Rank m_partner;
+	int m_sentPings;
+	int m_receivedPongs;
+	bool m_sentHistogram;
+	uint64_t m_startingTime;
+
+	/* the histogram of this rank, and the merged histogram on rank 0 */
+	MessageUnit m_histogram[BENCHMARK_HISTOGRAM_UNITS];
+	MessageUnit m_mergedHistogram[BENCHMARK_HISTOGRAM_UNITS];
+	int m_receivedHistograms;
+
+	void sendMessage(MessageUnit*units,int count,Rank destination,MessageTag tag){
+		MessageUnit*buffer=(MessageUnit*)m_core->getOutboxAllocator()->allocate(count*sizeof(MessageUnit));
+
+		for(int i=0;i<count;i++)
+			buffer[i]=units[i];
+
+		Message message(buffer,count,destination,tag,m_core->getRank());
+		m_core->getOutbox()->push_back(&message);
+	}
+
+	uint64_t getPercentile(double fraction){
+		uint64_t count=m_mergedHistogram[BENCHMARK_HISTOGRAM_COUNT];
+		uint64_t seen=0;
+
+		for(int bucket=0;bucket<BENCHMARK_BUCKETS;bucket++){
+			seen+=m_mergedHistogram[bucket];
+
+			if(seen>=fraction*count)
+				return (uint64_t)ceil(getBucketBound(bucket));
+		}
+
+		return m_mergedHistogram[BENCHMARK_HISTOGRAM_MAXIMUM];
+	}
+
+	void printResults(){
+		uint64_t count=m_mergedHistogram[BENCHMARK_HISTOGRAM_COUNT];
+		double seconds=(getMicroseconds()-m_startingTime)/1000000.0;
+
+		const char*pattern="all-to-one";
+		if(g_pattern==BENCHMARK_TRANSPOSE)
+			pattern="transpose";
+
+		cout<<"HotSpot: "<<pattern<<", "<<m_core->getSize()<<" ranks, "<<count<<" round trips in "<<seconds<<" s";
+
+		if(count>0){
+			cout<<", mean "<<m_mergedHistogram[BENCHMARK_HISTOGRAM_SUM]/count<<" us";
+			cout<<", p50 <= "<<getPercentile(0.50)<<" us";
+			cout<<", p99 <= "<<getPercentile(0.99)<<" us";
+			cout<<", max "<<m_mergedHistogram[BENCHMARK_HISTOGRAM_MAXIMUM]<<" us";
+		}
+
+		cout<<endl;
+	}
+
+public:
+
+	void registerPlugin(ComputeCore*core){
+		m_core=core;
+		m_started=false;
+		m_done=false;
+		m_sentPings=0;
+		m_receivedPongs=0;
+		m_sentHistogram=false;
+		m_receivedHistograms=0;
+
+		for(int i=0;i<BENCHMARK_HISTOGRAM_UNITS;i++){
+			m_histogram[i]=0;
+			m_mergedHistogram[i]=0;
+		}
+
+		PluginHandle plugin=core->allocatePluginHandle();
+		m_plugin=plugin;
+
+		core->setPluginName(plugin,"HotSpot");
+
+		RAY_MASTER_MODE_HOT_SPOT=core->allocateMasterModeHandle(plugin);
+		core->setMasterModeSymbol(plugin,RAY_MASTER_MODE_HOT_SPOT,"RAY_MASTER_MODE_HOT_SPOT");
+		core->setMasterModeObjectHandler(plugin,RAY_MASTER_MODE_HOT_SPOT,__GetAdapter(HotSpot,RAY_MASTER_MODE_HOT_SPOT));
+
+		RAY_SLAVE_MODE_HOT_SPOT=core->allocateSlaveModeHandle(plugin);
+		core->setSlaveModeSymbol(plugin,RAY_SLAVE_MODE_HOT_SPOT,"RAY_SLAVE_MODE_HOT_SPOT");
+		core->setSlaveModeObjectHandler(plugin,RAY_SLAVE_MODE_HOT_SPOT,__GetAdapter(HotSpot,RAY_SLAVE_MODE_HOT_SPOT));
+
+		RAY_MPI_TAG_HOT_SPOT_START=core->allocateMessageTagHandle(plugin);
+		core->setMessageTagSymbol(plugin,RAY_MPI_TAG_HOT_SPOT_START,"RAY_MPI_TAG_HOT_SPOT_START");
+
+		RAY_MPI_TAG_HOT_SPOT_PING=core->allocateMessageTagHandle(plugin);
+		core->setMessageTagSymbol(plugin,RAY_MPI_TAG_HOT_SPOT_PING,"RAY_MPI_TAG_HOT_SPOT_PING");
+		core->setMessageTagObjectHandler(plugin,RAY_MPI_TAG_HOT_SPOT_PING,__GetAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PING));
+
+		RAY_MPI_TAG_HOT_SPOT_PONG=core->allocateMessageTagHandle(plugin);
+		core->setMessageTagSymbol(plugin,RAY_MPI_TAG_HOT_SPOT_PONG,"RAY_MPI_TAG_HOT_SPOT_PONG");
+		core->setMessageTagObjectHandler(plugin,RAY_MPI_TAG_HOT_SPOT_PONG,__GetAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PONG));
+
+		RAY_MPI_TAG_HOT_SPOT_HISTOGRAM=core->allocateMessageTagHandle(plugin);
+		core->setMessageTagSymbol(plugin,RAY_MPI_TAG_HOT_SPOT_HISTOGRAM,"RAY_MPI_TAG_HOT_SPOT_HISTOGRAM");
+		core->setMessageTagObjectHandler(plugin,RAY_MPI_TAG_HOT_SPOT_HISTOGRAM,__GetAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_HISTOGRAM));
+
+		RAY_MPI_TAG_HOT_SPOT_STOP=core->allocateMessageTagHandle(plugin);
+		core->setMessageTagSymbol(plugin,RAY_MPI_TAG_HOT_SPOT_STOP,"RAY_MPI_TAG_HOT_SPOT_STOP");
+		core->setMessageTagObjectHandler(plugin,RAY_MPI_TAG_HOT_SPOT_STOP,__GetAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_STOP));
+
+		core->setMasterModeToMessageTagSwitch(plugin,RAY_MASTER_MODE_HOT_SPOT,RAY_MPI_TAG_HOT_SPOT_START);
+		core->setMessageTagToSlaveModeSwitch(plugin,RAY_MPI_TAG_HOT_SPOT_START,RAY_SLAVE_MODE_HOT_SPOT);
+
+		core->setFirstMasterMode(plugin,RAY_MASTER_MODE_HOT_SPOT);
+	}
+
+	void resolveSymbols(ComputeCore*core){
+		__BindAdapter(HotSpot,RAY_MASTER_MODE_HOT_SPOT);
+		__BindAdapter(HotSpot,RAY_SLAVE_MODE_HOT_SPOT);
+		__BindAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PING);
+		__BindAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PONG);
+		__BindAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_HISTOGRAM);
+		__BindAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_STOP);
+	}
+
+	void call_RAY_MASTER_MODE_HOT_SPOT(){
+		SwitchMan*switchMan=m_core->getSwitchMan();
+
+		if(!m_started){
+			m_startingTime=getMicroseconds();
+			switchMan->openMasterMode(m_core->getOutbox(),m_core->getRank());
+			m_started=true;
+
+		/* the histograms are sent before the completion signals */
+		}else if(!m_done && switchMan->allRanksAreReady() && m_receivedHistograms==m_core->getSize()){
+			m_done=true;
+
+			printResults();
+
+			m_core->sendEmptyMessageToAll(RAY_MPI_TAG_HOT_SPOT_STOP);
+		}
+	}
+
+	void call_RAY_SLAVE_MODE_HOT_SPOT(){
+		if(m_sentHistogram)
+			return;
+
+		m_partner=getPartner(m_core->getRank(),m_core->getSize());
+
+		int pings=g_pings;
+
+		if(m_partner==-1)
+			pings=0;
+
+		while(m_sentPings<pings && m_sentPings-m_receivedPongs<g_window){
+			MessageUnit ping[2];
+			ping[0]=getMicroseconds();
+			ping[1]=m_sentPings;
+
+			sendMessage(ping,2,m_partner,RAY_MPI_TAG_HOT_SPOT_PING);
+			m_sentPings++;
+		}
+
+		if(m_receivedPongs==pings){
+			sendMessage(m_histogram,BENCHMARK_HISTOGRAM_UNITS,MASTER_RANK,RAY_MPI_TAG_HOT_SPOT_HISTOGRAM);
+			m_sentHistogram=true;
+
+			m_core->closeSlaveModeLocally();
+		}
+	}
+
+	void call_RAY_MPI_TAG_HOT_SPOT_PING(Message*message){
+		sendMessage(message->getBuffer(),message->getCount(),message->getSource(),RAY_MPI_TAG_HOT_SPOT_PONG);
+	}
+
+	void call_RAY_MPI_TAG_HOT_SPOT_PONG(Message*message){
+		uint64_t roundTrip=getMicroseconds()-message->getBuffer()[0];
+
+		m_histogram[getBucket(roundTrip)]++;
+		m_histogram[BENCHMARK_HISTOGRAM_COUNT]++;
+		m_histogram[BENCHMARK_HISTOGRAM_SUM]+=roundTrip;
+
+		if(roundTrip>m_histogram[BENCHMARK_HISTOGRAM_MAXIMUM])
+			m_histogram[BENCHMARK_HISTOGRAM_MAXIMUM]=roundTrip;
+
+		m_receivedPongs++;
+	}
+
+	void call_RAY_MPI_TAG_HOT_SPOT_HISTOGRAM(Message*message){
+		MessageUnit*histogram=message->getBuffer();
+
+		for(int i=0;i<BENCHMARK_HISTOGRAM_MAXIMUM;i++)
+			m_mergedHistogram[i]+=histogram[i];
+
+		if(histogram[BENCHMARK_HISTOGRAM_MAXIMUM]>m_mergedHistogram[BENCHMARK_HISTOGRAM_MAXIMUM])
+			m_mergedHistogram[BENCHMARK_HISTOGRAM_MAXIMUM]=histogram[BENCHMARK_HISTOGRAM_MAXIMUM];
+
+		m_receivedHistograms++;
+	}
+
+	void call_RAY_MPI_TAG_HOT_SPOT_STOP(Message*message){
+		m_core->stop();
+	}
+};
+
+__CreatePlugin(HotSpot);
+
+__CreateMasterModeAdapter(HotSpot,RAY_MASTER_MODE_HOT_SPOT);
+__CreateSlaveModeAdapter(HotSpot,RAY_SLAVE_MODE_HOT_SPOT);
+__CreateMessageTagAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PING);
+__CreateMessageTagAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_PONG);
+__CreateMessageTagAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_HISTOGRAM);
+__CreateMessageTagAdapter(HotSpot,RAY_MPI_TAG_HOT_SPOT_STOP);
+
+class HotSpotApplication: public MiniRank{
+
+	HotSpot m_hotSpot;
+
+public:
+	HotSpotApplication(int argc,char**argv){
+		for(int i=0;i<argc;i++){
+			if(strcmp(argv[i],"-pattern")==0 && i+1<argc)
+				g_pattern=strcmp(argv[i+1],"transpose")==0?BENCHMARK_TRANSPOSE:BENCHMARK_ALL_TO_ONE;
+			else if(strcmp(argv[i],"-pings")==0 && i+1<argc)
+				g_pings=atoi(argv[i+1]);
+			else if(strcmp(argv[i],"-window")==0 && i+1<argc)
+				g_window=atoi(argv[i+1]);
+			else if(strcmp(argv[i],"-route-messages")==0 && i+2<argc){
+				g_routingType=argv[i+1];
+				g_routingDegree=atoi(argv[i+2]);
+			}
+		}
+
+		if(g_window<1)
+			g_window=1;
+	}
+
+	void run(){
+		ComputeCore*core=&m_computeCore;
+
+		if(g_routingType!=NULL)
+			core->getRouter()->enable(core->getInbox(),core->getOutbox(),core->getOutboxAllocator(),
+				core->getRank(),"HotSpotBenchmark-",core->getSize(),g_routingType,g_routingDegree);
+
+		core->registerPlugin(&m_hotSpot);
+		core->resolveSymbols();
+		core->run();
+	}
+};
+
+int main(int argc,char**argv){
+	RankProcess<HotSpotApplication> process;
+	process.constructor(&argc,&argv);
+	process.run();
+	process.destructor();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,353 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Round-trip test for the compact message header.
+ *
+ * For every combination of the header fields (actors 0x01, routing 0x02,
+ * mini-ranks 0x04 and sequence 0x08), a message is encoded with
+ * saveMetaData() and decoded with loadMetaData() from a copy of its
+ * bytes, like a receiver would. The flags byte, the header size, the
+ * payload and every decoded field are checked. The bytes written by
+ * saveMetaData() are also compared with a header laid out by hand as
+ * described in Message.h, and each of these hand-made headers is
+ * decoded too, including the ones with routing and without actors that
+ * saveMetaData() never writes.
+ *
+ * A message with another wire-format version must be rejected:
+ * loadMetaData() is called in a child process that must exit with
+ * EXIT_WIRE_FORMAT_MISMATCH.
+ *
+ * Usage: MessageHeaderTest
+ */
+
+#include <RayPlatform/communication/Message.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+using namespace std;
+
+#define TEST_SOURCE 1
+#define TEST_DESTINATION 2
+#define TEST_TAG 3
+
+#define TEST_MINI_RANK_SOURCE 5
+#define TEST_MINI_RANK_DESTINATION 6
+#define TEST_SOURCE_ACTOR 11
+#define TEST_DESTINATION_ACTOR 13
+#define TEST_ROUTING_SOURCE 7
+#define TEST_ROUTING_DESTINATION 9
+
+// NO_VALUE of Message.cpp
+#define TEST_NO_VALUE -1
+
+#define TEST_BUFFER_SIZE ( MAXIMUM_MESSAGE_SIZE_IN_BYTES + MESSAGE_META_DATA_SIZE )
+
+int getSequence(int fields){
+	return 1000+fields*17;
+}
+
+/*
+ * saveMetaData always sends the actors of a routed message.
+ */
+uint8_t getExpectedFlags(int fields){
+	uint8_t flags=fields;
+
+	if(flags & MESSAGE_HEADER_ROUTING)
+		flags|=MESSAGE_HEADER_ACTORS;
+
+	return flags|(MESSAGE_WIRE_FORMAT_VERSION<<MESSAGE_HEADER_VERSION_SHIFT);
+}
+
+void fillPayload(char*buffer,int bytes,int fields){
+	for(int i=0;i<bytes;i++)
+		buffer[i]=(char)(i*31+fields);
+}
+
+void writeInts(char**memory,int first,int second){
+	memcpy(*memory,&first,sizeof(int));
+	memcpy(*memory+sizeof(int),&second,sizeof(int));
+	*memory+=MESSAGE_HEADER_PAIR_SIZE;
+}
+
+/*
+ * Lay out the header after the payload, in the order of Message.h,
+ * and return the number of bytes of the message.
+ */
+int writeHeader(char*buffer,int bytes,uint8_t flags,int fields){
+	char*memory=buffer+bytes;
+
+	if(flags & MESSAGE_HEADER_MINI_RANKS)
+		writeInts(&memory,TEST_MINI_RANK_SOURCE,TEST_MINI_RANK_DESTINATION);
+
+	if(flags & MESSAGE_HEADER_ACTORS){
+		if(fields & MESSAGE_HEADER_ACTORS)
+			writeInts(&memory,TEST_SOURCE_ACTOR,TEST_DESTINATION_ACTOR);
+		else
+			writeInts(&memory,TEST_SOURCE,TEST_DESTINATION);
+	}
+
+	if(flags & MESSAGE_HEADER_ROUTING)
+		writeInts(&memory,TEST_ROUTING_SOURCE,TEST_ROUTING_DESTINATION);
+
+	if(flags & MESSAGE_HEADER_SEQUENCE){
+		int sequence=getSequence(fields);
+		memcpy(memory,&sequence,sizeof(int));
+		memory+=MESSAGE_HEADER_SEQUENCE_SIZE;
+	}
+
+	memcpy(memory,&flags,sizeof(flags));
+	memory+=sizeof(flags);
+
+	return memory-buffer;
+}
+
+/*
+ * Decode a message of the given bytes like the receiver does and
+ * compare the fields with the ones that were sent.
+ */
+bool checkDecodedMessage(char*buffer,int bytes,int payloadBytes,int fields,const char*what){
+
+	Message message(buffer,0,TEST_DESTINATION,TEST_TAG,TEST_SOURCE);
+	message.setNumberOfBytes(bytes);
+	message.loadMetaData();
+
+	bool success=true;
+
+	if(message.getNumberOfBytes()!=payloadBytes){
+		cout<<"Error: "<<what<<" fields 0x"<<hex<<fields<<dec<<" has "<<message.getNumberOfBytes();
+		cout<<" payload bytes after loadMetaData, expected "<<payloadBytes<<endl;
+		success=false;
+	}
+
+	char expected[TEST_BUFFER_SIZE];
+	fillPayload(expected,payloadBytes,fields);
+
+	if(memcmp(buffer,expected,payloadBytes)!=0){
+		cout<<"Error: "<<what<<" fields 0x"<<hex<<fields<<dec<<" has a corrupted payload"<<endl;
+		success=false;
+	}
+
+	int miniRankSource=TEST_NO_VALUE;
+	int miniRankDestination=TEST_NO_VALUE;
+
+	if(fields & MESSAGE_HEADER_MINI_RANKS){
+		miniRankSource=TEST_MINI_RANK_SOURCE;
+		miniRankDestination=TEST_MINI_RANK_DESTINATION;
+	}
+
+	int sourceActor=TEST_SOURCE;
+	int destinationActor=TEST_DESTINATION;
+
+	if(fields & MESSAGE_HEADER_ACTORS){
+		sourceActor=TEST_SOURCE_ACTOR;
+		destinationActor=TEST_DESTINATION_ACTOR;
+	}
+
+	int routingSource=TEST_NO_VALUE;
+	int routingDestination=TEST_NO_VALUE;
+
+	if(fields & MESSAGE_HEADER_ROUTING){
+		routingSource=TEST_ROUTING_SOURCE;
+		routingDestination=TEST_ROUTING_DESTINATION;
+	}
+
+	int sequence=MESSAGE_NO_SEQUENCE;
+
+	if(fields & MESSAGE_HEADER_SEQUENCE)
+		sequence=getSequence(fields);
+
+	if(message.getSourceMiniRank()!=miniRankSource || message.getDestinationMiniRank()!=miniRankDestination
+			|| message.getSourceActor()!=sourceActor || message.getDestinationActor()!=destinationActor
+			|| message.getRoutingSource()!=routingSource || message.getRoutingDestination()!=routingDestination
+			|| message.getSequence()!=sequence){
+
+		cout<<"Error: "<<what<<" fields 0x"<<hex<<fields<<dec<<" decoded as mini-ranks ";
+		cout<<message.getSourceMiniRank()<<" "<<message.getDestinationMiniRank();
+		cout<<" actors "<<message.getSourceActor()<<" "<<message.getDestinationActor();
+		cout<<" routing "<<message.getRoutingSource()<<" "<<message.getRoutingDestination();
+		cout<<" sequence "<<message.getSequence()<<endl;
+		success=false;
+	}
+
+	return success;
+}
+
+bool testRoundTrip(int fields,int payloadBytes){
+
+	char buffer[TEST_BUFFER_SIZE];
+	fillPayload(buffer,payloadBytes,fields);
+
+	Message message(buffer,0,TEST_DESTINATION,TEST_TAG,TEST_SOURCE);
+	message.setNumberOfBytes(payloadBytes);
+
+	if(fields & MESSAGE_HEADER_MINI_RANKS)
+		message.setMiniRanks(TEST_MINI_RANK_SOURCE,TEST_MINI_RANK_DESTINATION);
+
+	if(fields & MESSAGE_HEADER_ACTORS){
+		message.setSourceActor(TEST_SOURCE_ACTOR);
+		message.setDestinationActor(TEST_DESTINATION_ACTOR);
+	}
+
+	if(fields & MESSAGE_HEADER_ROUTING){
+		message.setRoutingSource(TEST_ROUTING_SOURCE);
+		message.setRoutingDestination(TEST_ROUTING_DESTINATION);
+	}
+
+	if(fields & MESSAGE_HEADER_SEQUENCE)
+		message.setSequence(getSequence(fields));
+
+	int headerSize=message.getMetaDataSize();
+
+	message.saveMetaData();
+
+	uint8_t flags=buffer[message.getNumberOfBytes()-1];
+	uint8_t expectedFlags=getExpectedFlags(fields);
+
+	bool success=true;
+
+	if(flags!=expectedFlags){
+		cout<<"Error: fields 0x"<<hex<<fields<<" were saved with flags 0x"<<(int)flags;
+		cout<<", expected 0x"<<(int)expectedFlags<<dec<<endl;
+		success=false;
+	}
+
+	if(message.getNumberOfBytes()!=payloadBytes+headerSize
+			|| headerSize!=Message::getHeaderSize(expectedFlags)){
+		cout<<"Error: fields 0x"<<hex<<fields<<dec<<" have "<<message.getNumberOfBytes()<<" bytes with a ";
+		cout<<headerSize<<"-byte header, expected "<<payloadBytes+Message::getHeaderSize(expectedFlags)<<endl;
+		success=false;
+	}
+
+	char layout[TEST_BUFFER_SIZE];
+	fillPayload(layout,payloadBytes,fields);
+	int layoutBytes=writeHeader(layout,payloadBytes,expectedFlags,fields);
+
+	if(layoutBytes!=message.getNumberOfBytes() || memcmp(layout,buffer,layoutBytes)!=0){
+		cout<<"Error: fields 0x"<<hex<<fields<<dec<<" were not saved with the layout of Message.h"<<endl;
+		success=false;
+	}
+
+	// the receiver gets a copy of the bytes
+	char received[TEST_BUFFER_SIZE];
+	memcpy(received,buffer,message.getNumberOfBytes());
+
+	if(!checkDecodedMessage(received,message.getNumberOfBytes(),payloadBytes,fields,"saveMetaData"))
+		success=false;
+
+	return success;
+}
+
+/*
+ * Headers that saveMetaData does not write, like routing without actors,
+ * must still be decoded.
+ */
+bool testLayout(int fields,int payloadBytes){
+
+	char buffer[TEST_BUFFER_SIZE];
+	fillPayload(buffer,payloadBytes,fields);
+
+	uint8_t flags=fields|(MESSAGE_WIRE_FORMAT_VERSION<<MESSAGE_HEADER_VERSION_SHIFT);
+	int bytes=writeHeader(buffer,payloadBytes,flags,fields);
+
+	return checkDecodedMessage(buffer,bytes,payloadBytes,fields,"layout");
+}
+
+/*
+ * loadMetaData exits, so it is called in a child process.
+ */
+bool testVersionMismatch(int version){
+
+	char buffer[TEST_BUFFER_SIZE];
+	fillPayload(buffer,16,MESSAGE_HEADER_SEQUENCE);
+
+	uint8_t flags=MESSAGE_HEADER_SEQUENCE|(version<<MESSAGE_HEADER_VERSION_SHIFT);
+	int bytes=writeHeader(buffer,16,flags,MESSAGE_HEADER_SEQUENCE);
+
+	cout.flush();
+
+	pid_t child=fork();
+
+	if(child==0){
+		if(freopen("/dev/null","w",stdout)==NULL)
+			_exit(EXIT_FAILURE);
+
+		Message message(buffer,0,TEST_DESTINATION,TEST_TAG,TEST_SOURCE);
+		message.setNumberOfBytes(bytes);
+		message.loadMetaData();
+
+		_exit(EXIT_SUCCESS);
+	}
+
+	int status=0;
+	waitpid(child,&status,0);
+
+	bool success=WIFEXITED(status) && WEXITSTATUS(status)==EXIT_WIRE_FORMAT_MISMATCH;
+
+	if(!success)
+		cout<<"Error: a message with wire-format version "<<version<<" was not rejected"<<endl;
+
+	return success;
+}
+
+int main(int argc,char**argv){
+
+	bool success=true;
+	int tested=0;
+
+	int payloadSizes[]={0,13,64,MAXIMUM_MESSAGE_SIZE_IN_BYTES};
+
+	for(int size=0;size<4;size++){
+		for(int fields=0;fields<=MESSAGE_HEADER_FIELDS;fields++){
+			if(!testRoundTrip(fields,payloadSizes[size]))
+				success=false;
+
+			if(!testLayout(fields,payloadSizes[size]))
+				success=false;
+
+			tested++;
+		}
+	}
+
+	cout<<"Message header: "<<tested<<" field combinations and payload sizes ";
+	cout<<(success?"PASSED":"FAILED")<<endl;
+
+	bool rejected=true;
+
+	for(int version=0;version<8;version++){
+		if(version!=MESSAGE_WIRE_FORMAT_VERSION && !testVersionMismatch(version))
+			rejected=false;
+	}
+
+	cout<<"Message header: other wire-format versions are rejected ";
+	cout<<(rejected?"PASSED":"FAILED")<<endl;
+
+	return (success && rejected)?EXIT_SUCCESS:EXIT_FAILURE;
+}
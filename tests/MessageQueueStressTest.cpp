@@ -0,0 +1,290 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+/*
+ * Stress test for the lock-free MessageQueue.
+ *
+ * One producer thread and one consumer thread exchange millions of
+ * messages. The tag, the count, the source and the destination of each
+ * message are derived from its sequence number, so a message that is
+ * lost, duplicated, reordered or read before it was published is
+ * reported.
+ *
+ * Two protocols are tested:
+ *
+ * - batches: pushMany() and popMany() with random batch sizes
+ * - payloads: the producer writes a payload buffer for each message and
+ *   reuses it only when getNumberOfQueuedMessages() says that the message
+ *   was popped. The consumer reads the payload with peek() before it
+ *   pops the message, like the communication thread does with the
+ *   outbox buffers of the mini-ranks.
+ *
+ * Usage: MessageQueueStressTest [messages]
+ */
+
+#include <RayPlatform/communication/MessageQueue.h>
+#include <RayPlatform/core/atomics.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <iostream>
+using namespace std;
+
+#define TEST_QUEUE_BINS 64
+#define TEST_MAXIMUM_BATCH 16
+
+/*
+ * There are fewer payload buffers than bins, so the queue does not
+ * protect them: the producer must see that a message was popped before
+ * it reuses its buffer.
+ */
+#define TEST_PAYLOADS 16
+#define TEST_PAYLOAD_UNITS 4
+
+class QueueTest{
+public:
+	MessageQueue m_queue;
+	uint64_t m_messages;
+	bool m_payloads;
+
+	MessageUnit m_buffers[TEST_PAYLOADS][TEST_PAYLOAD_UNITS];
+
+/** set by the consumer when it stops */
+	bool m_stopped;
+
+	uint64_t m_errors;
+	uint64_t m_producerErrors;
+	uint64_t m_received;
+	uint64_t m_emptyPolls;
+	uint64_t m_fullPolls;
+};
+
+/*
+ * The random numbers of each thread, rand() is not reentrant.
+ */
+uint32_t nextRandom(uint32_t*state){
+	*state=(*state)*1103515245+12345;
+	return ((*state)>>16)&0x7fff;
+}
+
+void fillMessage(Message*message,uint64_t sequence,MessageUnit*buffer){
+	message->setBuffer(buffer);
+	message->setCount(sequence%1000);
+	message->setTag(sequence%251);
+	message->setSource(sequence%1021);
+	message->setDestination((sequence/1021)%1019);
+}
+
+bool checkMessage(Message*message,uint64_t sequence){
+	return message->getCount()==(int)(sequence%1000)
+		&& message->getTag()==(MessageTag)(sequence%251)
+		&& message->getSource()==(Rank)(sequence%1021)
+		&& message->getDestination()==(Rank)((sequence/1021)%1019);
+}
+
+void*produce(void*argument){
+
+	QueueTest*test=(QueueTest*)argument;
+	uint32_t state=7;
+	uint64_t sequence=0;
+
+	Message batch[TEST_MAXIMUM_BATCH];
+
+	while(sequence<test->m_messages && !loadAcquire(&test->m_stopped)){
+
+		if(test->m_payloads){
+			uint64_t queued=test->m_queue.getNumberOfQueuedMessages();
+
+			// the buffer of message sequence-TEST_PAYLOADS must be popped
+			if(queued>=TEST_PAYLOADS){
+				test->m_fullPolls++;
+				sched_yield();
+				continue;
+			}
+
+			MessageUnit*buffer=test->m_buffers[sequence%TEST_PAYLOADS];
+
+			for(int i=0;i<TEST_PAYLOAD_UNITS;i++)
+				buffer[i]=sequence*TEST_PAYLOAD_UNITS+i;
+
+			Message message;
+			fillMessage(&message,sequence,buffer);
+
+			if(!test->m_queue.push(&message)){
+				test->m_producerErrors++;
+				cout<<"Error: push failed with "<<queued<<" queued messages"<<endl;
+				storeRelease(&test->m_stopped,true);
+				return NULL;
+			}
+
+			sequence++;
+			continue;
+		}
+
+		uint32_t count=1+nextRandom(&state)%TEST_MAXIMUM_BATCH;
+
+		if(count>test->m_messages-sequence)
+			count=test->m_messages-sequence;
+
+		for(uint32_t i=0;i<count;i++)
+			fillMessage(batch+i,sequence+i,NULL);
+
+		uint32_t pushed=test->m_queue.pushMany(batch,count);
+
+		if(pushed==0){
+			test->m_fullPolls++;
+			sched_yield();
+		}
+
+		sequence+=pushed;
+	}
+
+	return NULL;
+}
+
+void*consume(void*argument){
+
+	QueueTest*test=(QueueTest*)argument;
+	uint32_t state=11;
+	uint64_t sequence=0;
+
+	Message batch[TEST_MAXIMUM_BATCH];
+
+	while(sequence<test->m_messages && test->m_errors==0){
+
+		if(test->m_payloads){
+			Message message;
+
+			if(!test->m_queue.peek(&message)){
+				if(loadAcquire(&test->m_stopped))
+					break;
+
+				test->m_emptyPolls++;
+				sched_yield();
+				continue;
+			}
+
+			MessageUnit*buffer=message.getBuffer();
+
+			bool correct=checkMessage(&message,sequence)
+				&& buffer==test->m_buffers[sequence%TEST_PAYLOADS];
+
+			for(int i=0;correct && i<TEST_PAYLOAD_UNITS;i++)
+				correct=(buffer[i]==sequence*TEST_PAYLOAD_UNITS+i);
+
+			if(!correct){
+				test->m_errors++;
+				cout<<"Error: message "<<sequence<<" has a wrong payload"<<endl;
+			}
+
+			Message popped;
+			test->m_queue.pop(&popped);
+
+			sequence++;
+			continue;
+		}
+
+		uint32_t maximum=1+nextRandom(&state)%TEST_MAXIMUM_BATCH;
+		uint32_t popped=test->m_queue.popMany(batch,maximum);
+
+		if(popped==0){
+			if(loadAcquire(&test->m_stopped))
+				break;
+
+			test->m_emptyPolls++;
+			sched_yield();
+			continue;
+		}
+
+		for(uint32_t i=0;i<popped;i++){
+			if(!checkMessage(batch+i,sequence)){
+				test->m_errors++;
+				cout<<"Error: expected message "<<sequence<<", got count "<<batch[i].getCount();
+				cout<<" tag "<<batch[i].getTag()<<endl;
+				break;
+			}
+			sequence++;
+		}
+	}
+
+	test->m_received=sequence;
+
+	if(test->m_errors==0 && test->m_queue.hasContent()){
+		test->m_errors++;
+		cout<<"Error: the queue is not empty at the end"<<endl;
+	}
+
+	storeRelease(&test->m_stopped,true);
+
+	return NULL;
+}
+
+bool runTest(uint64_t messages,bool payloads){
+
+	QueueTest test;
+	test.m_queue.constructor(TEST_QUEUE_BINS);
+	test.m_messages=messages;
+	test.m_payloads=payloads;
+	test.m_stopped=false;
+	test.m_errors=0;
+	test.m_producerErrors=0;
+	test.m_received=0;
+	test.m_emptyPolls=0;
+	test.m_fullPolls=0;
+
+	pthread_t producer;
+	pthread_t consumer;
+
+	pthread_create(&consumer,NULL,consume,&test);
+	pthread_create(&producer,NULL,produce,&test);
+
+	pthread_join(producer,NULL);
+	pthread_join(consumer,NULL);
+
+	test.m_queue.destructor();
+
+	bool success=test.m_errors==0 && test.m_producerErrors==0 && test.m_received==messages;
+
+	cout<<"MessageQueue "<<(payloads?"payloads":"batches")<<": "<<test.m_received<<"/"<<messages;
+	cout<<" messages, "<<test.m_emptyPolls<<" empty polls, "<<test.m_fullPolls<<" full polls ";
+	cout<<(success?"PASSED":"FAILED")<<endl;
+
+	return success;
+}
+
+int main(int argc,char**argv){
+
+	uint64_t messages=4000000;
+
+	if(argc>1)
+		messages=strtoull(argv[1],NULL,10);
+
+	bool success=runTest(messages,false);
+
+	if(!runTest(messages/4,true))
+		success=false;
+
+	return success?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -0,0 +1,452 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Randomized test for MyHashTable, compared with a std::map.
+ *
+ * Random insert(), find() and erase() calls are run on a small key
+ * space, so that keys are erased and inserted again all the time. The
+ * phases make the table grow, then fill it with tombstones with a
+ * sliding window of keys so that it is rebuilt with the same size. The content is compared with the map after
+ * each operation and completely from time to time, with findBatch() too.
+ *
+ * The test fails if it did not exercise:
+ *
+ * - erase() during an incremental resize
+ * - insert() of a key that was erased, which can take a tombstone
+ * - a rebuild with the same size, to clean the tombstones
+ *
+ * A directed test also erases all the keys in the middle of a resize,
+ * when the keys that were transferred are in both tables, and inserts
+ * them again.
+ *
+ * Usage: MyHashTableTest [operations per phase]
+ */
+
+#include <RayPlatform/structures/MyHashTable.h>
+#include <RayPlatform/cryptography/crypto.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <map>
+#include <set>
+#include <vector>
+#include <iostream>
+using namespace std;
+
+#define TEST_BUCKETS 1024
+#define TEST_BUCKETS_PER_GROUP 64
+#define TEST_LOAD_FACTOR 0.7
+#define TEST_CHECK_PERIOD 5000
+
+class TestKey{
+public:
+	uint64_t m_value;
+
+	uint64_t hash_function_1() const{
+		return uniform_hashing_function_1_64_64(m_value);
+	}
+
+	uint64_t hash_function_2() const{
+		return uniform_hashing_function_2_64_64(m_value);
+	}
+
+	void print(){
+		cout<<"TestKey "<<m_value<<endl;
+	}
+
+	bool operator==(const TestKey&key) const{
+		return m_value==key.m_value;
+	}
+
+	bool operator!=(const TestKey&key) const{
+		return m_value!=key.m_value;
+	}
+};
+
+class TestValue{
+public:
+	TestKey m_key;
+	uint64_t m_value;
+
+	TestKey getKey(){
+		return m_key;
+	}
+
+/* a new bucket can hold the bytes of an erased one */
+	void setKey(TestKey key){
+		m_key=key;
+		m_value=0;
+	}
+};
+
+typedef MyHashTable<TestKey,TestValue> TestTable;
+
+class TableTest{
+public:
+	TestTable m_table;
+	map<uint64_t,uint64_t> m_reference;
+	set<uint64_t> m_erasedKeys;
+
+	uint64_t m_errors;
+	uint64_t m_operations;
+
+	uint64_t m_erasesDuringResize;
+	uint64_t m_reinsertions;
+	uint64_t m_growths;
+	uint64_t m_rebuilds;
+
+	bool m_resizing;
+	uint64_t m_capacity;
+
+	void constructor();
+	void destructor();
+
+	void reportError(const char*operation,uint64_t key);
+
+	void insert(uint64_t key,uint64_t value);
+	void find(uint64_t key);
+	void erase(uint64_t key);
+
+	void checkResizing();
+	void checkContent();
+	void runPhase(uint64_t operations,uint64_t keys,int insertPercent,int erasePercent,uint64_t seed);
+	void runSlidingPhase(uint64_t operations,uint64_t window,uint64_t firstKey);
+	void eraseDuringResize();
+};
+
+void TableTest::constructor(){
+	m_table.constructor(TEST_BUCKETS,"RAY_MALLOC_TYPE_TEST",false,0,
+		TEST_BUCKETS_PER_GROUP,TEST_LOAD_FACTOR);
+
+	m_errors=0;
+	m_operations=0;
+	m_erasesDuringResize=0;
+	m_reinsertions=0;
+	m_growths=0;
+	m_rebuilds=0;
+	m_resizing=false;
+	m_capacity=m_table.capacity();
+}
+
+void TableTest::destructor(){
+	m_table.destructor();
+}
+
+void TableTest::reportError(const char*operation,uint64_t key){
+	m_errors++;
+
+	if(m_errors<=10){
+		cout<<"Error: "<<operation<<" of key "<<key<<" after "<<m_operations<<" operations, ";
+		cout<<"size "<<m_table.size()<<", expected "<<m_reference.size();
+		cout<<(m_table.needsToCompleteResizing()?", resizing":"")<<endl;
+	}
+}
+
+void TableTest::insert(uint64_t key,uint64_t value){
+	TestKey testKey;
+	testKey.m_value=key;
+
+	if(m_erasedKeys.count(key)>0){
+		m_reinsertions++;
+		m_erasedKeys.erase(key);
+	}
+
+	TestValue*entry=m_table.insert(&testKey);
+
+	uint64_t expected=0;
+
+	if(m_reference.count(key)>0)
+		expected=m_reference[key];
+
+	if(entry==NULL || entry->getKey()!=testKey || entry->m_value!=expected){
+		reportError("insert",key);
+		return;
+	}
+
+	entry->m_value=value;
+	m_reference[key]=value;
+}
+
+void TableTest::find(uint64_t key){
+	TestKey testKey;
+	testKey.m_value=key;
+
+	TestValue*entry=m_table.find(&testKey);
+
+	if(m_reference.count(key)==0){
+		if(entry!=NULL)
+			reportError("find of an absent key",key);
+
+		return;
+	}
+
+	if(entry==NULL || entry->getKey()!=testKey || entry->m_value!=m_reference[key])
+		reportError("find",key);
+}
+
+void TableTest::erase(uint64_t key){
+	TestKey testKey;
+	testKey.m_value=key;
+
+	bool resizing=m_table.needsToCompleteResizing();
+	bool present=m_reference.count(key)>0;
+
+	if(m_table.erase(&testKey)!=present)
+		reportError("erase",key);
+
+	if(m_table.find(&testKey)!=NULL)
+		reportError("find after erase",key);
+
+	if(!present)
+		return;
+
+	if(resizing)
+		m_erasesDuringResize++;
+
+	m_reference.erase(key);
+	m_erasedKeys.insert(key);
+}
+
+/*
+ * count the resizes, a resize that ends with the same capacity
+ * cleaned the tombstones
+ */
+void TableTest::checkResizing(){
+	bool resizing=m_table.needsToCompleteResizing();
+
+	if(m_resizing && !resizing){
+		if(m_table.capacity()==m_capacity)
+			m_rebuilds++;
+		else
+			m_growths++;
+	}
+
+	m_resizing=resizing;
+	m_capacity=m_table.capacity();
+}
+
+void TableTest::checkContent(){
+	if(m_table.size()!=m_reference.size())
+		reportError("size",m_table.size());
+
+	vector<TestKey> keys;
+
+	for(map<uint64_t,uint64_t>::iterator i=m_reference.begin();i!=m_reference.end();i++){
+		TestKey key;
+		key.m_value=i->first;
+		keys.push_back(key);
+	}
+
+	if(keys.empty())
+		return;
+
+	vector<TestValue*> entries(keys.size());
+
+	m_table.findBatch(&keys[0],keys.size(),&entries[0]);
+
+	for(int i=0;i<(int)keys.size();i++){
+		if(entries[i]==NULL || entries[i]->getKey()!=keys[i]
+				|| entries[i]->m_value!=m_reference[keys[i].m_value])
+			reportError("findBatch",keys[i].m_value);
+	}
+
+	// when it is not resizing, the buckets hold exactly the keys of the map
+	if(m_table.needsToCompleteResizing())
+		return;
+
+	uint64_t utilised=0;
+
+	for(uint64_t bucket=0;bucket<m_table.capacity();bucket++){
+		if(m_table.isAvailable(bucket))
+			continue;
+
+		utilised++;
+
+		TestValue*entry=m_table.at(bucket);
+
+		if(m_reference.count(entry->m_key.m_value)==0)
+			reportError("bucket with an erased key",entry->m_key.m_value);
+	}
+
+	if(utilised!=m_reference.size())
+		reportError("number of utilised buckets",utilised);
+}
+
+void TableTest::runPhase(uint64_t operations,uint64_t keys,int insertPercent,int erasePercent,uint64_t seed){
+
+	for(uint64_t i=0;i<operations;i++){
+		uint64_t random=uniform_hashing_function_1_64_64((seed<<40)|i);
+		uint64_t key=(random>>8)%keys;
+		int operation=random%100;
+
+		if(operation<insertPercent)
+			insert(key,random|1);
+		else if(operation<insertPercent+erasePercent)
+			erase(key);
+		else
+			find(key);
+
+		m_operations++;
+
+		if(m_table.size()!=m_reference.size())
+			reportError("size",key);
+
+		checkResizing();
+
+		if(i%TEST_CHECK_PERIOD==0)
+			checkContent();
+
+		if(i%(TEST_CHECK_PERIOD*4)==0)
+			m_table.defragment();
+	}
+
+	checkContent();
+}
+
+/*
+ * A window of keys slides: each new key is inserted and the oldest one
+ * is erased, so the tombstones pile up while the size stays the same.
+ */
+void TableTest::runSlidingPhase(uint64_t operations,uint64_t window,uint64_t firstKey){
+
+	for(uint64_t i=0;i<operations;i++){
+		uint64_t key=firstKey+i;
+
+		insert(key,key*3);
+
+		if(i>=window)
+			erase(key-window);
+
+		find(firstKey+uniform_hashing_function_1_64_64(i)%(i+1));
+
+		m_operations++;
+
+		if(m_table.size()!=m_reference.size())
+			reportError("size",key);
+
+		checkResizing();
+
+		if(i%TEST_CHECK_PERIOD==0)
+			checkContent();
+	}
+
+	checkContent();
+}
+
+/*
+ * Each insert transfers a few buckets, so right after the resize starts,
+ * the first keys are in both tables and the other ones only in the old one.
+ */
+void TableTest::eraseDuringResize(){
+	uint64_t key=1000000000;
+
+	while(!m_table.needsToCompleteResizing()){
+		insert(key,key);
+		key++;
+		checkResizing();
+	}
+
+	for(int i=0;i<4;i++){
+		insert(key,key);
+		key++;
+		checkResizing();
+	}
+
+	vector<uint64_t> keys;
+
+	for(map<uint64_t,uint64_t>::iterator i=m_reference.begin();i!=m_reference.end();i++)
+		keys.push_back(i->first);
+
+	for(int i=0;i<(int)keys.size();i++){
+		erase(keys[i]);
+		checkResizing();
+	}
+
+	checkContent();
+
+	m_table.completeResizing();
+	checkResizing();
+	checkContent();
+
+	for(int i=0;i<(int)keys.size();i++)
+		find(keys[i]);
+
+	for(int i=0;i<(int)keys.size();i++){
+		insert(keys[i],keys[i]*7);
+		checkResizing();
+	}
+
+	m_table.completeResizing();
+	checkResizing();
+	checkContent();
+}
+
+int main(int argc,char**argv){
+
+	uint64_t operations=200000;
+
+	if(argc>1)
+		operations=strtoull(argv[1],NULL,10);
+
+	TableTest test;
+	test.constructor();
+
+	// churn on a few keys
+	test.runPhase(operations,2000,40,30,1);
+
+	// growth
+	test.runPhase(operations,50000,70,10,2);
+
+	// mostly erases
+	test.runPhase(operations,50000,20,60,3);
+
+	// the tombstones fill the table, which is rebuilt with the same size
+	test.runSlidingPhase(operations,2000,100000000);
+
+	// churn again, on the keys that are left
+	test.runPhase(operations,50000,40,40,4);
+
+	test.eraseDuringResize();
+
+	test.m_table.completeResizing();
+	test.checkResizing();
+	test.checkContent();
+
+	bool covered=test.m_erasesDuringResize>0 && test.m_reinsertions>0
+		&& test.m_growths>0 && test.m_rebuilds>0;
+
+	if(!covered)
+		cout<<"Error: the operations did not cover erase during a resize, reinsertion and both resizes"<<endl;
+
+	bool success=test.m_errors==0 && covered;
+
+	cout<<"MyHashTable: "<<test.m_operations<<" operations, "<<test.m_erasesDuringResize<<" erases during a resize, ";
+	cout<<test.m_reinsertions<<" reinsertions, "<<test.m_growths<<" growths, "<<test.m_rebuilds<<" same-size rebuilds, ";
+	cout<<test.m_errors<<" errors "<<(success?"PASSED":"FAILED")<<endl;
+
+	test.destructor();
+
+	return success?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -0,0 +1,196 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+/*
+ * Latency micro-benchmark for the receive engines of the MessagesHandler.
+ *
+ * The ranks are paired (0 with 1, 2 with 3, and so on) and each pair
+ * plays ping-pong at the same time with 8-byte messages, through
+ * MessagesHandler::sendMessages and MessagesHandler::receiveMessages,
+ * like a ComputeCore does at each tick. Rank 0 prints the one-way
+ * latency (half of a round trip) averaged over the pairs, and the
+ * slowest pair.
+ *
+ * Usage:
+ *
+ * mpiexec -n <ranks> tests/ReceiveLatencyBenchmark -receive-engine probe|persistent [-round-trips <n>]
+ *
+ * With an odd number of ranks, the last rank stays idle.
+ */
+
+#include <RayPlatform/communication/MessagesHandler.h>
+#include <RayPlatform/memory/RingAllocator.h>
+#include <RayPlatform/structures/StaticVector.h>
+
+#include <mpi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_TAG 7
+#define BENCHMARK_WARM_UP 1000
+#define BENCHMARK_RECEIVE_BATCH 4
+#define BENCHMARK_BUFFERS 64
+
+class Endpoint{
+public:
+	MessagesHandler*m_handler;
+	StaticVector m_inbox;
+	StaticVector m_outbox;
+	RingAllocator m_inboxAllocator;
+	RingAllocator m_outboxAllocator;
+
+	void constructor(MessagesHandler*handler);
+	void send(Rank destination,MessageUnit value);
+	MessageUnit receive();
+	void destructor();
+};
+
+void Endpoint::constructor(MessagesHandler*handler){
+	m_handler=handler;
+
+	int bufferSize=MAXIMUM_MESSAGE_SIZE_IN_BYTES+MESSAGE_HEADER_MAXIMUM_SIZE;
+
+	m_inbox.constructor(BENCHMARK_BUFFERS,"RAY_MALLOC_TYPE_INBOX_VECTOR",false);
+	m_outbox.constructor(BENCHMARK_BUFFERS,"RAY_MALLOC_TYPE_OUTBOX_VECTOR",false);
+	m_inboxAllocator.constructor(BENCHMARK_BUFFERS,bufferSize,"RAY_MALLOC_TYPE_INBOX_ALLOCATOR",false);
+	m_outboxAllocator.constructor(BENCHMARK_BUFFERS,bufferSize,"RAY_MALLOC_TYPE_OUTBOX_ALLOCATOR",false);
+}
+
+void Endpoint::send(Rank destination,MessageUnit value){
+
+	MessageUnit*buffer=(MessageUnit*)m_outboxAllocator.allocate(sizeof(MessageUnit));
+	buffer[0]=value;
+
+	Message message(buffer,1,destination,BENCHMARK_TAG,m_handler->getRank());
+	m_outbox.push_back(&message);
+
+	m_handler->sendMessages(&m_outbox,&m_outboxAllocator);
+	m_outboxAllocator.resetCount();
+}
+
+/*
+ * Poll like the ticks of an idle ComputeCore until a message arrives.
+ */
+MessageUnit Endpoint::receive(){
+
+	while(1){
+		m_inbox.clear();
+		m_handler->receiveMessages(&m_inbox,&m_inboxAllocator,BENCHMARK_RECEIVE_BATCH);
+
+		if(m_inbox.size()>0)
+			break;
+	}
+
+	MessageUnit value=m_inbox[0]->getBuffer()[0];
+	m_inbox.clear();
+
+	return value;
+}
+
+void Endpoint::destructor(){
+	m_inboxAllocator.clear();
+	m_outboxAllocator.clear();
+}
+
+int main(int argc,char**argv){
+
+	MessagesHandler handler;
+	handler.constructor(&argc,&argv);
+
+	int roundTrips=100000;
+
+	const char*engine="persistent";
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-round-trips")==0 && i+1<argc)
+			roundTrips=atoi(argv[i+1]);
+		else if(strcmp(argv[i],"-receive-engine")==0 && i+1<argc)
+			engine=argv[i+1];
+	}
+
+	Rank rank=handler.getRank();
+	int size=handler.getSize();
+
+	Endpoint endpoint;
+	endpoint.constructor(&handler);
+
+	Rank peer=rank^1;
+	bool playing=peer<size;
+	bool serving=(rank%2==0);
+
+	double latency=0;
+
+	for(int phase=0;phase<2 && playing;phase++){
+
+		int iterations=BENCHMARK_WARM_UP;
+
+		if(phase==1){
+			iterations=roundTrips;
+			MPI_Barrier(MPI_COMM_WORLD);
+		}
+
+		double start=MPI_Wtime();
+
+		for(int i=0;i<iterations;i++){
+			if(serving){
+				endpoint.send(peer,i);
+
+				if(endpoint.receive()!=(MessageUnit)i){
+					cout<<"Error: rank "<<rank<<" received a wrong reply"<<endl;
+					MPI_Abort(MPI_COMM_WORLD,1);
+				}
+			}else{
+				endpoint.send(peer,endpoint.receive());
+			}
+		}
+
+		latency=(MPI_Wtime()-start)/iterations/2*1000000;
+	}
+
+	// the idle rank must join the barrier of the pairs
+	if(!playing)
+		MPI_Barrier(MPI_COMM_WORLD);
+
+	double pairLatency=(playing && serving)?latency:0;
+	double sum=0;
+	double maximum=0;
+	int pairs=size/2;
+
+	MPI_Reduce(&pairLatency,&sum,1,MPI_DOUBLE,MPI_SUM,MASTER_RANK,MPI_COMM_WORLD);
+	MPI_Reduce(&pairLatency,&maximum,1,MPI_DOUBLE,MPI_MAX,MASTER_RANK,MPI_COMM_WORLD);
+
+	if(rank==MASTER_RANK){
+		cout<<"engine "<<engine<<" ranks "<<size<<" round-trips "<<roundTrips;
+		cout<<" one-way latency: average "<<sum/pairs<<" us, slowest pair "<<maximum<<" us"<<endl;
+	}
+
+	// every message was answered, so no send is pending
+	MPI_Barrier(MPI_COMM_WORLD);
+
+	endpoint.destructor();
+	handler.destructor();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Startup benchmark for the routing graphs of the MessageRouter.
+ *
+ * For each number of simulated ranks and each type of graph, a child
+ * process builds the ConnectionGraph like MessageRouter::enable does
+ * on every rank with -route-messages, and reports the seconds spent,
+ * the growth of the data segment (VmData) and the time to look up the
+ * next rank of routes between random pairs of ranks. The results are
+ * printed again at the end, after the progress messages of the graphs.
+ *
+ * Usage: RouteStartupBenchmark [-ranks <n,n,...>] [-types <type,type,...>] [-degree <degree>] [-threads <n>]
+ *
+ * The defaults are 256,1024,4096 ranks, the types
+ * debruijn,polytope,torus,group,random,complete, a degree of 4 and 1
+ * thread. A Kautz graph can not have 256, 1024 or 4096 vertices.
+ */
+
+#include <RayPlatform/routing/ConnectionGraph.h>
+#include <RayPlatform/core/OperatingSystem.h>
+#include <RayPlatform/cryptography/crypto.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_LOOKUPS 1000000
+
+void split(const char*text,vector<string>*items){
+	items->clear();
+
+	istringstream stream(text);
+	string item;
+
+	while(getline(stream,item,','))
+		items->push_back(item);
+}
+
+/** the result is written in the pipe */
+void benchmark(int ranks,string type,int degree,int threads,int pipe){
+
+	uint64_t startingMemory=getMemoryUsageInKiBytes();
+	uint64_t startingTime=getMicroseconds();
+
+	ConnectionGraph*graph=new ConnectionGraph();
+	graph->buildGraph(ranks,type,false,degree,threads);
+	graph->start(MASTER_RANK);
+
+	double seconds=(getMicroseconds()-startingTime)/1000000.0;
+	uint64_t memory=getMemoryUsageInKiBytes();
+
+	/* the next rank at the source of random routes */
+	uint64_t checksum=0;
+	startingTime=getMicroseconds();
+
+	for(uint64_t i=0;i<BENCHMARK_LOOKUPS;i++){
+		Rank source=uniform_hashing_function_1_64_64(i)%ranks;
+		Rank destination=uniform_hashing_function_2_64_64(i)%ranks;
+
+		/* a message is never routed to its source */
+		if(destination==source)
+			destination=(destination+1)%ranks;
+
+		checksum+=graph->getNextRankInRoute(source,destination,source);
+	}
+
+	double lookupSeconds=(getMicroseconds()-startingTime)/1000000.0;
+
+	ostringstream result;
+	result<<type<<", "<<ranks<<" ranks: "<<seconds<<" s, "<<(memory-startingMemory)/1024.0<<" MiB, ";
+	result<<lookupSeconds*1000000000/BENCHMARK_LOOKUPS<<" ns/next rank (checksum "<<checksum<<")"<<endl;
+
+	cout<<result.str();
+
+	string text=result.str();
+	if(write(pipe,text.c_str(),text.length())!=(ssize_t)text.length())
+		_exit(EXIT_FAILURE);
+}
+
+int main(int argc,char**argv){
+
+	vector<string> rankList;
+	vector<string> types;
+	int degree=4;
+	int threads=1;
+
+	split("256,1024,4096",&rankList);
+	split("debruijn,polytope,torus,group,random,complete",&types);
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-ranks")==0 && i+1<argc)
+			split(argv[i+1],&rankList);
+		else if(strcmp(argv[i],"-types")==0 && i+1<argc)
+			split(argv[i+1],&types);
+		else if(strcmp(argv[i],"-degree")==0 && i+1<argc)
+			degree=atoi(argv[i+1]);
+		else if(strcmp(argv[i],"-threads")==0 && i+1<argc)
+			threads=atoi(argv[i+1]);
+	}
+
+	int failures=0;
+	string results;
+
+	for(int i=0;i<(int)rankList.size();i++){
+		for(int j=0;j<(int)types.size();j++){
+
+			cout.flush();
+
+			int descriptors[2];
+			if(pipe(descriptors)!=0){
+				cout<<"Error: can not create a pipe"<<endl;
+				return EXIT_FAILURE;
+			}
+
+			/* a child per graph, so that the memory of a graph is not reused by the next */
+			pid_t child=fork();
+
+			if(child==0){
+				close(descriptors[0]);
+				benchmark(atoi(rankList[i].c_str()),types[j],degree,threads,descriptors[1]);
+				cout.flush();
+				_exit(EXIT_SUCCESS);
+			}
+
+			close(descriptors[1]);
+
+			char buffer[256];
+			ssize_t bytes=0;
+
+			while((bytes=read(descriptors[0],buffer,sizeof(buffer)))>0)
+				results.append(buffer,bytes);
+
+			close(descriptors[0]);
+
+			int status=0;
+			waitpid(child,&status,0);
+
+			if(!WIFEXITED(status) || WEXITSTATUS(status)!=EXIT_SUCCESS){
+				cout<<"Error: "<<types[j]<<" with "<<rankList[i]<<" ranks failed"<<endl;
+				failures++;
+			}
+		}
+	}
+
+	cout<<endl<<results;
+
+	return failures==0?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -0,0 +1,306 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Throughput benchmark for the messages larger than
+ * MAXIMUM_MESSAGE_SIZE_IN_BYTES, sent with the MessageStreamer.
+ *
+ * Rank 0 sends messages of 64 KB, 256 KB, and so on up to 64 MB, to the
+ * destination rank, one at a time. The destination checks the bytes of
+ * each message in its handler and acknowledges it. A message is timed
+ * from the call to MessageStreamer::send to the reception of the
+ * acknowledgement, and rank 0 prints the throughput for each size.
+ *
+ * Usage:
+ *
+ * mpiexec -n <ranks> tests/StreamThroughputBenchmark [-minimum <bytes>] [-maximum <bytes>] [-repeats <n>]
+ *	[-destination <rank>] [-compute-checksums] [-route-messages <type> <degree>] [-stream-window <chunks>]
+ *
+ * The defaults are 65536 to 67108864 bytes, 3 messages per size and
+ * rank 1 as the destination. -stream-window is handled by the
+ * ComputeCore.
+ */
+
+#include <RayPlatform/core/ComputeCore.h>
+#include <RayPlatform/core/MiniRank.h>
+#include <RayPlatform/core/RankProcess.h>
+#include <RayPlatform/core/OperatingSystem.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+using namespace std;
+
+uint64_t g_minimum=65536;
+uint64_t g_maximum=67108864;
+int g_repeats=3;
+Rank g_destination=1;
+bool g_checksums=false;
+const char*g_routingType=NULL;
+int g_routingDegree=2;
+
+/** the byte at an offset of a message */
+char getByte(uint64_t offset,uint64_t bytes){
+	return (char)(offset*7+bytes);
+}
+
+class StreamThroughput;
+
+__DeclarePlugin(StreamThroughput);
+
+__DeclareMasterModeAdapter(StreamThroughput,RAY_MASTER_MODE_STREAM_THROUGHPUT);
+__DeclareMessageTagAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_DATA);
+__DeclareMessageTagAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT);
+__DeclareMessageTagAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_STOP);
+
+class StreamThroughput: public CorePlugin{
+
+	__AddAdapter(StreamThroughput,RAY_MASTER_MODE_STREAM_THROUGHPUT);
+	__AddAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_DATA);
+	__AddAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT);
+	__AddAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_STOP);
+
+	MasterMode RAY_MASTER_MODE_STREAM_THROUGHPUT;
+	MessageTag RAY_MPI_TAG_STREAM_THROUGHPUT_DATA;
+	MessageTag RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT;
+	MessageTag RAY_MPI_TAG_STREAM_THROUGHPUT_STOP;
+
+	ComputeCore*m_core;
+
+	uint64_t m_bytes;
+	char*m_buffer;
+	int m_repeat;
+	int m_handle;
+	bool m_sent;
+	bool m_acknowledged;
+	bool m_done;
+	uint64_t m_startingTime;
+	uint64_t m_microseconds;
+	int m_receivedMessages;
+	int m_errors;
+
+	void fillBuffer(){
+		m_buffer=(char*)malloc(m_bytes);
+
+		for(uint64_t i=0;i<m_bytes;i++)
+			m_buffer[i]=getByte(i,m_bytes);
+	}
+
+public:
+
+	void registerPlugin(ComputeCore*core){
+		m_core=core;
+		m_bytes=g_minimum;
+		m_buffer=NULL;
+		m_repeat=0;
+		m_handle=-1;
+		m_sent=false;
+		m_acknowledged=false;
+		m_done=false;
+		m_microseconds=0;
+		m_receivedMessages=0;
+		m_errors=0;
+
+		PluginHandle plugin=core->allocatePluginHandle();
+		m_plugin=plugin;
+
+		core->setPluginName(plugin,"StreamThroughput");
+
+		RAY_MASTER_MODE_STREAM_THROUGHPUT=core->allocateMasterModeHandle(plugin);
+		core->setMasterModeSymbol(plugin,RAY_MASTER_MODE_STREAM_THROUGHPUT,"RAY_MASTER_MODE_STREAM_THROUGHPUT");
+		core->setMasterModeObjectHandler(plugin,RAY_MASTER_MODE_STREAM_THROUGHPUT,
+			__GetAdapter(StreamThroughput,RAY_MASTER_MODE_STREAM_THROUGHPUT));
+
+		RAY_MPI_TAG_STREAM_THROUGHPUT_DATA=core->allocateMessageTagHandle(plugin);
+		core->setMessageTagSymbol(plugin,RAY_MPI_TAG_STREAM_THROUGHPUT_DATA,"RAY_MPI_TAG_STREAM_THROUGHPUT_DATA");
+		core->setMessageTagObjectHandler(plugin,RAY_MPI_TAG_STREAM_THROUGHPUT_DATA,
+			__GetAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_DATA));
+
+		RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT=core->allocateMessageTagHandle(plugin);
+		core->setMessageTagSymbol(plugin,RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT,"RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT");
+		core->setMessageTagObjectHandler(plugin,RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT,
+			__GetAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT));
+
+		RAY_MPI_TAG_STREAM_THROUGHPUT_STOP=core->allocateMessageTagHandle(plugin);
+		core->setMessageTagSymbol(plugin,RAY_MPI_TAG_STREAM_THROUGHPUT_STOP,"RAY_MPI_TAG_STREAM_THROUGHPUT_STOP");
+		core->setMessageTagObjectHandler(plugin,RAY_MPI_TAG_STREAM_THROUGHPUT_STOP,
+			__GetAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_STOP));
+
+		core->setFirstMasterMode(plugin,RAY_MASTER_MODE_STREAM_THROUGHPUT);
+	}
+
+	void resolveSymbols(ComputeCore*core){
+		__BindAdapter(StreamThroughput,RAY_MASTER_MODE_STREAM_THROUGHPUT);
+		__BindAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_DATA);
+		__BindAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT);
+		__BindAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_STOP);
+	}
+
+	void call_RAY_MASTER_MODE_STREAM_THROUGHPUT(){
+		if(m_done)
+			return;
+
+		MessageStreamer*streamer=m_core->getMessageStreamer();
+
+		if(!m_sent){
+			if(m_bytes>g_maximum || g_destination>=m_core->getSize()){
+				if(g_destination>=m_core->getSize())
+					cout<<"Error: the destination "<<g_destination<<" does not exist"<<endl;
+
+				m_done=true;
+				m_core->sendEmptyMessageToAll(RAY_MPI_TAG_STREAM_THROUGHPUT_STOP);
+				return;
+			}
+
+			if(m_buffer==NULL)
+				fillBuffer();
+
+			m_startingTime=getMicroseconds();
+			m_handle=streamer->send(m_buffer,m_bytes,g_destination,RAY_MPI_TAG_STREAM_THROUGHPUT_DATA);
+			m_sent=true;
+			m_acknowledged=false;
+			return;
+		}
+
+		if(m_handle>=0 && streamer->test(m_handle))
+			m_handle=-1;
+
+		if(m_handle>=0 || !m_acknowledged)
+			return;
+
+		m_microseconds+=getMicroseconds()-m_startingTime;
+		m_repeat++;
+		m_sent=false;
+
+		if(m_repeat<g_repeats)
+			return;
+
+		double seconds=m_microseconds/1000000.0/g_repeats;
+
+		cout<<"StreamThroughput: "<<m_bytes<<" bytes, "<<m_bytes/seconds/1000000<<" MB/s, ";
+		cout<<seconds<<" s per message"<<endl;
+
+		free(m_buffer);
+		m_buffer=NULL;
+		m_bytes*=4;
+		m_repeat=0;
+		m_microseconds=0;
+	}
+
+	void call_RAY_MPI_TAG_STREAM_THROUGHPUT_DATA(Message*message){
+		char*bytes=(char*)message->getBuffer();
+		uint64_t numberOfBytes=m_core->getMessageStreamer()->getCompletedMessageBytes();
+
+		for(uint64_t i=0;i<numberOfBytes;i++){
+			if(bytes[i]!=getByte(i,numberOfBytes)){
+				m_errors++;
+				break;
+			}
+		}
+
+		m_receivedMessages++;
+
+		MessageUnit*buffer=m_core->reserveMessage();
+		buffer[0]=numberOfBytes;
+		m_core->commitMessage(buffer,1,message->getSource(),RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT);
+	}
+
+	void call_RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT(Message*message){
+		if(message->getBuffer()[0]!=m_bytes)
+			m_errors++;
+
+		m_acknowledged=true;
+	}
+
+	void call_RAY_MPI_TAG_STREAM_THROUGHPUT_STOP(Message*message){
+		if(m_receivedMessages>0 || m_errors>0){
+			cout<<"Rank "<<m_core->getRank()<<" received "<<m_receivedMessages<<" messages, ";
+			cout<<m_errors<<" errors"<<endl;
+		}
+
+		m_core->stop();
+	}
+};
+
+__CreatePlugin(StreamThroughput);
+
+__CreateMasterModeAdapter(StreamThroughput,RAY_MASTER_MODE_STREAM_THROUGHPUT);
+__CreateMessageTagAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_DATA);
+__CreateMessageTagAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_ACKNOWLEDGEMENT);
+__CreateMessageTagAdapter(StreamThroughput,RAY_MPI_TAG_STREAM_THROUGHPUT_STOP);
+
+class StreamThroughputApplication: public MiniRank{
+
+	StreamThroughput m_streamThroughput;
+
+public:
+	StreamThroughputApplication(int argc,char**argv){
+		for(int i=0;i<argc;i++){
+			if(strcmp(argv[i],"-minimum")==0 && i+1<argc)
+				g_minimum=strtoull(argv[i+1],NULL,10);
+			else if(strcmp(argv[i],"-maximum")==0 && i+1<argc)
+				g_maximum=strtoull(argv[i+1],NULL,10);
+			else if(strcmp(argv[i],"-repeats")==0 && i+1<argc)
+				g_repeats=atoi(argv[i+1]);
+			else if(strcmp(argv[i],"-destination")==0 && i+1<argc)
+				g_destination=atoi(argv[i+1]);
+			else if(strcmp(argv[i],"-compute-checksums")==0)
+				g_checksums=true;
+			else if(strcmp(argv[i],"-route-messages")==0 && i+2<argc){
+				g_routingType=argv[i+1];
+				g_routingDegree=atoi(argv[i+2]);
+			}
+		}
+
+		if(g_minimum<1)
+			g_minimum=1;
+
+		if(g_repeats<1)
+			g_repeats=1;
+	}
+
+	void run(){
+		ComputeCore*core=&m_computeCore;
+
+		if(g_routingType!=NULL)
+			core->getRouter()->enable(core->getInbox(),core->getOutbox(),core->getOutboxAllocator(),
+				core->getRank(),"StreamThroughputBenchmark-",core->getSize(),g_routingType,g_routingDegree);
+
+		if(g_checksums)
+			core->enableCheckSums();
+
+		core->registerPlugin(&m_streamThroughput);
+		core->resolveSymbols();
+		core->run();
+	}
+};
+
+int main(int argc,char**argv){
+	RankProcess<StreamThroughputApplication> process;
+	process.constructor(&argc,&argv);
+	process.run();
+	process.destructor();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Micro-benchmark for VirtualCommunicator::pushMessage.
+ *
+ * A single process pushes queries of one element for simulated
+ * destination ranks chosen at random. When the window of aggregated
+ * messages is full, the aggregated messages in the outbox are answered
+ * as the destinations would do, the replies are processed with
+ * processInbox and each worker reads its reply, then the pushes resume.
+ *
+ * The time spent in pushMessage and the number of operator new calls
+ * made by it (the heap allocations of the STL containers) are reported
+ * per push. The time spent to process the replies is reported per
+ * reply.
+ *
+ * Usage: VirtualCommunicatorBenchmark [-pushes <n>] [-destinations <ranks>] [-window <messages>]
+ *
+ * The defaults are 10000000 pushes, 1024 destinations and a window of 8.
+ */
+
+#include <RayPlatform/communication/VirtualCommunicator.h>
+#include <RayPlatform/cryptography/crypto.h>
+
+#include <sys/time.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_QUERY_TAG 1
+#define BENCHMARK_REPLY_TAG 2
+#define BENCHMARK_BUFFERS 64
+#define BENCHMARK_INBOX_SIZE 1
+
+/* the allocations of the STL containers are counted here */
+uint64_t g_allocations=0;
+
+void*operator new(size_t bytes) throw(std::bad_alloc){
+	g_allocations++;
+
+	void*memory=malloc(bytes==0?1:bytes);
+
+	if(memory==NULL)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void operator delete(void*memory) throw(){
+	free(memory);
+}
+
+double getSeconds(){
+	struct timeval now;
+	gettimeofday(&now,NULL);
+
+	return now.tv_sec+now.tv_usec/1000000.0;
+}
+
+/** the destination of a query */
+Rank getDestination(uint64_t query,int destinations){
+	return uniform_hashing_function_1_64_64(query)%destinations;
+}
+
+int main(int argc,char**argv){
+
+	uint64_t pushes=10000000;
+	int destinations=1024;
+	int window=8;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-pushes")==0 && i+1<argc)
+			pushes=strtoull(argv[i+1],NULL,10);
+		else if(strcmp(argv[i],"-destinations")==0 && i+1<argc)
+			destinations=atoi(argv[i+1]);
+		else if(strcmp(argv[i],"-window")==0 && i+1<argc)
+			window=atoi(argv[i+1]);
+	}
+
+	RingAllocator outboxAllocator;
+	outboxAllocator.constructor(BENCHMARK_BUFFERS,MAXIMUM_MESSAGE_SIZE_IN_BYTES,"RAY_MALLOC_TYPE_OUTBOX_ALLOCATOR",false);
+
+	StaticVector inbox;
+	StaticVector outbox;
+	inbox.constructor(BENCHMARK_INBOX_SIZE,"RAY_MALLOC_TYPE_INBOX_VECTOR",false);
+	outbox.constructor(BENCHMARK_BUFFERS,"RAY_MALLOC_TYPE_OUTBOX_VECTOR",false);
+
+	VirtualCommunicator communicator;
+	communicator.setElementsPerQuery(BENCHMARK_QUERY_TAG,1);
+	communicator.setReplyType(BENCHMARK_QUERY_TAG,BENCHMARK_REPLY_TAG);
+	communicator.constructor(MASTER_RANK,destinations,&outboxAllocator,&inbox,&outbox,window);
+
+	MessageUnit reply[MAXIMUM_MESSAGE_SIZE_IN_BYTES/sizeof(MessageUnit)];
+	vector<WorkerHandle> activeWorkers;
+	vector<MessageUnit> elements;
+
+	double pushSeconds=0;
+	double replySeconds=0;
+	uint64_t pushAllocations=0;
+	uint64_t replies=0;
+	uint64_t errors=0;
+
+	uint64_t pushed=0;
+
+	while(pushed<pushes || communicator.hasMessagesToFlush() || outbox.size()>0){
+
+		double start=getSeconds();
+		uint64_t allocations=g_allocations;
+
+		while(pushed<pushes && communicator.isReady()){
+			MessageUnit query=pushed;
+			Message message(&query,1,getDestination(pushed,destinations),BENCHMARK_QUERY_TAG,MASTER_RANK);
+
+			communicator.pushMessage(pushed,&message);
+			pushed++;
+		}
+
+		if(pushed==pushes && communicator.isReady() && communicator.hasMessagesToFlush())
+			communicator.forceFlush();
+
+		pushSeconds+=getSeconds()-start;
+		pushAllocations+=g_allocations-allocations;
+
+		start=getSeconds();
+
+		// the destinations answer each element with the element plus one
+		for(int i=0;i<outbox.size();i++){
+			Message*query=outbox.at(i);
+			MessageUnit*buffer=query->getBuffer();
+			int count=query->getCount();
+
+			for(int j=0;j<count;j++)
+				reply[j]=buffer[j]+1;
+
+			Message answer(reply,count,MASTER_RANK,BENCHMARK_REPLY_TAG,query->getDestination());
+			answer.setSequence(query->getSequence());
+			inbox.push_back(&answer);
+
+			communicator.processInbox(&activeWorkers);
+			inbox.clear();
+
+			for(int j=0;j<(int)activeWorkers.size();j++){
+				WorkerHandle worker=activeWorkers[j];
+
+				elements.clear();
+				communicator.getMessageResponseElements(worker,&elements);
+
+				if(elements.size()!=1 || elements[0]!=worker+1)
+					errors++;
+
+				replies++;
+			}
+
+			activeWorkers.clear();
+		}
+
+		outbox.clear();
+		outboxAllocator.resetCount();
+
+		replySeconds+=getSeconds()-start;
+	}
+
+	cout<<"VirtualCommunicator: "<<pushes<<" pushes to "<<destinations<<" destinations, window "<<window;
+	cout<<", "<<pushSeconds*1000000000/pushes<<" ns/push, ";
+	cout<<(0.0+pushAllocations)/pushes<<" allocations/push, ";
+	cout<<replySeconds*1000000000/replies<<" ns/reply"<<endl;
+
+	if(replies!=pushes || errors>0){
+		cout<<"Error: "<<replies<<" replies for "<<pushes<<" pushes, "<<errors<<" wrong replies"<<endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,276 @@
+/*
+ 	RayPlatform: a message-passing development framework
+    Copyright (C) 2026 RayPlatform contributors
+
+	http://github.com/sebhtml/RayPlatform: a message-passing development framework
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You have received a copy of the GNU Lesser General Public License
+    along with this program (lgpl-3.0.txt).  
+	see <http://www.gnu.org/licenses/>
+
+*/
+
+
+
+/*
+ * Micro-benchmark for the scheduling of workers by the VirtualProcessor.
+ *
+ * A TaskCreator creates one worker per task, up to the maximum number
+ * of alive workers. Each worker calls work() a number of times and
+ * pushes a query to the VirtualCommunicator every other call, so about
+ * half of the workers sleep at any time. The queries are answered in
+ * the same process, one reply per call to mainLoop, like the replies
+ * received by a ComputeCore at each tick.
+ *
+ * The number of worker switches (calls to Worker::work) per second is
+ * reported.
+ *
+ * Usage: VirtualProcessorBenchmark [-tasks <n>] [-steps <calls per worker>] [-destinations <ranks>] [-window <messages>]
+ *
+ * The defaults are 1000000 tasks, 8 steps, 64 destinations and a window of 8.
+ */
+
+#include <RayPlatform/scheduling/TaskCreator.h>
+#include <RayPlatform/scheduling/VirtualProcessor.h>
+#include <RayPlatform/communication/VirtualCommunicator.h>
+
+#include <sys/time.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deque>
+#include <iostream>
+using namespace std;
+
+#define BENCHMARK_QUERY_TAG 1
+#define BENCHMARK_REPLY_TAG 2
+#define BENCHMARK_BUFFERS 64
+#define BENCHMARK_INBOX_SIZE 1
+
+double getSeconds(){
+	struct timeval now;
+	gettimeofday(&now,NULL);
+
+	return now.tv_sec+now.tv_usec/1000000.0;
+}
+
+uint64_t g_workerSwitches=0;
+uint64_t g_errors=0;
+
+class BenchmarkWorker: public Worker{
+
+	WorkerHandle m_workerId;
+	VirtualCommunicator*m_virtualCommunicator;
+	int m_destinations;
+	int m_steps;
+	int m_step;
+	bool m_waiting;
+	MessageUnit m_value;
+	vector<MessageUnit> m_elements;
+
+public:
+	void constructor(WorkerHandle workerId,VirtualCommunicator*virtualCommunicator,int destinations,int steps){
+		m_workerId=workerId;
+		m_virtualCommunicator=virtualCommunicator;
+		m_destinations=destinations;
+		m_steps=steps;
+		m_step=0;
+		m_waiting=false;
+		m_value=workerId;
+	}
+
+	void work(){
+		g_workerSwitches++;
+
+		if(m_waiting){
+			if(!m_virtualCommunicator->isMessageProcessed(m_workerId))
+				return;
+
+			m_elements.clear();
+			m_virtualCommunicator->getMessageResponseElements(m_workerId,&m_elements);
+
+			if(m_elements.size()!=1 || m_elements[0]!=m_value+1)
+				g_errors++;
+
+			m_value=m_elements[0];
+			m_waiting=false;
+		}else if(m_step%2==0){
+			Message message(&m_value,1,(m_workerId+m_step)%m_destinations,BENCHMARK_QUERY_TAG,MASTER_RANK);
+			m_virtualCommunicator->pushMessage(m_workerId,&message);
+			m_waiting=true;
+		}
+
+		m_step++;
+	}
+
+	bool isDone(){
+		return m_step>=m_steps && !m_waiting;
+	}
+
+	WorkerHandle getWorkerIdentifier(){
+		return m_workerId;
+	}
+};
+
+class BenchmarkTaskCreator: public TaskCreator{
+
+	VirtualCommunicator*m_virtualCommunicator;
+	uint64_t m_tasks;
+	uint64_t m_nextTask;
+	int m_destinations;
+	int m_steps;
+	bool m_done;
+
+public:
+	void constructor(VirtualProcessor*virtualProcessor,VirtualCommunicator*virtualCommunicator,
+		uint64_t tasks,int destinations,int steps){
+
+		m_initialized=false;
+		m_virtualProcessor=virtualProcessor;
+		m_virtualCommunicator=virtualCommunicator;
+		m_tasks=tasks;
+		m_destinations=destinations;
+		m_steps=steps;
+		m_done=false;
+	}
+
+	void initializeMethod(){
+		m_nextTask=0;
+	}
+
+	void finalizeMethod(){
+		m_done=true;
+	}
+
+	bool hasUnassignedTask(){
+		return m_nextTask<m_tasks;
+	}
+
+	Worker*assignNextTask(){
+		BenchmarkWorker*worker=new BenchmarkWorker();
+		worker->constructor(m_nextTask,m_virtualCommunicator,m_destinations,m_steps);
+		m_nextTask++;
+
+		return worker;
+	}
+
+	void processWorkerResult(Worker*worker){
+	}
+
+	void destroyWorker(Worker*worker){
+		delete worker;
+	}
+
+	bool isDone(){
+		return m_done;
+	}
+
+	uint64_t getCompletedJobs(){
+		return m_completedJobs;
+	}
+};
+
+int main(int argc,char**argv){
+
+	uint64_t tasks=1000000;
+	int steps=8;
+	int destinations=64;
+	int window=8;
+
+	for(int i=0;i<argc;i++){
+		if(strcmp(argv[i],"-tasks")==0 && i+1<argc)
+			tasks=strtoull(argv[i+1],NULL,10);
+		else if(strcmp(argv[i],"-steps")==0 && i+1<argc)
+			steps=atoi(argv[i+1]);
+		else if(strcmp(argv[i],"-destinations")==0 && i+1<argc)
+			destinations=atoi(argv[i+1]);
+		else if(strcmp(argv[i],"-window")==0 && i+1<argc)
+			window=atoi(argv[i+1]);
+	}
+
+	RingAllocator outboxAllocator;
+	outboxAllocator.constructor(BENCHMARK_BUFFERS,MAXIMUM_MESSAGE_SIZE_IN_BYTES,"RAY_MALLOC_TYPE_OUTBOX_ALLOCATOR",false);
+
+	StaticVector inbox;
+	StaticVector outbox;
+	inbox.constructor(BENCHMARK_INBOX_SIZE,"RAY_MALLOC_TYPE_INBOX_VECTOR",false);
+	outbox.constructor(BENCHMARK_BUFFERS,"RAY_MALLOC_TYPE_OUTBOX_VECTOR",false);
+
+	VirtualCommunicator communicator;
+	communicator.setElementsPerQuery(BENCHMARK_QUERY_TAG,1);
+	communicator.setReplyType(BENCHMARK_QUERY_TAG,BENCHMARK_REPLY_TAG);
+	communicator.constructor(MASTER_RANK,destinations,&outboxAllocator,&inbox,&outbox,window);
+
+	VirtualProcessor processor;
+	processor.constructor(&outbox,&inbox,&outboxAllocator,&communicator);
+
+	BenchmarkTaskCreator creator;
+	creator.constructor(&processor,&communicator,tasks,destinations,steps);
+
+	/* the replies that the destinations sent, delivered one per tick */
+	deque<vector<MessageUnit> > replies;
+	deque<int> replySources;
+	deque<int> replySequences;
+
+	uint64_t ticks=0;
+	double start=getSeconds();
+
+	while(!creator.isDone()){
+
+		if(!replies.empty()){
+			Message reply(&(replies.front()[0]),replies.front().size(),MASTER_RANK,BENCHMARK_REPLY_TAG,
+				replySources.front());
+			reply.setSequence(replySequences.front());
+			inbox.push_back(&reply);
+		}
+
+		creator.mainLoop();
+		ticks++;
+
+		if(inbox.size()>0){
+			inbox.clear();
+			replies.pop_front();
+			replySources.pop_front();
+			replySequences.pop_front();
+		}
+
+		// the destinations answer each element with the element plus one
+		for(int i=0;i<outbox.size();i++){
+			Message*query=outbox.at(i);
+			MessageUnit*buffer=query->getBuffer();
+
+			replies.push_back(vector<MessageUnit>(buffer,buffer+query->getCount()));
+
+			for(int j=0;j<(int)replies.back().size();j++)
+				replies.back()[j]++;
+
+			replySources.push_back(query->getDestination());
+			replySequences.push_back(query->getSequence());
+		}
+
+		outbox.clear();
+		outboxAllocator.resetCount();
+	}
+
+	double seconds=getSeconds()-start;
+
+	cout<<"VirtualProcessor: "<<tasks<<" tasks, "<<steps<<" steps, "<<g_workerSwitches<<" worker switches in ";
+	cout<<ticks<<" ticks, "<<seconds<<" s, "<<g_workerSwitches/seconds<<" worker switches/s"<<endl;
+
+	if(creator.getCompletedJobs()!=tasks || g_errors>0){
+		cout<<"Error: "<<creator.getCompletedJobs()<<" completed jobs for "<<tasks<<" tasks, ";
+		cout<<g_errors<<" wrong replies"<<endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}